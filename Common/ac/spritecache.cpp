@@ -22,6 +22,14 @@
 #pragma warning (disable: 4996 4312)  // disable deprecation warnings
 #endif
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <thread>
+#include "util/stdtr1compat.h"
+#include TR1INCLUDE(unordered_map)
 #include "ac/common.h" // quit
 #include "ac/gamestructdefines.h"
 #include "ac/spritecache.h"
@@ -30,6 +38,8 @@
 #include "gfx/bitmap.h"
 #include "util/compress.h"
 #include "util/file.h"
+#include "util/lz4.h"
+#include "util/mappedfilestream.h"
 #include "util/stream.h"
 
 using namespace AGS::Common;
@@ -38,9 +48,6 @@ using namespace AGS::Common;
 extern void initialize_sprite(int);
 extern void pre_save_sprite(int);
 
-#define START_OF_LIST -1
-#define END_OF_LIST   -1
-
 const char *spindexid = "SPRINDEX";
 const char *spindexfilename = "sprindex.dat";
 
@@ -60,6 +67,14 @@ SpriteCache::SpriteData::SpriteData()
 {
 }
 
+SpriteCache::Stats::Stats()
+    : Hits(0)
+    , Misses(0)
+    , Evictions(0)
+    , EvictedBytes(0)
+{
+}
+
 SpriteCache::SpriteData::~SpriteData()
 {
     // TODO: investigate, if it's actually safe/preferred to delete bitmap here
@@ -67,11 +82,188 @@ SpriteCache::SpriteData::~SpriteData()
 }
 
 
+// Reads and unpacks sprite pixels of the given format into the rows;
+// works with plain memory only, so may be used from any thread
+static void ReadSpriteRows(Stream *in, SpriteCompression compress, int coldep, int wdd, int htt, uint8_t *const *lines);
+
+// Background sprite loader: the worker thread reads requested sprites from
+// its own stream, and keeps decoded pixels until the cache takes them.
+// Allegro bitmaps are not created on the worker thread: the image is made
+// from the pixels when the sprite is actually requested, on the main thread,
+// along with the rest of the sprite initialization.
+struct SpriteCache::AsyncLoader
+{
+    struct Request
+    {
+        sprkey_t Index;
+        soff_t   Offset;
+    };
+    struct Result
+    {
+        soff_t   Offset;
+        int      ColorDepth; // in bytes
+        int      Width;
+        int      Height;
+        std::vector<uint8_t> Pixels; // rows without padding
+        std::list<sprkey_t>::iterator OrderIt; // position in DoneOrder
+
+        Result() : Offset(0), ColorDepth(0), Width(0), Height(0) {}
+
+        // Creates the sprite image from the pixels; must be called on the main thread
+        Bitmap *CreateImage() const
+        {
+            Bitmap *image = BitmapHelper::CreateBitmap(Width, Height, ColorDepth * 8);
+            if (image == NULL)
+                return NULL;
+            const size_t pitch = Width * ColorDepth;
+            for (int hh = 0; hh < Height; ++hh)
+                memcpy(image->GetScanLineForWriting(hh), &Pixels[hh * pitch], pitch);
+            return image;
+        }
+    };
+    typedef stdtr1compat::unordered_map<sprkey_t, Result> ResultMap;
+
+    std::unique_ptr<Stream> In; // separately opened sprite stream
+    const SpriteCompression Compression;
+    std::thread     Thread;
+    std::mutex      Mutex;
+    std::condition_variable Cond;
+    std::deque<Request> Queue;  // pending requests
+    sprkey_t        Current;    // sprite being loaded right now, or -1
+    ResultMap       Done;       // loaded pixels, waiting to be taken
+    std::list<sprkey_t> DoneOrder; // loaded sprites, oldest first
+    size_t          DoneSize;   // total size of the waiting pixels
+    size_t          MaxDoneSize;
+    bool            Exit;
+
+    AsyncLoader(Stream *in, SpriteCompression compress)
+        : In(in)
+        , Compression(compress)
+        , Current(-1)
+        , DoneSize(0)
+        , MaxDoneSize(0)
+        , Exit(false)
+    {
+        Thread = std::thread(&AsyncLoader::Run, this);
+    }
+
+    ~AsyncLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(Mutex);
+            Exit = true;
+        }
+        Cond.notify_all();
+        Thread.join();
+    }
+
+    // Tells if the sprite is already scheduled or loaded; must be locked
+    bool IsScheduled(sprkey_t index) const
+    {
+        if (Current == index || Done.count(index) > 0)
+            return true;
+        for (std::deque<Request>::const_iterator it = Queue.begin(); it != Queue.end(); ++it)
+            if (it->Index == index)
+                return true;
+        return false;
+    }
+
+    // Reads and unpacks the sprite from the stream positioned at its data;
+    // returns false for the sprites left for the main thread to load
+    bool Read(Result &res)
+    {
+        res.ColorDepth = In->ReadInt16();
+        // empty and 24-bit sprites are read the regular way
+        if (res.ColorDepth != 1 && res.ColorDepth != 2 && res.ColorDepth != 4)
+            return false;
+        res.Width = In->ReadInt16();
+        res.Height = In->ReadInt16();
+        if (res.Width <= 0 || res.Height <= 0)
+            return false;
+        const size_t pitch = res.Width * res.ColorDepth;
+        res.Pixels.resize(pitch * res.Height);
+        std::vector<uint8_t*> lines(res.Height);
+        for (int hh = 0; hh < res.Height; ++hh)
+            lines[hh] = &res.Pixels[hh * pitch];
+        ReadSpriteRows(In.get(), Compression, res.ColorDepth, res.Width, res.Height, &lines[0]);
+        return true;
+    }
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(Mutex);
+        for (;;)
+        {
+            while (!Exit && Queue.empty())
+                Cond.wait(lock);
+            if (Exit)
+                break;
+            Request req = Queue.front();
+            Queue.pop_front();
+            Current = req.Index;
+            lock.unlock();
+
+            In->Seek(req.Offset, kSeekBegin);
+            Result res;
+            res.Offset = req.Offset;
+            const bool loaded = Read(res);
+
+            lock.lock();
+            Current = -1;
+            if (loaded)
+            {
+                DoneSize += res.Pixels.size();
+                Result &done = Done[req.Index];
+                done = std::move(res);
+                done.OrderIt = DoneOrder.insert(DoneOrder.end(), req.Index);
+                // if nobody takes these, drop the oldest ones
+                while (DoneSize > MaxDoneSize && Done.size() > 1)
+                    Release(Done.find(DoneOrder.front()));
+            }
+            Cond.notify_all();
+        }
+    }
+
+    // Removes the waiting result from the list and returns it; must be locked
+    Result Release(ResultMap::iterator it)
+    {
+        Result res = std::move(it->second);
+        DoneOrder.erase(res.OrderIt);
+        DoneSize -= res.Pixels.size();
+        Done.erase(it);
+        return res;
+    }
+
+    // Removes the sprite from the queue, or waits until it is loaded and
+    // takes the result; returns false if there is no result; must be locked
+    bool Take(sprkey_t index, std::unique_lock<std::mutex> &lock, Result &res)
+    {
+        // if still in queue, then there's no reason to wait for it
+        for (std::deque<Request>::iterator it = Queue.begin(); it != Queue.end(); ++it)
+        {
+            if (it->Index == index)
+            {
+                Queue.erase(it);
+                return false;
+            }
+        }
+        while (Current == index)
+            Cond.wait(lock);
+        ResultMap::iterator it = Done.find(index);
+        if (it == Done.end())
+            return false;
+        res = Release(it);
+        return true;
+    }
+};
+
+
 SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos)
     : _sprInfos(sprInfos)
 {
     _sprite0InitialOffset = 0;
-    _compressed = false;
+    _compress = kSprCompress_None;
+    _useFileMapping = true;
     Init();
 }
 
@@ -95,6 +287,16 @@ size_t SpriteCache::GetMaxCacheSize() const
     return _maxCacheSize;
 }
 
+const SpriteCache::Stats &SpriteCache::GetStats() const
+{
+    return _stats;
+}
+
+void SpriteCache::ResetStats()
+{
+    _stats = Stats();
+}
+
 sprkey_t SpriteCache::GetSpriteSlotCount() const
 {
     return _spriteData.size();
@@ -114,18 +316,43 @@ void SpriteCache::SetMaxCacheSize(size_t size)
     _maxCacheSize = size;
 }
 
+void SpriteCache::SetFileMapping(bool enable)
+{
+    _useFileMapping = enable;
+}
+
+bool SpriteCache::IsImageMapped(const Bitmap *image) const
+{
+    return _mappedFile && image && _mappedFile->HasAddress(image->GetData());
+}
+
+Bitmap *SpriteCache::GetWritableImage(sprkey_t index)
+{
+    Bitmap *image = (*this)[index];
+    if (!IsImageMapped(image))
+        return image;
+    // same image may be assigned to multiple slots
+    Bitmap *copy = BitmapHelper::CreateBitmapCopy(image);
+    for (size_t i = 0; i < _spriteData.size(); ++i)
+    {
+        if (_spriteData[i].Image == image)
+            _spriteData[i].Image = copy;
+    }
+    delete image;
+    return copy;
+}
+
 void SpriteCache::Init()
 {
     _cacheSize = 0;
     _lockedSize = 0;
     _maxCacheSize = DEFAULTCACHESIZE;
-    _liststart = -1;
-    _listend = -1;
     _lastLoad = -2;
 }
 
 void SpriteCache::Reset()
 {
+    _asyncLoader.reset();
     _stream.reset();
     // TODO: find out if it's safe to simply always delete _spriteData.Image with array element
     for (size_t i = 0; i < _spriteData.size(); ++i)
@@ -137,22 +364,61 @@ void SpriteCache::Reset()
         }
     }
     _spriteData.clear();
-
-    _mrulist.clear();
-    _mrubacklink.clear();
+    _mru.clear();
+    _mappedFile.reset();
+    _deferred.clear();
 
     Init();
 }
 
+void SpriteCache::TouchMRU(sprkey_t index)
+{
+    SpriteData &spr = _spriteData[index];
+    if (spr.Flags & SPRCACHEFLAG_INMRULIST)
+    {
+        _mru.splice(_mru.end(), _mru, spr.MruIt);
+    }
+    else
+    {
+        spr.MruIt = _mru.insert(_mru.end(), index);
+        spr.Flags |= SPRCACHEFLAG_INMRULIST;
+    }
+}
+
+void SpriteCache::RemoveFromMRU(sprkey_t index)
+{
+    SpriteData &spr = _spriteData[index];
+    if (spr.Flags & SPRCACHEFLAG_INMRULIST)
+    {
+        _mru.erase(spr.MruIt);
+        spr.Flags &= ~SPRCACHEFLAG_INMRULIST;
+    }
+}
+
 void SpriteCache::Set(sprkey_t index, Bitmap *sprite)
 {
     EnlargeTo(index + 1);
     _spriteData[index].Image = sprite;
+    if (!_deferred.empty())
+        _deferred.erase(index);
+}
+
+void SpriteCache::SetDeferred(sprkey_t index, const ImageLoader &loader)
+{
+    EnlargeTo(index + 1);
+    _spriteData[index].Image = NULL;
+    _deferred[index] = loader;
+}
+
+bool SpriteCache::IsDeferred(sprkey_t index) const
+{
+    return !_deferred.empty() && _deferred.count(index) > 0;
 }
 
 void SpriteCache::SetSpriteAndLock(sprkey_t index, Bitmap *sprite)
 {
     EnlargeTo(index + 1);
+    RemoveFromMRU(index);
     _spriteData[index].Image = sprite;
     _spriteData[index].Flags |= SPRCACHEFLAG_LOCKED;
 }
@@ -161,9 +427,20 @@ void SpriteCache::RemoveSprite(sprkey_t index, bool freeMemory)
 {
     if ((_spriteData[index].Image != NULL) && (freeMemory))
         delete _spriteData[index].Image;
+    // the image might be already loading in background
+    if (_asyncLoader && _spriteData[index].Offset > 0)
+        CancelPrefetch(index);
+    // the loaded sprite is no longer accounted in cache
+    if (_spriteData[index].Flags & SPRCACHEFLAG_INMRULIST)
+    {
+        _cacheSize -= _spriteData[index].Size;
+        RemoveFromMRU(index);
+    }
 
     _spriteData[index].Image = NULL;
     _spriteData[index].Offset = 0;
+    if (!_deferred.empty())
+        _deferred.erase(index);
 }
 
 sprkey_t SpriteCache::EnlargeTo(sprkey_t newsize)
@@ -176,8 +453,6 @@ sprkey_t SpriteCache::EnlargeTo(sprkey_t newsize)
     sprkey_t elementsWas = (sprkey_t)_spriteData.size();
     _sprInfos.resize(newsize);
     _spriteData.resize(newsize);
-    _mrulist.resize(newsize);
-    _mrubacklink.resize(newsize);
     return elementsWas;
 }
 
@@ -188,7 +463,8 @@ sprkey_t SpriteCache::AddNewSprite()
     for (size_t i = MIN_SPRITE_INDEX; i < _spriteData.size(); ++i)
     {
         // slot empty
-        if ((_spriteData[i].Image == NULL) && ((_spriteData[i].Offset == 0) || (_spriteData[i].Offset == _sprite0InitialOffset)))
+        if ((_spriteData[i].Image == NULL) && ((_spriteData[i].Offset == 0) || (_spriteData[i].Offset == _sprite0InitialOffset)) &&
+            !IsDeferred(i))
         {
             _sprInfos[i] = SpriteInfo();
             _spriteData[i] = SpriteData();
@@ -202,6 +478,7 @@ sprkey_t SpriteCache::AddNewSprite()
 bool SpriteCache::DoesSpriteExist(sprkey_t index) const
 {
     return _spriteData[index].Image != NULL || // has loaded bitmap
+        IsDeferred(index) || // bitmap is created on first use
         (_spriteData[index].Flags & SPRCACHEFLAG_DOESNOTEXIST) == 0 || // not marked as an empty slot
         _spriteData[index].Offset > 0; // bitmap is unloaded, but has valid sprite file offset
 }
@@ -212,6 +489,20 @@ Bitmap *SpriteCache::operator [] (sprkey_t index)
     if (index < 0 || (size_t)index >= _spriteData.size())
         return NULL;
 
+    // Sprite image which was not needed until now; it is not a part of the
+    // cache, same as the other dynamically added sprites
+    if (_spriteData[index].Image == NULL && !_deferred.empty())
+    {
+        stdtr1compat::unordered_map<sprkey_t, ImageLoader>::iterator it = _deferred.find(index);
+        if (it != _deferred.end())
+        {
+            ImageLoader loader = it->second;
+            _deferred.erase(it);
+            _spriteData[index].Image = loader();
+            return _spriteData[index].Image;
+        }
+    }
+
     // Dynamically added sprite, don't put it on the sprite list
     if ((_spriteData[index].Image != NULL) &&
         ((_spriteData[index].Offset == 0) || ((_spriteData[index].Flags & SPRCACHEFLAG_DOESNOTEXIST) != 0)))
@@ -219,103 +510,74 @@ Bitmap *SpriteCache::operator [] (sprkey_t index)
 
     // if sprite exists in file but is not in mem, load it
     if ((_spriteData[index].Image == NULL) && (_spriteData[index].Offset > 0))
+    {
+        _stats.Misses++;
         LoadSprite(index);
+    }
+    else if (_spriteData[index].Image != NULL)
+    {
+        _stats.Hits++;
+    }
 
     // Locked sprite, eg. mouse cursor, that shouldn't be discarded
     if (_spriteData[index].Flags & SPRCACHEFLAG_LOCKED)
         return _spriteData[index].Image;
 
-    if (_liststart < 0)
-    {
-        _liststart = index;
-        _listend = index;
-        _mrulist[index] = END_OF_LIST;
-        _mrubacklink[index] = START_OF_LIST;
-    } 
-    else if (_listend != index)
-    {
-        // this is the oldest element being bumped to newest, so update start link
-        if (index == _liststart)
-        {
-            _liststart = _mrulist[index];
-            _mrubacklink[_liststart] = START_OF_LIST;
-        }
-        // already in list, link previous to next
-        else if (_mrulist[index] > 0)
-        {
-            _mrulist[_mrubacklink[index]] = _mrulist[index];
-            _mrubacklink[_mrulist[index]] = _mrubacklink[index];
-        }
-
-        // set this as the newest element in the list
-        _mrulist[index] = END_OF_LIST;
-        _mrulist[_listend] = index;
-        _mrubacklink[index] = _listend;
-        _listend = index;
-    }
-
+    // Only loaded sprites are tracked, failed ones have nothing to release
+    if (_spriteData[index].Image != NULL)
+        TouchMRU(index);
     return _spriteData[index].Image;
 }
 
-// Remove the oldest cache element
-void SpriteCache::RemoveOldest()
+// Remove the oldest cache elements, until enough space is free
+void SpriteCache::FreeMem()
 {
-    if (_liststart < 0)
+    if (_cacheSize <= _maxCacheSize)
         return;
 
-    sprkey_t sprnum = _liststart;
+    // Locked sprites are accounted in both cache size and its limit, so only
+    // the unlocked part is reduced to the low-water mark
+    const size_t unlocked_limit = _maxCacheSize > _lockedSize ? _maxCacheSize - _lockedSize : 0;
+    const size_t low_water = _lockedSize + unlocked_limit / 100 * CACHELOWWATERPERCENT;
+    size_t freed = 0;
+    int count = 0;
+    while (_cacheSize > low_water && !_mru.empty())
+    {
+        const sprkey_t sprnum = _mru.front();
+        SpriteData &spr = _spriteData[sprnum];
+        RemoveFromMRU(sprnum);
+        if (spr.Image == NULL || (spr.Flags & SPRCACHEFLAG_LOCKED))
+            continue;
+        if (spr.Flags & SPRCACHEFLAG_DOESNOTEXIST)
+            quitprintf("SpriteCache::FreeMem: Attempted to remove sprite %d that does not exist", sprnum);
 
-    if ((_spriteData[sprnum].Image != NULL) && !(_spriteData[sprnum].Flags & SPRCACHEFLAG_LOCKED)) {
         // Free the memory
-        if (_spriteData[sprnum].Flags & SPRCACHEFLAG_DOESNOTEXIST)
-        {
-            quitprintf("SpriteCache::removeOldest: Attempted to remove sprite %d that does not exist", sprnum);
-        }
-        _cacheSize -= _spriteData[sprnum].Size;
-
-        delete _spriteData[sprnum].Image;
-        _spriteData[sprnum].Image = NULL;
+        _cacheSize -= spr.Size;
+        freed += spr.Size;
+        count++;
+        delete spr.Image;
+        spr.Image = NULL;
     }
+    _stats.Evictions += count;
+    _stats.EvictedBytes += freed;
 
-    if (_liststart == _listend)
+    if (_cacheSize > _maxCacheSize)
     {
-        // there was one huge sprite, removing it has now emptied the cache completely
-        if (_cacheSize > 0)
-        {
-            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SPRITE CACHE ERROR: Sprite cache should be empty, but still has %d bytes", _cacheSize);
-        }
-        _mrulist[_liststart] = 0;
-        _liststart = -1;
-        _listend = -1;
-    }
-    else
-    {
-        sprkey_t oldstart = _liststart;
-        _liststart = _mrulist[_liststart];
-        _mrulist[oldstart] = 0;
-        _mrubacklink[_liststart] = START_OF_LIST;
-        if (oldstart == _liststart)
-        {
-            // Somehow, we have got a recursive link to itself, so we
-            // the game will freeze (since it is not actually freeing any
-            // memory)
-            // There must be a bug somewhere causing this, but for now
-            // let's just reset the cache
-            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "RUNTIME CACHE ERROR: CACHE INCONSISTENT: RESETTING\n\tAt size %d (of %d), start %d end %d  fwdlink=%d",
-                        _cacheSize, _maxCacheSize, oldstart, _listend, _liststart);
-            RemoveAll();
-        }
+        // nothing else may be released; this should only happen if the sizes
+        // got out of sync, because locked sprites extend the limit
+        Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SPRITE CACHE ERROR: Sprite cache has no sprites to release, but still has %u bytes (limit %u)",
+            _cacheSize, _maxCacheSize);
+        _cacheSize = _lockedSize;
     }
 
 #ifdef DEBUG_SPRITECACHE
-    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Removed %d, size now %d KB", sprnum, _cacheSize / 1024);
+    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Removed %d sprites (%u KB), size now %u KB", count, freed / 1024, _cacheSize / 1024);
 #endif
 }
 
 void SpriteCache::RemoveAll()
 {
-    _liststart = -1;
-    _listend = -1;
+    _mru.clear();
     for (size_t i = 0; i < _spriteData.size(); ++i)
     {
         if (!(_spriteData[i].Flags & SPRCACHEFLAG_LOCKED) && (_spriteData[i].Image != NULL) &&
@@ -324,8 +586,7 @@ void SpriteCache::RemoveAll()
             delete _spriteData[i].Image;
             _spriteData[i].Image = NULL;
         }
-        _mrulist[i] = 0;
-        _mrubacklink[i] = 0;
+        _spriteData[i].Flags &= ~SPRCACHEFLAG_INMRULIST;
     }
     _cacheSize = _lockedSize;
 }
@@ -342,6 +603,9 @@ void SpriteCache::Precache(sprkey_t index)
     else if (!(_spriteData[index].Flags & SPRCACHEFLAG_LOCKED))
         sprSize = _spriteData[index].Size;
 
+    // locked sprites are never released, so they don't need to be tracked
+    RemoveFromMRU(index);
+
     // make sure locked sprites can't fill the cache
     _maxCacheSize += sprSize;
     _lockedSize += sprSize;
@@ -353,6 +617,67 @@ void SpriteCache::Precache(sprkey_t index)
 #endif
 }
 
+void SpriteCache::Prefetch(sprkey_t index)
+{
+    if (index < 0 || (size_t)index >= _spriteData.size())
+        return;
+    // only sprites from file which are not in memory yet
+    if ((_spriteData[index].Image != NULL) || (_spriteData[index].Offset <= 0) ||
+        (_spriteData[index].Flags & SPRCACHEFLAG_DOESNOTEXIST))
+        return;
+    // mapped sprites do not need decoding
+    if (_mappedFile)
+        return;
+
+    if (!_asyncLoader)
+    {
+        // the loader reads from its own stream, so that it does not
+        // interfere with the one used for loading sprites immediately
+        Stream *in = Common::AssetManager::OpenAsset(_filename);
+        if (in == NULL)
+            return;
+        _asyncLoader.reset(new AsyncLoader(in, _compress));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_asyncLoader->Mutex);
+        if (_asyncLoader->IsScheduled(index))
+            return;
+        // don't let the images which were never requested take too much memory
+        _asyncLoader->MaxDoneSize = _maxCacheSize / 4;
+        AsyncLoader::Request req = { index, _spriteData[index].Offset };
+        _asyncLoader->Queue.push_back(req);
+    }
+    _asyncLoader->Cond.notify_all();
+}
+
+void SpriteCache::Prefetch(sprkey_t first, sprkey_t last)
+{
+    for (sprkey_t i = first; i <= last; ++i)
+        Prefetch(i);
+}
+
+Bitmap *SpriteCache::TakePrefetched(sprkey_t index)
+{
+    AsyncLoader::Result res;
+    {
+        std::unique_lock<std::mutex> lock(_asyncLoader->Mutex);
+        if (!_asyncLoader->Take(index, lock, res))
+            return NULL;
+    }
+    // the sprite was replaced since scheduling
+    if (res.Offset != _spriteData[index].Offset)
+        return NULL;
+    return res.CreateImage();
+}
+
+void SpriteCache::CancelPrefetch(sprkey_t index)
+{
+    AsyncLoader::Result res; // freed after unlocking
+    std::unique_lock<std::mutex> lock(_asyncLoader->Mutex);
+    _asyncLoader->Take(index, lock, res);
+}
+
 void SpriteCache::SeekToSprite(sprkey_t index)
 {
     if (index - 1 != _lastLoad)
@@ -361,64 +686,124 @@ void SpriteCache::SeekToSprite(sprkey_t index)
 
 size_t SpriteCache::LoadSprite(sprkey_t index)
 {
-    int hh = 0;
+    FreeMem();
 
-    while (_cacheSize > _maxCacheSize)
+    if (index < 0 || (size_t)index >= _spriteData.size())
+        quit("sprite cache array index out of bounds");
+
+    int coldep = 0;
+    // If the sprite was scheduled for loading in background, use that image
+    Bitmap *image = _asyncLoader ? TakePrefetched(index) : NULL;
+    // Uncompressed sprites may be taken right from the mapped file
+    if (image == NULL && _mappedFile)
+        image = ReadMappedSpriteImage(index);
+    if (image != NULL)
+    {
+        coldep = image->GetBPP();
+    }
+    else
     {
-        RemoveOldest();
-        hh++;
-        if (hh > 1000)
+        // If we didn't just load the previous sprite, seek to it
+        SeekToSprite(index);
+        image = ReadSpriteImage(_stream.get(), _compress, coldep);
+        if (image == NULL)
         {
-            Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "RUNTIME CACHE ERROR: STUCK IN FREE_UP_MEM; RESETTING CACHE");
-            RemoveAll();
+            if (coldep == 0)
+            {
+                _lastLoad = index;
+            }
+            else
+            {
+                _spriteData[index].Offset = 0;
+                _lastLoad = -2; // stream is in the middle of sprite data
+            }
+            return 0;
         }
+        _lastLoad = index;
     }
 
-    if (index < 0 || (size_t)index >= _spriteData.size())
-        quit("sprite cache array index out of bounds");
+    // update the stored width/height
+    _sprInfos[index].Width = image->GetWidth();
+    _sprInfos[index].Height = image->GetHeight();
+    _spriteData[index].Image = image;
 
-    // If we didn't just load the previous sprite, seek to it
-    SeekToSprite(index);
+    // Stop it adding the sprite to the used list just because it's loaded
+    // TODO: this messy hack is required, because initialize_sprite calls operator[]
+    // which puts the sprite to the MRU list.
+    _spriteData[index].Flags |= SPRCACHEFLAG_LOCKED;
 
-    int coldep = _stream->ReadInt16();
+    // TODO: this is ugly: asks the engine to convert the sprite using its own knowledge.
+    // And engine assigns new bitmap using SpriteCache::Set().
+    // Perhaps change to the callback function pointer?
+    initialize_sprite(index);
 
-    if (coldep == 0)
-    {
-        _lastLoad = index;
-        return 0;
-    }
+    if (index != 0)  // leave sprite 0 locked
+        _spriteData[index].Flags &= ~SPRCACHEFLAG_LOCKED;
 
-    int wdd = _stream->ReadInt16();
-    int htt = _stream->ReadInt16();
-    // update the stored width/height
-    _sprInfos[index].Width = wdd;
-    _sprInfos[index].Height = htt;
+    // we need to store this because the main program might
+    // alter spritewidth/height if it resizes stuff
+    size_t size = _sprInfos[index].Width * _sprInfos[index].Height * coldep;
+    _spriteData[index].Size = size;
+    _cacheSize += size;
 
-    _spriteData[index].Image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
-    if (_spriteData[index].Image == NULL)
-    {
-        _spriteData[index].Offset = 0;
-        return 0;
-    }
+#ifdef DEBUG_SPRITECACHE
+    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Loaded %lld, size now %u KB", index, _cacheSize / 1024);
+#endif
+
+    return size;
+}
 
-    Bitmap *image = _spriteData[index].Image;
-    if (this->_compressed) 
+static void ReadSpriteRows(Stream *in, SpriteCompression compress, int coldep, int wdd, int htt, uint8_t *const *lines)
+{
+    int hh;
+    if (compress != kSprCompress_None)
     {
-        _stream->ReadInt32(); // skip data size
-        if (coldep == 1)
+        // compressed data is read at once and decoded from memory
+        std::vector<uint8_t> packed(in->ReadInt32());
+        if (!packed.empty())
+            packed.resize(in->Read(packed.data(), packed.size()));
+        const uint8_t *src = packed.data();
+        size_t src_sz = packed.size();
+        if (compress == kSprCompress_LZ4)
         {
-            for (hh = 0; hh < htt; hh++)
-                cunpackbitl(&image->GetScanLineForWriting(hh)[0], wdd, _stream.get());
-        }
-        else if (coldep == 2)
-        {
-            for (hh = 0; hh < htt; hh++)
-                cunpackbitl16((unsigned short*)&image->GetScanLine(hh)[0], wdd, _stream.get());
+            const size_t pitch = wdd * coldep;
+            std::vector<uint8_t> pixels(pitch * htt);
+            if (lz4expand(src, src_sz, pixels.data(), pixels.size()))
+            {
+                for (hh = 0; hh < htt; hh++)
+                    memcpy(lines[hh], &pixels[hh * pitch], pitch);
+#if defined(AGS_BIG_ENDIAN)
+                for (hh = 0; hh < htt; hh++)
+                {
+                    uint8_t *line = lines[hh];
+                    for (int x = 0; x < wdd; x++)
+                    {
+                        if (coldep == 2)
+                            ((int16_t*)line)[x] = BBOp::SwapBytesInt16(((int16_t*)line)[x]);
+                        else if (coldep == 4)
+                            ((int32_t*)line)[x] = BBOp::SwapBytesInt32(((int32_t*)line)[x]);
+                    }
+                }
+#endif
+            }
         }
         else
         {
+            // corrupt lines are left as they are
             for (hh = 0; hh < htt; hh++)
-                cunpackbitl32((unsigned int*)&image->GetScanLine(hh)[0], wdd, _stream.get());
+            {
+                int used;
+                if (coldep == 1)
+                    used = cunpackbitl(lines[hh], wdd, src, src_sz);
+                else if (coldep == 2)
+                    used = cunpackbitl16((unsigned short*)lines[hh], wdd, src, src_sz);
+                else
+                    used = cunpackbitl32((unsigned int*)lines[hh], wdd, src, src_sz);
+                if (used <= 0)
+                    break;
+                src += used;
+                src_sz -= used;
+            }
         }
     }
     else
@@ -426,55 +811,116 @@ size_t SpriteCache::LoadSprite(sprkey_t index)
         if (coldep == 1)
         {
             for (hh = 0; hh < htt; hh++)
-                _stream->ReadArray(&image->GetScanLineForWriting(hh)[0], coldep, wdd);
+                in->ReadArray(&lines[hh][0], coldep, wdd);
         }
         else if (coldep == 2)
         {
             for (hh = 0; hh < htt; hh++)
-                _stream->ReadArrayOfInt16((int16_t*)&image->GetScanLineForWriting(hh)[0], wdd);
+                in->ReadArrayOfInt16((int16_t*)&lines[hh][0], wdd);
         }
         else
         {
             for (hh = 0; hh < htt; hh++)
-                _stream->ReadArrayOfInt32((int32_t*)&image->GetScanLineForWriting(hh)[0], wdd);
+                in->ReadArrayOfInt32((int32_t*)&lines[hh][0], wdd);
         }
     }
+}
 
-    _lastLoad = index;
-
-    // Stop it adding the sprite to the used list just because it's loaded
-    // TODO: this messy hack is required, because initialize_sprite calls operator[]
-    // which puts the sprite to the MRU list.
-    _spriteData[index].Flags |= SPRCACHEFLAG_LOCKED;
+Bitmap *SpriteCache::ReadSpriteImage(Stream *in, SpriteCompression compress, int &coldep)
+{
+    coldep = in->ReadInt16();
+    if (coldep == 0)
+        return NULL;
 
-    // TODO: this is ugly: asks the engine to convert the sprite using its own knowledge.
-    // And engine assigns new bitmap using SpriteCache::Set().
-    // Perhaps change to the callback function pointer?
-    initialize_sprite(index);
+    int wdd = in->ReadInt16();
+    int htt = in->ReadInt16();
+    Bitmap *image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
+    if (image == NULL)
+        return NULL;
 
-    if (index != 0)  // leave sprite 0 locked
-        _spriteData[index].Flags &= ~SPRCACHEFLAG_LOCKED;
+    std::vector<uint8_t*> lines(htt);
+    for (int hh = 0; hh < htt; ++hh)
+        lines[hh] = image->GetScanLineForWriting(hh);
+    ReadSpriteRows(in, compress, coldep, wdd, htt, lines.empty() ? NULL : &lines[0]);
+    return image;
+}
 
-    // we need to store this because the main program might
-    // alter spritewidth/height if it resizes stuff
-    size_t size = _sprInfos[index].Width * _sprInfos[index].Height * coldep;
-    _spriteData[index].Size = size;
-    _cacheSize += size;
+Bitmap *SpriteCache::ReadMappedSpriteImage(sprkey_t index)
+{
+    const soff_t offset = _spriteData[index].Offset;
+    const uint8_t *header = _mappedFile->GetData(offset, 3 * sizeof(int16_t));
+    if (header == NULL)
+        return NULL;
+    int16_t fields[3]; // color depth, width, height
+    memcpy(fields, header, sizeof(fields));
+    const int coldep = fields[0];
+    const int wdd = fields[1];
+    const int htt = fields[2];
+    // only the formats which are stored exactly as the bitmap pixels
+    if ((coldep != 1 && coldep != 2 && coldep != 4) || wdd <= 0 || htt <= 0)
+        return NULL;
+    const size_t pitch = wdd * coldep;
+    const uint8_t *data = _mappedFile->GetData(offset + sizeof(fields), pitch * htt);
+    if (data == NULL)
+        return NULL;
 
-#ifdef DEBUG_SPRITECACHE
-    Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Debug, "Loaded %lld, size now %u KB", index, _cacheSize / 1024);
-#endif
+    Bitmap *image;
+    if (((uintptr_t)data % coldep) == 0)
+    {
+        // the pixels are read-only, see GetWritableImage
+        image = new Bitmap();
+        if (image->WrapPixelData(const_cast<uint8_t*>(data), wdd, htt, coldep * 8))
+            return image;
+        delete image;
+    }
+    // pixel data is not aligned, copy it
+    image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
+    if (image == NULL)
+        return NULL;
+    for (int hh = 0; hh < htt; ++hh)
+        memcpy(image->GetScanLineForWriting(hh), data + hh * pitch, pitch);
+    return image;
+}
 
-    return size;
+void SpriteCache::ReleaseFileMapping()
+{
+    if (!_mappedFile)
+        return;
+    // same image may be assigned to multiple slots
+    stdtr1compat::unordered_map<Bitmap*, Bitmap*> copies;
+    for (size_t i = 0; i < _spriteData.size(); ++i)
+    {
+        Bitmap *image = _spriteData[i].Image;
+        if (!IsImageMapped(image))
+            continue;
+        Bitmap *&copy = copies[image];
+        if (copy == NULL)
+            copy = BitmapHelper::CreateBitmapCopy(image);
+        _spriteData[i].Image = copy;
+    }
+    for (stdtr1compat::unordered_map<Bitmap*, Bitmap*>::const_iterator it = copies.begin(); it != copies.end(); ++it)
+        delete it->first;
+    _mappedFile.reset();
 }
 
 const char *spriteFileSig = " Sprite File ";
 
-void SpriteCache::CompressSprite(Bitmap *sprite, Stream *out)
+void SpriteCache::CompressSprite(Bitmap *sprite, SpriteCompression compress, Stream *out)
 {
     int depth = sprite->GetColorDepth() / 8;
 
-    if (depth == 1)
+    if (compress == kSprCompress_LZ4)
+    {
+        // whole image is compressed as one block
+        const size_t pitch = sprite->GetWidth() * depth;
+        std::vector<uint8_t> pixels(pitch * sprite->GetHeight());
+        for (int yy = 0; yy < sprite->GetHeight(); yy++)
+            memcpy(&pixels[yy * pitch], sprite->GetScanLine(yy), pitch);
+        std::vector<uint8_t> packed(lz4bound(pixels.size()));
+        size_t packed_size = lz4compress(pixels.data(), pixels.size(), packed.data(), packed.size());
+        out->Write(packed.data(), packed_size);
+    }
+    else if (depth == 1)
     {
         for (int yy = 0; yy < sprite->GetHeight(); yy++)
             cpackbitl(&sprite->GetScanLineForWriting(yy)[0], sprite->GetWidth(), out);
@@ -491,13 +937,13 @@ void SpriteCache::CompressSprite(Bitmap *sprite, Stream *out)
     }
 }
 
-int SpriteCache::SaveToFile(const char *filnam, bool compressOutput)
+int SpriteCache::SaveToFile(const char *filnam, SpriteCompression compress)
 {
     Stream *output = Common::File::CreateFile(filnam);
     if (output == NULL)
         return -1;
 
-    if (compressOutput)
+    if (compress != kSprCompress_None)
     {
         // re-open the file so that it can be seeked
         delete output;
@@ -508,12 +954,13 @@ int SpriteCache::SaveToFile(const char *filnam, bool compressOutput)
 
     int spriteFileIDCheck = (int)time(NULL);
 
-    // sprite file version
-    output->WriteInt16(kSprfVersion_Current);
+    // sprite file version; older engines may still read the file, unless
+    // it uses the newer compression
+    output->WriteInt16(compress == kSprCompress_LZ4 ? kSprfVersion_StorageFormats : kSprfVersion_HighSpriteLimit);
 
     output->WriteArray(spriteFileSig, strlen(spriteFileSig), 1);
 
-    output->WriteInt8(compressOutput ? 1 : 0);
+    output->WriteInt8(compress);
     output->WriteInt32(spriteFileIDCheck);
 
     sprkey_t lastslot = FindTopmostSprite();
@@ -535,7 +982,7 @@ int SpriteCache::SaveToFile(const char *filnam, bool compressOutput)
         spriteoffs[i] = output->GetPosition();
 
         // if compressing uncompressed sprites, load the sprite into memory
-        if ((_spriteData[i].Image == NULL) && (this->_compressed != compressOutput))
+        if ((_spriteData[i].Image == NULL) && (this->_compress != compress))
             (*this)[i];
 
         if (_spriteData[i].Image != NULL)
@@ -550,13 +997,13 @@ int SpriteCache::SaveToFile(const char *filnam, bool compressOutput)
             output->WriteInt16(spritewidths[i]);
             output->WriteInt16(spriteheights[i]);
 
-            if (compressOutput)
+            if (compress != kSprCompress_None)
             {
                 size_t lenloc = output->GetPosition();
                 // write some space for the length data
                 output->WriteInt32(0);
 
-                CompressSprite(image, output);
+                CompressSprite(image, compress, output);
 
                 size_t fileSizeSoFar = output->GetPosition();
                 // write the length of the compressed data
@@ -591,7 +1038,7 @@ int SpriteCache::SaveToFile(const char *filnam, bool compressOutput)
         if (colDepth == 0)
             continue;
 
-        if (this->_compressed != compressOutput)
+        if (this->_compress != compress)
         {
             // shouldn't be able to get here
             delete [] memBuffer;
@@ -610,7 +1057,7 @@ int SpriteCache::SaveToFile(const char *filnam, bool compressOutput)
         output->WriteInt16(height);
 
         int sizeToCopy;
-        if (this->_compressed)
+        if (this->_compress != kSprCompress_None)
         {
             sizeToCopy = _stream->ReadInt32();
             output->WriteInt32(sizeToCopy);
@@ -665,9 +1112,12 @@ HError SpriteCache::InitFile(const char *filnam)
     soff_t spr_initial_offs = 0;
     int spriteFileID = 0;
 
+    _asyncLoader.reset();
+    ReleaseFileMapping();
     _stream.reset(Common::AssetManager::OpenAsset(filnam));
     if (_stream == NULL)
         return new Error(String::FromFormat("Failed to open spriteset file '%s'.", filnam));
+    _filename = filnam;
 
     spr_initial_offs = _stream->GetPosition();
 
@@ -691,15 +1141,22 @@ HError SpriteCache::InitFile(const char *filnam)
 
     if (vers == kSprfVersion_Uncompressed)
     {
-        this->_compressed = false;
+        this->_compress = kSprCompress_None;
     }
     else if (vers == kSprfVersion_Compressed)
     {
-        this->_compressed = true;
+        this->_compress = kSprCompress_RLE;
     }
     else if (vers >= kSprfVersion_Last32bit)
     {
-        this->_compressed = (_stream->ReadInt8() == 1);
+        const int compress = _stream->ReadInt8();
+        if (compress < kSprCompress_None || compress > kSprCompress_LZ4 ||
+            (compress == kSprCompress_LZ4 && vers < kSprfVersion_StorageFormats))
+        {
+            _stream.reset();
+            return new Error(String::FromFormat("Unsupported sprite compression type: %d.", compress));
+        }
+        this->_compress = (SpriteCompression)compress;
         spriteFileID = _stream->ReadInt32();
     }
 
@@ -719,6 +1176,21 @@ HError SpriteCache::InitFile(const char *filnam)
 
     EnlargeTo(topmost + 1);
 
+    // uncompressed sprites are stored exactly as they are in memory, so these
+    // may be used without reading the file
+#if !defined (AGS_BIG_ENDIAN)
+    if (_compress == kSprCompress_None && _useFileMapping)
+    {
+        AssetLocation loc;
+        if (AssetManager::GetAssetLocation(filnam, loc))
+        {
+            _mappedFile.reset(new MappedFileStream(loc.FileName));
+            if (!_mappedFile->IsValid())
+                _mappedFile.reset();
+        }
+    }
+#endif
+
     // if there is a sprite index file, use it
     if (LoadSpriteIndexFile(spriteFileID, spr_initial_offs, topmost))
     {
@@ -776,7 +1248,7 @@ HError SpriteCache::RebuildSpriteIndex(AGS::Common::Stream *in, sprkey_t topmost
         }
         else if (vers >= kSprfVersion_Last32bit)
         {
-            spriteDataSize = this->_compressed ? in->ReadInt32() : wdd * coldep * htt;
+            spriteDataSize = (_compress != kSprCompress_None) ? in->ReadInt32() : wdd * coldep * htt;
         }
         else
         {
@@ -879,19 +1351,29 @@ bool SpriteCache::LoadSpriteIndexFile(int expectedFileID, soff_t spr_initial_off
 
 void SpriteCache::DetachFile()
 {
+    _asyncLoader.reset();
+    ReleaseFileMapping();
     _stream.reset();
     _lastLoad = -2;
 }
 
 int SpriteCache::AttachFile(const char *filename)
 {
+    _asyncLoader.reset();
+    ReleaseFileMapping();
     _stream.reset(Common::AssetManager::OpenAsset((char *)filename));
     if (_stream == NULL)
         return -1;
+    _filename = filename;
     return 0;
 }
 
 bool SpriteCache::IsFileCompressed() const
 {
-    return _compressed;
+    return _compress != kSprCompress_None;
+}
+
+SpriteCompression SpriteCache::GetFileCompression() const
+{
+    return _compress;
 }
@@ -37,10 +37,13 @@
 
 #include "util/stdtr1compat.h"
 #include TR1INCLUDE(memory)
+#include TR1INCLUDE(functional)
+#include TR1INCLUDE(unordered_map)
+#include <list>
 #include <vector>
 #include "util/error.h"
 
-namespace AGS { namespace Common { class Stream; class Bitmap; } }
+namespace AGS { namespace Common { class Stream; class MappedFileStream; class Bitmap; } }
 using namespace AGS; // FIXME later
 typedef AGS::Common::HError HAGSError;
 
@@ -52,6 +55,8 @@ struct SpriteInfo;
 #define SPRCACHEFLAG_DOESNOTEXIST   0x01
 // Locked sprites are ones that should not be freed when clearing cache space.
 #define SPRCACHEFLAG_LOCKED         0x02
+// Sprite is registered in the MRU list and may be released to free space.
+#define SPRCACHEFLAG_INMRULIST      0x04
 
 // Max size of the sprite cache, in bytes
 #if defined (PSP_VERSION)
@@ -62,6 +67,9 @@ struct SpriteInfo;
 #else
 #define DEFAULTCACHESIZE 128 * 1024 * 1024
 #endif
+// When the cache is overfilled, sprites are released until its unlocked
+// part is filled no more than this percentage of the limit
+#define CACHELOWWATERPERCENT 75
 
 // TODO: research old version differences
 enum SpriteFileVersion
@@ -71,7 +79,16 @@ enum SpriteFileVersion
     kSprfVersion_Last32bit = 6,
     kSprfVersion_64bit = 10,
     kSprfVersion_HighSpriteLimit = 11,
-    kSprfVersion_Current = kSprfVersion_HighSpriteLimit
+    kSprfVersion_StorageFormats = 12,
+    kSprfVersion_Current = kSprfVersion_StorageFormats
+};
+
+// Compression of the sprite images in the file
+enum SpriteCompression
+{
+    kSprCompress_None = 0,
+    kSprCompress_RLE = 1,
+    kSprCompress_LZ4 = 2 // since kSprfVersion_StorageFormats
 };
 
 enum SpriteIndexFileVersion
@@ -93,6 +110,20 @@ public:
     static const sprkey_t MAX_SPRITE_INDEX = INT32_MAX - 1;
     static const size_t   MAX_SPRITE_SLOTS = INT32_MAX;
 
+    // Function which creates the sprite image when it is first requested
+    typedef stdtr1compat::function<Common::Bitmap*()> ImageLoader;
+
+    // Cache usage statistics
+    struct Stats
+    {
+        uint64_t Hits;          // requests for sprites already in memory
+        uint64_t Misses;        // requests which had to load the sprite
+        uint64_t Evictions;     // number of sprites released to free space
+        uint64_t EvictedBytes;  // total size of released sprites, in bytes
+
+        Stats();
+    };
+
     SpriteCache(std::vector<SpriteInfo> &sprInfos);
     ~SpriteCache();
 
@@ -110,12 +141,21 @@ public:
     size_t      GetLockedSize() const;
     // Returns maximal size limit of the cache, in bytes
     size_t      GetMaxCacheSize() const;
+    // Returns cache usage statistics
+    const Stats &GetStats() const;
+    // Resets cache usage statistics
+    void        ResetStats();
     // Returns number of sprite slots in the bank (this includes both actual sprites and free slots)
     sprkey_t    GetSpriteSlotCount() const;
     // Finds the topmost occupied slot index. Warning: may be slow.
     sprkey_t    FindTopmostSprite() const;
     // Loads sprite and and locks in memory (so it cannot get removed implicitly)
     void        Precache(sprkey_t index);
+    // Schedules sprite for loading in background, if it is not in memory yet;
+    // the image will be taken when the sprite is requested next time
+    void        Prefetch(sprkey_t index);
+    // Schedules the range of sprites for loading in background (inclusive)
+    void        Prefetch(sprkey_t first, sprkey_t last);
     // Unregisters sprite from the bank and optionally deletes bitmap
     void        RemoveSprite(sprkey_t index, bool freeMemory);
     // Removes all loaded images from the cache
@@ -124,19 +164,36 @@ public:
     void        Reset();
     // Assigns new bitmap for the given sprite index
     void        Set(sprkey_t index, Common::Bitmap *);
+    // Assigns the sprite the function which creates its bitmap; it is called
+    // when the sprite is requested for the first time
+    void        SetDeferred(sprkey_t index, const ImageLoader &loader);
+    // Tells if the sprite has a deferred bitmap which was not created yet
+    bool        IsDeferred(sprkey_t index) const;
     // Sets max cache size in bytes
     void        SetMaxCacheSize(size_t size);
+    // Sets whether uncompressed sprite file may be mapped into memory, letting
+    // loaded sprites reference the file data directly; applied on InitFile
+    void        SetFileMapping(bool enable);
+    // Tells if the image references the mapped sprite file data; such image
+    // is read-only and must be copied before modifying it
+    bool        IsImageMapped(const Common::Bitmap *image) const;
+    // Gets the sprite image which may be modified; the image referencing
+    // mapped sprite file is replaced with its copy first
+    Common::Bitmap *GetWritableImage(sprkey_t index);
 
     // Loads sprite reference information and inits sprite stream
     HAGSError   InitFile(const char *filename);
     // Tells if bitmaps in the file are compressed
     bool        IsFileCompressed() const;
+    // Gets compression of the bitmaps in the file
+    SpriteCompression GetFileCompression() const;
     // Opens file stream
     int         AttachFile(const char *filename);
     // Closes file stream
     void        DetachFile();
-    // Saves all sprites until lastElement (exclusive) to file 
-    int         SaveToFile(const char *filename, bool compressOutput);
+    // Saves all sprites until lastElement (exclusive) to file; the file is
+    // written in older format, unless the new compression type is requested
+    int         SaveToFile(const char *filename, SpriteCompression compress);
     // Saves sprite index table in a separate file
     int         SaveSpriteIndex(const char *filename, int spriteFileIDCheck, sprkey_t lastslot, sprkey_t numsprits,
         const std::vector<int16_t> &spritewidths, const std::vector<int16_t> &spriteheights, const std::vector<soff_t> &spriteoffs);
@@ -148,7 +205,27 @@ private:
     void        Init();
     size_t      LoadSprite(sprkey_t index);
     void        SeekToSprite(sprkey_t index);
-    void        RemoveOldest();
+    // Releases least recently used sprites until the cache is filled no more
+    // than the low-water mark
+    void        FreeMem();
+    // Puts sprite to the end of the MRU list, as the most recently used one
+    void        TouchMRU(sprkey_t index);
+    // Removes sprite from the MRU list, if it is there
+    void        RemoveFromMRU(sprkey_t index);
+    // Reads and unpacks sprite image from the stream positioned at sprite's
+    // data; does not change the cache state, but creates the bitmap, so must
+    // be called on the main thread
+    static Common::Bitmap *ReadSpriteImage(Common::Stream *in, SpriteCompression compress, int &coldep);
+    // Creates sprite image over the mapped sprite file data, copying pixels
+    // only if they are not aligned; returns NULL if this is not possible
+    Common::Bitmap *ReadMappedSpriteImage(sprkey_t index);
+    // Copies loaded images which reference mapped file, and closes the mapping
+    void        ReleaseFileMapping();
+    // Gets the image of the sprite loaded in background, waiting for it if the
+    // loading is in progress; returns NULL if sprite was not scheduled
+    Common::Bitmap *TakePrefetched(sprkey_t index);
+    // Drops the sprite scheduled for loading in background, or its result
+    void        CancelPrefetch(sprkey_t index);
 
     // Information required for the sprite streaming
     // TODO: make compatible with large (over 2GB) files
@@ -162,6 +239,7 @@ private:
         // TODO: investigate if we may safely use unique_ptr here
         // (some of these bitmaps may be assigned from outside of the cache)
         Common::Bitmap *Image; // actual bitmap
+        std::list<sprkey_t>::iterator MruIt; // position in the MRU list, if registered
 
         SpriteData();
         ~SpriteData();
@@ -171,30 +249,39 @@ private:
     std::vector<SpriteInfo> &_sprInfos;
     // Array of sprite references
     std::vector<SpriteData> _spriteData;
-    bool _compressed;        // are sprites compressed
+    SpriteCompression _compress; // how sprites are compressed
     soff_t _sprite0InitialOffset; // offset of the first sprite in the stream
 
+    Common::String _filename; // name of the sprite file asset
     std::unique_ptr<Common::Stream> _stream; // the sprite stream
+    bool _useFileMapping; // whether to map uncompressed sprite file into memory
+    std::unique_ptr<Common::MappedFileStream> _mappedFile; // mapped sprite file
     sprkey_t _lastLoad; // last loaded sprite index
 
+    // Background loader, decoding sprites from the separately opened stream;
+    // created on demand
+    struct AsyncLoader;
+    std::unique_ptr<AsyncLoader> _asyncLoader;
+
     size_t _maxCacheSize;  // cache size limit
     size_t _lockedSize;    // size in bytes of currently locked images
     size_t _cacheSize;     // size in bytes of currently cached images
 
     // MRU list: the way to track which sprites were used recently.
-    // When clearing up space for new sprites, cache first deletes the sprites
-    // that were last time used long ago.
-    std::vector<sprkey_t> _mrulist;
-    std::vector<sprkey_t> _mrubacklink;
-    int _liststart;
-    int _listend;
+    // Only contains sprites that are loaded and may be released; the least
+    // recently used ones are at the front. When clearing up space for new
+    // sprites, cache first deletes the sprites that were last time used long ago.
+    std::list<sprkey_t> _mru;
+    Stats _stats;
+    // Sprites which images are not created yet
+    stdtr1compat::unordered_map<sprkey_t, ImageLoader> _deferred;
 
     // Loads sprite index file
     bool        LoadSpriteIndexFile(int expectedFileID, soff_t spr_initial_offs, sprkey_t topmost);
     // Rebuilds sprite index from the main sprite file
     HAGSError   RebuildSpriteIndex(AGS::Common::Stream *in, sprkey_t topmost, SpriteFileVersion vers);
     // Writes compressed sprite to the stream
-    void        CompressSprite(Common::Bitmap *sprite, Common::Stream *out);
+    static void CompressSprite(Common::Bitmap *sprite, SpriteCompression compress, Common::Stream *out);
 
     void initFile_initNullSpriteParams(sprkey_t index);
 };
@@ -20,11 +20,15 @@
 #include "font/ttffontrenderer.h"
 #include "font/wfnfontrenderer.h"
 #include "gfx/bitmap.h"
+#include "util/string_types.h"
 
 using namespace AGS::Common;
 
 int wtext_multiply = 1;
 
+// Maximal number of text widths remembered per font
+#define FONT_WIDTH_CACHE_SIZE 512
+
 namespace AGS
 {
 namespace Common
@@ -35,6 +39,10 @@ struct Font
     IAGSFontRenderer   *Renderer;
     IAGSFontRenderer2  *Renderer2;
     FontInfo            Info;
+    // Widths of the recently measured texts; only used with the TTF
+    // renderer, measuring which is relatively slow
+    stdtr1compat::unordered_map<String, int> WidthCache;
+    int                 WidthCacheMultiply;
 
     Font();
 };
@@ -42,6 +50,7 @@ struct Font
 Font::Font()
     : Renderer(NULL)
     , Renderer2(NULL)
+    , WidthCacheMultiply(0)
 {}
 
 } // Common
@@ -50,6 +59,15 @@ Font::Font()
 static std::vector<Font> fonts;
 static TTFFontRenderer ttfRenderer;
 static WFNFontRenderer wfnRenderer;
+// Incremented whenever the way any font measures text may have changed
+static int fontChangeCount = 0;
+
+static void font_changed(size_t fontNumber)
+{
+  if (fontNumber < fonts.size())
+    fonts[fontNumber].WidthCache.clear();
+  fontChangeCount++;
+}
 
 
 FontInfo::FontInfo()
@@ -92,6 +110,7 @@ IAGSFontRenderer* font_replace_renderer(size_t fontNumber, IAGSFontRenderer* ren
   IAGSFontRenderer* oldRender = fonts[fontNumber].Renderer;
   fonts[fontNumber].Renderer = renderer;
   fonts[fontNumber].Renderer2 = NULL;
+  font_changed(fontNumber);
   return oldRender;
 }
 
@@ -113,7 +132,24 @@ int wgettextwidth(const char *texx, size_t fontNumber)
 {
   if (fontNumber >= fonts.size() || !fonts[fontNumber].Renderer)
     return 0;
-  return fonts[fontNumber].Renderer->GetTextWidth(texx, fontNumber);
+  Font &font = fonts[fontNumber];
+  if (font.Renderer != &ttfRenderer)
+    return font.Renderer->GetTextWidth(texx, fontNumber);
+
+  if (font.WidthCacheMultiply != wtext_multiply)
+  {
+    font.WidthCache.clear();
+    font.WidthCacheMultiply = wtext_multiply;
+  }
+  const String text = texx;
+  stdtr1compat::unordered_map<String, int>::const_iterator it = font.WidthCache.find(text);
+  if (it != font.WidthCache.end())
+    return it->second;
+  const int width = font.Renderer->GetTextWidth(texx, fontNumber);
+  if (font.WidthCache.size() >= FONT_WIDTH_CACHE_SIZE)
+    font.WidthCache.clear();
+  font.WidthCache[text] = width;
+  return width;
 }
 
 int wgettextheight(const char *text, size_t fontNumber)
@@ -135,6 +171,12 @@ void set_font_outline(size_t font_number, int outline_type)
     if (font_number >= fonts.size())
         return;
     fonts[font_number].Info.Outline = FONT_OUTLINE_AUTO;
+    font_changed(font_number);
+}
+
+int get_font_change_count()
+{
+    return fontChangeCount;
 }
 
 int getfontheight(size_t fontNumber)
@@ -183,13 +225,17 @@ void wouttextxy(Common::Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t
 void set_fontinfo(size_t fontNumber, const FontInfo &finfo)
 {
     if (fontNumber < fonts.size() && fonts[fontNumber].Renderer)
+    {
         fonts[fontNumber].Info = finfo;
+        font_changed(fontNumber);
+    }
 }
 
 // Loads a font from disk
 bool wloadfont_size(size_t fontNumber, const FontInfo &font_info, const FontRenderParams *params)
 {
   fonts.resize(fontNumber + 1);
+  font_changed(fontNumber);
   if (ttfRenderer.LoadFromDiskEx(fontNumber, font_info.SizePt, params))
   {
     fonts[fontNumber].Renderer  = &ttfRenderer;
@@ -232,4 +278,5 @@ void wfreefont(size_t fontNumber)
     fonts[fontNumber].Renderer->FreeMemory(fontNumber);
 
   fonts[fontNumber].Renderer = NULL;
+  font_changed(fontNumber);
 }
@@ -51,6 +51,9 @@ int getfontlinespacing(size_t fontNumber);
 bool use_default_linespacing(size_t fontNumber);
 int  get_font_outline(size_t font_number);
 void set_font_outline(size_t font_number, int outline_type);
+// Returns the number of changes made to the loaded fonts so far; texts
+// measured before the returned value has changed must be measured again
+int  get_font_change_count();
 // Outputs a single line of text on the defined position on bitmap, using defined font, color and parameters
 int getfontlinespacing(size_t fontNumber);
 void wouttextxy(Common::Bitmap *ds, int xxx, int yyy, size_t fontNumber, color_t text_color, const char *texx);
@@ -26,6 +26,7 @@
 #include "script/cc_script.h"
 #include "util/compress.h"
 #include "util/string_utils.h"
+#include "util/threadpool.h"
 
 // default number of hotspots to read from the room file
 #define MIN_ROOM_HOTSPOTS  20
@@ -73,6 +74,8 @@ String GetRoomFileErrorText(RoomFileErrorType err)
         return "Errors encountered when reading custom properties.";
     case kRoomFileErr_BlockNotFound:
         return "Required block was not found.";
+    case kRoomFileErr_OutOfMemory:
+        return "Not enough memory to load the room.";
     }
     return "Unknown error.";
 }
@@ -162,8 +165,49 @@ void WriteRoomObject(const RoomObjectInfo &obj, Stream *out)
     out->WriteInt16(obj.IsOn ? 1 : 0);
 }
 
+// Room background, which was read from the file, but is decompressed only
+// after all the room data is read, by several threads at once if possible
+struct PendingBackground
+{
+    size_t   Frame;
+    LzwImage Image;
+};
+typedef std::vector<PendingBackground> PendingBackgrounds;
+
+void ReadBackground(size_t frame, color *pal, Stream *in, PendingBackgrounds &bgs)
+{
+    bgs.push_back(PendingBackground());
+    bgs.back().Frame = frame;
+    read_lzw(in, bgs.back().Image, pal);
+}
+
+HRoomFileError UnpackBackgrounds(RoomStruct *room, PendingBackgrounds &bgs, ThreadPool *threads)
+{
+    std::vector<char> unpacked(bgs.size());
+    ThreadPool::Task unpack = [&bgs, &unpacked](size_t i) { unpacked[i] = unpack_lzw(bgs[i].Image); };
+    if (threads)
+        threads->RunForEach(bgs.size(), unpack);
+    else
+        for (size_t i = 0; i < bgs.size(); ++i)
+            unpack(i);
+
+    for (size_t i = 0; i < bgs.size(); ++i)
+    {
+        update_polled_stuff_if_runtime();
+        if (!unpacked[i])
+            return new RoomFileError(kRoomFileErr_InconsistentData,
+                String::FromFormat("Background frame %u is corrupt.", (unsigned)bgs[i].Frame));
+        Bitmap *frame = create_lzw_bitmap(bgs[i].Image, room->BackgroundBPP);
+        if (frame == NULL)
+            return new RoomFileError(kRoomFileErr_OutOfMemory,
+                String::FromFormat("Failed to create background frame %u.", (unsigned)bgs[i].Frame));
+        room->BgFrames[bgs[i].Frame].Graphic.reset(frame);
+    }
+    return HRoomFileError::None();
+}
+
 // Main room data
-HRoomFileError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
+HRoomFileError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver, PendingBackgrounds &bgs)
 {
 
     room->BackgroundBPP = in->ReadInt32();
@@ -322,9 +366,8 @@ HRoomFileError ReadMainBlock(RoomStruct *room, Stream *in, RoomFileVersion data_
 
     update_polled_stuff_if_runtime();
     // Primary background
+    ReadBackground(0, room->Palette, in, bgs);
     Bitmap *mask = NULL;
-    load_lzw(in, &mask, room->BackgroundBPP, room->Palette);
-    room->BgFrames[0].Graphic.reset(mask);
 
     // Mask bitmaps
     update_polled_stuff_if_runtime();
@@ -405,7 +448,7 @@ HRoomFileError ReadObjScNamesBlock(RoomStruct *room, Stream *in, RoomFileVersion
 }
 
 // Secondary backgrounds
-HRoomFileError ReadAnimBgBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
+HRoomFileError ReadAnimBgBlock(RoomStruct *room, Stream *in, RoomFileVersion data_ver, PendingBackgrounds &bgs)
 {
     room->BgFrameCount = in->ReadByte();
     if (room->BgFrameCount > MAX_ROOM_BGFRAMES)
@@ -418,9 +461,7 @@ HRoomFileError ReadAnimBgBlock(RoomStruct *room, Stream *in, RoomFileVersion dat
     for (size_t i = 1; i < room->BgFrameCount; ++i)
     {
         update_polled_stuff_if_runtime();
-        Bitmap *frame = NULL;
-        load_lzw(in, &frame, room->BackgroundBPP, room->BgFrames[i].Palette);
-        room->BgFrames[i].Graphic.reset(frame);
+        ReadBackground(i, room->BgFrames[i].Palette, in, bgs);
     }
     return HRoomFileError::None();
 }
@@ -444,7 +485,8 @@ HRoomFileError ReadPropertiesBlock(RoomStruct *room, Stream *in, RoomFileVersion
     return HRoomFileError::None();
 }
 
-HRoomFileError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block, RoomFileVersion data_ver)
+HRoomFileError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block, RoomFileVersion data_ver,
+    PendingBackgrounds &bgs)
 {
     soff_t block_len = data_ver < kRoomVersion_350 ? in->ReadInt32() : in->ReadInt64();
     soff_t block_end = in->GetPosition() + block_len;
@@ -453,7 +495,7 @@ HRoomFileError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block,
     switch (block)
     {
     case kRoomFblk_Main:
-        err = ReadMainBlock(room, in, data_ver);
+        err = ReadMainBlock(room, in, data_ver, bgs);
         break;
     case kRoomFblk_Script:
         in->Seek(block_len); // no longer read source script text into RoomStruct
@@ -468,7 +510,7 @@ HRoomFileError ReadRoomBlock(RoomStruct *room, Stream *in, RoomFileBlock block,
         err = ReadObjScNamesBlock(room, in, data_ver);
         break;
     case kRoomFblk_AnimBg:
-        err = ReadAnimBgBlock(room, in, data_ver);
+        err = ReadAnimBgBlock(room, in, data_ver, bgs);
         break;
     case kRoomFblk_Properties:
         err = ReadPropertiesBlock(room, in, data_ver);
@@ -507,10 +549,12 @@ void SkipRoomBlock(Stream *in, RoomFileVersion data_ver)
 }
 
 
-HRoomFileError ReadRoomData(RoomStruct *room, Stream *in, RoomFileVersion data_ver)
+HRoomFileError ReadRoomData(RoomStruct *room, Stream *in, RoomFileVersion data_ver, ThreadPool *decode_threads)
 {
     room->DataVersion = data_ver;
 
+    PendingBackgrounds bgs;
+
     RoomFileBlock block;
     do
     {
@@ -521,13 +565,13 @@ HRoomFileError ReadRoomData(RoomStruct *room, Stream *in, RoomFileVersion data_v
         block = (RoomFileBlock)b;
         if (block != kRoomFile_EOF)
         {
-            HRoomFileError err = ReadRoomBlock(room, in, block, data_ver);
+            HRoomFileError err = ReadRoomBlock(room, in, block, data_ver, bgs);
             if (!err)
                 return err;
         }
     }
     while (block != kRoomFile_EOF);
-    return HRoomFileError::None();
+    return UnpackBackgrounds(room, bgs, decode_threads);
 }
 
 HRoomFileError UpdateRoomData(RoomStruct *room, RoomFileVersion data_ver, const std::vector<SpriteInfo> &sprinfos)
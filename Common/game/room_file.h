@@ -37,6 +37,7 @@ namespace Common
 {
 
 class RoomStruct;
+class ThreadPool;
 
 enum RoomFileErrorType
 {
@@ -52,7 +53,8 @@ enum RoomFileErrorType
     kRoomFileErr_InconsistentData,
     kRoomFileErr_PropertiesBlockFormat,
     kRoomFileErr_InvalidPropertyValues,
-    kRoomFileErr_BlockNotFound
+    kRoomFileErr_BlockNotFound,
+    kRoomFileErr_OutOfMemory
 };
 
 String GetRoomFileErrorText(RoomFileErrorType err);
@@ -77,8 +79,8 @@ struct RoomDataSource
 
 // Opens room file for reading from an arbitrary file
 HRoomFileError OpenRoomFile(const String &filename, RoomDataSource &src);
-// Reads room data
-HRoomFileError ReadRoomData(RoomStruct *room, Stream *in, RoomFileVersion data_ver);
+// Reads room data; backgrounds are decompressed using given threads, if any
+HRoomFileError ReadRoomData(RoomStruct *room, Stream *in, RoomFileVersion data_ver, ThreadPool *decode_threads = NULL);
 // Applies necessary updates, conversions and fixups to the loaded data
 // making it compatible with current engine
 HRoomFileError UpdateRoomData(RoomStruct *room, RoomFileVersion data_ver, const std::vector<SpriteInfo> &sprinfos);
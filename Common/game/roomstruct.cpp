@@ -220,7 +220,8 @@ int RoomStruct::GetRegionTintLuminance(int id) const
     return 0;
 }
 
-void load_room(const char *filename, RoomStruct *room, const std::vector<SpriteInfo> &sprinfos)
+void load_room(const char *filename, RoomStruct *room, const std::vector<SpriteInfo> &sprinfos,
+    ThreadPool *decode_threads)
 {
     room->Free();
     room->InitDefaults();
@@ -232,7 +233,7 @@ void load_room(const char *filename, RoomStruct *room, const std::vector<SpriteI
     if (err)
     {
         update_polled_stuff_if_runtime();  // it can take a while to load the file sometimes
-        err = ReadRoomData(room, src.InputStream.get(), src.DataVersion);
+        err = ReadRoomData(room, src.InputStream.get(), src.DataVersion, decode_threads);
         if (err)
             err = UpdateRoomData(room, src.DataVersion, sprinfos);
     }
@@ -95,6 +95,7 @@ namespace Common
 
 class Bitmap;
 class Stream;
+class ThreadPool;
 
 typedef stdtr1compat::shared_ptr<Bitmap> PBitmap;
 
@@ -320,7 +321,9 @@ public:
 };
 
 
-void load_room(const char *filename, RoomStruct *room, const std::vector<SpriteInfo> &sprinfos);
+// Loads room from file; backgrounds are decompressed using given threads, if any
+void load_room(const char *filename, RoomStruct *room, const std::vector<SpriteInfo> &sprinfos,
+    ThreadPool *decode_threads = NULL);
 
 } // namespace Common
 } // namespace AGS
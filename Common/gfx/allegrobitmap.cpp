@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include <aastr.h>
+#include <allegro/internal/aintern.h>
 #include "gfx/allegrobitmap.h"
 #include "debug/assert.h"
 
@@ -110,6 +111,42 @@ bool Bitmap::WrapAllegroBitmap(BITMAP *al_bmp, bool shared_data)
     return _alBitmap != NULL;
 }
 
+bool Bitmap::WrapPixelData(uint8_t *data, int width, int height, int color_depth)
+{
+    Destroy();
+    GFX_VTABLE *vtable = _get_vtable(color_depth);
+    if (!data || width <= 0 || height <= 0 || !vtable)
+        return false;
+
+    // Fill the memory bitmap struct the same way create_bitmap_ex does, except
+    // for the data which is not owned by bitmap; destroy_bitmap then only
+    // frees the struct itself. At least two line pointers are required by
+    // some of Allegro drawing routines.
+    const int nr_pointers = MAX(2, height);
+    BITMAP *al_bmp = (BITMAP*)malloc(sizeof(BITMAP) + sizeof(char*) * nr_pointers);
+    if (!al_bmp)
+        return false;
+    al_bmp->w = al_bmp->cr = width;
+    al_bmp->h = al_bmp->cb = height;
+    al_bmp->clip = TRUE;
+    al_bmp->cl = al_bmp->ct = 0;
+    al_bmp->vtable = vtable;
+    al_bmp->write_bank = al_bmp->read_bank = (void*)_stub_bank_switch;
+    al_bmp->dat = NULL;
+    al_bmp->id = 0;
+    al_bmp->extra = NULL;
+    al_bmp->x_ofs = 0;
+    al_bmp->y_ofs = 0;
+    al_bmp->seg = _default_ds();
+    const int pitch = width * BYTES_PER_PIXEL(color_depth);
+    for (int i = 0; i < height; ++i)
+        al_bmp->line[i] = data + i * pitch;
+
+    _alBitmap = al_bmp;
+    _isDataOwner = true;
+    return true;
+}
+
 void Bitmap::Destroy()
 {
     if (_isDataOwner && _alBitmap)
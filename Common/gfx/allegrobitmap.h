@@ -51,6 +51,9 @@ public:
     bool	CreateCopy(Bitmap *src, int color_depth = 0);
     // TODO: a temporary solution for plugin support
     bool    WrapAllegroBitmap(BITMAP *al_bmp, bool shared_data);
+    // Wrap existing pixel data, laid out as continuous rows of the given
+    // format; the data is not copied and must stay valid while bitmap exists
+    bool    WrapPixelData(uint8_t *data, int width, int height, int color_depth);
     // Deallocate bitmap
     void	Destroy();
 
@@ -182,6 +182,8 @@ enum GuiSvgVersion
 } // namespace Common
 } // namespace AGS
 
+// Tells that all GUIs have to be redrawn; changes which concern particular
+// GUI or control are marked with their MarkChanged() instead
 extern int guis_need_update;
 
 #endif // __AC_GUIDEFINES_H
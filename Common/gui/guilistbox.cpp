@@ -80,7 +80,7 @@ bool GUIListBox::IsInRightMargin(int x) const
 
 int GUIListBox::AddItem(const String &text)
 {
-    guis_need_update = 1;
+    MarkChanged();
     Items.push_back(text);
     SavedGameIndex.push_back(-1);
     ItemCount++;
@@ -94,7 +94,7 @@ void GUIListBox::Clear()
     ItemCount = 0;
     SelectedItem = 0;
     TopItem = 0;
-    guis_need_update = 1;
+    MarkChanged();
 }
 
 void GUIListBox::Draw(Common::Bitmap *ds)
@@ -188,7 +188,7 @@ int GUIListBox::InsertItem(int index, const String &text)
         SelectedItem++;
 
     ItemCount++;
-    guis_need_update = 1;
+    MarkChanged();
     return ItemCount - 1;
 }
 
@@ -205,7 +205,7 @@ void GUIListBox::RemoveItem(int index)
         SelectedItem--;
     if (SelectedItem >= ItemCount)
         SelectedItem = -1;
-    guis_need_update = 1;
+    MarkChanged();
 }
 
 void GUIListBox::SetShowArrows(bool on)
@@ -243,7 +243,7 @@ void GUIListBox::SetItemText(int index, const String &text)
 {
     if (index >= 0 && index < ItemCount)
     {
-        guis_need_update = 1;
+        MarkChanged();
         Items[index] = text;
     }
 }
@@ -50,6 +50,7 @@ void GUIMain::InitDefaults()
     ID            = 0;
     Name.Empty();
     _flags        = kGUIMain_DefFlags;
+    _hasChanged   = true;
 
     X             = 0;
     Y             = 0;
@@ -129,6 +130,18 @@ int32_t GUIMain::GetControlID(int index) const
     return _ctrlRefs[index].second;
 }
 
+bool GUIMain::HasChanged() const
+{
+    if (_hasChanged)
+        return true;
+    for (size_t i = 0; i < _controls.size(); ++i)
+    {
+        if (_controls[i]->HasChanged())
+            return true;
+    }
+    return false;
+}
+
 bool GUIMain::IsClickable() const
 {
     return (_flags & kGUIMain_Clickable) != 0;
@@ -182,6 +195,13 @@ bool GUIMain::BringControlToFront(int index)
     return SetControlZOrder(index, (int)_controls.size() - 1);
 }
 
+void GUIMain::ClearChanged()
+{
+    _hasChanged = false;
+    for (size_t i = 0; i < _controls.size(); ++i)
+        _controls[i]->ClearChanged();
+}
+
 void GUIMain::Draw(Bitmap *ds)
 {
     DrawAt(ds, X, Y);
@@ -305,7 +325,7 @@ void GUIMain::Poll()
                     _controls[MouseOverCtrl]->OnMouseMove(mousex, mousey);
                 }
             }
-            guis_need_update = 1;
+            MarkChanged();
         } 
         else if (MouseOverCtrl >= 0)
             _controls[MouseOverCtrl]->OnMouseMove(mousex, mousey);
@@ -317,6 +337,11 @@ void GUIMain::Poll()
     mousey = mywas;
 }
 
+void GUIMain::MarkChanged()
+{
+    _hasChanged = true;
+}
+
 HError GUIMain::RebuildArray()
 {
     GUIControlType thistype;
@@ -383,6 +408,7 @@ void GUIMain::SetConceal(bool on)
         _flags |= kGUIMain_Concealed;
     else
         _flags &= ~kGUIMain_Concealed;
+    MarkChanged();
 }
 
 bool GUIMain::SendControlToBack(int index)
@@ -419,6 +445,7 @@ bool GUIMain::SetControlZOrder(int index, int zorder)
     }
     ResortZOrder();
     OnControlPositionChanged();
+    MarkChanged();
     return true;
 }
 
@@ -428,6 +455,7 @@ void GUIMain::SetTextWindow(bool on)
         _flags |= kGUIMain_TextWindow;
     else
         _flags &= ~kGUIMain_TextWindow;
+    MarkChanged();
 }
 
 void GUIMain::SetTransparencyAsPercentage(int percent)
@@ -441,6 +469,7 @@ void GUIMain::SetVisible(bool on)
         _flags |= kGUIMain_Visible;
     else
         _flags &= ~kGUIMain_Visible;
+    MarkChanged();
 }
 
 void GUIMain::OnControlPositionChanged()
@@ -464,7 +493,7 @@ void GUIMain::OnMouseButtonDown()
     if (_controls[MouseOverCtrl]->OnMouseDown())
         MouseOverCtrl = MOVER_MOUSEDOWNLOCKED;
     _controls[MouseDownCtrl]->OnMouseMove(mousex - X, mousey - Y);
-    guis_need_update = 1;
+    MarkChanged();
 }
 
 void GUIMain::OnMouseButtonUp()
@@ -482,7 +511,7 @@ void GUIMain::OnMouseButtonUp()
 
     _controls[MouseDownCtrl]->OnMouseUp();
     MouseDownCtrl = -1;
-    guis_need_update = 1;
+    MarkChanged();
 }
 
 void GUIMain::ReadFromFile(Stream *in, GuiVersion gui_version)
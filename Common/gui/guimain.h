@@ -63,6 +63,8 @@ public:
 
     // Tells if the gui background supports alpha channel
     bool        HasAlphaChannel() const;
+    // Tells if the GUI or any of its controls has changed since it was drawn
+    bool        HasChanged() const;
     // Tells if GUI will react on clicking on it
     bool        IsClickable() const;
     // Tells if GUI's visibility is overridden and it won't be displayed on
@@ -105,9 +107,13 @@ public:
 
     // Operations
     bool    BringControlToFront(int index);
+    // Resets the changed state of the GUI and its controls after drawing it
+    void    ClearChanged();
     void    Draw(Bitmap *ds);
     void    DrawAt(Bitmap *ds, int x, int y);
     void    Poll();
+    // Notifies that the whole GUI has to be redrawn
+    void    MarkChanged();
     HError  RebuildArray();
     void    ResortZOrder();
     bool    SendControlToBack(int index);
@@ -170,6 +176,7 @@ public:
 
 private:
     int32_t _flags;          // style and behavior flags
+    bool    _hasChanged;     // GUI needs to be redrawn
 
     // Array of types and control indexes in global GUI object arrays;
     // maps GUI child slots to actual controls and used for rebuilding Controls array
@@ -33,6 +33,7 @@ GUIObject::GUIObject()
     Height      = 0;
     ZOrder      = -1;
     IsActivated    = false;
+    _hasChanged = true;
 }
 
 int GUIObject::GetEventCount() const
@@ -70,6 +71,11 @@ bool GUIObject::IsOverControl(int x, int y, int leeway) const
     return x >= X && y >= Y && x < (X + Width + leeway) && y < (Y + Height + leeway);
 }
 
+bool GUIObject::HasChanged() const
+{
+    return _hasChanged;
+}
+
 bool GUIObject::IsTranslated() const
 {
     return (Flags & kGUICtrl_Translated) != 0;
@@ -80,6 +86,16 @@ bool GUIObject::IsVisible() const
     return (Flags & kGUICtrl_Visible) != 0;
 }
 
+void GUIObject::ClearChanged()
+{
+    _hasChanged = false;
+}
+
+void GUIObject::MarkChanged()
+{
+    _hasChanged = true;
+}
+
 void GUIObject::SetClickable(bool on)
 {
     if (on)
@@ -94,6 +110,7 @@ void GUIObject::SetEnabled(bool on)
         Flags |= kGUICtrl_Enabled;
     else
         Flags &= ~kGUICtrl_Enabled;
+    MarkChanged();
 }
 
 void GUIObject::SetTranslated(bool on)
@@ -110,6 +127,7 @@ void GUIObject::SetVisible(bool on)
         Flags |= kGUICtrl_Visible;
     else
         Flags &= ~kGUICtrl_Visible;
+    MarkChanged();
 }
 
 // TODO: replace string serialization with StrUtil::ReadString and WriteString
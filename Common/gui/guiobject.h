@@ -58,9 +58,15 @@ public:
     bool            IsVisible() const;
     // implemented separately in engine and editor
     bool            IsClickable() const;
+    // Tells if the control's look has changed since the parent GUI was drawn
+    bool            HasChanged() const;
     
     // Operations
     virtual void    Draw(Bitmap *ds) { }
+    // Resets the changed state after the parent GUI was drawn
+    void            ClearChanged();
+    // Notifies that the control has to be redrawn
+    void            MarkChanged();
     void            SetClickable(bool on);
     void            SetEnabled(bool on);
     void            SetTranslated(bool on);
@@ -105,6 +111,7 @@ public:
   
 protected:
     uint32_t Flags;      // generic style and behavior flags
+    bool     _hasChanged; // control needs to be redrawn
 
     // TODO: explicit event names & handlers for every event
     int32_t  _scEventCount;                    // number of supported script events
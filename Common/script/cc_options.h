@@ -27,6 +27,9 @@
 #define SCOPT_NOIMPORTOVERRIDE 0x20 // do not allow an import to be re-declared
 //#define SCOPT_LEFTTORIGHT 0x40   // left-to-right operator precedance
 #define SCOPT_OLDSTRINGS  0x80   // allow old-style strings
+#define SCOPT_FUSEOPS    0x100   // combine common instruction sequences when creating instance (engine only)
+#define SCOPT_OPSTATS    0x200   // log instruction sequence statistics when creating instance (engine only)
+#define SCOPT_NOPREDECODE 0x400  // decode each instruction as it is executed, like older engines did (engine only, for comparison)
 
 extern void ccSetOption(int, int);
 extern int ccGetOption(int);
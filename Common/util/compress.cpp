@@ -18,6 +18,8 @@
 #endif
 
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include "ac/common.h"	// quit, update_polled_stuff
 #include "gfx/bitmap.h"
 #include "util/compress.h"
@@ -280,6 +282,76 @@ int cunpackbitl32(unsigned int *line, int size, Stream *in)
   return in->HasErrors() ? -1 : 0;
 }
 
+#if defined(AGS_BIG_ENDIAN)
+static inline unsigned char rle_swap(unsigned char v) { return v; }
+static inline unsigned short rle_swap(unsigned short v) { return BBOp::SwapBytesInt16(v); }
+static inline unsigned int rle_swap(unsigned int v) { return BBOp::SwapBytesInt32(v); }
+#endif
+
+// Decodes the line from memory; the control byte is followed either by one
+// value repeated 1 - cx times, or by cx + 1 values
+template <typename T>
+static int cunpackbits(T *line, int size, const uint8_t *src, size_t src_sz)
+{
+  const uint8_t *p = src;
+  const uint8_t *const end = src + src_sz;
+  int n = 0;
+
+  while (n < size) {
+    if (p == end)
+      return 0;
+    int cx = (int8_t)*p++;
+    if (cx == -128)
+      cx = 0;
+
+    if (cx < 0) {                //.............run
+      const int cnt = 1 - cx;
+      if ((size_t)(end - p) < sizeof(T))
+        return 0;
+      if (cnt > size - n)
+        return -1;
+      T ch;
+      memcpy(&ch, p, sizeof(T));
+      p += sizeof(T);
+#if defined(AGS_BIG_ENDIAN)
+      ch = rle_swap(ch);
+#endif
+      std::fill(line + n, line + n + cnt, ch);
+      n += cnt;
+    } else {                     //.....................seq
+      const int cnt = cx + 1;
+      if ((size_t)(end - p) < cnt * sizeof(T))
+        return 0;
+      if (cnt > size - n)
+        return -1;
+      memcpy(line + n, p, cnt * sizeof(T));
+      p += cnt * sizeof(T);
+#if defined(AGS_BIG_ENDIAN)
+      for (int i = n; i < n + cnt; ++i)
+        line[i] = rle_swap(line[i]);
+#endif
+      n += cnt;
+    }
+  }
+
+  return (int)(p - src);
+}
+
+int cunpackbitl(unsigned char *line, int size, const uint8_t *src, size_t src_sz)
+{
+  return cunpackbits(line, size, src, src_sz);
+}
+
+int cunpackbitl16(unsigned short *line, int size, const uint8_t *src, size_t src_sz)
+{
+  return cunpackbits(line, size, src, src_sz);
+}
+
+int cunpackbitl32(unsigned int *line, int size, const uint8_t *src, size_t src_sz)
+{
+  return cunpackbits(line, size, src, src_sz);
+}
+
 //=============================================================================
 
 const char *lztempfnm = "~aclzw.tmp";
@@ -316,29 +388,42 @@ void save_lzw(Stream *out, const Bitmap *bmpp, const color *pall)
   out->Seek(toret, kSeekBegin);
 }
 
-void load_lzw(Stream *in, Bitmap **dst_bmp, int dst_bpp, color *pall)
+void read_lzw(Stream *in, LzwImage &img, color *pall)
 {
-  soff_t        uncompsiz;
-  int           *loptr;
-  unsigned char *membuffer;
-  int           arin;
-
   in->Read(&pall[0], sizeof(color)*256);
-  maxsize = in->ReadInt32();
-  uncompsiz = in->ReadInt32();
-
-  uncompsiz += in->GetPosition();
-  outbytes = 0; putbytes = 0;
-
-  update_polled_stuff_if_runtime();
-  membuffer = lzwexpand_to_mem(in);
-  update_polled_stuff_if_runtime();
+  img.UnpackedSize = in->ReadInt32();
+  soff_t packed_size = in->ReadInt32();
+  img.Data.resize(packed_size);
+  if (packed_size > 0)
+    img.Data.resize(in->Read(&img.Data[0], packed_size));
+  img.Pixels.clear();
+}
 
-  loptr = (int *)&membuffer[0];
-  membuffer += 8;
+bool unpack_lzw(LzwImage &img)
+{
+  // decompressed data begins with line length in bytes and number of lines
+  const size_t header_size = sizeof(int) * 2;
+  if (img.UnpackedSize < header_size)
+    return false;
+  img.Pixels.resize(img.UnpackedSize);
+  if (!lzwexpand(img.Data.empty() ? NULL : &img.Data[0], img.Data.size(), &img.Pixels[0], img.UnpackedSize))
+    return false;
+  img.Data.clear();
+
+  int *loptr = (int *)&img.Pixels[0];
 #if defined(AGS_BIG_ENDIAN)
   loptr[0] = BBOp::SwapBytesInt32(loptr[0]);
   loptr[1] = BBOp::SwapBytesInt32(loptr[1]);
+#endif // defined(AGS_BIG_ENDIAN)
+  return loptr[0] >= 0 && loptr[1] >= 0 &&
+    (soff_t)loptr[0] * loptr[1] <= (soff_t)(img.UnpackedSize - header_size);
+}
+
+Bitmap *create_lzw_bitmap(LzwImage &img, int dst_bpp)
+{
+  int *loptr = (int *)&img.Pixels[0];
+  unsigned char *membuffer = &img.Pixels[sizeof(int) * 2];
+#if defined(AGS_BIG_ENDIAN)
   int bitmapNumPixels = loptr[0]*loptr[1]/ dst_bpp;
   switch (dst_bpp) // bytes per pixel!
   {
@@ -370,30 +455,33 @@ void load_lzw(Stream *in, Bitmap **dst_bmp, int dst_bpp, color *pall)
   }
 #endif // defined(AGS_BIG_ENDIAN)
 
-  update_polled_stuff_if_runtime();
-
   Bitmap *bmm = BitmapHelper::CreateBitmap((loptr[0] / dst_bpp), loptr[1], dst_bpp * 8);
   if (bmm == NULL)
-    quit("!load_room: not enough memory to load room background");
-
-  update_polled_stuff_if_runtime();
+    return NULL;
 
   bmm->Acquire ();
 
-  for (arin = 0; arin < loptr[1]; arin++)
+  for (int arin = 0; arin < loptr[1]; arin++)
     memcpy(&bmm->GetScanLineForWriting(arin)[0], &membuffer[arin * loptr[0]], loptr[0]);
 
   bmm->Release ();
 
-  update_polled_stuff_if_runtime();
-
-  free(membuffer-8);
-
-  if (in->GetPosition() != uncompsiz)
-    in->Seek(uncompsiz, kSeekBegin);
+  img.Pixels.clear();
+  return bmm;
+}
 
+void load_lzw(Stream *in, Bitmap **dst_bmp, int dst_bpp, color *pall)
+{
+  LzwImage img;
+  read_lzw(in, img, pall);
+  update_polled_stuff_if_runtime();
+  if (!unpack_lzw(img))
+    quit("Read error decompressing image - file is corrupt");
+  update_polled_stuff_if_runtime();
+  Bitmap *bmm = create_lzw_bitmap(img, dst_bpp);
+  if (bmm == NULL)
+    quit("!load_room: not enough memory to load room background");
   update_polled_stuff_if_runtime();
-
   *dst_bmp = bmm;
 }
 
@@ -411,6 +499,9 @@ void savecompressed_allegro(Stream *out, const Bitmap *bmpp, const color *pall)
   free(wgtbl);
 }
 
+// Size of the chunks in which compressed masks are read
+#define MASK_READ_CHUNK 65536
+
 void loadcompressed_allegro(Stream *in, Bitmap **bimpp, color *pall)
 {
   short widd,hitt;
@@ -422,11 +513,33 @@ void loadcompressed_allegro(Stream *in, Bitmap **bimpp, color *pall)
   if (bim == NULL)
     quit("!load_room: not enough memory to decompress masks");
 
+  // size of the compressed lines is not stored, so they are read in large
+  // chunks, and the unused part is returned to the stream in the end
+  std::vector<uint8_t> buf(std::max<size_t>(MASK_READ_CHUNK, widd * 2 + 2));
+  size_t buf_pos = 0, buf_len = 0;
   for (ii = 0; ii < hitt; ii++) {
-    cunpackbitl(&bim->GetScanLineForWriting(ii)[0], widd, in);
+    unsigned char *line = &bim->GetScanLineForWriting(ii)[0];
+    int used = cunpackbitl(line, widd, buf.data() + buf_pos, buf_len - buf_pos);
+    if (used == 0) {
+      memmove(buf.data(), buf.data() + buf_pos, buf_len - buf_pos);
+      buf_len -= buf_pos;
+      buf_pos = 0;
+      buf_len += in->Read(buf.data() + buf_len, buf.size() - buf_len);
+      used = cunpackbitl(line, widd, buf.data(), buf_len);
+    }
+    if (used <= 0) {
+      // corrupt or truncated data, read the rest as it always has been
+      in->Seek(-(soff_t)(buf_len - buf_pos), kSeekCurrent);
+      buf_pos = buf_len = 0;
+      for (; ii < hitt; ii++)
+        cunpackbitl(&bim->GetScanLineForWriting(ii)[0], widd, in);
+      break;
+    }
+    buf_pos += used;
     if (ii % 20 == 0)
       update_polled_stuff_if_runtime();
   }
+  in->Seek(-(soff_t)(buf_len - buf_pos), kSeekCurrent);
 
   in->Seek(768);  // skip palette
   *bimpp = bim;
@@ -15,6 +15,8 @@
 #ifndef __AC_COMPRESS_H
 #define __AC_COMPRESS_H
 
+#include <vector>
+#include "core/types.h"
 #include "util/wgt2allg.h" // color (allegro RGB)
 
 namespace AGS { namespace Common { class Stream; class Bitmap; } }
@@ -27,11 +29,33 @@ void cpackbitl32(unsigned int *line, int size, Common::Stream *out);
 int  cunpackbitl(unsigned char *line, int size, Common::Stream *in);
 int  cunpackbitl16(unsigned short *line, int size, Common::Stream *in);
 int  cunpackbitl32(unsigned int *line, int size, Common::Stream *in);
+// Decode one line from the memory buffer; return the number of bytes used,
+// 0 if the buffer ends before the line does, or -1 if the data is corrupt
+int  cunpackbitl(unsigned char *line, int size, const uint8_t *src, size_t src_sz);
+int  cunpackbitl16(unsigned short *line, int size, const uint8_t *src, size_t src_sz);
+int  cunpackbitl32(unsigned int *line, int size, const uint8_t *src, size_t src_sz);
 
 //=============================================================================
 
 void save_lzw(Common::Stream *out, const Common::Bitmap *bmpp, const color *pall);
 void load_lzw(Common::Stream *in, Common::Bitmap **bmm, int dst_bpp, color *pall);
+
+// LZW-compressed bitmap, which is read from the stream and decompressed
+// separately; decompression uses no shared state and so may be done by any
+// thread, while the bitmap is created by the thread which read it
+struct LzwImage
+{
+    std::vector<uint8_t> Data;      // compressed data
+    size_t               UnpackedSize;
+    std::vector<uint8_t> Pixels;    // decompressed data
+};
+
+// Reads compressed bitmap data and its palette from the stream
+void read_lzw(Common::Stream *in, LzwImage &img, color *pall);
+// Decompresses bitmap data; returns false if it is corrupt
+bool unpack_lzw(LzwImage &img);
+// Creates bitmap of the decompressed data, or returns NULL on failure
+Common::Bitmap *create_lzw_bitmap(LzwImage &img, int dst_bpp);
 void savecompressed_allegro(Common::Stream *out, const Common::Bitmap *bmpp, const color *pall);
 void loadcompressed_allegro(Common::Stream *in, Common::Bitmap **bimpp, color *pall);
 
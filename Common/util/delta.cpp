@@ -0,0 +1,234 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "util/delta.h"
+#include "util/stdtr1compat.h"
+#include TR1INCLUDE(unordered_map)
+
+#define DELTA_MIN_CHUNK  64
+#define DELTA_MAX_CHUNK  2048
+#define DELTA_CHUNK_MASK 0xFF000000u // 8 bits, chunks of 256 bytes on average
+
+enum DeltaOp
+{
+    kDeltaOp_End  = 0,
+    kDeltaOp_Copy = 1, // offset and length of the data in base
+    kDeltaOp_Data = 2  // length of the new data, followed by the data
+};
+
+// Table of random values for the rolling hash, one per byte value
+struct DeltaGearTable
+{
+    uint32_t Values[256];
+
+    DeltaGearTable()
+    {
+        uint64_t x = 0;
+        for (int i = 0; i < 256; ++i)
+        {
+            x += 0x9E3779B97F4A7C15ull;
+            uint64_t z = x;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            Values[i] = (uint32_t)((z ^ (z >> 31)) >> 32);
+        }
+    }
+};
+
+static const DeltaGearTable DeltaGear;
+
+// Returns the length of the chunk which starts at the given data
+static size_t delta_chunk(const uint8_t *data, size_t size)
+{
+    if (size <= DELTA_MIN_CHUNK)
+        return size;
+    const size_t max_len = size < DELTA_MAX_CHUNK ? size : DELTA_MAX_CHUNK;
+    uint32_t hash = 0;
+    size_t i = 0;
+    // the hash depends on the last 32 bytes only, so begin just before
+    // the earliest allowed boundary
+    for (i = DELTA_MIN_CHUNK - 32; i < DELTA_MIN_CHUNK; ++i)
+        hash = (hash << 1) + DeltaGear.Values[data[i]];
+    for (; i < max_len; ++i)
+    {
+        if ((hash & DELTA_CHUNK_MASK) == 0)
+            return i;
+        hash = (hash << 1) + DeltaGear.Values[data[i]];
+    }
+    return max_len;
+}
+
+static uint64_t delta_hash(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i)
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    return hash;
+}
+
+static void delta_write_num(std::vector<uint8_t> &out, uint64_t v)
+{
+    for (; v >= 0x80; v >>= 7)
+        out.push_back((uint8_t)(v | 0x80));
+    out.push_back((uint8_t)v);
+}
+
+static bool delta_read_num(const uint8_t *&p, const uint8_t *end, uint64_t &v)
+{
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7)
+    {
+        const uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static void delta_write_data(std::vector<uint8_t> &out, const uint8_t *data, size_t size)
+{
+    if (size == 0)
+        return;
+    out.push_back(kDeltaOp_Data);
+    delta_write_num(out, size);
+    out.insert(out.end(), data, data + size);
+}
+
+void deltacompress(const uint8_t *base, size_t base_sz, const uint8_t *src, size_t src_sz,
+                   std::vector<uint8_t> &delta)
+{
+    delta.clear();
+    if (base_sz == src_sz && memcmp(base, src, src_sz) == 0)
+    {
+        if (src_sz > 0)
+        {
+            delta.push_back(kDeltaOp_Copy);
+            delta_write_num(delta, 0);
+            delta_write_num(delta, src_sz);
+        }
+        delta.push_back(kDeltaOp_End);
+        return;
+    }
+
+    // Index the chunks of the base by their content
+    typedef stdtr1compat::unordered_multimap<uint64_t, std::pair<size_t, size_t> > ChunkMap;
+    ChunkMap base_chunks;
+    for (size_t off = 0; off < base_sz;)
+    {
+        const size_t len = delta_chunk(base + off, base_sz - off);
+        base_chunks.insert(std::make_pair(delta_hash(base + off, len), std::make_pair(off, len)));
+        off += len;
+    }
+
+    // Replace the new data's chunks found in the base by the references;
+    // adjacent references and data pieces are merged together
+    size_t data_start = 0;
+    size_t copy_off = 0, copy_len = 0;
+    for (size_t off = 0; off < src_sz;)
+    {
+        const size_t len = delta_chunk(src + off, src_sz - off);
+        const std::pair<ChunkMap::const_iterator, ChunkMap::const_iterator> found =
+            base_chunks.equal_range(delta_hash(src + off, len));
+        ChunkMap::const_iterator match = found.second;
+        for (ChunkMap::const_iterator it = found.first; it != found.second; ++it)
+        {
+            if (it->second.second == len && memcmp(base + it->second.first, src + off, len) == 0)
+            {
+                match = it;
+                // prefer the chunk which continues the current reference
+                if (copy_len > 0 && it->second.first == copy_off + copy_len)
+                    break;
+            }
+        }
+
+        if (match == found.second)
+        {
+            if (copy_len > 0)
+            {
+                delta.push_back(kDeltaOp_Copy);
+                delta_write_num(delta, copy_off);
+                delta_write_num(delta, copy_len);
+                copy_len = 0;
+                data_start = off;
+            }
+        }
+        else
+        {
+            delta_write_data(delta, src + data_start, off - data_start);
+            if (copy_len > 0 && match->second.first == copy_off + copy_len)
+            {
+                copy_len += len;
+            }
+            else
+            {
+                if (copy_len > 0)
+                {
+                    delta.push_back(kDeltaOp_Copy);
+                    delta_write_num(delta, copy_off);
+                    delta_write_num(delta, copy_len);
+                }
+                copy_off = match->second.first;
+                copy_len = len;
+            }
+            data_start = off + len;
+        }
+        off += len;
+    }
+    if (copy_len > 0)
+    {
+        delta.push_back(kDeltaOp_Copy);
+        delta_write_num(delta, copy_off);
+        delta_write_num(delta, copy_len);
+    }
+    else
+    {
+        delta_write_data(delta, src + data_start, src_sz - data_start);
+    }
+    delta.push_back(kDeltaOp_End);
+}
+
+bool deltaexpand(const uint8_t *base, size_t base_sz, const uint8_t *delta, size_t delta_sz,
+                 std::vector<uint8_t> &dst)
+{
+    dst.clear();
+    const uint8_t *p = delta;
+    const uint8_t *end = delta + delta_sz;
+    while (p < end)
+    {
+        const uint8_t op = *p++;
+        uint64_t off, len;
+        switch (op)
+        {
+        case kDeltaOp_End:
+            return p == end;
+        case kDeltaOp_Copy:
+            if (!delta_read_num(p, end, off) || !delta_read_num(p, end, len) ||
+                off > base_sz || len > base_sz - off)
+                return false;
+            dst.insert(dst.end(), base + off, base + off + len);
+            break;
+        case kDeltaOp_Data:
+            if (!delta_read_num(p, end, len) || len > (uint64_t)(end - p))
+                return false;
+            dst.insert(dst.end(), p, p + len);
+            p += len;
+            break;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
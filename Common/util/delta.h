@@ -0,0 +1,37 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Delta encoding of the data against its older version. Both buffers are
+// split into chunks at the positions defined by their content, so that the
+// chunks stay the same when data is inserted or removed before them; the
+// delta then consists of references to the chunks found in the base and of
+// the new data.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__DELTA_H
+#define __AGS_CN_UTIL__DELTA_H
+
+#include <stddef.h>
+#include <vector>
+#include "core/types.h"
+
+// Makes the delta which turns the base data into the new one
+void deltacompress(const uint8_t *base, size_t base_sz, const uint8_t *src, size_t src_sz,
+                   std::vector<uint8_t> &delta);
+// Restores the data from the base and the delta; returns false if the delta
+// is corrupt or was made for another base
+bool deltaexpand(const uint8_t *base, size_t base_sz, const uint8_t *delta, size_t delta_sz,
+                 std::vector<uint8_t> &dst);
+
+#endif // __AGS_CN_UTIL__DELTA_H
@@ -14,6 +14,10 @@
 
 #if defined(WINDOWS_VERSION)
 #include <io.h>
+#include <windows.h>
+#undef CreateFile  // undef the declarations from winbase.h
+#undef DeleteFile
+#undef ReplaceFile
 #else
 #include <unistd.h> // for unlink()
 #endif
@@ -85,6 +89,16 @@ bool File::DeleteFile(const String &filename)
     return true;
 }
 
+bool File::ReplaceFile(const String &old_name, const String &new_name)
+{
+#if defined(WINDOWS_VERSION)
+    return MoveFileExA(old_name, new_name, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    // rename is atomic on POSIX systems
+    return rename(old_name, new_name) == 0;
+#endif
+}
+
 bool File::GetFileModesFromCMode(const String &cmode, FileOpenMode &open_mode, FileWorkMode &work_mode)
 {
     // We do not test for 'b' and 't' here, because text mode reading/writing should be done with
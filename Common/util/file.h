@@ -54,6 +54,9 @@ namespace File
     bool        TestCreateFile(const String &filename);
     // Deletes existing file; returns TRUE if was able to delete one
     bool        DeleteFile(const String &filename);
+    // Renames file, replacing the existing one with the new name in one step
+    // where the system allows; returns TRUE on success
+    bool        ReplaceFile(const String &old_name, const String &new_name);
 
     // Sets FileOpenMode and FileWorkMode values corresponding to C-style file open mode string
     bool        GetFileModesFromCMode(const String &cmode, FileOpenMode &open_mode, FileWorkMode &work_mode);
@@ -0,0 +1,199 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "util/lz4.h"
+
+#ifdef _MANAGED
+// ensure this doesn't get compiled to .NET IL
+#pragma unmanaged
+#endif
+
+#define LZ4_MINMATCH     4
+#define LZ4_LASTLITERALS 5  // last bytes of the block are always literals
+#define LZ4_MFLIMIT      12 // last match must start this far from the end
+#define LZ4_MAXDISTANCE  65535
+#define LZ4_HASH_BITS    12
+
+static inline uint32_t lz4_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint32_t lz4_hash(uint32_t v)
+{
+    return (v * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+// Writes the length remainder, which did not fit into the token nibble
+static inline uint8_t *lz4_write_length(uint8_t *op, size_t len)
+{
+    for (; len >= 255; len -= 255)
+        *op++ = 255;
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+// Reads the length remainder; returns false if the data ends before it does
+static inline bool lz4_read_length(const uint8_t *&ip, const uint8_t *iend, size_t &len)
+{
+    uint8_t b;
+    do
+    {
+        if (ip == iend)
+            return false;
+        b = *ip++;
+        len += b;
+    }
+    while (b == 255);
+    return true;
+}
+
+size_t lz4bound(size_t src_sz)
+{
+    return src_sz + src_sz / 255 + 16;
+}
+
+size_t lz4compress(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
+{
+    const uint8_t *ip = src;
+    const uint8_t *anchor = src;
+    const uint8_t *const iend = src + src_sz;
+    uint8_t *op = dst;
+    uint8_t *const oend = dst + dst_sz;
+
+    if (src_sz > LZ4_MFLIMIT)
+    {
+        const uint8_t *const mflimit = iend - LZ4_MFLIMIT;
+        const uint8_t *const matchlimit = iend - LZ4_LASTLITERALS;
+        // last seen position + 1 of every hashed 4-byte sequence, 0 if none
+        uint32_t table[1 << LZ4_HASH_BITS];
+        memset(table, 0, sizeof(table));
+
+        while (ip < mflimit)
+        {
+            const uint32_t seq = lz4_read32(ip);
+            const uint32_t h = lz4_hash(seq);
+            const uint32_t ref = table[h];
+            table[h] = (uint32_t)(ip - src) + 1;
+            if (ref == 0 || (size_t)(ip - src) + 1 - ref > LZ4_MAXDISTANCE ||
+                lz4_read32(src + ref - 1) != seq)
+            {
+                ip++;
+                continue;
+            }
+
+            const uint8_t *match = src + ref - 1;
+            while (ip > anchor && match > src && ip[-1] == match[-1])
+            {
+                ip--;
+                match--;
+            }
+            const uint8_t *match_end = ip + LZ4_MINMATCH;
+            for (const uint8_t *m = match + LZ4_MINMATCH; match_end < matchlimit && *match_end == *m; ++m)
+                match_end++;
+
+            const size_t lit_len = ip - anchor;
+            const size_t match_len = match_end - ip - LZ4_MINMATCH;
+            if ((size_t)(oend - op) < 1 + lit_len + lit_len / 255 + 1 + 2 + match_len / 255 + 1)
+                return 0;
+            uint8_t *token = op++;
+            *token = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+            if (lit_len >= 15)
+                op = lz4_write_length(op, lit_len - 15);
+            memcpy(op, anchor, lit_len);
+            op += lit_len;
+            const size_t offset = ip - match;
+            *op++ = (uint8_t)offset;
+            *op++ = (uint8_t)(offset >> 8);
+            *token |= (uint8_t)(match_len >= 15 ? 15 : match_len);
+            if (match_len >= 15)
+                op = lz4_write_length(op, match_len - 15);
+
+            ip = match_end;
+            anchor = ip;
+        }
+    }
+
+    // the rest is written as literals
+    const size_t lit_len = iend - anchor;
+    if ((size_t)(oend - op) < 1 + lit_len + lit_len / 255 + 1)
+        return 0;
+    *op++ = (uint8_t)((lit_len >= 15 ? 15 : lit_len) << 4);
+    if (lit_len >= 15)
+        op = lz4_write_length(op, lit_len - 15);
+    memcpy(op, anchor, lit_len);
+    op += lit_len;
+    return op - dst;
+}
+
+bool lz4expand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz)
+{
+    const uint8_t *ip = src;
+    const uint8_t *const iend = src + src_sz;
+    uint8_t *op = dst;
+    uint8_t *const oend = dst + dst_sz;
+
+    for (;;)
+    {
+        if (ip == iend)
+            return false;
+        const uint8_t token = *ip++;
+
+        size_t len = token >> 4;
+        if (len == 15 && !lz4_read_length(ip, iend, len))
+            return false;
+        if (len > (size_t)(iend - ip) || len > (size_t)(oend - op))
+            return false;
+        memcpy(op, ip, len);
+        op += len;
+        ip += len;
+        // the last sequence has only literals
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return false;
+        const size_t offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst))
+            return false;
+        len = token & 15;
+        if (len == 15 && !lz4_read_length(ip, iend, len))
+            return false;
+        len += LZ4_MINMATCH;
+        if (len > (size_t)(oend - op))
+            return false;
+
+        const uint8_t *match = op - offset;
+        if (offset >= len)
+        {
+            memcpy(op, match, len);
+        }
+        else if (offset == 1)
+        {
+            memset(op, *match, len);
+        }
+        else
+        {
+            // overlapping match repeats the last bytes
+            for (size_t i = 0; i < len; ++i)
+                op[i] = match[i];
+        }
+        op += len;
+    }
+    return op == oend;
+}
@@ -0,0 +1,36 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Compression in the LZ4 block format: sequences of literals followed by
+// back-references within a 64 KB window. Decompression is many times faster
+// than LZW and RLE, at a moderately worse ratio.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__LZ4_H
+#define __AGS_CN_UTIL__LZ4_H
+
+#include <stddef.h>
+#include "core/types.h"
+
+// Returns the largest possible size of compressed data of the given size
+size_t lz4bound(size_t src_sz);
+// Compresses the buffer into another, which should have at least lz4bound
+// bytes; returns the compressed size, or 0 if the output does not fit
+size_t lz4compress(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz);
+// Decompresses the data, which must fill the output buffer exactly; returns
+// false if the data is corrupt. Uses no shared state, so may be called by
+// several threads at once.
+bool   lz4expand(const uint8_t *src, size_t src_sz, uint8_t *dst, size_t dst_sz);
+
+#endif // __AGS_CN_UTIL__LZ4_H
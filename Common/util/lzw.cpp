@@ -17,6 +17,7 @@
 //=============================================================================
 
 #include <stdlib.h>
+#include <string.h>
 #include "ac/common.h" // quit
 #include "util/stream.h"
 
@@ -48,7 +49,7 @@ void _delete(int);
 char *lzbuffer;
 int *node;
 int pos;
-long outbytes = 0, maxsize = 0, putbytes = 0;
+long outbytes = 0;
 
 int insert(int i, int run)
 {
@@ -196,80 +197,67 @@ void lzwcompress(Stream *lzw_in, Stream *out)
   free(lzbuffer);
 }
 
-int expand_to_mem = 0;
-unsigned char *membfptr = NULL;
-void myputc(int ccc, Stream *out)
+// Copies the back-reference, using the output as the window; the data
+// before the output start reads as zeros, which is what the window used to
+// be filled with
+static inline unsigned char *lzw_copy_match(unsigned char *dst, unsigned char *out, size_t dist, size_t len)
 {
-  if (maxsize > 0) {
-    putbytes++;
-    if (putbytes > maxsize)
-      return;
+  if (dist > (size_t)(out - dst)) {
+    for (; len > 0; --len, ++out)
+      *out = (dist > (size_t)(out - dst)) ? 0 : *(out - dist);
+    return out;
   }
-
-  outbytes++;
-  if (expand_to_mem) {
-    membfptr[0] = ccc;
-    membfptr++;
-  } else
-    out->WriteInt8(ccc);
+  const unsigned char *from = out - dist;
+  if (dist >= len)
+    memcpy(out, from, len);
+  else
+    for (size_t k = 0; k < len; ++k)
+      out[k] = from[k];
+  return out + len;
 }
 
-void lzwexpand(Stream *lzw_in, Stream *out)
+bool lzwexpand(const unsigned char *src, size_t src_sz, unsigned char *dst, size_t dst_sz)
 {
-  int bits, ch, i, j, len, mask;
-  char *lzbuffer;
-//  printf(" UnShrinking: %s ",filena);
-  putbytes = 0;
-
-  lzbuffer = (char *)malloc(N);
-  if (lzbuffer == NULL) {
-    quit("compress.cpp: unable to decompress: insufficient memory");
-  }
-  i = N - F;
+  // every flag byte is followed by 8 tokens: a literal byte or a 2-byte
+  // reference, which repeats up to MAX_MATCH bytes from the last N
+  const int MAX_MATCH = 15 + THRESHOLD;
+  const unsigned char *src_end = src + src_sz;
+  unsigned char *out = dst;
+  unsigned char *const out_end = dst + dst_sz;
+
+  while (out < out_end && src < src_end) {
+    const int bits = *src++;
+    if (src_end - src >= 16 && out_end - out >= 8 * MAX_MATCH) {
+      // the whole group fits in both buffers, no need to test the bounds
+      for (int mask = 0x01; mask & 0xFF; mask <<= 1) {
+        if (bits & mask) {
+          const int j = src[0] | (src[1] << 8); // little-endian short
+          src += 2;
+          out = lzw_copy_match(dst, out, (j & (N - 1)) + 1, ((j >> 12) & 15) + THRESHOLD);
+        } else {
+          *out++ = *src++;
+        }
+      }
+      continue;
+    }
 
-  // this end condition just checks for EOF, which is no good to us
-  while ((bits = lzw_in->ReadByte()) != -1) {
-    for (mask = 0x01; mask & 0xFF; mask <<= 1) {
+    for (int mask = 0x01; mask & 0xFF; mask <<= 1) {
       if (bits & mask) {
-        // MACPORT FIX: read to short and expand
-        short jshort = 0;
-        jshort = lzw_in->ReadInt16();
-        j = jshort;
-
-        len = ((j >> 12) & 15) + 3;
-        j = (i - j - 1) & (N - 1);
-
-        while (len--) {
-          myputc(lzbuffer[i] = lzbuffer[j], out);
-          j = (j + 1) & (N - 1);
-          i = (i + 1) & (N - 1);
-        }
+        if (src_end - src < 2)
+          return false;
+        const int j = src[0] | (src[1] << 8);
+        src += 2;
+        const size_t len = min((size_t)((j >> 12) & 15) + THRESHOLD, (size_t)(out_end - out));
+        out = lzw_copy_match(dst, out, (j & (N - 1)) + 1, len);
       } else {
-        ch = lzw_in->ReadByte();
-        myputc(lzbuffer[i] = ch, out);
-        i = (i + 1) & (N - 1);
+        if (src == src_end)
+          return false;
+        *out++ = *src++;
       }
 
-      if ((putbytes >= maxsize) && (maxsize > 0))
+      if (out == out_end)
         break;
-
-      if ((lzw_in->EOS()) && (maxsize > 0))
-        quit("Read error decompressing image - file is corrupt");
-    }                           // end for mask
-
-    if ((putbytes >= maxsize) && (maxsize > 0))
-      break;
+    }
   }
-
-  free(lzbuffer);
-  expand_to_mem = 0;
-}
-
-unsigned char *lzwexpand_to_mem(Stream *in)
-{
-  unsigned char *membuff = (unsigned char *)malloc(maxsize + 10);
-  expand_to_mem = 1;
-  membfptr = membuff;
-  lzwexpand(in, NULL);
-  return membuff;
+  return out == out_end;
 }
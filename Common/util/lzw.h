@@ -18,12 +18,17 @@
 #ifndef __AGS_CN_UTIL__LZW_H
 #define __AGS_CN_UTIL__LZW_H
 
+#include <stddef.h>
+
 namespace AGS { namespace Common { class Stream; } }
 using namespace AGS; // FIXME later
 
 void lzwcompress(Common::Stream *lzw_in, Common::Stream *out);
-unsigned char *lzwexpand_to_mem(Common::Stream *in);
+// Decompresses LZW data from one memory buffer into another, until the output
+// buffer is full; returns false if the input data ends before that. Uses no
+// shared state, so may be called by several threads at once.
+bool lzwexpand(const unsigned char *src, size_t src_sz, unsigned char *dst, size_t dst_sz);
 
-extern long outbytes, maxsize, putbytes;
+extern long outbytes;
 
 #endif // __AGS_CN_UTIL__LZW_H
@@ -0,0 +1,185 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#if !defined (WINDOWS_VERSION) && !defined (PSP_VERSION)
+#define AGS_HAS_FILE_MAPPING
+#endif
+
+#include <string.h>
+#if defined (AGS_HAS_FILE_MAPPING)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "util/mappedfilestream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+MappedFileStream::MappedFileStream(const String &file_name, DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _data(NULL)
+    , _length(0)
+    , _pos(0)
+{
+    Open(file_name);
+}
+
+MappedFileStream::~MappedFileStream()
+{
+    Close();
+}
+
+void MappedFileStream::Close()
+{
+#if defined (AGS_HAS_FILE_MAPPING)
+    if (_data)
+        munmap(_data, _length);
+#endif
+    _data = NULL;
+    _length = 0;
+    _pos = 0;
+}
+
+bool MappedFileStream::Flush()
+{
+    return false;
+}
+
+bool MappedFileStream::IsValid() const
+{
+    return _data != NULL;
+}
+
+bool MappedFileStream::EOS() const
+{
+    return !IsValid() || _pos >= _length;
+}
+
+soff_t MappedFileStream::GetLength() const
+{
+    return (soff_t)_length;
+}
+
+soff_t MappedFileStream::GetPosition() const
+{
+    return IsValid() ? (soff_t)_pos : -1;
+}
+
+bool MappedFileStream::CanRead() const
+{
+    return IsValid();
+}
+
+bool MappedFileStream::CanWrite() const
+{
+    return false;
+}
+
+bool MappedFileStream::CanSeek() const
+{
+    return IsValid();
+}
+
+size_t MappedFileStream::Read(void *buffer, size_t size)
+{
+    if (!_data || !buffer || _pos >= _length)
+        return 0;
+    if (size > _length - _pos)
+        size = _length - _pos;
+    memcpy(buffer, _data + _pos, size);
+    _pos += size;
+    return size;
+}
+
+int32_t MappedFileStream::ReadByte()
+{
+    if (!_data || _pos >= _length)
+        return -1;
+    return _data[_pos++];
+}
+
+size_t MappedFileStream::Write(const void *buffer, size_t size)
+{
+    return 0;
+}
+
+int32_t MappedFileStream::WriteByte(uint8_t b)
+{
+    return -1;
+}
+
+soff_t MappedFileStream::Seek(soff_t offset, StreamSeek origin)
+{
+    if (!_data)
+        return -1;
+
+    soff_t new_pos;
+    switch (origin)
+    {
+    case kSeekBegin:    new_pos = offset; break;
+    case kSeekCurrent:  new_pos = (soff_t)_pos + offset; break;
+    case kSeekEnd:      new_pos = (soff_t)_length + offset; break;
+    default:
+        return -1;
+    }
+    if (new_pos < 0)
+        new_pos = 0;
+    else if (new_pos > (soff_t)_length)
+        new_pos = (soff_t)_length;
+    _pos = (size_t)new_pos;
+    return new_pos;
+}
+
+const uint8_t *MappedFileStream::GetData(soff_t pos, size_t size) const
+{
+    if (!_data || pos < 0 || (size_t)pos > _length || size > _length - (size_t)pos)
+        return NULL;
+    return _data + pos;
+}
+
+bool MappedFileStream::HasAddress(const void *ptr) const
+{
+    const uint8_t *p = static_cast<const uint8_t*>(ptr);
+    return _data && p >= _data && p < _data + _length;
+}
+
+void MappedFileStream::Open(const String &file_name)
+{
+#if defined (AGS_HAS_FILE_MAPPING)
+    int fd = open(file_name, O_RDONLY);
+    if (fd < 0)
+        return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0 && (uint64_t)st.st_size <= SIZE_MAX)
+    {
+        // Read-only mapping, so that writing into the images made over it
+        // fails at once instead of changing the sprites for the next load
+        void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            _data = static_cast<uint8_t*>(data);
+            _length = (size_t)st.st_size;
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    close(fd);
+#endif
+}
+
+} // namespace Common
+} // namespace AGS
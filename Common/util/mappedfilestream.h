@@ -0,0 +1,81 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Read-only stream over the file mapped into memory. Besides the regular
+// reading, allows to access file contents directly, without copying.
+//
+// The mapping is read-only: the mapped memory must never be written to,
+// and anything that has to be modified must be copied out of it first.
+//
+// Memory mapping is currently only supported on POSIX systems; elsewhere the
+// stream is always invalid and caller should use FileStream instead.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MAPPEDFILESTREAM_H
+#define __AGS_CN_UTIL__MAPPEDFILESTREAM_H
+
+#include "util/datastream.h"
+#include "util/string.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MappedFileStream : public DataStream
+{
+public:
+    MappedFileStream(const String &file_name, DataEndianess stream_endianess = kLittleEndian);
+    virtual ~MappedFileStream();
+
+    virtual void    Close();
+    virtual bool    Flush();
+
+    // Is stream valid (underlying data initialized properly)
+    virtual bool    IsValid() const;
+    // Is end of stream
+    virtual bool    EOS() const;
+    // Total length of stream (if known)
+    virtual soff_t  GetLength() const;
+    // Current position (if known)
+    virtual soff_t  GetPosition() const;
+    virtual bool    CanRead() const;
+    virtual bool    CanWrite() const;
+    virtual bool    CanSeek() const;
+
+    virtual size_t  Read(void *buffer, size_t size);
+    virtual int32_t ReadByte();
+    virtual size_t  Write(const void *buffer, size_t size);
+    virtual int32_t WriteByte(uint8_t b);
+
+    virtual soff_t  Seek(soff_t offset, StreamSeek origin);
+
+    // Returns pointer to the mapped data at the given position, if there is
+    // at least the given amount of bytes available after it; otherwise NULL
+    const uint8_t  *GetData(soff_t pos, size_t size) const;
+    // Tells if the memory address belongs to the mapped file
+    bool            HasAddress(const void *ptr) const;
+
+private:
+    void            Open(const String &file_name);
+
+    uint8_t         *_data;
+    size_t           _length;
+    size_t           _pos;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MAPPEDFILESTREAM_H
@@ -0,0 +1,139 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include "util/memorystream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+MemoryStream::MemoryStream(std::vector<uint8_t> data, DataEndianess stream_endianess)
+    : DataStream(stream_endianess)
+    , _data(std::move(data))
+    , _pos(0)
+{
+}
+
+MemoryStream::~MemoryStream()
+{
+}
+
+void MemoryStream::Close()
+{
+    _data.clear();
+    _pos = 0;
+}
+
+bool MemoryStream::Flush()
+{
+    return true;
+}
+
+bool MemoryStream::IsValid() const
+{
+    return true;
+}
+
+bool MemoryStream::EOS() const
+{
+    return _pos >= _data.size();
+}
+
+soff_t MemoryStream::GetLength() const
+{
+    return (soff_t)_data.size();
+}
+
+soff_t MemoryStream::GetPosition() const
+{
+    return (soff_t)_pos;
+}
+
+bool MemoryStream::CanRead() const
+{
+    return true;
+}
+
+bool MemoryStream::CanWrite() const
+{
+    return true;
+}
+
+bool MemoryStream::CanSeek() const
+{
+    return true;
+}
+
+size_t MemoryStream::Read(void *buffer, size_t size)
+{
+    if (_pos >= _data.size())
+        return 0;
+    if (size > _data.size() - _pos)
+        size = _data.size() - _pos;
+    memcpy(buffer, &_data[_pos], size);
+    _pos += size;
+    return size;
+}
+
+int32_t MemoryStream::ReadByte()
+{
+    if (_pos >= _data.size())
+        return -1;
+    return _data[_pos++];
+}
+
+size_t MemoryStream::Write(const void *buffer, size_t size)
+{
+    if (size == 0)
+        return 0;
+    if (_data.size() < _pos + size)
+        _data.resize(_pos + size);
+    memcpy(&_data[_pos], buffer, size);
+    _pos += size;
+    return size;
+}
+
+int32_t MemoryStream::WriteByte(uint8_t b)
+{
+    if (_pos == _data.size())
+        _data.push_back(b);
+    else
+        _data[_pos] = b;
+    _pos++;
+    return b;
+}
+
+soff_t MemoryStream::Seek(soff_t offset, StreamSeek origin)
+{
+    soff_t new_pos;
+    switch (origin)
+    {
+    case kSeekBegin:    new_pos = offset; break;
+    case kSeekCurrent:  new_pos = (soff_t)_pos + offset; break;
+    case kSeekEnd:      new_pos = (soff_t)_data.size() + offset; break;
+    default:
+        return -1;
+    }
+    if (new_pos < 0)
+        new_pos = 0;
+    else if (new_pos > (soff_t)_data.size())
+        new_pos = (soff_t)_data.size();
+    _pos = (size_t)new_pos;
+    return new_pos;
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,71 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Stream over the growing memory buffer, for preparing data which is written
+// elsewhere later, or for reading such data back.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__MEMORYSTREAM_H
+#define __AGS_CN_UTIL__MEMORYSTREAM_H
+
+#include <vector>
+#include "util/datastream.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+class MemoryStream : public DataStream
+{
+public:
+    // Creates the stream positioned at the beginning of the given data
+    explicit MemoryStream(std::vector<uint8_t> data = std::vector<uint8_t>(),
+        DataEndianess stream_endianess = kLittleEndian);
+    virtual ~MemoryStream();
+
+    virtual void    Close();
+    virtual bool    Flush();
+
+    // Is stream valid (underlying data initialized properly)
+    virtual bool    IsValid() const;
+    // Is end of stream
+    virtual bool    EOS() const;
+    // Total length of stream (if known)
+    virtual soff_t  GetLength() const;
+    // Current position (if known)
+    virtual soff_t  GetPosition() const;
+    virtual bool    CanRead() const;
+    virtual bool    CanWrite() const;
+    virtual bool    CanSeek() const;
+
+    virtual size_t  Read(void *buffer, size_t size);
+    virtual int32_t ReadByte();
+    virtual size_t  Write(const void *buffer, size_t size);
+    virtual int32_t WriteByte(uint8_t b);
+
+    virtual soff_t  Seek(soff_t offset, StreamSeek origin);
+
+    // Gives access to the stream data
+    std::vector<uint8_t> &GetBuffer() { return _data; }
+
+private:
+    std::vector<uint8_t> _data;
+    size_t               _pos;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__MEMORYSTREAM_H
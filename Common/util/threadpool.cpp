@@ -0,0 +1,106 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <algorithm>
+#include "util/threadpool.h"
+
+namespace AGS
+{
+namespace Common
+{
+
+ThreadPool::ThreadPool(int thread_count)
+    : _task(NULL)
+    , _count(0)
+    , _next(0)
+    , _batch(0)
+    , _active(0)
+    , _exit(false)
+{
+    if (thread_count <= 0)
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    // the calling thread is one of the workers
+    for (int i = 1; i < thread_count; ++i)
+        _threads.push_back(std::thread(&ThreadPool::Run, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _exit = true;
+    }
+    _wake.notify_all();
+    for (size_t i = 0; i < _threads.size(); ++i)
+        _threads[i].join();
+}
+
+int ThreadPool::GetThreadCount() const
+{
+    return (int)_threads.size() + 1;
+}
+
+void ThreadPool::RunForEach(size_t count, const Task &task)
+{
+    if (_threads.empty() || count < 2)
+    {
+        for (size_t i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _task = &task;
+        _count = count;
+        _next = 0;
+        _batch++;
+    }
+    _wake.notify_all();
+
+    for (size_t i = _next++; i < count; i = _next++)
+        task(i);
+
+    // stop workers from joining this batch, and wait for the ones which did
+    std::unique_lock<std::mutex> lock(_mutex);
+    _task = NULL;
+    _done.wait(lock, [this]() { return _active == 0; });
+}
+
+void ThreadPool::Run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    unsigned seen_batch = _batch;
+    for (;;)
+    {
+        _wake.wait(lock, [this, &seen_batch]() { return _exit || (_task && _batch != seen_batch); });
+        if (_exit)
+            return;
+        seen_batch = _batch;
+        const Task &task = *_task;
+        const size_t count = _count;
+        _active++;
+        lock.unlock();
+
+        for (size_t i = _next++; i < count; i = _next++)
+            task(i);
+
+        lock.lock();
+        if (--_active == 0)
+            _done.notify_all();
+    }
+}
+
+} // namespace Common
+} // namespace AGS
@@ -0,0 +1,74 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Fixed set of worker threads, which run the same task for a range of
+// indexes. The calling thread takes part in the work and is blocked until
+// all of it is done, so the pool is suitable for splitting data processing
+// between several CPU cores, but not for the background jobs.
+//
+// The pool may only be used from one thread at a time.
+//
+//=============================================================================
+#ifndef __AGS_CN_UTIL__THREADPOOL_H
+#define __AGS_CN_UTIL__THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AGS
+{
+namespace Common
+{
+
+class ThreadPool
+{
+public:
+    typedef std::function<void(size_t)> Task;
+
+    // Creates the pool which runs tasks on the given number of threads in
+    // total, including the calling one; 0 means as many as there are CPU cores
+    explicit ThreadPool(int thread_count);
+    ~ThreadPool();
+
+    // Number of threads which run the tasks, including the calling one
+    int  GetThreadCount() const;
+    // Runs the task for every index in [0; count) and returns when all are
+    // done. Indexes are handed out to the threads in no particular order,
+    // so the task should only modify the data belonging to its index.
+    void RunForEach(size_t count, const Task &task);
+
+private:
+    // Worker thread's loop
+    void Run();
+
+    std::vector<std::thread> _threads;
+    std::mutex              _mutex;
+    std::condition_variable _wake;   // signals workers about the new batch
+    std::condition_variable _done;   // signals caller that workers finished
+    const Task             *_task;   // task of the current batch, or NULL
+    size_t                  _count;  // number of indexes in current batch
+    std::atomic<size_t>     _next;   // next index to run
+    unsigned                _batch;  // batch counter
+    int                     _active; // workers running current batch
+    bool                    _exit;
+};
+
+} // namespace Common
+} // namespace AGS
+
+#endif // __AGS_CN_UTIL__THREADPOOL_H
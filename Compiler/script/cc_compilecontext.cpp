@@ -0,0 +1,50 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <utility>
+#include "cc_compilecontext.h"
+
+using namespace AGS::Common;
+
+// Returns full script error message and callstack (if possible)
+extern std::pair<String, String> cc_error_at_line(const char *error_msg);
+// Returns script error message without location or callstack
+extern String cc_error_without_line(const char *error_msg);
+
+thread_local ccCompileContext ccCompile;
+
+void cc_compile_error(const char *descr, ...)
+{
+    // there are no user errors at compile time
+    if (descr[0] == '!')
+        descr++;
+
+    char displbuf[1000];
+    va_list ap;
+
+    va_start(ap, descr);
+    vsprintf(displbuf, descr, ap);
+    va_end(ap);
+
+    // [IKM] Implementation is project-specific
+    if (ccCompile.currentline > 0)
+        ccCompile.errorString = cc_error_at_line(displbuf).first;
+    else
+        ccCompile.errorString = cc_error_without_line(displbuf);
+
+    ccCompile.error = 1;
+    ccCompile.errorLine = ccCompile.currentline;
+}
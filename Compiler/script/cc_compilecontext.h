@@ -0,0 +1,44 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// 'C'-style script compiler
+//
+// Line and error state of the compilation running on the current thread.
+// The compiler keeps it apart from the engine's ccError and currentline,
+// so that several scripts may be compiled at once; ccCompileText copies the
+// error details to ccError and the rest when it returns.
+//
+//=============================================================================
+
+#ifndef __CC_COMPILECONTEXT_H
+#define __CC_COMPILECONTEXT_H
+
+#include "util/string.h"
+
+struct ccCompileContext {
+    int  currentline;       // line being compiled
+    int  error;             // set to non-zero if error occurs
+    int  errorLine;         // line number of the error
+    AGS::Common::String errorString; // description of the error
+    const char *scriptName; // name of currently compiling script
+
+    ccCompileContext() : currentline(0), error(0), errorLine(0), scriptName("") {}
+};
+
+extern thread_local ccCompileContext ccCompile;
+
+// reports compilation error on the current thread
+extern void cc_compile_error(const char *, ...);
+
+#endif // __CC_COMPILECONTEXT_H
@@ -6,7 +6,7 @@
 #include "script/script_common.h"       // macro definitions
 #include "cc_symboltable.h"     // symbolTable
 #include "script/cc_options.h"      // ccGetOption
-#include "script/cc_error.h"
+#include "cc_compilecontext.h"
 
 void ccCompiledScript::write_cmd(int cmdd) {
     write_code(cmdd);
@@ -43,6 +43,26 @@ ccCompiledScript::ccCompiledScript() {
     ax_val_type = 0;
     ax_val_scope = 0;
 }
+// copies the script compiled so far, which may then be continued
+ccCompiledScript::ccCompiledScript(const ccCompiledScript &src)
+    : ccScript(src) {
+    codeallocated = codesize;
+    // imports are allocated with room for the parameter count suffix
+    for (int aa = 0; aa < numimports; aa++) {
+        imports[aa] = (char*)realloc(imports[aa], strlen(imports[aa]) + 12);
+    }
+    for (int aa = 0; aa < src.numfunctions; aa++) {
+        functions[aa] = (char*)malloc(strlen(src.functions[aa]) + 20);
+        strcpy(functions[aa], src.functions[aa]);
+        funccodeoffs[aa] = src.funccodeoffs[aa];
+        funcnumparams[aa] = src.funcnumparams[aa];
+    }
+    numfunctions = src.numfunctions;
+    cur_sp = src.cur_sp;
+    next_line = src.next_line;
+    ax_val_type = src.ax_val_type;
+    ax_val_scope = src.ax_val_scope;
+}
 ccCompiledScript::~ccCompiledScript() {
     shutdown();
 }
@@ -126,12 +146,12 @@ int ccCompiledScript::remove_any_import (const char*namm, SymbolDef *oldSym) {
         return 0;
     // if this import has been referenced, flag an error
     if (sym.entries[sidx].flags & SFLG_ACCESSED) {
-        cc_error("Already referenced name as import; you must define it before using it");
+        cc_compile_error("Already referenced name as import; you must define it before using it");
         return -1;
     }
     // if they set the No Override Imports flag, don't allow it
     if (ccGetOption(SCOPT_NOIMPORTOVERRIDE)) {
-        cc_error("Variable '%s' is already imported", namm);
+        cc_compile_error("Variable '%s' is already imported", namm);
         return -1;
     }
 
@@ -193,7 +213,7 @@ int ccCompiledScript::add_new_export(const char*namm,int etype,long eoffs, int n
         export_addr = (int32_t*)realloc(export_addr, sizeof(int32_t) * exportsCapacity);
     }
     if (eoffs >= 0x00ffffff) {
-        cc_error("export offset too high; script data size too large?");
+        cc_compile_error("export offset too high; script data size too large?");
         return -1;
     }
     char *newName = (char*)malloc(strlen(namm)+20);
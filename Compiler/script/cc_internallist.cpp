@@ -1,8 +1,7 @@
 
 #include <stdlib.h>
 #include "cc_internallist.h"
-
-extern int currentline;  // in script_common
+#include "cc_compilecontext.h"
 
 void ccInternalList::startread() {
     pos=0;
@@ -31,11 +30,11 @@ long ccInternalList::getnext() {
 		long bytesRemaining = length - pos;
 		if (bytesRemaining >= 3) {
 			if (script[pos+1] == SMETA_LINENUM) {
-				currentline = script[pos+2];
+				ccCompile.currentline = script[pos+2];
 			} else if (script[pos+1] == SMETA_END) {
-				lineAtEnd = currentline;
+				lineAtEnd = ccCompile.currentline;
 				if (cancelCurrentLine) {
-					currentline = -10;
+					ccCompile.currentline = -10;
 				}
                 // TODO DEFECT?: If we break, we return SCODE_META *and* increase pos, so next getnext will return SMETA_END.
 				break;
@@ -45,7 +44,7 @@ long ccInternalList::getnext() {
     }
     if (pos >= length) {
 		if (cancelCurrentLine) {
-            currentline = -10;
+            ccCompile.currentline = -10;
 		}
         return SCODE_INVALID;
     }
@@ -1,56 +1,52 @@
-
 #include <stdlib.h>
 #include <string.h>
 #include "cc_macrotable.h"
-#include "script/cc_error.h"
+#include "cc_compilecontext.h"
 
+void MacroTable::init() {
+    names.clear();
+    definitions.clear();
+    macroOffs.clear();
+}
 void MacroTable::shutdown() {
-    int rr;
-    for (rr=0;rr<num;rr++) {
-        free(macro[rr]);
-        free(name[rr]);
-        macro[rr]=NULL;
-        name[rr]=NULL;
-    }
-    num = 0;
+    init();
 }
 void MacroTable::merge(MacroTable *others) {
 
-    for (int aa = 0; aa < others->num; aa++) {
-        this->add(others->name[aa], others->macro[aa]);
+    for (int aa = 0; aa < others->get_count(); aa++) {
+        if (others->macroOffs[aa] >= 0)
+            this->add(others->get_name(aa), others->get_macro(aa));
     }
 
 }
-int MacroTable::find_name(char* namm) {
-    int ss;
-    for (ss=0;ss<num;ss++) {
-        if (strcmp(namm,name[ss])==0) return ss;
-    }
-    return -1;
+int MacroTable::find_name(const char* namm) {
+    int ss = names.find(namm);
+    if ((ss < 0) || (macroOffs[ss] < 0)) return -1;
+    return ss;
 }
-void MacroTable::add(char*namm,char*mac) {
+const char *MacroTable::get_macro(int index) const {
+    if (macroOffs[index] < 0) return "";
+    return &definitions[macroOffs[index]];
+}
+void MacroTable::add(const char*namm,const char*mac) {
     if (find_name(namm) >= 0) {
-        cc_error("macro '%s' already defined",namm);
-        return;
-    }
-    if (num>=MAXDEFINES) {
-        cc_error("too many macros defined");
+        cc_compile_error("macro '%s' already defined",namm);
         return;
     }
-    name[num]=(char*)malloc(strlen(namm)+5);
-    strcpy(name[num],namm);
-    macro[num]=(char*)malloc(strlen(mac)+5);
-    strcpy(macro[num],mac);
-    num++;
+    // a removed macro gets its old slot back
+    int ss = names.add(namm);
+    if (ss >= (int)macroOffs.size())
+        macroOffs.resize(ss + 1);
+    macroOffs[ss] = (int)definitions.size();
+    definitions.insert(definitions.end(), mac, mac + strlen(mac) + 1);
 }
 void MacroTable::remove(int index) {
-    if ((index < 0) || (index >= num)) {
-        cc_error("MacroTable::Remove: index out of range");
+    if ((index < 0) || (index >= get_count())) {
+        cc_compile_error("MacroTable::Remove: index out of range");
         return;
     }
-    // just blank out the entry, don't bother to remove it
-    name[index][0] = 0;
-    macro[index][0] = 0;
+    // just mark the entry removed, its name stays interned
+    macroOffs[index] = -1;
 }
 
-MacroTable macros;
\ No newline at end of file
+thread_local MacroTable macros;
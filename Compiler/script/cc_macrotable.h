@@ -1,26 +1,39 @@
 #ifndef __CC_MACROTABLE_H
 #define __CC_MACROTABLE_H
 
+#include <vector>
+#include "cc_nametable.h"
+
 #define MAX_LINE_LENGTH 500
-#define MAXDEFINES 1500
+
+// Macro names are interned in a hash table, and the definitions are stored
+// one after another in a single buffer; there is no limit on their number
 struct MacroTable {
-    int num;
-    char*name[MAXDEFINES];
-    char*macro[MAXDEFINES];
-    void init() {
-        num=0; }
+    void init();
     void shutdown();
-    int  find_name(char*);
-    void add(char*,char*);
+    int  find_name(const char*);
+    void add(const char*,const char*);
     void remove(int index);
     void merge(MacroTable *);
 
+    // number of macro slots, including removed ones
+    int  get_count() const { return names.get_count(); }
+    const char *get_name(int index) const { return names.get(index); }
+    const char *get_macro(int index) const;
+
     MacroTable() {
         init();
     }
+
+private:
+    ccNameTable names;
+    std::vector<char> definitions;
+    // offset of the definition for each name index, -1 if it was removed
+    std::vector<int> macroOffs;
 };
 
 
-extern MacroTable macros;
+// macros of the script being compiled by the current thread
+extern thread_local MacroTable macros;
 
-#endif // __CC_MACROTABLE_H
\ No newline at end of file
+#endif // __CC_MACROTABLE_H
@@ -0,0 +1,79 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include <algorithm>
+#include "cc_nametable.h"
+#include "util/string_types.h"
+
+// Initial number of slots; the table grows when it gets half full
+static const size_t MIN_SLOT_COUNT = 256;
+
+ccNameTable::ccNameTable() {
+}
+
+int ccNameTable::find(const char *name) const {
+    if (entries.empty())
+        return -1;
+    const uint32_t index = slots[find_slot(name, (uint32_t)FNV::Hash(name, strlen(name)))];
+    return (int)index - 1;
+}
+
+int ccNameTable::add(const char *name) {
+    if (slots.size() < (entries.size() + 1) * 2)
+        rehash(std::max(MIN_SLOT_COUNT, slots.size() * 2));
+
+    const size_t len = strlen(name);
+    const uint32_t hash = (uint32_t)FNV::Hash(name, len);
+    const size_t slot = find_slot(name, hash);
+    if (slots[slot] != 0)
+        return slots[slot] - 1;
+
+    Entry entry;
+    entry.hash = hash;
+    entry.name = (uint32_t)strings.size();
+    strings.insert(strings.end(), name, name + len + 1);
+    entries.push_back(entry);
+    slots[slot] = (uint32_t)entries.size();
+    return (int)entries.size() - 1;
+}
+
+void ccNameTable::clear() {
+    strings.clear();
+    entries.clear();
+    slots.clear();
+}
+
+size_t ccNameTable::find_slot(const char *name, uint32_t hash) const {
+    const size_t mask = slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        const uint32_t index = slots[slot];
+        if (index == 0)
+            return slot;
+        const Entry &entry = entries[index - 1];
+        if ((entry.hash == hash) && (strcmp(&strings[entry.name], name) == 0))
+            return slot;
+    }
+}
+
+void ccNameTable::rehash(size_t slot_count) {
+    slots.assign(slot_count, 0);
+    const size_t mask = slot_count - 1;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        size_t slot = entries[i].hash & mask;
+        while (slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        slots[slot] = (uint32_t)(i + 1);
+    }
+}
@@ -0,0 +1,63 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// 'C'-style script compiler
+//
+// Table of interned names. Every distinct name is stored once, one after
+// another in a single buffer, and gets a sequential index. An open addressing
+// table keeps the indexes along with the hashes of the names, so that a lookup
+// hashes the name once and only compares the names whose hashes are equal.
+// Since names are kept as offsets, the table may be copied as a whole.
+//
+//=============================================================================
+
+#ifndef __CC_NAMETABLE_H
+#define __CC_NAMETABLE_H
+
+#include <vector>
+#include "core/types.h"
+
+struct ccNameTable {
+    ccNameTable();
+
+    // returns index of the name, or -1 if it's not in the table
+    int  find(const char *name) const;
+    // returns index of the name, adding it to the table if it's not there
+    int  add(const char *name);
+    // returns name at the index; valid until the table is changed
+    const char *get(int index) const { return &strings[entries[index].name]; }
+    // returns number of names in the table
+    int  get_count() const { return (int)entries.size(); }
+    // removes all names
+    void clear();
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t name; // offset in the string buffer
+    };
+
+    // returns the slot which holds the name, or the empty one where it belongs
+    size_t find_slot(const char *name, uint32_t hash) const;
+    // resizes the slot table and puts all entries to it anew
+    void   rehash(size_t slot_count);
+
+    std::vector<char>     strings;
+    std::vector<Entry>    entries;
+    // open addressing table of entry indexes plus one, 0 marks empty slot;
+    // the number of slots is a power of two
+    std::vector<uint32_t> slots;
+};
+
+#endif // __CC_NAMETABLE_H
@@ -10,6 +10,36 @@ symbolTable::symbolTable() {
 	stringStructSym = 0;
 }
 
+symbolTable::symbolTable(const symbolTable &src) {
+	*this = src;
+}
+
+symbolTable::~symbolTable() {
+	clear_name_cache();
+}
+
+// copies the symbols; the generated names are not shared between tables
+symbolTable &symbolTable::operator=(const symbolTable &src) {
+	if (this == &src) { return *this; }
+	clear_name_cache();
+	normalIntSym = src.normalIntSym;
+	normalStringSym = src.normalStringSym;
+	normalFloatSym = src.normalFloatSym;
+	normalVoidSym = src.normalVoidSym;
+	nullSym = src.nullSym;
+	stringStructSym = src.stringStructSym;
+	entries = src.entries;
+	symbolTree = src.symbolTree;
+	return *this;
+}
+
+void symbolTable::clear_name_cache() {
+	for (std::map<int, char*>::iterator it = nameGenCache.begin(); it != nameGenCache.end(); ++it) {
+		free(it->second);
+	}
+	nameGenCache.clear();
+}
+
 int SymbolTableEntry::get_num_args() {
 	// TODO: assert is func?
     return sscope % 100;
@@ -47,10 +77,7 @@ int SymbolTableEntry::get_propset() {
 }
 
 void symbolTable::reset() {
-	for (std::map<int, char*>::iterator it = nameGenCache.begin(); it != nameGenCache.end(); ++it) {
-		free(it->second);
-	}
-	nameGenCache.clear();
+	clear_name_cache();
 
 	entries.clear();
 
@@ -244,4 +271,4 @@ int symbolTable::add_operator(const char *nta, int priority, int vcpucmd) {
     return nss;
 }
 
-symbolTable sym;
+thread_local symbolTable sym;
@@ -14,24 +14,24 @@
 
 #include "cc_treemap.h"
 
-int ccTreeMap::findValue(const char *key) {
-	if (!key || strlen(key) <= 0) { return -1; }
-    std::string cppkey(key);
-    if (this->storage.count(cppkey) <= 0) { return -1; }
-    return this->storage[cppkey];
+int ccTreeMap::findValue(const char *key) const {
+    if (!key || key[0] == 0) { return -1; }
+    int index = names.find(key);
+    if (index < 0) { return -1; }
+    return values[index];
 }
 
 void ccTreeMap::addEntry(const char* ntx, int p_value) {
-    // don't add if it's an empty string or if it's already here
-    if (!ntx || strlen(ntx) <= 0) { return; }
+    // don't add if it's an empty string
+    if (!ntx || ntx[0] == 0) { return; }
 
-    this->storage[std::string(ntx)] = p_value;
+    int index = names.add(ntx);
+    if (index >= (int)values.size())
+        values.resize(index + 1);
+    values[index] = p_value;
 }
 
 void ccTreeMap::clear() {
-    this->storage.clear();
+    names.clear();
+    values.clear();
 }
-
-ccTreeMap::~ccTreeMap() {
-    this->storage.clear();
-}
\ No newline at end of file
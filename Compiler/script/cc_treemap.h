@@ -19,18 +19,18 @@
 #ifndef __CC_TREEMAP_H
 #define __CC_TREEMAP_H
 
-#include <map>
-#include <string>
+#include <vector>
+#include "cc_nametable.h"
 
-// Mimics original interface but uses a std::map for storage
+// Mimics original interface but uses a hash table of interned names
 struct ccTreeMap {
-    int findValue(const char *key);
+    int findValue(const char *key) const;
     void addEntry(const char *ntx, int p_value);
     void clear();
-    ~ccTreeMap();
 
 private:
-    std::map<std::string, int> storage;
+    ccNameTable names;
+    std::vector<int> values; // value for each name index
 };
 
-#endif // __CC_TREEMAP_H
\ No newline at end of file
+#endif // __CC_TREEMAP_H
@@ -2,13 +2,19 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 #include "cs_compiler.h"
 #include "cc_macrotable.h"
 #include "cc_compiledscript.h"
 #include "cc_symboltable.h"
+#include "cc_compilecontext.h"
 #include "script/cc_error.h"
 #include "script/cc_options.h"
 #include "script/script_common.h"
+#include "util/threadpool.h"
 
 #include "cs_prepro.h"
 #include "cs_parser.h"
@@ -22,6 +28,100 @@ static int capacityHeaders=0;
 
 MacroTable predefinedMacros;
 
+extern int ccCompOptions;
+
+// The result of compiling the default headers: symbols and the compiled
+// script they were compiled into. Every script is compiled with the same
+// headers, so this is reused for as long as the headers and compiler
+// options stay the same, instead of compiling them for each script.
+// Once made it is only read, so several threads may copy it at once.
+struct PrecompiledHeaders {
+    std::vector<std::string> texts;
+    std::vector<std::string> names;
+    int options;
+    symbolTable symbols;
+    ccCompiledScript *script;
+
+    PrecompiledHeaders() : options(0), script(NULL) {}
+    ~PrecompiledHeaders() { delete script; }
+
+    bool matches_default_headers();
+};
+
+static std::shared_ptr<PrecompiledHeaders> precompiledHeaders;
+static std::mutex precompiledHeadersLock;
+
+static const char *get_default_header_name(int index) {
+    if (defaultHeaderNames[index] != NULL)
+        return defaultHeaderNames[index];
+    return "Internal header file";
+}
+
+bool PrecompiledHeaders::matches_default_headers() {
+    if ((options != ccCompOptions) || (texts.size() != numheaders))
+        return false;
+    for (int t = 0; t < numheaders; t++) {
+        if ((texts[t] != defaultheaders[t]) || (names[t] != get_default_header_name(t)))
+            return false;
+    }
+    return true;
+}
+
+void ccResetPrecompiledHeaders() {
+    std::lock_guard<std::mutex> lock(precompiledHeadersLock);
+    precompiledHeaders.reset();
+}
+
+// Compiles the default headers into the new script and saves the result
+// for the next scripts; returns NULL on failure
+static ccCompiledScript *precompile_default_headers() {
+    ccCompiledScript *cctemp = new ccCompiledScript();
+    cctemp->init();
+    sym.reset();
+
+    for (int t=0;t<numheaders;t++) {
+        ccCompile.scriptName = get_default_header_name(t);
+        cctemp->start_new_section(ccCompile.scriptName);
+        cc_compile(defaultheaders[t],cctemp);
+        if (ccCompile.error) {
+            cctemp->shutdown();
+            delete cctemp;
+            return NULL;
+        }
+    }
+
+    std::shared_ptr<PrecompiledHeaders> headers(new PrecompiledHeaders());
+    for (int t=0;t<numheaders;t++) {
+        headers->texts.push_back(defaultheaders[t]);
+        headers->names.push_back(get_default_header_name(t));
+    }
+    headers->options = ccCompOptions;
+    headers->symbols = sym;
+    headers->script = new ccCompiledScript(*cctemp);
+    precompiledHeaders = headers;
+    return cctemp;
+}
+
+// Compiles the default headers into the new script, or copies the result
+// of compiling them before; returns NULL on failure
+static ccCompiledScript *compile_default_headers() {
+    std::shared_ptr<PrecompiledHeaders> headers;
+    {
+        // threads which need the headers at the same time wait for the
+        // first one to compile them, and then copy its result
+        std::lock_guard<std::mutex> lock(precompiledHeadersLock);
+        if (!precompiledHeaders || !precompiledHeaders->matches_default_headers()) {
+            precompiledHeaders.reset();
+            return precompile_default_headers();
+        }
+        headers = precompiledHeaders;
+    }
+    sym = headers->symbols;
+    if (numheaders > 0)
+        ccCompile.scriptName = get_default_header_name(numheaders - 1);
+    return new ccCompiledScript(*headers->script);
+}
+
 int ccAddDefaultHeader(char* nhead, char *nName)
 {
     if (numheaders >= capacityHeaders)
@@ -54,39 +154,31 @@ void ccSetSoftwareVersion(const char *versionNumber) {
     ccSoftwareVersion = versionNumber;
 }
 
-ccScript* ccCompileText(const char *texo, const char *scriptName) {
+// Compiles the script into ccCompile's state only, so that it may run
+// on any thread
+static ccScript *compile_text(const char *texo, const char *scriptName) {
     int t;
-    ccCompiledScript *cctemp = new ccCompiledScript();
-    cctemp->init();
 
-    sym.reset();
     preproc_startup(&predefinedMacros);
 
     if (scriptName == NULL)
         scriptName = "Main script";
 
-    ccError = 0;
-    ccErrorLine = 0;
-
-    for (t=0;t<numheaders;t++) {
-        if (defaultHeaderNames[t] != NULL)
-            ccCurScriptName = defaultHeaderNames[t];
-        else
-            ccCurScriptName = "Internal header file";
+    ccCompile.error = 0;
+    ccCompile.errorLine = 0;
 
-        cctemp->start_new_section(ccCurScriptName);
-        cc_compile(defaultheaders[t],cctemp);
-        if (ccError) break;
+    ccCompiledScript *cctemp = compile_default_headers();
+    if (cctemp == NULL) {
+        preproc_shutdown();
+        return NULL;
     }
 
-    if (!ccError) {
-        ccCurScriptName = scriptName;
-        cctemp->start_new_section(ccCurScriptName);
-        cc_compile(texo,cctemp);
-    }
+    ccCompile.scriptName = scriptName;
+    cctemp->start_new_section(ccCompile.scriptName);
+    cc_compile(texo,cctemp);
     preproc_shutdown();
 
-    if (ccError) {
+    if (ccCompile.error) {
         cctemp->shutdown();
         delete cctemp;
         return NULL;
@@ -138,3 +230,47 @@ ccScript* ccCompileText(const char *texo, const char *scriptName) {
     cctemp->free_extra();
     return cctemp;
 }
+
+// Name of the script reported in ccCurScriptName; a copy, as the name
+// may belong to the caller's compile task which is freed afterwards
+static thread_local AGS::Common::String reportedScriptName;
+
+ccScript* ccCompileText(const char *texo, const char *scriptName) {
+    ccScript *compiled = compile_text(texo, scriptName);
+    ccError = ccCompile.error;
+    ccErrorLine = ccCompile.errorLine;
+    ccErrorString = ccCompile.errorString;
+    reportedScriptName = ccCompile.scriptName;
+    ccCurScriptName = reportedScriptName.GetCStr();
+    return compiled;
+}
+
+// compiles one script of the batch, on any thread
+static void compile_task(ccCompileTask *task) {
+    task->compiled = compile_text(task->script, task->scriptName);
+    if (task->compiled == NULL) {
+        task->errorLine = ccCompile.errorLine;
+        task->errorScriptName = ccCompile.scriptName;
+        task->errorString = ccCompile.errorString;
+    }
+}
+
+int ccCompileTexts(ccCompileTask *tasks, int count, int threadCount) {
+    AGS::Common::ThreadPool pool(threadCount);
+    pool.RunForEach(count, [tasks](size_t index) { compile_task(&tasks[index]); });
+
+    // report the first script that failed, no matter which one failed first
+    ccError = 0;
+    ccErrorLine = 0;
+    for (int t = 0; t < count; t++) {
+        if (tasks[t].compiled == NULL) {
+            ccError = 1;
+            ccErrorLine = tasks[t].errorLine;
+            ccErrorString = tasks[t].errorString;
+            reportedScriptName = tasks[t].errorScriptName;
+            ccCurScriptName = reportedScriptName.GetCStr();
+            return t;
+        }
+    }
+    return -1;
+}
@@ -14,6 +14,7 @@
 #define __CS_COMPILER_H
 
 #include "script/cc_script.h"  // ccScript
+#include "util/string.h"
 
 // ********* SCRIPT COMPILATION FUNCTIONS **************
 // add a script that will be compiled as a header into every compilation
@@ -22,6 +23,9 @@
 extern int ccAddDefaultHeader(char *script, char *name);
 // don't compile any headers into the compilation
 extern void ccRemoveDefaultHeaders(void);
+// forget the result of compiling the headers; they are compiled only once
+// and reused for as long as the headers and options stay the same
+extern void ccResetPrecompiledHeaders(void);
 
 // define a macro which will affect all compilations
 extern void ccDefineMacro(const char *macro, const char *definition);
@@ -34,6 +38,26 @@ extern void ccSetSoftwareVersion(const char *version);
 // compile the script supplied, returns NULL on failure
 extern ccScript *ccCompileText(const char *script, const char *scriptName);
 
+// a script to compile with ccCompileTexts, and the result of compiling it
+struct ccCompileTask {
+    const char *script;
+    const char *scriptName;
+    ccScript   *compiled;     // NULL on failure
+    // error details, if compilation failed
+    int         errorLine;
+    AGS::Common::String errorScriptName;
+    AGS::Common::String errorString;
+
+    ccCompileTask() : script(NULL), scriptName(NULL), compiled(NULL), errorLine(0) {}
+};
+
+// compile several scripts at once on the given number of threads, 0 meaning
+// as many as there are CPU cores; the headers, macros and options must not
+// change until it returns. Every script is compiled even if some fail.
+// Returns the index of the first failed script in the array, or -1, and sets
+// ccError and the other error details same as ccCompileText would for it.
+extern int ccCompileTexts(ccCompileTask *tasks, int count, int threadCount);
+
 extern const char *ccSoftwareVersion;
 
 #endif // __CS_COMPILER_H
\ No newline at end of file
@@ -10,15 +10,13 @@
 #include "cc_symboltable.h"
 #include "script/cc_options.h"
 #include "script/script_common.h"
-#include "script/cc_error.h"
+#include "cc_compilecontext.h"
 #include "cc_variablesymlist.h"
 
 #include "fmem.h"
 
-extern int currentline;
-
 char ccCopyright[]="ScriptCompiler32 v" SCOM_VERSIONSTR " (c) 2000-2007 Chris Jones and 2011-2014 others";
-static char scriptNameBuffer[256];
+static thread_local char scriptNameBuffer[256];
 
 int  evaluate_expression(ccInternalList*,ccCompiledScript*,int,bool insideBracketedDeclaration);
 int  evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expectCloseBracket, int cursym, long lilen, long *vnlist, bool insideBracketedDeclaration);
@@ -70,8 +68,8 @@ void clear_chunk_list(std::vector<ccChunk> *list) {
 
 int is_part_of_symbol(char thischar, char startchar) {
     // workaround for strings
-    static int sayno_next_char = 0;
-    static int next_is_escaped = 0;
+    static thread_local int sayno_next_char = 0;
+    static thread_local int next_is_escaped = 0;
     if (sayno_next_char) {
         sayno_next_char = 0;
         return 0;
@@ -128,7 +126,7 @@ int is_part_of_symbol(char thischar, char startchar) {
     return 0;
 }
 
-char constructedMemberName[MAX_SYM_LEN];
+thread_local char constructedMemberName[MAX_SYM_LEN];
 const char *get_member_full_name(int structSym, int memberSym) {
 
     const char* memberName = sym.get_name(memberSym);
@@ -173,7 +171,7 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
             linenum++;
             targ->write_meta(SMETA_LINENUM,linenum);
             if (fmem_peekc(iii) =='\n') fmem_getc(iii);
-            currentline=linenum;
+            ccCompile.currentline=linenum;
             // go back and get the whitespace after the CRLF
             continue;
         }
@@ -194,7 +192,7 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
             sprintf(thissymbol,"%d",thissymbol[1]);
         }
         else if (thissymbol[0] == '\'') {
-            cc_error("incorrectly terminated character constant");
+            cc_compile_error("incorrectly terminated character constant");
             return -1;
         }
 
@@ -208,7 +206,7 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
 
         int towrite = sym_find_or_add(sym, thissymbol);
         if (towrite < 0) {
-            cc_error("symbol table overflow - could not ensure new symbol.");
+            cc_compile_error("symbol table overflow - could not ensure new symbol.");
             return -1;
         }
         if ((thissymbol[0] >= '0') && (thissymbol[0] <= '9')) {
@@ -273,7 +271,7 @@ int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip) {
                         //      printf("changed '%s' to '%s'\n",sym.get_friendly_name(towrite).c_str(),new_name);
                         towrite = sym_find_or_add(sym, new_name);
                         if (towrite < 0) {
-                            cc_error("symbol table error - could not ensure new struct symbol.");
+                            cc_compile_error("symbol table error - could not ensure new struct symbol.");
                             return -1;
                         }
                 }
@@ -461,18 +459,18 @@ int deal_with_end_of_do (long *nested_info, long *nested_start, ccCompiledScript
     nested_level = nestlevel[0];
     scrip->flush_line_numbers();
     if (sym.get_type(cursym) != SYM_WHILE) {
-        cc_error("Do without while");
+        cc_compile_error("Do without while");
         return -1;
     }
     if (sym.get_type(targ->peeknext()) != SYM_OPENPARENTHESIS) {
-        cc_error("expected '('");
+        cc_compile_error("expected '('");
         return -1;
     }
     scrip->flush_line_numbers();
     if (evaluate_expression(targ, scrip, 1, false))
         return -1;
     if (sym.get_type(targ->peeknext()) != SYM_SEMICOLON) {
-        cc_error("expected ';'");
+        cc_compile_error("expected ';'");
         return -1;
     }
     targ->getnext();
@@ -531,11 +529,11 @@ int find_member_sym(int structSym, long *memSym, int allowProtected) {
             // the inherited member was not found, so fall through to
             // the error message
         }
-        cc_error("'%s' is not a public member of '%s'. Are you sure you spelt it correctly (remember, capital letters are important)?",sym.get_friendly_name(*memSym).c_str(),sym.get_friendly_name(structSym).c_str());
+        cc_compile_error("'%s' is not a public member of '%s'. Are you sure you spelt it correctly (remember, capital letters are important)?",sym.get_friendly_name(*memSym).c_str(),sym.get_friendly_name(structSym).c_str());
         return -1;
     }
     if ((!allowProtected) && (sym.entries[oriname].flags & SFLG_PROTECTED)) {
-        cc_error("Cannot access protected member '%s'", sym.get_friendly_name(oriname).c_str());
+        cc_compile_error("Cannot access protected member '%s'", sym.get_friendly_name(oriname).c_str());
         return -1;
     }
     *memSym = oriname;
@@ -564,15 +562,15 @@ int accept_literal_or_constant_value(int fromSym, int &theValue, bool isNegative
     const long longValue = strtol(literalStrValue.c_str(), &endptr, 10);
 
     if ((longValue == LONG_MIN || longValue == LONG_MAX) && errno == ERANGE) {
-        cc_error("Could not parse integer symbol '%s' because of overflow.", friendly_int_symbol(fromSym, isNegative).c_str());
+        cc_compile_error("Could not parse integer symbol '%s' because of overflow.", friendly_int_symbol(fromSym, isNegative).c_str());
         return -1;
     }
     if (endptr[0] != 0) {
-        cc_error("Could not parse integer symbol '%s' because the whole buffer wasn't converted.", friendly_int_symbol(fromSym, isNegative).c_str());
+        cc_compile_error("Could not parse integer symbol '%s' because the whole buffer wasn't converted.", friendly_int_symbol(fromSym, isNegative).c_str());
         return -1;
     }
     if (longValue > INT_MAX || longValue < INT_MIN) {
-        cc_error("Could not parse integer symbol '%s' because of overflow.", friendly_int_symbol(fromSym, isNegative).c_str());
+        cc_compile_error("Could not parse integer symbol '%s' because of overflow.", friendly_int_symbol(fromSym, isNegative).c_str());
         return -1;
     }
 
@@ -585,7 +583,7 @@ int accept_literal_or_constant_value(int fromSym, int &theValue, bool isNegative
     }
   }
   else {
-    cc_error((char*)errorMsg);
+    cc_compile_error((char*)errorMsg);
     return -1;
   }
   return 0;
@@ -595,8 +593,8 @@ int check_not_eof(ccInternalList &targ) {
   if (targ.peeknext() == SCODE_INVALID) {
     // We are past the last symbol in the file
     targ.getnext();
-    currentline = targ.lineAtEnd;
-    cc_error("Unexpected end of file");
+    ccCompile.currentline = targ.lineAtEnd;
+    cc_compile_error("Unexpected end of file");
     return -1;
   }
   return 0;
@@ -639,16 +637,16 @@ int check_for_dynamic_array_declaration(ccInternalList &targ, int typeSym, bool
     targ.getnext();
     if (sym.get_type(targ.getnext()) != SYM_CLOSEBRACKET)
     {
-      cc_error("fixed size array cannot be used in this way");
+      cc_compile_error("fixed size array cannot be used in this way");
       return -1;
     }
     if (sym.entries[typeSym].flags & SFLG_STRUCTTYPE) {
         if (!(sym.entries[typeSym].flags & SFLG_MANAGED)) {
-            cc_error("cannot pass non-managed struct array");
+            cc_compile_error("cannot pass non-managed struct array");
             return -1;
         }
         if (!isPointer) {
-            cc_error("cannot pass non-pointer struct array");
+            cc_compile_error("cannot pass non-pointer struct array");
             return -1;
         }
     }
@@ -685,22 +683,22 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
 	  if (sym.get_type(targ.peeknext()) != SYM_VARTYPE)
 	  {
 	    if(func_is_static)
-	      cc_error("'static' must be followed by a struct name");
+	      cc_compile_error("'static' must be followed by a struct name");
 	    else
-	      cc_error("'this' must be followed by a struct name");
+	      cc_compile_error("'this' must be followed by a struct name");
 	    return -1;
 	  }
 	  if ((sym.entries[targ.peeknext()].flags & SFLG_STRUCTTYPE) == 0)
 	  {
 	    if(func_is_static)
-	      cc_error("'static' cannot be used with primitive types");
+	      cc_compile_error("'static' cannot be used with primitive types");
 	    else
-	      cc_error("'this' cannot be used with primitive types");
+	      cc_compile_error("'this' cannot be used with primitive types");
 	    return -1;
 	  }
 	  if (strchr(functionName, ':') != NULL)
 	  {
-	    cc_error("extender functions cannot be part of a struct");
+	    cc_compile_error("extender functions cannot be part of a struct");
 	    return -1;
 	  }
 
@@ -724,7 +722,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
 
 	  if (sym.entries[funcsym].stype != 0)
 	  {
-	    cc_error("function '%s' is already defined", functionName);
+	    cc_compile_error("function '%s' is already defined", functionName);
 	    return -1;
 	  }
 	  sym.entries[funcsym].flags = SFLG_STRUCTMEMBER;
@@ -735,7 +733,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
 	  targ.getnext();
 	  if (!func_is_static && strcmp(sym.get_name(targ.getnext()), "*") != 0)
 	  {
-	    cc_error("instance extender function must be pointer");
+	    cc_compile_error("instance extender function must be pointer");
 	    return -1;
 	  }
 
@@ -743,9 +741,9 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
 	      (sym.get_type(targ.peeknext()) != SYM_CLOSEPARENTHESIS))
 	  {
 	    if(strcmp(sym.get_name(targ.getnext()), "*") == 0)
-	      cc_error("static extender function cannot be pointer");
+	      cc_compile_error("static extender function cannot be pointer");
 	    else
-	      cc_error("parameter name cannot be defined for extender type");
+	      cc_compile_error("parameter name cannot be defined for extender type");
 	    return -1;
 	  }
 
@@ -767,7 +765,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
       }
       if (sym.entries[funcsym].stype != 0) 
       {
-          cc_error("function '%s' is already defined", functionName);
+          cc_compile_error("function '%s' is already defined", functionName);
           return -1;
       }
   }
@@ -788,15 +786,15 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
   if ((!returnsPointer) && (!returnsDynArray) &&
       ((sym.entries[vtwas].flags & SFLG_STRUCTTYPE) != 0))
   {
-    cc_error("Cannot return entire struct from function");
+    cc_compile_error("Cannot return entire struct from function");
     return -1;
   }
   if ((in_func >= 0) || (nested_level > 0)) {
-    cc_error("Nested functions not supported (you may have forgotten a closing brace)");
+    cc_compile_error("Nested functions not supported (you may have forgotten a closing brace)");
     return -1;
   }
   if (next_is_readonly) {
-    cc_error("readonly cannot be applied to a function");
+    cc_compile_error("readonly cannot be applied to a function");
     return -1;
   }
 
@@ -810,7 +808,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
   if (in_func < 0) {
     // don't overwrite the "used import" error message
     if (in_func != -2)
-      cc_error("Internal compiler error: table overflow");
+      cc_compile_error("Internal compiler error: table overflow");
     return -1;
   }
   sym.entries[funcsym].soffs = in_func;  // save code offset of function
@@ -828,7 +826,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
       numparams+=100;
       cursym = targ.getnext();
       if (sym.get_type(cursym) != SYM_CLOSEPARENTHESIS) {
-        cc_error("expected ')' after variable-args");
+        cc_compile_error("expected ')' after variable-args");
         return -1;
       }
       break;
@@ -839,11 +837,11 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
     else if (next_type == SYM_VARTYPE) {
       // function parameter
       if ((numparams % 100) >= MAX_FUNCTION_PARAMETERS) {
-        cc_error("too many parameters defined for function");
+        cc_compile_error("too many parameters defined for function");
         return -1;
       }
       if (cursym == sym.normalVoidSym) {
-        cc_error("'void' invalid type for function parameter");
+        cc_compile_error("'void' invalid type for function parameter");
         return -1;
       }
       int isPointerParam = 0;
@@ -866,11 +864,11 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
         targ.getnext();
         if ((sym.entries[cursym].flags & SFLG_MANAGED) == 0) {
           // can only point to managed structs
-          cc_error("Cannot declare pointer to non-managed type");
+          cc_compile_error("Cannot declare pointer to non-managed type");
           return -1;
         }
         if (sym.entries[cursym].flags & SFLG_AUTOPTR) {
-          cc_error("Invalid use of pointer");
+          cc_compile_error("Invalid use of pointer");
           return -1;
         }
       }
@@ -910,7 +908,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
         // it's a parameter
         int vartypesym = cursym;
         if ((sym.entries[cursym].flags & SFLG_STRUCTTYPE) && (!isPointerParam)) {
-          cc_error("struct cannot be passed as parameter");
+          cc_compile_error("struct cannot be passed as parameter");
           return -1;
         }
         cursym = targ.getnext();
@@ -952,11 +950,11 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
       next_type = sym.get_type(cursym=targ.getnext());
       if (next_type == SYM_CLOSEPARENTHESIS) break;
       else if (next_type == SYM_GLOBALVAR) {
-        cc_error("'%s' is a global var; cannot use as name for local",sym.get_friendly_name(cursym).c_str());
+        cc_compile_error("'%s' is a global var; cannot use as name for local",sym.get_friendly_name(cursym).c_str());
         return -1;
       }
       else if (next_type != SYM_COMMA) {
-        cc_error("PE02: Parse error at '%s'",sym.get_friendly_name(cursym).c_str());
+        cc_compile_error("PE02: Parse error at '%s'",sym.get_friendly_name(cursym).c_str());
         return -1;
       }
 
@@ -964,7 +962,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
     }
     else {
       // something odd was inside the parentheses
-      cc_error("PE03: Parse error at '%s'",sym.get_friendly_name(cursym).c_str());
+      cc_compile_error("PE03: Parse error at '%s'",sym.get_friendly_name(cursym).c_str());
       return -1;
     }
   }
@@ -995,7 +993,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
       nextvar = targ.getnext();
 
     if (sym.get_type(nextvar) != SYM_SEMICOLON) {
-      cc_error("';' expected (cannot define body of imported function)");
+      cc_compile_error("';' expected (cannot define body of imported function)");
       return -1;
     }
     in_func=-1;
@@ -1003,7 +1001,7 @@ int process_function_declaration(ccInternalList &targ, ccCompiledScript*scrip,
   else if (sym.get_type(targ.peeknext()) == SYM_OPENBRACE) {
   }
   else {
-    cc_error("Expected '{'");
+    cc_compile_error("Expected '{'");
     return -1;
   }
 
@@ -1160,7 +1158,7 @@ int check_operator_valid_for_type(int *vcpuOpPtr, int type1, int type2) {
   }
 
   if (isError) {
-    cc_error("Operator cannot be applied to this type");
+    cc_compile_error("Operator cannot be applied to this type");
     return -1;
   }
   return 0;
@@ -1257,7 +1255,7 @@ int check_type_mismatch(int typeIs, int typeWantsToBe, int orderMatters) {
         return -1;
     }
     else {
-      cc_error("Type mismatch: cannot convert '%s' to '%s'", sym.get_friendly_name(typeIsOriginally).c_str(), sym.get_friendly_name(typeWantsToBeOriginally).c_str());
+      cc_compile_error("Type mismatch: cannot convert '%s' to '%s'", sym.get_friendly_name(typeIsOriginally).c_str(), sym.get_friendly_name(typeWantsToBeOriginally).c_str());
       return -1;
     }
   }
@@ -1317,13 +1315,13 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
     if (slist[sslen] == SCODE_INVALID) {
       // this happens if they do:
       // player.Walk(oKey.-4666);
-      cc_error("dot operator must be followed by member function or property");
+      cc_compile_error("dot operator must be followed by member function or property");
       return -1;
     }
 
     if (sslen >= TEMP_SYMLIST_LENGTH - 5)
     {
-      cc_error("buffer exceeded: you probably have a missing closing bracket on a previous line");
+      cc_compile_error("buffer exceeded: you probably have a missing closing bracket on a previous line");
       return -1;
     }
 
@@ -1337,13 +1335,13 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
       else {
         reallywant = sym.entries[fsym].vartype;
         if (reallywant < 1) {
-          cc_error("structure required on left side of '.'");
+          cc_compile_error("structure required on left side of '.'");
           return -1;
         }
       }
 
       if (((sym.entries[fsym].flags & SFLG_ARRAY) != 0) && (justHadBrackets == 0)) {
-        cc_error("'[' expected");
+        cc_compile_error("'[' expected");
         return -1;
       }
       justHadBrackets = 0;
@@ -1357,11 +1355,11 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
       if (find_member_sym(reallywant, &slist[sslen], allowProtectedMembers))
         return -1;
       if ((sym.entries[slist[sslen]].flags & SFLG_STRUCTMEMBER) == 0) {
-        cc_error("structure member required after '.'");
+        cc_compile_error("structure member required after '.'");
         return -1;
       }
       if ((mustBeStaticMember) && ((sym.entries[slist[sslen]].flags & SFLG_STATIC) == 0)) {
-        cc_error("must have an instance of the struct to access a non-static member");
+        cc_compile_error("must have an instance of the struct to access a non-static member");
         return -1;
       }
       fsym = slist[sslen];
@@ -1374,7 +1372,7 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
         slist[sslen++] = targ->getnext();
 
         if (sym.get_type(slist[sslen - 1]) != SYM_OPENPARENTHESIS) {
-          cc_error("'(' expected");
+          cc_compile_error("'(' expected");
           return -1;
         }
 
@@ -1386,7 +1384,7 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
           slist[sslen] = targ->getnext();
           if (sslen >= TEMP_SYMLIST_LENGTH - 1)
           {
-            cc_error("buffer exceeded: you probably have a missing closing bracket on a previous line");
+            cc_compile_error("buffer exceeded: you probably have a missing closing bracket on a previous line");
             return -1;
           }
           sslen++;
@@ -1402,18 +1400,18 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
     else if (nexttype == SYM_OPENBRACKET) {
       if ((sym.get_type(slist[sslen]) >= NOTEXPRESSION) &&
           ((sym.get_type(slist[sslen]) != SYM_VARTYPE) || ((sym.entries[slist[sslen]].flags & SFLG_STRUCTTYPE) == 0))) {
-        cc_error("parse error after '['");
+        cc_compile_error("parse error after '['");
         return -1;
         }
       if (sym.get_type(slist[sslen]) == SYM_CLOSEBRACKET) {
-        cc_error("array index not specified");
+        cc_compile_error("array index not specified");
         return -1;
         }
       if ((sym.entries[slist[sslen-2]].flags & SFLG_ARRAY)==0) {
-        cc_error("%s is not an array",sym.get_friendly_name(slist[sslen-2]).c_str());
+        cc_compile_error("%s is not an array",sym.get_friendly_name(slist[sslen-2]).c_str());
         return -1;
         }
-      int braclevel = 0, linenumWas = currentline;
+      int braclevel = 0, linenumWas = ccCompile.currentline;
       // extract the contents of the brackets
       // comma is allowed because you can have like array[func(a,b)]
       // vartype is allowed to permit access to static members, e.g. array[Game.GetColorFromRGB(0, 0, 0)]
@@ -1423,8 +1421,8 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
         if (sym.get_type(slist[sslen - 1]) == SYM_VARTYPE && sym.get_type(slist[sslen]) != SYM_DOT)
           break;
         if (targ->getnext() == SCODE_INVALID) {
-          currentline = linenumWas;
-          cc_error("missing ']'");
+          ccCompile.currentline = linenumWas;
+          cc_compile_error("missing ']'");
           return -1;
         }
         if (sym.get_type(slist[sslen]) == SYM_CLOSEBRACKET) {
@@ -1439,7 +1437,7 @@ long extract_variable_name(int fsym, ccInternalList*targ,long*slist, int *funcAt
         sslen++;
         if (sslen >= TEMP_SYMLIST_LENGTH - 1)
         {
-          cc_error("buffer exceeded: you probably have a missing closing bracket on a previous line");
+          cc_compile_error("buffer exceeded: you probably have a missing closing bracket on a previous line");
           return -1;
         }
         slist[sslen] = targ->peeknext();
@@ -1542,7 +1540,7 @@ int extractPathIntoParts(VariableSymlist *variablePath, int slilen, long *syml)
 
     if (createPath) {
       if (variablePathSize >= MAX_VARIABLE_PATH) {
-        cc_error("variable path too long");
+        cc_compile_error("variable path too long");
         return -1;
       }
       VariableSymlist *vpp = &variablePath[variablePathSize];
@@ -1558,7 +1556,7 @@ int extractPathIntoParts(VariableSymlist *variablePath, int slilen, long *syml)
   return variablePathSize;
 }
 
-int readcmd_lastcalledwith=0;
+thread_local int readcmd_lastcalledwith=0;
 int get_readcmd_for_size(int sizz, int writeinstead) {
   int readcmd = SCMD_MEMREAD;
   if (writeinstead) {
@@ -1603,7 +1601,7 @@ int get_array_index_into_ax(ccCompiledScript *scrip, long *symlist, int openBrac
   int arrSym = symlist[openBracketOffs - 1];
 
   if ((sym.entries[arrSym].flags & SFLG_ARRAY) == 0) {
-    cc_error("Internal error: not an array: '%s'", sym.get_friendly_name(arrSym).c_str());
+    cc_compile_error("Internal error: not an array: '%s'", sym.get_friendly_name(arrSym).c_str());
     return -1;
   }
 
@@ -1633,7 +1631,7 @@ int parseArrayIndexOffsets(ccCompiledScript *scrip, VariableSymlist *thisClause,
     // find where the brackets end
     int arrIndexEnd = findClosingBracketOffs(1, thisClause->syml, thisClause->len);
     if (arrIndexEnd != thisClause->len - 1) {
-      cc_error("Error parsing path; unexpected token after array index");
+      cc_compile_error("Error parsing path; unexpected token after array index");
       return -1;
     }
 
@@ -1750,14 +1748,14 @@ int process_arrays_and_members(int slilen,long*syml,int*soffset,int*extraoffset,
         }
         else if (iswrite) {
           if (sym.entries[syml[onoffs+1]].flags & SFLG_READONLY) {
-            cc_error("property '%s' is read-only", sym.get_friendly_name(syml[onoffs + 1]).c_str());
+            cc_compile_error("property '%s' is read-only", sym.get_friendly_name(syml[onoffs + 1]).c_str());
             return -1;
           }
         }
 
         if (slilen > onoffs + 2) {
           // they did  lstList.OwningGUI.ID  for instance
-          cc_error("nested property access not currently supported");
+          cc_compile_error("nested property access not currently supported");
           return -1;
         }
 
@@ -1773,7 +1771,7 @@ int process_arrays_and_members(int slilen,long*syml,int*soffset,int*extraoffset,
         // if one of the struct members in the path is read-only, don't allow it
         if ((iswrite) || (mustBeWritable)) {
           if (sym.entries[syml[onoffs+1]].flags & SFLG_READONLY) {
-            cc_error("variable '%s' is read-only", sym.get_friendly_name(syml[onoffs + 1]).c_str());
+            cc_compile_error("variable '%s' is read-only", sym.get_friendly_name(syml[onoffs + 1]).c_str());
             return -1;
           }
         }
@@ -1802,7 +1800,7 @@ int call_property_func(ccCompiledScript *scrip, int propSym, int isWrite) {
     if (sym.entries[propSym].flags & SFLG_IMPORTED)
       scrip->write_cmd1(SCMD_PUSHREAL, SREG_BX);
     else {
-      cc_error("internal error: prop is not import");
+      cc_compile_error("internal error: prop is not import");
       return -1;
     }
 
@@ -1814,7 +1812,7 @@ int call_property_func(ccCompiledScript *scrip, int propSym, int isWrite) {
     if (sym.entries[propSym].flags & SFLG_IMPORTED)
       scrip->write_cmd1(SCMD_PUSHREAL, SREG_DX);
     else {
-      cc_error("internal error: prop is not import");
+      cc_compile_error("internal error: prop is not import");
       return -1;
     }
 
@@ -1834,7 +1832,7 @@ int call_property_func(ccCompiledScript *scrip, int propSym, int isWrite) {
     propFunc = sym.entries[propSym].get_propget();
 
   if (propFunc == 0) {
-    cc_error("Internal error: property in use but not set");
+    cc_compile_error("Internal error: property in use but not set");
     return -1;
   }
 
@@ -1892,7 +1890,7 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
   if (mainVariableType == SYM_VARTYPE) {
     // it's a static member property
     if (!isProperty) {
-      cc_error("static non-property access: internal error");
+      cc_compile_error("static non-property access: internal error");
       return -1;
     }
     // just write 0 to AX for ease of debugging if anything
@@ -1906,9 +1904,9 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
   else if ((mainVariableType == SYM_LITERALVALUE) || (mainVariableType == SYM_CONSTANT)) {
     if ((writing) || (mustBeWritable)) {
       if(mainVariableType == SYM_LITERALVALUE)
-        cc_error("cannot write to a literal value");
+        cc_compile_error("cannot write to a literal value");
       else
-        cc_error("cannot write to constant");
+        cc_compile_error("cannot write to constant");
       return -1;
     }
     int varSymValue;
@@ -1920,7 +1918,7 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
   }
   else if (mainVariableType == SYM_LITERALFLOAT) {
     if ((writing) || (mustBeWritable)) {
-      cc_error("cannot write to a literal value");
+      cc_compile_error("cannot write to a literal value");
       return -1;
     }
     scrip->write_cmd2(SCMD_LITTOREG, SREG_AX, float_to_int_raw((float)atof(sym.get_name(variableSym))));
@@ -1989,7 +1987,7 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
     }
   else if (mainVariableType == SYM_STRING) {
     if (writing) {
-      cc_error("cannot write to a literal string");
+      cc_compile_error("cannot write to a literal string");
       return -1;
     }
 
@@ -1998,19 +1996,19 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
     gotValType = sym.normalStringSym | STYPE_CONST;
   }
   else if (mainVariableType == SYM_STRUCTMEMBER) {
-    cc_error("must include parent structure of member '%s'",sym.get_friendly_name(mainVariableSym).c_str());
+    cc_compile_error("must include parent structure of member '%s'",sym.get_friendly_name(mainVariableSym).c_str());
     return -1;
     }
   else if (mainVariableType == SYM_NULL) {
     if (writing) {
-      cc_error("Invalid use of null");
+      cc_compile_error("Invalid use of null");
       return -1;
     }
     scrip->write_cmd2(SCMD_LITTOREG, SREG_AX, 0);
     gotValType = sym.nullSym | STYPE_POINTER;
   }
   else {
-    cc_error("read/write ax called with non-variable parameter ('%s')",sym.get_friendly_name(variableSym).c_str());
+    cc_compile_error("read/write ax called with non-variable parameter ('%s')",sym.get_friendly_name(variableSym).c_str());
     return -1;
     }
 
@@ -2040,7 +2038,7 @@ int do_variable_memory_access(ccCompiledScript *scrip, int variableSym,
 
 // If the variable being read is actually a property, not a
 // member variable, then read_variable_into_ax sets this
-int readonly_cannot_cause_error = 0;
+thread_local int readonly_cannot_cause_error = 0;
 
 int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int mustBeWritable, bool negateLiteral = false) {
   // read the various types of values into AX
@@ -2106,7 +2104,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
       doMemoryAccessNow = true;
 
       if (!isLastClause) {
-        cc_error("Function().Member not supported");
+        cc_compile_error("Function().Member not supported");
         return -1;
       }
     }
@@ -2123,7 +2121,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
         // normally, the whole array can be used as a pointer.
         // this is not the case with an property array, so catch
         // it here and give an error
-        cc_error("Expected array index after '%s'", sym.get_friendly_name(variableSym).c_str());
+        cc_compile_error("Expected array index after '%s'", sym.get_friendly_name(variableSym).c_str());
         return -1;
       }
 
@@ -2140,7 +2138,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
       else if (writing) {
 
         if ((writingThisTime) && (sym.entries[variableSym].flags & SFLG_READONLY)) {
-          cc_error("property '%s' is read-only", sym.get_friendly_name(variableSym).c_str());
+          cc_compile_error("property '%s' is read-only", sym.get_friendly_name(variableSym).c_str());
           return -1;
         }
 
@@ -2167,7 +2165,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
           }
           else
           {
-            cc_error("Expected array index after '%s'", sym.get_friendly_name(variableSym).c_str());
+            cc_compile_error("Expected array index after '%s'", sym.get_friendly_name(variableSym).c_str());
             return -1;
           }
         }
@@ -2192,7 +2190,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
       if (sym.entries[variableSym].flags & SFLG_THISPTR) {
         if (isPointer) {
           // already a pointer on the stack
-          cc_error("Nested this pointers??");
+          cc_compile_error("Nested this pointers??");
           return -1;
         }
 
@@ -2227,7 +2225,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
           }
         }
         else {
-          cc_error("Invalid type for pointer");
+          cc_compile_error("Invalid type for pointer");
           return -1;
         }
 
@@ -2276,7 +2274,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
       // a property being accessed
       if ((sym.entries[variableSym].flags & SFLG_POINTER) && (!isLastClause)) { }
       else if (sym.entries[variableSym].flags & SFLG_READONLY) {
-        cc_error("variable '%s' is read-only", sym.get_friendly_name(variableSym).c_str());
+        cc_compile_error("variable '%s' is read-only", sym.get_friendly_name(variableSym).c_str());
         return -1;
       }
       else if (sym.entries[variableSym].flags & SFLG_WRITEPROTECTED) {
@@ -2284,7 +2282,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
         // the this ptr
         if ((ee > 0) && (sym.entries[variablePath[ee - 1].syml[0]].flags & SFLG_THISPTR)) { }
         else {
-          cc_error("variable '%s' is write-protected", sym.get_friendly_name(variableSym).c_str());
+          cc_compile_error("variable '%s' is write-protected", sym.get_friendly_name(variableSym).c_str());
           return -1;
         }
 
@@ -2321,7 +2319,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
 
     if ((writing) && (cannotAssign)) {
       // an entire array or struct cannot be assigned to
-      cc_error("cannot assign to '%s'", sym.get_friendly_name(variableSym).c_str());
+      cc_compile_error("cannot assign to '%s'", sym.get_friendly_name(variableSym).c_str());
       return -1;
     }
 
@@ -2378,7 +2376,7 @@ int do_variable_ax(int slilen,long*syml,ccCompiledScript*scrip,int writing, int
           isPointer = true;
         }
         else {
-          cc_error("Invalid pathing: unexpected '%s'", sym.get_friendly_name(variablePath[ee + 1].syml[0]).c_str());
+          cc_compile_error("Invalid pathing: unexpected '%s'", sym.get_friendly_name(variablePath[ee + 1].syml[0]).c_str());
           return -1;
         }
 
@@ -2418,7 +2416,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
   printf("'\n");*/
 
   if (listlen == 0) {
-    cc_error("Empty sub-expression?");
+    cc_compile_error("Empty sub-expression?");
     return -1;
   }
 
@@ -2440,7 +2438,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
     {
       if (listlen < 2 || sym.get_type(symlist[oploc + 1]) != SYM_VARTYPE)
       {
-        cc_error("expected type after 'new'");
+        cc_compile_error("expected type after 'new'");
         return -1;
       }
 
@@ -2453,7 +2451,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
 
           if (scrip->ax_val_type != sym.normalIntSym)
           {
-            cc_error("array size must be an int");
+            cc_compile_error("array size must be an int");
             return -1;
           }
 
@@ -2466,7 +2464,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
           }
           else if (sym.entries[arrayType].flags & SFLG_STRUCTTYPE)
           {
-            cc_error("cannot create dynamic array of unmanaged struct");
+            cc_compile_error("cannot create dynamic array of unmanaged struct");
             return -1;
           }
 
@@ -2480,7 +2478,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
       {
           if(sym.entries[symlist[oploc + 1]].flags & SFLG_BUILTIN)
           {
-            cc_error("Built-in type '%s' cannot be instantiated directly", sym.get_name(symlist[oploc + 1]));
+            cc_compile_error("Built-in type '%s' cannot be instantiated directly", sym.get_name(symlist[oploc + 1]));
             return -1;
           }
           const size_t size = sym.entries[symlist[oploc + 1]].ssize;
@@ -2493,7 +2491,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
     else if (sym.entries[symlist[oploc]].operatorToVCPUCmd() == SCMD_SUBREG) {
       // "-" operator (it wants to negate whatever comes next)
       if (listlen < 2) {
-        cc_error("parse error at '-'");
+        cc_compile_error("parse error at '-'");
         return -1;
       }
       // parse the rest of the expression into AX
@@ -2511,7 +2509,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
     else if (sym.entries[symlist[oploc]].operatorToVCPUCmd() == SCMD_NOTREG) {
       // "!" operator (NOT whatever comes next)
       if (listlen < 2) {
-        cc_error("parse error at '!'");
+        cc_compile_error("parse error at '!'");
         return -1;
       }
       // parse the rest of the expression into AX
@@ -2526,7 +2524,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
     }
     else {
       // this operator needs a left hand side
-      cc_error("Parse error: unexpected operator '%s'",sym.get_friendly_name(symlist[oploc]).c_str());
+      cc_compile_error("Parse error: unexpected operator '%s'",sym.get_friendly_name(symlist[oploc]).c_str());
       return -1;
     }
   }
@@ -2537,7 +2535,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
 
     if (vcpuOperator == SCMD_NOTREG) {
       // you can't do   a = b ! c;
-      cc_error("Invalid use of operator '!'");
+      cc_compile_error("Invalid use of operator '!'");
       return -1;
     }
     // A value is being negated on the right
@@ -2551,7 +2549,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
 
     if (oploc + 1 >= listlen) {
       // there is no right hand side for the expression
-      cc_error("Parse error: invalid use of operator '%s'",sym.get_friendly_name(symlist[oploc]).c_str());
+      cc_compile_error("Parse error: invalid use of operator '%s'",sym.get_friendly_name(symlist[oploc]).c_str());
       return -1;
     }
 
@@ -2633,11 +2631,11 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
         level++;
       }
     if (fnd < 0) {
-      cc_error("Bracketed expression not terminated");
+      cc_compile_error("Bracketed expression not terminated");
       return -1;
     }
     if (fnd <= 1) {
-      cc_error("Empty bracketed expression");
+      cc_compile_error("Empty bracketed expression");
       return -1;
     }
 
@@ -2648,13 +2646,13 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
       // there is some code after the )
       // this should not be possible, unless the user does
       // something like "if ((x) 1234)" ie. with an operator missing
-      cc_error("Parse error: operator expected");
+      cc_compile_error("Parse error: operator expected");
       return -1;
 /*
       scrip->push_reg(SREG_AX);
       int op = symlist[0];
       if (sym.get_type(op) != SYM_OPERATOR) {
-        cc_error("expected operator, not '%s'",sym.get_friendly_name(op).c_str());
+        cc_compile_error("expected operator, not '%s'",sym.get_friendly_name(op).c_str());
         return -1;
         }
       if (parse_sub_expr(&symlist[1],listlen-1,scrip) < 0) return -1;
@@ -2667,7 +2665,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
     return 0;
     }
   else if (sym.get_type(symlist[0]) == 0) {
-    cc_error("undefined symbol '%s'",sym.get_friendly_name(symlist[0]).c_str());
+    cc_compile_error("undefined symbol '%s'",sym.get_friendly_name(symlist[0]).c_str());
     return -1;
     }
   else if (hasNegatedLiteral && (listlen == 2)) {
@@ -2677,9 +2675,9 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
   else if (sym.get_type(symlist[0]) == SYM_OPERATOR) {
     // If someone follows the negation operator with bogus tokens, the problem is actually on the right of it
     if ((sym.entries[symlist[0]].operatorToVCPUCmd() == SCMD_SUBREG) && (listlen > 2))
-      cc_error("Parse error: unexpected '%s'",sym.get_friendly_name(symlist[2]).c_str());
+      cc_compile_error("Parse error: unexpected '%s'",sym.get_friendly_name(symlist[2]).c_str());
     else
-      cc_error("Parse error: unexpected '%s'",sym.get_friendly_name(symlist[0]).c_str());
+      cc_compile_error("Parse error: unexpected '%s'",sym.get_friendly_name(symlist[0]).c_str());
     return -1;
     }
   else if ((sym.get_type(symlist[0]) == SYM_FUNCTION) || (funcAtOffs > 0)) {
@@ -2708,7 +2706,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
 
     // a function call
     if (sym.get_type(usingList[funcAtOffs + 1]) != SYM_OPENPARENTHESIS) {
-      cc_error("expected '('");
+      cc_compile_error("expected '('");
       return -1;
     }
 
@@ -2731,7 +2729,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
       if ((sym.get_type(usingList[ct]) == SYM_COMMA) && (bdepth == 0)) {
         num_supplied_args++;
         if (opsSinceComma < 1) {
-          cc_error("missing argument in function call");
+          cc_compile_error("missing argument in function call");
           return -1;
         }
         opsSinceComma = 0;
@@ -2744,7 +2742,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
       num_supplied_args = 0;
 
     if (bdepth >= 0) {
-      cc_error("parser confused near '%s'",sym.get_friendly_name(usingList[-2]).c_str());
+      cc_compile_error("parser confused near '%s'",sym.get_friendly_name(usingList[-2]).c_str());
       return -1;
     }
 
@@ -2764,7 +2762,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
       for (int ii = func_args; ii > num_supplied_args; ii--) {
 
         if (!sym.entries[funcsym].funcParamHasDefaultValues[ii]) {
-          cc_error("Not enough parameters in call to function");
+          cc_compile_error("Not enough parameters in call to function");
           return -1;
         }
 
@@ -2802,7 +2800,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
         }
       if (sym.get_type(usingList[thispar]) == SYM_CLOSEPARENTHESIS) {
         // they did  Display("Jibble",);
-        cc_error("Unexpected ')'");
+        cc_compile_error("Unexpected ')'");
         return -1;
       }
       if (parse_sub_expr(&usingList[thispar],flen - thispar,scrip)) return -1;
@@ -2833,7 +2831,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
     usingListLen -= orisize;
 
     if (sym.get_type(usingList[0]) != SYM_CLOSEPARENTHESIS) {
-      cc_error("expected ')'");
+      cc_compile_error("expected ')'");
       return -1;
     }
 
@@ -2844,7 +2842,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
     if ((sym.entries[funcsym].sscope >= 100) && (numargs >= sym.entries[funcsym].sscope - 100)) ;
     else if (sym.entries[funcsym].sscope == numargs) ;
     else {
-      cc_error("wrong number of parameters in call to '%s'",sym.get_friendly_name(funcsym).c_str());
+      cc_compile_error("wrong number of parameters in call to '%s'",sym.get_friendly_name(funcsym).c_str());
       return -1;
       }
     sym.entries[funcsym].flags |= SFLG_ACCESSED;
@@ -2888,7 +2886,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
 
     // make sure there's nothing left to process in this clause
     if (usingListLen > 0) {
-      cc_error("expected semicolon after '%s'",sym.get_friendly_name(usingList[-1]).c_str());
+      cc_compile_error("expected semicolon after '%s'",sym.get_friendly_name(usingList[-1]).c_str());
       return -1;
     }
   }
@@ -2899,7 +2897,7 @@ int parse_sub_expr(long*symlist,int listlen,ccCompiledScript*scrip) {
     if (read_variable_into_ax(1,&symlist[0],scrip)) return -1;
     }
   else {
-    cc_error("Parse error in expr near '%s'",sym.get_friendly_name(symlist[0]).c_str());
+    cc_compile_error("Parse error in expr near '%s'",sym.get_friendly_name(symlist[0]).c_str());
     return -1;
     }
 
@@ -2954,7 +2952,7 @@ int evaluate_expression(ccInternalList*targ,ccCompiledScript*scrip,int countbrac
           || sym.get_type(targ->script[j]) == SYM_CLOSEPARENTHESIS) {
       ourlen = j - targ->pos;
       if ((ourlen < 1) || (hadMetaOnly == 1)) {
-        cc_error("PE01: Parse error at '%s'",sym.get_friendly_name(targ->script[j]).c_str());
+        cc_compile_error("PE01: Parse error at '%s'",sym.get_friendly_name(targ->script[j]).c_str());
         return -1;
         }
       ours.script = (long*)malloc(ourlen * sizeof(long));
@@ -2981,7 +2979,7 @@ int evaluate_expression(ccInternalList*targ,ccCompiledScript*scrip,int countbrac
   if (j >= targ->length) {
     free(ours.script);
     ours.script=NULL;
-    cc_error("end of input reached in middle of expression");
+    cc_compile_error("end of input reached in middle of expression");
     return -1;
     }
   targ->pos = j;
@@ -3001,7 +2999,7 @@ int evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expe
             (sym.entries[vnlist[2]].flags & SFLG_STATIC))
         { }
         else {
-            cc_error("variable required on left of assignment %s ", sym.get_name(cursym));
+            cc_compile_error("variable required on left of assignment %s ", sym.get_name(cursym));
             return -1;
         }
     }
@@ -3011,23 +3009,23 @@ int evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expe
     {
         if (sym.get_type(targ->peeknext()) != SYM_ASSIGN)
         {
-            cc_error("invalid use of operator with array");
+            cc_compile_error("invalid use of operator with array");
             return -1;
         }
         isAccessingDynamicArray = true;
     }
     else if (((sym.entries[cursym].flags & SFLG_ARRAY) != 0) && (lilen < 2))
     {
-        cc_error("cannot assign value to entire array");
+        cc_compile_error("cannot assign value to entire array");
         return -1;
     }
     if (sym.entries[cursym].flags & SFLG_ISSTRING) {
-        cc_error ("cannot assign to string; use Str* functions instead");
+        cc_compile_error ("cannot assign to string; use Str* functions instead");
         return -1;
     }
     /*
     if (sym.entries[cursym].flags & SFLG_READONLY) {
-    cc_error("variable '%s' is read-only", sym.get_name(cursym));
+    cc_compile_error("variable '%s' is read-only", sym.get_name(cursym));
     return -1;
     }
     */
@@ -3085,7 +3083,7 @@ int evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expe
             // deal with  a[1] = b
             finalPartOfLHS = findOpeningBracketOffs(lilen - 1, vnlist) - 1;
             if (finalPartOfLHS < 0) {
-                cc_error("No [ for ] to match");
+                cc_compile_error("No [ for ] to match");
                 return -1;
             }
         }
@@ -3099,13 +3097,13 @@ int evaluate_assignment(ccInternalList *targ, ccCompiledScript *scrip, bool expe
 
     if(expectCloseBracket) {
         if (sym.get_type(targ->getnext()) != SYM_CLOSEPARENTHESIS) {
-            cc_error("Expected ')'");
+            cc_compile_error("Expected ')'");
             return -1;
         }
     }
     else
         if (sym.get_type(targ->getnext()) != SYM_SEMICOLON) {
-            cc_error("Expected ';'");
+            cc_compile_error("Expected ';'");
             return -1;
         }
 
@@ -3120,19 +3118,19 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
   int need_fixup = 0;
   int array_size = 1;
   if (sym.get_type(cursym) != 0) {
-    cc_error ("Symbol '%s' already defined");
+    cc_compile_error ("Symbol '%s' already defined");
     return -1;
   }
 
   if ((sym.entries[vtwas].flags & SFLG_MANAGED) && (!isPointer) && (isglobal != 2)) {
     // managed structs must be allocated via ccRegisterObject,
     // and cannot be declared normally in the script (unless imported)
-    cc_error("Cannot declare local instance of managed type");
+    cc_compile_error("Cannot declare local instance of managed type");
     return -1;
   }
 
   if (vtwas == sym.normalVoidSym) {
-    cc_error("'void' not a valid variable type");
+    cc_compile_error("'void' not a valid variable type");
     return -1;
   }
 
@@ -3149,7 +3147,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
 
   if (((sym.entries[vtwas].flags & SFLG_MANAGED) == 0) && (isPointer) && (isglobal != 2)) {
     // can only point to managed structs
-    cc_error("Cannot declare pointer to non-managed type");
+    cc_compile_error("Cannot declare pointer to non-managed type");
     return -1;
   }
 
@@ -3162,7 +3160,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
       sym.entries[cursym].flags |= SFLG_DYNAMICARRAY;
       array_size = 0;
       varsize = 4;
-      //cc_error("dynamic arrays not yet supported"); return -1;
+      //cc_compile_error("dynamic arrays not yet supported"); return -1;
     }
     else
     {
@@ -3173,12 +3171,12 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
       }
 
       if (sym.entries[vtwas].flags & SFLG_HASDYNAMICARRAY) {
-        cc_error("Cannot declare an array of a type containing dynamic array(s)");
+        cc_compile_error("Cannot declare an array of a type containing dynamic array(s)");
         return -1;
       }
 
       if (array_size < 1) {
-        cc_error("Array size must be >=1");
+        cc_compile_error("Array size must be >=1");
         return -1;
       }
 
@@ -3189,7 +3187,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
 
     if (sym.get_type(targ->getnext()) != SYM_CLOSEBRACKET)
     {
-      cc_error("expected ']'");
+      cc_compile_error("expected ']'");
       return -1;
     }
 
@@ -3204,19 +3202,19 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
     sym.entries[cursym].flags |= SFLG_ISSTRING;
     // if it's a string, allocate it some space
     if (ccGetOption(SCOPT_OLDSTRINGS) == 0) {
-      cc_error("type 'string' is no longer supported; use String instead");
+      cc_compile_error("type 'string' is no longer supported; use String instead");
       return -1;
     }
     else if (sym.entries[cursym].flags & SFLG_DYNAMICARRAY)
     {
-      cc_error("arrays of old-style strings are not supported");
+      cc_compile_error("arrays of old-style strings are not supported");
       return -1;
     }
     else if (isglobal == 2) {
       // importing a string
       // cannot import, because string is really char*, and the pointer
       // won't resolve properly
-      cc_error("cannot import string; use char[] instead");
+      cc_compile_error("cannot import string; use char[] instead");
       return -1;
     }
     else if (isglobal == 1) {
@@ -3243,15 +3241,15 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
   // assign an initial value to the variable
   if (next_type[0] == SYM_ASSIGN) {
     if (isglobal == 2) {
-      cc_error("cannot set initial value of imported variables");
+      cc_compile_error("cannot set initial value of imported variables");
       return -1;
     }
     if ((sym.entries[cursym].flags & (SFLG_ARRAY | SFLG_DYNAMICARRAY)) == SFLG_ARRAY) {
-      cc_error("cannot assign value to array");
+      cc_compile_error("cannot assign value to array");
       return -1;
     }
     if (sym.entries[cursym].flags & SFLG_ISSTRING) {
-      cc_error("cannot assign value to string, use StrCopy");
+      cc_compile_error("cannot assign value to string, use StrCopy");
       return -1;
     }
     targ->getnext();  // skip the '='
@@ -3265,7 +3263,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
 
     if (isglobal) {
       if ((sym.entries[cursym].flags & (SFLG_POINTER | SFLG_DYNAMICARRAY)) != 0) {
-        cc_error("cannot assign initial value to global pointer");
+        cc_compile_error("cannot assign initial value to global pointer");
         return -1;
       }
       bool is_neg = false;
@@ -3276,7 +3274,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
       if (sym.entries[cursym].vartype == sym.normalFloatSym) {
         // initialize float
         if (sym.get_type(targ->peeknext()) != SYM_LITERALFLOAT) {
-          cc_error("Expected floating point value after '='");
+          cc_compile_error("Expected floating point value after '='");
           return -1;
         }
         float tehValue = (float)atof(sym.get_name(targ->getnext()));
@@ -3285,7 +3283,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
         getsvalue[0] = float_to_int_raw(tehValue);
       }
       else if (sym.entries[cursym].ssize > 4) {
-        cc_error("cannot initialize struct type");
+        cc_compile_error("cannot initialize struct type");
         return -1;
       }
       else {
@@ -3316,7 +3314,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
     sym.entries[cursym].soffs = scrip->add_new_import(sym.get_name(cursym));
     sym.entries[cursym].flags |= SFLG_IMPORTED;
     if (sym.entries[cursym].soffs == -1) {
-      cc_error("Internal error: import table overflow");
+      cc_compile_error("Internal error: import table overflow");
       return -1;
       }
     }
@@ -3364,7 +3362,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
   if (check_not_eof(*targ))
     return -1;
   if (next_type[0] != SYM_SEMICOLON) {
-    cc_error("Expected ',' or ';', not '%s'",sym.get_friendly_name(targ->peeknext()).c_str());
+    cc_compile_error("Expected ',' or ';', not '%s'",sym.get_friendly_name(targ->peeknext()).c_str());
     return -1;
     }
   targ->getnext();  // skip the semicolon
@@ -3373,7 +3371,7 @@ int parse_variable_declaration(long cursym,int *next_type,int isglobal,
 
 #define INC_NESTED_LEVEL \
     if (nested_level >= MAX_NESTED_LEVEL) {\
-    cc_error("too many nested if/else statements");\
+    cc_compile_error("too many nested if/else statements");\
     return -1;\
     }\
     nested_level++
@@ -3402,30 +3400,30 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
     // *** now we have the program as a list of symbols in targ
     // go through it one by one. We start off in the global data
     // part - no code is allowed until a function definition is started
-    currentline=1;
+    ccCompile.currentline=1;
     targ.startread();
     int currentlinewas=0;
     for (aa=0;aa<targ.length;aa++) {
         int cursym = targ.getnext();
-        if (currentline == -10) break; // end of stream was reached
-        if ((currentline != currentlinewas) && (ccGetOption(SCOPT_LINENUMBERS)!=0)) {
-            scrip->set_line_number(currentline);
-            currentlinewas = currentline;
+        if (ccCompile.currentline == -10) break; // end of stream was reached
+        if ((ccCompile.currentline != currentlinewas) && (ccGetOption(SCOPT_LINENUMBERS)!=0)) {
+            scrip->set_line_number(ccCompile.currentline);
+            currentlinewas = ccCompile.currentline;
         }
 
         if (cursym == SCODE_INVALID) {
-            cc_error("Internal compiler error: invalid symbol found");
+            cc_compile_error("Internal compiler error: invalid symbol found");
             return -1;
         }
         else if (cursym == SCODE_META) {
             long metatype = targ.getnext();
             if (metatype==SMETA_END) break;
             else if (metatype==SMETA_LINENUM) {
-                cc_error("Internal errror: unexpected meta tag");
+                cc_compile_error("Internal errror: unexpected meta tag");
                 return -1;
             }
             else {
-                cc_error("Internal compiler error: invalid meta tag found in stream");
+                cc_compile_error("Internal compiler error: invalid meta tag found in stream");
                 return -1;
             }
         }
@@ -3434,10 +3432,10 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
         {
             strcpy(scriptNameBuffer, &sym.get_name(cursym)[18]);
             scriptNameBuffer[strlen(scriptNameBuffer) - 1] = 0;  // strip closing speech mark
-            ccCurScriptName = scriptNameBuffer;
+            ccCompile.scriptName = scriptNameBuffer;
 
             scrip->start_new_section(scriptNameBuffer);
-            currentline = 0;
+            ccCompile.currentline = 0;
             continue;
         }
 
@@ -3445,13 +3443,13 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
 
         if (symType == SYM_OPENBRACE) {
             if (in_func < 0) {
-                cc_error("Unexpected '{'");
+                cc_compile_error("Unexpected '{'");
                 return -1;
             }
             if ((nested_type[nested_level] == NEST_IFSINGLE) ||
                 (nested_type[nested_level] == NEST_ELSESINGLE) ||
                 (nested_type[nested_level] == NEST_DOSINGLE)) {
-                    cc_error("Internal compiler error in openbrace");
+                    cc_compile_error("Internal compiler error in openbrace");
                     return -1;
             }
             INC_NESTED_LEVEL;
@@ -3514,12 +3512,12 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
             if ((nested_type[nested_level] == NEST_IFSINGLE) ||
                 (nested_type[nested_level] == NEST_ELSESINGLE) ||
                 (nested_type[nested_level] == NEST_DOSINGLE)) {
-                    cc_error("Unexpected '}'");
+                    cc_compile_error("Unexpected '}'");
                     return -1;
             }
             nested_level--;
             if (nested_level < 0) {
-                cc_error("Unexpected '}'");
+                cc_compile_error("Unexpected '}'");
                 return -1;
             }
 
@@ -3582,7 +3580,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
             int stname = targ.getnext();
             if ((sym.get_type(stname) != 0) &&
                 (sym.get_type(stname) != SYM_UNDEFINEDSTRUCT)) {
-                    cc_error("'%s' is already defined",sym.get_friendly_name(stname).c_str());
+                    cc_compile_error("'%s' is already defined",sym.get_friendly_name(stname).c_str());
                     return -1;
             }
             int size_so_far = 0;
@@ -3628,30 +3626,30 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                 targ.getnext();
                 extendsWhat = targ.getnext();
                 if (sym.get_type(extendsWhat) != SYM_VARTYPE) {
-                    cc_error("Invalid use of 'extends'");
+                    cc_compile_error("Invalid use of 'extends'");
                     return -1;
                 }
                 if ((sym.entries[extendsWhat].flags & SFLG_STRUCTTYPE) == 0) {
-                    cc_error("Must extend a struct type");
+                    cc_compile_error("Must extend a struct type");
                     return -1;
                 }
                 if ((sym.entries[extendsWhat].flags & SFLG_MANAGED) == 0 && (sym.entries[stname].flags & SFLG_MANAGED)) {
-                    cc_error("Incompatible types. Managed struct cannot extend unmanaged struct '%s'", sym.get_name(extendsWhat));
+                    cc_compile_error("Incompatible types. Managed struct cannot extend unmanaged struct '%s'", sym.get_name(extendsWhat));
                     return -1;
                 }
                 if ((sym.entries[extendsWhat].flags & SFLG_MANAGED) && (sym.entries[stname].flags & SFLG_MANAGED) == 0) {
-                    cc_error("Incompatible types. Unmanaged struct cannot extend managed struct '%s'", sym.get_name(extendsWhat));
+                    cc_compile_error("Incompatible types. Unmanaged struct cannot extend managed struct '%s'", sym.get_name(extendsWhat));
                     return -1;
                 }
                 if ((sym.entries[extendsWhat].flags & SFLG_BUILTIN) && (sym.entries[stname].flags & SFLG_BUILTIN) == 0) {
-                    cc_error("The built-in type '%s' cannot be extended by a concrete struct. Use extender methods instead", sym.get_name(extendsWhat));
+                    cc_compile_error("The built-in type '%s' cannot be extended by a concrete struct. Use extender methods instead", sym.get_name(extendsWhat));
                     return -1;
                 }
                 size_so_far = sym.entries[extendsWhat].ssize;
                 sym.entries[stname].extends = extendsWhat;
             }
             if (sym.get_type(targ.getnext()) != SYM_OPENBRACE) {
-                cc_error("expected '{'");
+                cc_compile_error("expected '{'");
                 return -1;
             }
 
@@ -3707,7 +3705,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                 } while (foundQualifier);
 
                 if (member_is_protected && member_is_writeprotected) {
-                    cc_error("Field cannot be both protected and write-protected.");
+                    cc_compile_error("Field cannot be both protected and write-protected.");
                     return -1;
                 }
 
@@ -3731,17 +3729,17 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
 
                         if (error)
                         {
-                            cc_error("Syntax error at '%s'; expected variable type", symName);
+                            cc_compile_error("Syntax error at '%s'; expected variable type", symName);
                             return -1;
                         }
                 }
                 if (cursym == sym.normalStringSym) {
-                    cc_error("'string' not allowed inside struct");
+                    cc_compile_error("'string' not allowed inside struct");
                     return -1;
                 }
 
                 if (targ.peeknext() < 0) {
-                    cc_error("Invalid syntax near '%s'", sym.get_friendly_name(cursym).c_str());
+                    cc_compile_error("Invalid syntax near '%s'", sym.get_friendly_name(cursym).c_str());
                     return -1;
                 }
 
@@ -3755,24 +3753,24 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                     targ.getnext();
                 }
                 else if (sym.get_type(cursym) == SYM_UNDEFINEDSTRUCT) {
-                    cc_error("Invalid use of forward-declared struct");
+                    cc_compile_error("Invalid use of forward-declared struct");
                     return -1;
                 }
 
                 if ((sym.entries[cursym].flags & SFLG_STRUCTTYPE) && (member_is_pointer == 0)) {
-                    cc_error("Member variable cannot be struct");
+                    cc_compile_error("Member variable cannot be struct");
                     return -1;
                 }
                 if ((member_is_pointer) && (sym.entries[stname].flags & SFLG_MANAGED) && (!member_is_import)) {
-                    cc_error("Member variable of managed struct cannot be pointer");
+                    cc_compile_error("Member variable of managed struct cannot be pointer");
                     return -1;
                 }
                 else if ((sym.entries[cursym].flags & SFLG_MANAGED) && (!member_is_pointer)) {
-                    cc_error("Cannot declare non-pointer of managed type");
+                    cc_compile_error("Cannot declare non-pointer of managed type");
                     return -1;
                 }
                 else if (((sym.entries[cursym].flags & SFLG_MANAGED) == 0) && (member_is_pointer)) {
-                    cc_error("Cannot declare pointer to non-managed type");
+                    cc_compile_error("Cannot declare pointer to non-managed type");
                     return -1;
                 }
 
@@ -3796,7 +3794,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                         vname = sym_find_or_add(sym, new_name);
                     }
                     if (sym.get_type(vname) != 0 && (sym.get_type(vname) != SYM_VARTYPE || vname <= sym.normalFloatSym)) {
-                        cc_error("'%s' is already defined",sym.get_friendly_name(vname).c_str());
+                        cc_compile_error("'%s' is already defined",sym.get_friendly_name(vname).c_str());
                         return -1;
                     }
                     if (extendsWhat > 0) {
@@ -3804,7 +3802,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                         // with the same name
                         long member = vname;
                         if (memberExt == NULL) {
-                            cc_error("Internal compiler error dbc");
+                            cc_compile_error("Internal compiler error dbc");
                             return -1;
                         }
                         // skip the colons
@@ -3817,22 +3815,22 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                         }
 
                         if (find_member_sym(extendsWhat, &member, true) == 0) {
-                            cc_error("'%s' already defined by inherited class", sym.get_friendly_name(member).c_str());
+                            cc_compile_error("'%s' already defined by inherited class", sym.get_friendly_name(member).c_str());
                             return -1;
                         }
                         // not found -- a good thing, but find_member_sym will
                         // have errored. Clear the error
-                        ccError = 0;
+                        ccCompile.error = 0;
                     }
 
                     if (isFunction) {
                         // member function
                         if (!member_is_import) {
-                            cc_error("function in a struct requires the import keyword");
+                            cc_compile_error("function in a struct requires the import keyword");
                             return -1;
                         }
                         if (member_is_writeprotected) {
-                            cc_error("'writeprotected' does not apply to functions");
+                            cc_compile_error("'writeprotected' does not apply to functions");
                             return -1;
                         }
 
@@ -3845,7 +3843,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                             sym.entries[vname].flags |= SFLG_PROTECTED;
 
                         if (in_func >= 0) {
-                            cc_error("Cannot define member function body inside struct");
+                            cc_compile_error("Cannot define member function body inside struct");
                             return -1;
                         }
 
@@ -3853,22 +3851,22 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                     else if (isDynamicArray) {
                         // Someone tried to declare the function syntax for a dynamic array
                         // But there was no function declaration
-                        cc_error("expected '('");
+                        cc_compile_error("expected '('");
                         return -1;
                     }
                     else if ((member_is_import) && (!member_is_property)) {
                         // member variable cannot be an import
-                        cc_error("'import' not valid in this context");
+                        cc_compile_error("'import' not valid in this context");
                         return -1;
                     }
                     else if ((member_is_static) && (!member_is_property)) {
-                        cc_error("static variables not supported");
+                        cc_compile_error("static variables not supported");
                         return -1;
                     }
                     else if ((cursym == stname) && (!member_is_pointer)) {
                         // cannot do  struct A { A a; }
                         // since we don't know the size of A, recursiveness
-                        cc_error("struct '%s' cannot be a member of itself", sym.get_friendly_name(cursym).c_str());
+                        cc_compile_error("struct '%s' cannot be a member of itself", sym.get_friendly_name(cursym).c_str());
                         return -1;
                     }
                     else {
@@ -3895,7 +3893,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
 
                         if (member_is_property) {
                             if (!member_is_import) {
-                                cc_error("Property must be import");
+                                cc_compile_error("Property must be import");
                                 return -1;
                             }
                             else {
@@ -3908,7 +3906,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                                 // An indexed property!
                                 targ.getnext();  // skip the [
                                 if (sym.get_type(targ.getnext()) != SYM_CLOSEBRACKET) {
-                                    cc_error("cannot specify array size for property");
+                                    cc_compile_error("cannot specify array size for property");
                                     return -1;
                                 }
 
@@ -3920,7 +3918,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                             // the struct name added to it -- strip it back off
                             const char *memberPart = strstr(sym.get_name(vname), "::");
                             if (memberPart == NULL) {
-                                cc_error("internal error: property has no struct name");
+                                cc_compile_error("internal error: property has no struct name");
                                 return -1;
                             }
                             // seek to the actual member name
@@ -3947,7 +3945,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
 
                             if (sym.get_type(nextt) == SYM_CLOSEBRACKET) {
                                 if ((sym.entries[stname].flags & SFLG_MANAGED)) {
-                                    cc_error("Member variable of managed struct cannot be dynamic array");
+                                    cc_compile_error("Member variable of managed struct cannot be dynamic array");
                                     return -1;
                                 }
                                 sym.entries[stname].flags |= SFLG_HASDYNAMICARRAY;
@@ -3961,14 +3959,14 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                                 }
 
                                 if (array_size < 1) {
-                                    cc_error("array size cannot be less than 1");
+                                    cc_compile_error("array size cannot be less than 1");
                                     return -1;
                                 }
 
                                 size_so_far += array_size * sym.entries[vname].ssize;
 
                                 if (sym.get_type(targ.getnext()) != SYM_CLOSEBRACKET) {
-                                    cc_error("expected ']'");
+                                    cc_compile_error("expected ']'");
                                     return -1;
                                 }
                             }
@@ -3986,7 +3984,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
 
                 // line must end with semicolon
                 if (sym.get_type(targ.getnext()) != SYM_SEMICOLON) {
-                    cc_error("expected ';'");
+                    cc_compile_error("expected ';'");
                     return -1;
                 }
             }
@@ -3996,7 +3994,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
             // read in the }
             targ.getnext();
             if (sym.get_type(targ.getnext()) != SYM_SEMICOLON) {
-                cc_error("missing semicolon after struct declaration");
+                cc_compile_error("missing semicolon after struct declaration");
                 return -1;
             }
         }
@@ -4004,13 +4002,13 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
             // enum eEnumName { value1, value2 };
 
             if (in_func >= 0) {
-                cc_error("enum declaration not allowed here");
+                cc_compile_error("enum declaration not allowed here");
                 return -1;
             }
 
             int enumName = targ.getnext();
             if (sym.get_type(enumName) != 0) {
-                cc_error("'%s' is already defined",sym.get_friendly_name(enumName).c_str());
+                cc_compile_error("'%s' is already defined",sym.get_friendly_name(enumName).c_str());
                 return -1;
             }
             sym.entries[enumName].stype = SYM_VARTYPE;
@@ -4019,7 +4017,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
             sym.entries[enumName].vartype = sym.normalIntSym;
 
             if (sym.get_type(targ.getnext()) != SYM_OPENBRACE) {
-                cc_error("expected '{'");
+                cc_compile_error("expected '{'");
                 return -1;
             }
 
@@ -4077,19 +4075,19 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                         break;
                     }
                     else if (sym.get_type(nextSym) != SYM_COMMA) {
-                        cc_error("enum parse error at '%s'", sym.get_friendly_name(nextSym).c_str());
+                        cc_compile_error("enum parse error at '%s'", sym.get_friendly_name(nextSym).c_str());
                         return -1;
                     }
 
                 }
                 else {
-                    cc_error("unexpected '%s'", sym.get_friendly_name(nextOne).c_str());
+                    cc_compile_error("unexpected '%s'", sym.get_friendly_name(nextOne).c_str());
                     return -1;
                 }
             }
 
             if (sym.get_type(targ.getnext()) != SYM_SEMICOLON) {
-                cc_error("expected ';'");
+                cc_compile_error("expected ';'");
                 return -1;
             }
 
@@ -4097,38 +4095,38 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
         else if (symType == SYM_BUILTIN) {
             next_is_builtin = 1;
             if (sym.get_type(targ.peeknext()) != SYM_MANAGED && sym.get_type(targ.peeknext()) != SYM_STRUCT) {
-                cc_error("Invalid use of 'builtin'");
+                cc_compile_error("Invalid use of 'builtin'");
                 return -1;
             }
         }
         else if (symType == SYM_MANAGED) {
             next_is_managed = 1;
             if (sym.get_type(targ.peeknext()) != SYM_STRUCT) {
-                cc_error("Invalid use of 'managed'");
+                cc_compile_error("Invalid use of 'managed'");
                 return -1;
             }
         }
         else if (symType == SYM_AUTOPTR) {
             next_is_autoptr = 1;
             if (sym.get_type(targ.peeknext()) != SYM_MANAGED && sym.get_type(targ.peeknext()) != SYM_BUILTIN) {
-                cc_error("Invalid use of 'autoptr'");
+                cc_compile_error("Invalid use of 'autoptr'");
                 return -1;
             }
         }
         else if (symType == SYM_STRINGSTRUCT) {
             next_is_stringstruct = 1;
             if (sym.stringStructSym > 0) {
-                cc_error("stringstruct already defined");
+                cc_compile_error("stringstruct already defined");
                 return -1;
             }
             if (sym.get_type(targ.peeknext()) != SYM_AUTOPTR) {
-                cc_error("Invalid use of 'stringstruct'");
+                cc_compile_error("Invalid use of 'stringstruct'");
                 return -1;
             }
         }
         else if (symType == SYM_IMPORT) {
             if (in_func >= 0) {
-                cc_error("'import' not allowed inside function body");
+                cc_compile_error("'import' not allowed inside function body");
                 return -1;
             }
 
@@ -4139,44 +4137,44 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
 
             if ((sym.get_type(targ.peeknext()) != SYM_VARTYPE) &&
                 (sym.get_type(targ.peeknext()) != SYM_READONLY)) {
-                    cc_error("expected variable or function after import, not '%s'", sym.get_friendly_name(targ.peeknext()).c_str());
+                    cc_compile_error("expected variable or function after import, not '%s'", sym.get_friendly_name(targ.peeknext()).c_str());
                     return -1;
             }
         }
         else if (symType == SYM_STATIC) {
             if (in_func >= 0) {
-                cc_error("'static' not allowed inside function body");
+                cc_compile_error("'static' not allowed inside function body");
                 return -1;
             }
             next_is_static = 1;
             if ((sym.get_type(targ.peeknext()) != SYM_VARTYPE) &&
                 (sym.get_type(targ.peeknext()) != SYM_READONLY)) {
-                    cc_error("expected variable or function after static");
+                    cc_compile_error("expected variable or function after static");
                     return -1;
             }
         }
         else if (symType == SYM_PROTECTED) {
             if (in_func >= 0) {
-                cc_error("'protected' not allowed here");
+                cc_compile_error("'protected' not allowed here");
                 return -1;
             }
             next_is_protected = 1;
             if ((sym.get_type(targ.peeknext()) != SYM_VARTYPE) &&
                 (sym.get_type(targ.peeknext()) != SYM_STATIC) &&
                 (sym.get_type(targ.peeknext()) != SYM_READONLY)) {
-                    cc_error("expected function after protected");
+                    cc_compile_error("expected function after protected");
                     return -1;
             }
         }
         else if (symType == SYM_READONLY) {
             next_is_readonly = 1;
             if (sym.get_type(targ.peeknext()) != SYM_VARTYPE) {
-                cc_error("expected variable after readonly");
+                cc_compile_error("expected variable after readonly");
                 return -1;
             }
         }
         else if (symType == SYM_CONST) {
-            cc_error("'const' is only valid for function parameters (use 'readonly' instead)");
+            cc_compile_error("'const' is only valid for function parameters (use 'readonly' instead)");
             return -1;
         }
         else if (symType == SYM_EXPORT) {
@@ -4185,19 +4183,19 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
             while (sym.get_type(cursym) != SYM_SEMICOLON) {
                 int nextype = sym.get_type(cursym);
                 if (nextype == 0) {
-                    cc_error("cannot export undefined symbol '%s'",sym.get_friendly_name(cursym).c_str());
+                    cc_compile_error("cannot export undefined symbol '%s'",sym.get_friendly_name(cursym).c_str());
                     return -1;
                 }
                 if ((nextype != SYM_GLOBALVAR) && (nextype != SYM_FUNCTION)) {
-                    cc_error("invalid export symbol '%s'",sym.get_friendly_name(cursym).c_str());
+                    cc_compile_error("invalid export symbol '%s'",sym.get_friendly_name(cursym).c_str());
                     return -1;
                 }
                 if (sym.entries[cursym].flags & SFLG_IMPORTED) {
-                    cc_error("cannot export an import");
+                    cc_compile_error("cannot export an import");
                     return -1;
                 }
                 if (sym.entries[cursym].flags & SFLG_ISSTRING) {
-                    cc_error("cannot export string; use char[200] instead");
+                    cc_compile_error("cannot export string; use char[200] instead");
                     return -1;
                 }
                 // if all functions are being exported anyway, don't bother doing
@@ -4213,7 +4211,7 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
                 cursym = targ.getnext();
                 if (sym.get_type(cursym) == SYM_SEMICOLON) break;
                 if (sym.get_type(cursym) != SYM_COMMA) {
-                    cc_error("export parse error at '%s'",sym.get_friendly_name(cursym).c_str());
+                    cc_compile_error("export parse error at '%s'",sym.get_friendly_name(cursym).c_str());
                     return -1;
                 }
                 cursym = targ.getnext();
@@ -4226,11 +4224,11 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
             if ((nested_type[nested_level] == NEST_IFSINGLE) ||
                 (nested_type[nested_level] == NEST_ELSESINGLE) ||
                 (nested_type[nested_level] == NEST_DOSINGLE)) {
-                    cc_error("Unexpected '%s'",sym.get_friendly_name(cursym).c_str());
+                    cc_compile_error("Unexpected '%s'",sym.get_friendly_name(cursym).c_str());
                     return -1;
             }
             if ((nested_type[nested_level] == NEST_SWITCH)) {
-                cc_error("Variable declaration may be skipped by case label. Use braces to limit its scope or move it outside the switch statement block");
+                cc_compile_error("Variable declaration may be skipped by case label. Use braces to limit its scope or move it outside the switch statement block");
                 return -1;
             }
 
@@ -4244,11 +4242,11 @@ int __cc_compile_file(const char*inpl,ccCompiledScript*scrip) {
             if (strcmp(sym.get_name(targ.peeknext()), "*") == 0) {
                 // only allow pointers to structs
                 if ((sym.entries[vtwas].flags & SFLG_STRUCTTYPE) == 0) {
-                    cc_error("Cannot create pointer to basic type");
+                    cc_compile_error("Cannot create pointer to basic type");
                     return -1;
                 }
                 if (sym.entries[vtwas].flags & SFLG_AUTOPTR) {
-                    cc_error("Invalid use of '*'");
+                    cc_compile_error("Invalid use of '*'");
                     return -1;
                 }
                 isPointer = 1;
@@ -4288,7 +4286,7 @@ startvarbit:
                 const char *mfullname = get_member_full_name(cursym, whichmember);
                 cursym = sym.find(mfullname);
                 if (cursym < 0) {
-                    cc_error("'%s' does not contain a function '%s'", sym.get_friendly_name(structSym).c_str(), sym.get_friendly_name(whichmember).c_str());
+                    cc_compile_error("'%s' does not contain a function '%s'", sym.get_friendly_name(structSym).c_str(), sym.get_friendly_name(whichmember).c_str());
                     return -1;
                 }
                 isMemberFunction = structSym;
@@ -4305,7 +4303,7 @@ startvarbit:
                     return -1;
             }
             if (sym.get_type(cursym) != 0 && (!isFunction && !isMemberFunction || sym.get_type(cursym) != SYM_VARTYPE || cursym <= sym.normalFloatSym)) {
-                cc_error("Variable '%s' is already defined",sym.get_friendly_name(cursym).c_str());
+                cc_compile_error("Variable '%s' is already defined",sym.get_friendly_name(cursym).c_str());
                 return -1;
             }
 
@@ -4324,7 +4322,7 @@ startvarbit:
                 if (member_function_definition)
                     sym.entries[cursym].flags |= SFLG_STRUCTMEMBER;
                 else if (next_is_static) {
-                    cc_error("'static' only applies to member functions");
+                    cc_compile_error("'static' only applies to member functions");
                     return -1;
                 }
 
@@ -4337,21 +4335,21 @@ startvarbit:
                 if (!next_is_import)
                     next_is_noloopcheck = loopCheckOff;
                 else if (loopCheckOff) {
-                    cc_error("'noloopcheck' cannot be applied to imported functions");
+                    cc_compile_error("'noloopcheck' cannot be applied to imported functions");
                     return -1;
                 }
 
             } // end if function
             else if (member_function_definition) {
-                cc_error("Expected '('");
+                cc_compile_error("Expected '('");
                 return -1;
             }
             else if (next_is_protected) {
-                cc_error("'protected' not valid in this context");
+                cc_compile_error("'protected' not valid in this context");
                 return -1;
             }
             else if (loopCheckOff) {
-                cc_error("'noloopcheck' not valid in this context");
+                cc_compile_error("'noloopcheck' not valid in this context");
                 return -1;
             }
             else {
@@ -4362,7 +4360,7 @@ startvarbit:
                 if (next_is_readonly)
                     sym.entries[cursym].flags |= SFLG_READONLY;
                 if (next_is_static) {
-                    cc_error("Invalid use of 'static'");
+                    cc_compile_error("Invalid use of 'static'");
                     return -1;
                 }
 
@@ -4379,26 +4377,26 @@ startvarbit:
             if (oldDefinition.stype) {
                 // there was a forward declaration -- check that
                 // the real declaration matches it
-                ccError = 0;
+                ccCompile.error = 0;
                 if (!isglobal)
-                    cc_error("Local variable cannot have the same name as an import");
+                    cc_compile_error("Local variable cannot have the same name as an import");
                 else if (oldDefinition.stype != sym.entries[cursym].stype)
-                    cc_error("Type of identifier differs from original declaration");
+                    cc_compile_error("Type of identifier differs from original declaration");
                 else if (oldDefinition.flags != (sym.entries[cursym].flags & ~SFLG_IMPORTED))
-                    cc_error("Attributes of identifier do not match prototype");
+                    cc_compile_error("Attributes of identifier do not match prototype");
                 else if (oldDefinition.ssize != sym.entries[cursym].ssize)
-                    cc_error("Size of identifier does not match prototype");
+                    cc_compile_error("Size of identifier does not match prototype");
                 else if ((sym.entries[cursym].flags & SFLG_ARRAY) && (oldDefinition.arrsize != sym.entries[cursym].arrsize))
-                    cc_error("Array size '%d' of identifier does not match prototype which is '%d'", sym.entries[cursym].arrsize, oldDefinition.arrsize);
+                    cc_compile_error("Array size '%d' of identifier does not match prototype which is '%d'", sym.entries[cursym].arrsize, oldDefinition.arrsize);
                 else if (oldDefinition.stype == SYM_FUNCTION) {
                     // function-only checks
                     if (oldDefinition.sscope != sym.entries[cursym].sscope)
-                        cc_error("Function declaration has wrong number of arguments to prototype");
+                        cc_compile_error("Function declaration has wrong number of arguments to prototype");
                     else {
                         // this is <= because the return type is the first one
                         for (int ii = 0; ii <= sym.entries[cursym].get_num_args(); ii++) {
                             if (oldDefinition.funcparamtypes[ii] != sym.entries[cursym].funcparamtypes[ii])
-                                cc_error("Parameter type does not match prototype");
+                                cc_compile_error("Parameter type does not match prototype");
 
                             // copy the default values from the function prototype
                             sym.entries[cursym].funcParamDefaultValues[ii] = oldDefinition.funcParamDefaultValues[ii];
@@ -4406,14 +4404,14 @@ startvarbit:
                         }
                     }
                 }
-                if (ccError)
+                if (ccCompile.error)
                     return -1;
             }
 
             continue;
         }
         else if (in_func < 0) {
-            cc_error("Parse error: unexpected '%s'",sym.get_friendly_name(cursym).c_str());
+            cc_compile_error("Parse error: unexpected '%s'",sym.get_friendly_name(cursym).c_str());
             return -1;
         }
         else if (symType == 0) {
@@ -4422,7 +4420,7 @@ startvarbit:
             if ((symname[0] <= 32) || (symname[0] >= 128))
                 sprintf (extratex, " (ASCII index %02X)", symname[0]);
 
-            cc_error("Undefined token '%s' %s", symname, extratex);
+            cc_compile_error("Undefined token '%s' %s", symname, extratex);
             return -1;
         }
         else {
@@ -4447,7 +4445,7 @@ startvarbit:
                     return -1;
 
                 if (sym.get_type(targ.getnext()) != SYM_SEMICOLON) {
-                    cc_error("Expected ';'");
+                    cc_compile_error("Expected ';'");
                     return -1;
                 }
 
@@ -4468,7 +4466,7 @@ startvarbit:
 
                 if (sym.get_type(targ.peeknext()) != SYM_SEMICOLON) {
                     if (functionReturnType == sym.normalVoidSym) {
-                        cc_error("Cannot return value from void function");
+                        cc_compile_error("Cannot return value from void function");
                         return -1;
                     }
 
@@ -4483,12 +4481,12 @@ startvarbit:
 
                     if ((is_string(scrip->ax_val_type)) &&
                         (scrip->ax_val_scope == SYM_LOCALVAR)) {
-                            cc_error("Cannot return local string from function");
+                            cc_compile_error("Cannot return local string from function");
                             return -1;
                     }
                 }
                 else if ((functionReturnType != sym.normalIntSym) && (functionReturnType != sym.normalVoidSym)) {
-                    cc_error("Must return a '%s' value from function", sym.get_friendly_name(functionReturnType).c_str());
+                    cc_compile_error("Must return a '%s' value from function", sym.get_friendly_name(functionReturnType).c_str());
                     return -1;
                 }
                 else {
@@ -4496,7 +4494,7 @@ startvarbit:
                 }
 
                 if (sym.get_type(targ.getnext()) != SYM_SEMICOLON) {
-                    cc_error("Parse error in 'return' clause");
+                    cc_compile_error("Parse error in 'return' clause");
                     return -1;
                 }
                 // count total space taken by all local variables
@@ -4513,7 +4511,7 @@ startvarbit:
                     // so that it can't be followed by an "else"
                     int iswhile = (sym.get_type(cursym) == SYM_WHILE);
                     if (sym.get_type(targ.peeknext()) != SYM_OPENPARENTHESIS) {
-                        cc_error("expected '('");
+                        cc_compile_error("expected '('");
                         return -1;
                     }
                     long oriaddr = scrip->codesize;
@@ -4567,14 +4565,14 @@ startvarbit:
                 nested_type[nested_level] = NEST_FOR;
                 nested_start[nested_level] = 0;
                 if (sym.get_type(targ.peeknext()) != SYM_OPENPARENTHESIS) {
-                    cc_error("expected '('");
+                    cc_compile_error("expected '('");
                     return -1;
                 }
                 targ.getnext(); // Skip the (
                 cursym = targ.getnext();
                 if (sym.get_type(cursym) != SYM_SEMICOLON) {
                     if(sym.get_type(cursym) == SYM_CLOSEPARENTHESIS) {
-                        cc_error("Missing ';' inside for loop declaration");
+                        cc_compile_error("Missing ';' inside for loop declaration");
                         return -1;
                     }
                     lilen = extract_variable_name(cursym, &targ, &vnlist[0], &funcAtOffs);
@@ -4589,11 +4587,11 @@ startvarbit:
                         if (strcmp(sym.get_name(targ.peeknext()), "*") == 0) {
                             // only allow pointers to structs
                             if ((sym.entries[vtwas].flags & SFLG_STRUCTTYPE) == 0) {
-                                cc_error("Cannot create pointer to basic type");
+                                cc_compile_error("Cannot create pointer to basic type");
                                 return -1;
                             }
                             if (sym.entries[vtwas].flags & SFLG_AUTOPTR) {
-                                cc_error("Invalid use of '*'");
+                                cc_compile_error("Invalid use of '*'");
                                 return -1;
                             }
                             isPointer = 1;
@@ -4604,7 +4602,7 @@ startvarbit:
                             isPointer = 1;
 
                         if (sym.get_type(targ.peeknext()) == SYM_LOOPCHECKOFF) {
-                            cc_error("'noloopcheck' is not applicable in this context");
+                            cc_compile_error("'noloopcheck' is not applicable in this context");
                             return -1;
                         }
 
@@ -4614,26 +4612,26 @@ startvarbit:
                             cursym = targ.getnext();
                             if (cursym == SCODE_META) {
                                 // eg. "int" was the last word in the file
-                                currentline = targ.lineAtEnd;
-                                cc_error("Unexpected end of file");
+                                ccCompile.currentline = targ.lineAtEnd;
+                                cc_compile_error("Unexpected end of file");
                                 return -1;
                             }
 
                             int next_type = sym.get_type(targ.peeknext());
                             if (next_type == SYM_MEMBERACCESS || next_type == SYM_OPENPARENTHESIS) {
-                                cc_error("Function declaration not allowed in for loop initialiser");
+                                cc_compile_error("Function declaration not allowed in for loop initialiser");
                                 return -1;
                             }
                             else if (sym.get_type(cursym) != 0) {
-                                cc_error("Variable '%s' is already defined",sym.get_name(cursym));
+                                cc_compile_error("Variable '%s' is already defined",sym.get_name(cursym));
                                 return -1;
                             }
                             else if (next_is_protected) {
-                                cc_error("'protected' not valid in this context");
+                                cc_compile_error("'protected' not valid in this context");
                                 return -1;
                             }
                             else if (next_is_static) {
-                                cc_error("Invalid use of 'static'");
+                                cc_compile_error("Invalid use of 'static'");
                                 return -1;
                             }
                             else {
@@ -4657,14 +4655,14 @@ startvarbit:
                 bool hasLimitCheck;
                 if (sym.get_type(targ.peeknext()) != SYM_SEMICOLON) {
                     if(sym.get_type(targ.peeknext()) == SYM_CLOSEPARENTHESIS) {
-                        cc_error("Missing ';' inside for loop declaration");
+                        cc_compile_error("Missing ';' inside for loop declaration");
                         return -1;
                     }
                     hasLimitCheck = true;
                     if (evaluate_expression(&targ,scrip,0,false))
                         return -1;
                     if (sym.get_type(targ.peeknext()) != SYM_SEMICOLON) {
-                        cc_error("expected ';'");
+                        cc_compile_error("expected ';'");
                         return -1;
                     }
                 }
@@ -4702,7 +4700,7 @@ startvarbit:
             }
             else if (sym.get_type(cursym) == SYM_SWITCH) {
                 if(sym.get_type(targ.peeknext()) != SYM_OPENPARENTHESIS) {
-                    cc_error("expected '('");
+                    cc_compile_error("expected '('");
                     return -1;
                 }
                 INC_NESTED_LEVEL;
@@ -4718,30 +4716,30 @@ startvarbit:
                 scrip->write_cmd1(SCMD_JMP, 0); // Placeholder for a jump to the lookup table
                 scrip->write_cmd1(SCMD_JMP, 0); // Placeholder for a jump to beyond the switch statement (for break)
                 if(sym.get_type(targ.peeknext()) != SYM_OPENBRACE) {
-                    cc_error("expected '{'");
+                    cc_compile_error("expected '{'");
                     return -1;
                 }
                 nested_assign_addr[nested_level] = -1; // Location of default: label
                 targ.getnext();
                 if(targ.peeknext() == SCODE_META) {
-                    currentline = targ.lineAtEnd;
-                    cc_error("Unexpected end of file");
+                    ccCompile.currentline = targ.lineAtEnd;
+                    cc_compile_error("Unexpected end of file");
                     return -1;
                 }
                 if(sym.get_type(targ.peeknext()) != SYM_CASE && sym.get_type(targ.peeknext()) != SYM_DEFAULT && sym.get_type(targ.peeknext()) != SYM_CLOSEBRACE) {
-                    cc_error("Invalid keyword '%s' in switch statement block", sym.get_name(targ.peeknext()));
+                    cc_compile_error("Invalid keyword '%s' in switch statement block", sym.get_name(targ.peeknext()));
                     return -1;
                 }
             }
             else if ((sym.get_type(cursym) == SYM_CASE) ||
                 (sym.get_type(cursym) == SYM_DEFAULT)) {
                 if(nested_type[nested_level] != NEST_SWITCH) {
-                    cc_error("Case label not valid outside switch statement block");
+                    cc_compile_error("Case label not valid outside switch statement block");
                     return -1;
                 }
                 if (sym.get_type(cursym) == SYM_DEFAULT) {
                     if(nested_assign_addr[nested_level] != -1) {
-                        cc_error("Multiple default labels in a switch statement block");
+                        cc_compile_error("Multiple default labels in a switch statement block");
                         return -1;
                     }
                     nested_assign_addr[nested_level] = scrip->codesize;
@@ -4763,7 +4761,7 @@ startvarbit:
                     yank_chunk(scrip, &nested_chunk[nested_level], oriaddr, orifixupcount);
                 }
                 if(sym.get_type(targ.peeknext()) != SYM_LABEL) {
-                    cc_error("expected ':'");
+                    cc_compile_error("expected ':'");
                     return -1;
                 }
                 targ.getnext();
@@ -4775,7 +4773,7 @@ startvarbit:
                     loop_level--;
                 if (loop_level > 0) {
                     if (sym.get_type(targ.getnext()) != SYM_SEMICOLON) {
-                        cc_error("expected ';'");
+                        cc_compile_error("expected ';'");
                         return -1;
                     }
                     int totalsub = remove_locals(loop_level - 1, 1, scrip);
@@ -4789,7 +4787,7 @@ startvarbit:
                         scrip->write_cmd1(SCMD_JMP, -(scrip->codesize - nested_info[loop_level] + 3)); // Jump to the known break point
                 }
                 else {
-                    cc_error("Break only valid inside a loop or switch statement block");
+                    cc_compile_error("Break only valid inside a loop or switch statement block");
                     return -1;
                 }
             }
@@ -4800,7 +4798,7 @@ startvarbit:
                     loop_level--;
                 if (loop_level > 0) {
                     if (sym.get_type(targ.getnext()) != SYM_SEMICOLON) {
-                        cc_error("expected ';'");
+                        cc_compile_error("expected ';'");
                         return -1;
                     }
                     int totalsub = remove_locals(loop_level - 1, 1, scrip);
@@ -4814,12 +4812,12 @@ startvarbit:
                     scrip->write_cmd1(SCMD_JMP, -((scrip->codesize+2) - nested_start[loop_level])); // Jump to the start of the loop
                 }
                 else {
-                    cc_error("Continue not valid outside a loop");
+                    cc_compile_error("Continue not valid outside a loop");
                     return -1;
                 }
             }
             else {
-                cc_error("PE04: parse error at '%s'",sym.get_friendly_name(cursym).c_str());
+                cc_compile_error("PE04: parse error at '%s'",sym.get_friendly_name(cursym).c_str());
                 return -1;
             }
             // sort out jumps when a single-line if or else has finished
@@ -4838,8 +4836,8 @@ startvarbit:
         }
     }
     if ((in_func >= 0) || (nested_level > 0)) {
-        currentline = targ.lineAtEnd;
-        cc_error("Function still open, missing }");
+        ccCompile.currentline = targ.lineAtEnd;
+        cc_compile_error("Function still open, missing }");
         return -1;
     }
     return 0;
@@ -4851,10 +4849,10 @@ int cc_compile(const char*inpl, ccCompiledScript*scrip) {
     int toret = 0;
     /* this malloc might not alloc enough memory
     char*mainbuf=(char*)malloc(strlen(inpl)+5000);
-    ccError = 0;
+    ccCompile.error = 0;
     // run the preprocessor on the code
     cc_preprocess(inpl, mainbuf);
-    if (ccError) return -1;
+    if (ccCompile.error) return -1;
     // now, compile the preprocessed code
     if (__cc_compile_file(mainbuf,scrip))
     toret=-1;
@@ -1,8 +1,6 @@
 #include "gtest/gtest.h"
 #include "script/cc_internallist.h"
-
-// defined in script_common, modified by getnext
-extern int currentline; 
+#include "script/cc_compilecontext.h"
 
 
 TEST(InternalList, Constructor) {
@@ -136,18 +134,18 @@ TEST(InternalList, GetNext) {
 	tlist.write(6);
 	tlist.write(8);
 
-	currentline = 42;
+	ccCompile.currentline = 42;
 	tlist.startread();
 	ASSERT_TRUE (tlist.getnext() == 2);
-	ASSERT_TRUE (currentline == 42);  // no line meta sym
+	ASSERT_TRUE (ccCompile.currentline == 42);  // no line meta sym
 	ASSERT_TRUE (tlist.getnext() == 4);
-	ASSERT_TRUE (currentline == 42);
+	ASSERT_TRUE (ccCompile.currentline == 42);
 	ASSERT_TRUE (tlist.getnext() == 6);
-	ASSERT_TRUE (currentline == 42);
+	ASSERT_TRUE (ccCompile.currentline == 42);
 	ASSERT_TRUE (tlist.getnext() == 8);
-	ASSERT_TRUE (currentline == 42);
+	ASSERT_TRUE (ccCompile.currentline == 42);
 	ASSERT_TRUE (tlist.getnext() == SCODE_INVALID);
-	ASSERT_TRUE (currentline == -10);
+	ASSERT_TRUE (ccCompile.currentline == -10);
 	}
 	
 	// cancelCurrentLine == false
@@ -155,13 +153,13 @@ TEST(InternalList, GetNext) {
 	ccInternalList tlist;
 	tlist.write(3);
 
-	currentline = 74;
+	ccCompile.currentline = 74;
 	tlist.startread();
 	tlist.cancelCurrentLine = 0;
 	ASSERT_TRUE (tlist.getnext() == 3);
-	ASSERT_TRUE (currentline == 74); 
+	ASSERT_TRUE (ccCompile.currentline == 74); 
 	ASSERT_TRUE (tlist.getnext() == SCODE_INVALID);
-	ASSERT_TRUE (currentline == 74);
+	ASSERT_TRUE (ccCompile.currentline == 74);
 	}
 
 	// set current line
@@ -170,11 +168,11 @@ TEST(InternalList, GetNext) {
 	tlist.write_meta(SMETA_LINENUM, 101);
 	tlist.write(7);
 
-	currentline = 100;
+	ccCompile.currentline = 100;
 	tlist.startread();
-	ASSERT_TRUE (currentline == 100); 
+	ASSERT_TRUE (ccCompile.currentline == 100); 
 	ASSERT_TRUE (tlist.getnext() == 7);
-	ASSERT_TRUE (currentline == 101); 
+	ASSERT_TRUE (ccCompile.currentline == 101); 
 	}
 
 	// set lineAtEnd
@@ -184,7 +182,7 @@ TEST(InternalList, GetNext) {
 	tlist.write_meta(SMETA_END, 0); // value ignored
 	tlist.write(7);
 
-	currentline = 100;
+	ccCompile.currentline = 100;
 	tlist.startread();
 	ASSERT_TRUE (tlist.lineAtEnd == -1); 
 	ASSERT_TRUE (tlist.getnext() == SCODE_META);//<-- weird!  we return the start of the meta code.
@@ -200,11 +198,11 @@ TEST(InternalList, GetNext) {
 	tlist.write_meta(SMETA_LINENUM, 104);
 	tlist.write(7);
 
-	currentline = 100;
+	ccCompile.currentline = 100;
 	tlist.startread();
-	ASSERT_TRUE (currentline == 100); 
+	ASSERT_TRUE (ccCompile.currentline == 100); 
 	ASSERT_TRUE (tlist.getnext() == 7);
-	ASSERT_TRUE (currentline == 104); 
+	ASSERT_TRUE (ccCompile.currentline == 104); 
 	}
 
 	// meta , no data
@@ -213,11 +211,11 @@ TEST(InternalList, GetNext) {
 	tlist.write_meta(SMETA_LINENUM, 101);
 	tlist.write_meta(SMETA_LINENUM, 102);
 
-	currentline = 100;
+	ccCompile.currentline = 100;
 	tlist.startread();
 	tlist.cancelCurrentLine = 0;
-	ASSERT_TRUE (currentline == 100); 
+	ASSERT_TRUE (ccCompile.currentline == 100); 
 	ASSERT_TRUE (tlist.getnext() == SCODE_INVALID);
-	ASSERT_TRUE (currentline == 102); 
+	ASSERT_TRUE (ccCompile.currentline == 102); 
 	}
 }
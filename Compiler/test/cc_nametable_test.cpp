@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cc_nametable.h"
+#include "script/cc_macrotable.h"
+#include "script/cc_treemap.h"
+
+TEST(NameTable, AddAndFind) {
+	ccNameTable names;
+	ASSERT_TRUE (names.find("a") == -1);
+	ASSERT_TRUE (names.add("a") == 0);
+	ASSERT_TRUE (names.add("b") == 1);
+	ASSERT_TRUE (names.add("a") == 0);
+	ASSERT_TRUE (names.find("b") == 1);
+	ASSERT_TRUE (names.find("B") == -1);
+	ASSERT_TRUE (names.get_count() == 2);
+	ASSERT_STREQ ("b", names.get(1));
+}
+
+TEST(NameTable, ManyNames) {
+	ccNameTable names;
+	char buf[32];
+	for (int i = 0; i < 10000; i++) {
+		sprintf(buf, "name%d", i);
+		ASSERT_TRUE (names.add(buf) == i);
+	}
+	for (int i = 0; i < 10000; i++) {
+		sprintf(buf, "name%d", i);
+		ASSERT_TRUE (names.find(buf) == i);
+		ASSERT_STREQ (buf, names.get(i));
+	}
+	ccNameTable copy = names;
+	names.clear();
+	ASSERT_TRUE (names.find("name5") == -1);
+	ASSERT_TRUE (copy.find("name5") == 5);
+}
+
+TEST(MacroTable, AddFindRemove) {
+	MacroTable table;
+	table.add("A", "1");
+	table.add("B", "2");
+	ASSERT_TRUE (table.find_name("B") == 1);
+	ASSERT_STREQ ("2", table.get_macro(1));
+	table.remove(0);
+	ASSERT_TRUE (table.find_name("A") == -1);
+	table.add("A", "3");
+	ASSERT_STREQ ("3", table.get_macro(table.find_name("A")));
+
+	MacroTable merged;
+	merged.add("C", "4");
+	merged.merge(&table);
+	ASSERT_STREQ ("2", merged.get_macro(merged.find_name("B")));
+	ASSERT_STREQ ("4", merged.get_macro(merged.find_name("C")));
+}
+
+TEST(MacroTable, NoLimit) {
+	MacroTable table;
+	char buf[32];
+	for (int i = 0; i < 5000; i++) {
+		sprintf(buf, "MACRO_%d", i);
+		table.add(buf, "value");
+	}
+	ASSERT_TRUE (table.get_count() == 5000);
+	ASSERT_TRUE (table.find_name("MACRO_4999") == 4999);
+}
+
+// Looks up identifiers the way the tokenizer does, in the symbol table's
+// hash table and in a std::map which it used before.
+// Disabled by default, run with --gtest_also_run_disabled_tests
+TEST(NameTable, DISABLED_LookupBenchmark) {
+	const int symbol_count = 20000;
+	const int lookup_count = 2000000;
+	std::vector<std::string> tokens;
+	char buf[64];
+	for (int i = 0; i < symbol_count; i++) {
+		sprintf(buf, "GameObject%d_Property%d", i % 97, i);
+		tokens.push_back(buf);
+	}
+
+	ccTreeMap tree;
+	std::map<std::string, int> map;
+	for (int i = 0; i < symbol_count; i++) {
+		tree.addEntry(tokens[i].c_str(), i);
+		map[tokens[i]] = i;
+	}
+
+	long sum_tree = 0;
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < lookup_count; i++)
+		sum_tree += tree.findValue(tokens[(i * 7919u) % symbol_count].c_str());
+	double time_tree = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	long sum_map = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < lookup_count; i++) {
+		std::string key(tokens[(i * 7919u) % symbol_count].c_str());
+		if (map.count(key) > 0)
+			sum_map += map[key];
+	}
+	double time_map = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+	ASSERT_TRUE (sum_tree == sum_map);
+	printf("Symbol lookup: %d names, %d lookups: hash table %.1f ms, std::map %.1f ms\n",
+		symbol_count, lookup_count, time_tree, time_map);
+}
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "script/cs_compiler.h"
+#include "script/cc_error.h"
+#include "script/cc_options.h"
+#include "script/cc_script.h"
+
+// Makes a header which declares things like the built-in game header does
+static std::string make_test_header(int count) {
+    std::string header;
+    char buf[512];
+    for (int i = 0; i < count; i++) {
+        sprintf(buf, "\
+            enum TestEnum%d { eTestA%d, eTestB%d = 5, eTestC%d };\n\
+            managed struct TestType%d {\n\
+              import int Do%d(int a, int b = 0);\n\
+              import static TestType%d* Create(int value);\n\
+              readonly import attribute int Value;\n\
+              int Data;\n\
+            };\n\
+            import int testVar%d;\n\
+            import TestType%d* testObj%d;\n\
+            import int TestFunc%d(int a, float b, TestEnum%d c = eTestA%d);\n",
+            i, i, i, i, i, i, i, i, i, i, i, i, i);
+        header += buf;
+    }
+    return header;
+}
+
+// Makes a room script which uses some of the header's declarations
+static std::string make_test_room(int room, int header_count) {
+    char buf[1024];
+    const int a = room % header_count;
+    const int b = (room * 7) % header_count;
+    sprintf(buf, "\
+        int roomVar;\n\
+        int room_Load() {\n\
+          TestFunc%d(testVar%d, 2.0, eTestB%d);\n\
+          TestType%d *obj = TestType%d.Create(%d);\n\
+          obj.Do%d(roomVar);\n\
+          roomVar = testObj%d.Value + obj.Data;\n\
+        }\n\
+        int room_AfterFadeIn() {\n\
+          int i = 0;\n\
+          while (i < %d) { i++; roomVar += i; }\n\
+          if (roomVar > 10) TestFunc%d(roomVar, 0.5);\n\
+        }\n",
+        a, b, a, b, b, room, b, a, room + 1, b);
+    return buf;
+}
+
+static bool scripts_equal(ccScript *s1, ccScript *s2) {
+    if ((s1->globaldatasize != s2->globaldatasize) || (s1->codesize != s2->codesize) ||
+        (s1->stringssize != s2->stringssize) || (s1->numfixups != s2->numfixups) ||
+        (s1->numimports != s2->numimports) || (s1->numexports != s2->numexports) ||
+        (s1->numSections != s2->numSections))
+        return false;
+    if ((memcmp(s1->globaldata, s2->globaldata, s1->globaldatasize) != 0) ||
+        (memcmp(s1->code, s2->code, s1->codesize * sizeof(intptr_t)) != 0) ||
+        (memcmp(s1->strings, s2->strings, s1->stringssize) != 0) ||
+        (memcmp(s1->fixups, s2->fixups, s1->numfixups * sizeof(int32_t)) != 0) ||
+        (memcmp(s1->fixuptypes, s2->fixuptypes, s1->numfixups) != 0))
+        return false;
+    for (int i = 0; i < s1->numimports; i++) {
+        if (strcmp(s1->imports[i], s2->imports[i]) != 0)
+            return false;
+    }
+    for (int i = 0; i < s1->numexports; i++) {
+        if ((strcmp(s1->exports[i], s2->exports[i]) != 0) || (s1->export_addr[i] != s2->export_addr[i]))
+            return false;
+    }
+    for (int i = 0; i < s1->numSections; i++) {
+        if ((strcmp(s1->sectionNames[i], s2->sectionNames[i]) != 0) || (s1->sectionOffsets[i] != s2->sectionOffsets[i]))
+            return false;
+    }
+    return true;
+}
+
+TEST(Compile, PrecompiledHeadersSameResult) {
+    std::string header = make_test_header(20);
+    std::string header2 = make_test_header(21);
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(&header[0], "Header");
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+
+    for (int room = 0; room < 10; room++) {
+        std::string room_script = make_test_room(room, 20);
+        ccResetPrecompiledHeaders();
+        ccScript *compiled = ccCompileText(room_script.c_str(), "room");
+        if (!compiled) printf("%s line %d: %s\n", ccCurScriptName, ccErrorLine, ccErrorString.GetCStr());
+        ASSERT_TRUE(compiled != NULL);
+        // once with the headers compiled by the first call, and once more
+        // to make sure the first use did not change the saved headers
+        for (int i = 0; i < 2; i++) {
+            ccScript *precompiled = ccCompileText(room_script.c_str(), "room");
+            ASSERT_TRUE(precompiled != NULL);
+            EXPECT_TRUE(scripts_equal(compiled, precompiled));
+            delete precompiled;
+        }
+        delete compiled;
+    }
+
+    // the changed header and options are compiled again
+    std::string room_script = make_test_room(20, 21);
+    ccScript *compiled = ccCompileText(room_script.c_str(), "room");
+    EXPECT_TRUE(compiled == NULL);
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(&header2[0], "Header");
+    compiled = ccCompileText(room_script.c_str(), "room");
+    if (!compiled) printf("%s line %d: %s\n", ccCurScriptName, ccErrorLine, ccErrorString.GetCStr());
+    ASSERT_TRUE(compiled != NULL);
+    ccSetOption(SCOPT_LINENUMBERS, 0);
+    ccScript *compiled2 = ccCompileText(room_script.c_str(), "room");
+    ASSERT_TRUE(compiled2 != NULL);
+    EXPECT_LT(compiled2->codesize, compiled->codesize);
+    delete compiled;
+    delete compiled2;
+
+    // header errors are reported on every compilation
+    std::string bad_header = header + "import int testVar0;";
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(&bad_header[0], "Header");
+    for (int i = 0; i < 2; i++) {
+        EXPECT_TRUE(ccCompileText(room_script.c_str(), "room") == NULL);
+        EXPECT_NE(0, ccError);
+    }
+
+    ccRemoveDefaultHeaders();
+    ccResetPrecompiledHeaders();
+}
+
+TEST(Compile, CompileTextsInParallel) {
+    const int room_count = 40;
+    std::string header = make_test_header(20);
+    std::vector<std::string> rooms;
+    for (int room = 0; room < room_count; room++)
+        rooms.push_back(make_test_room(room, 20));
+    // these two fail, and the first of them must always be reported
+    rooms[17] = "int room_Load() { UnknownFunc(); }";
+    rooms[31] = "int room_Load() { int a = ; }";
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(&header[0], "Header");
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+    ccResetPrecompiledHeaders();
+
+    std::vector<ccCompileTask> tasks(room_count);
+    for (int room = 0; room < room_count; room++) {
+        tasks[room].script = rooms[room].c_str();
+        tasks[room].scriptName = "room";
+    }
+    EXPECT_EQ(17, ccCompileTexts(&tasks[0], room_count, 4));
+    EXPECT_NE(0, ccError);
+    EXPECT_STREQ("room", ccCurScriptName);
+    EXPECT_STREQ(tasks[17].errorString.GetCStr(), ccErrorString.GetCStr());
+    EXPECT_TRUE(tasks[31].compiled == NULL);
+    EXPECT_FALSE(tasks[31].errorString.IsEmpty());
+
+    for (int room = 0; room < room_count; room++) {
+        ccScript *compiled = ccCompileText(rooms[room].c_str(), "room");
+        EXPECT_EQ(compiled == NULL, tasks[room].compiled == NULL);
+        if (compiled && tasks[room].compiled)
+            EXPECT_TRUE(scripts_equal(compiled, tasks[room].compiled));
+        else if (!compiled)
+            EXPECT_STREQ(ccErrorString.GetCStr(), tasks[room].errorString.GetCStr());
+        delete compiled;
+        delete tasks[room].compiled;
+    }
+
+    ccRemoveDefaultHeaders();
+    ccResetPrecompiledHeaders();
+}
+
+TEST(Compile, CompileTextsErrorScriptNameOutlivesTasks) {
+    ccRemoveDefaultHeaders();
+    ccResetPrecompiledHeaders();
+    {
+        std::string name = "room7";
+        std::vector<ccCompileTask> tasks(1);
+        tasks[0].script = "int room_Load() { UnknownFunc(); }";
+        tasks[0].scriptName = name.c_str();
+        EXPECT_EQ(0, ccCompileTexts(&tasks[0], 1, 1));
+    }
+    // the reported name does not point into the freed task
+    EXPECT_STREQ("room7", ccCurScriptName);
+    ccResetPrecompiledHeaders();
+}
+
+// Compiles a game with many rooms, the way the editor does it, with and
+// without reusing the compiled headers, and on all CPU cores.
+// Disabled by default, run with --gtest_also_run_disabled_tests
+TEST(Compile, DISABLED_ManyRoomsBenchmark) {
+    const int header_count = 300;
+    const int room_count = 200;
+    std::string header = make_test_header(header_count);
+    std::vector<std::string> rooms;
+    for (int room = 0; room < room_count; room++)
+        rooms.push_back(make_test_room(room, header_count));
+    ccRemoveDefaultHeaders();
+    ccAddDefaultHeader(&header[0], "Header");
+    ccSetOption(SCOPT_EXPORTALL, 1);
+    ccSetOption(SCOPT_LINENUMBERS, 1);
+
+    for (int precompiled = 0; precompiled < 2; precompiled++) {
+        ccResetPrecompiledHeaders();
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        for (int room = 0; room < room_count; room++) {
+            if (!precompiled)
+                ccResetPrecompiledHeaders();
+            ccScript *compiled = ccCompileText(rooms[room].c_str(), "room");
+            if (!compiled) printf("%s line %d: %s\n", ccCurScriptName, ccErrorLine, ccErrorString.GetCStr());
+            ASSERT_TRUE(compiled != NULL);
+            delete compiled;
+        }
+        printf("Compile: %d rooms, %s: %.1f ms\n", room_count,
+            precompiled ? "precompiled headers" : "headers compiled for each room",
+            std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+    }
+
+    std::vector<ccCompileTask> tasks(room_count);
+    for (int room = 0; room < room_count; room++) {
+        tasks[room].script = rooms[room].c_str();
+        tasks[room].scriptName = "room";
+    }
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    EXPECT_EQ(-1, ccCompileTexts(&tasks[0], room_count, 0));
+    printf("Compile: %d rooms, precompiled headers, in parallel: %.1f ms\n", room_count,
+        std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+    for (int room = 0; room < room_count; room++)
+        delete tasks[room].compiled;
+
+    ccRemoveDefaultHeaders();
+    ccResetPrecompiledHeaders();
+}
@@ -3,12 +3,12 @@
 #include "script/cs_parser.h"
 #include "script/cc_symboltable.h"
 #include "script/cc_internallist.h"
+#include "script/cc_compilecontext.h"
 #include "util/string.h"
 
 typedef AGS::Common::String AGSString;
 
 extern int cc_tokenize(const char*inpl, ccInternalList*targ, ccCompiledScript*scrip);
-extern int currentline; // in script/script_common
 
 std::string last_cc_error_buf;
 void clear_error()
@@ -27,7 +27,7 @@ std::pair<AGSString, AGSString> cc_error_at_line(const char *error_msg)
 {
     // printf("error: %s\n", error_msg);
     last_cc_error_buf = _strdup(error_msg);
-    return std::make_pair(AGSString::FromFormat("Error (line %d): %s", currentline, error_msg), AGSString());
+    return std::make_pair(AGSString::FromFormat("Error (line %d): %s", ccCompile.currentline, error_msg), AGSString());
 }
 
 AGSString cc_error_without_line(const char *error_msg)
@@ -1048,7 +1048,8 @@ enum EventType {
   eEventGUIMouseUp = 6,
   eEventAddInventory = 7,
   eEventLoseInventory = 8,
-  eEventRestoreGame = 9
+  eEventRestoreGame = 9,
+  eEventSaveGame = 10
 };
 
 enum GUIPopupStyle {
@@ -565,7 +565,7 @@ const char* save_sprites(bool compressSprites)
     else if (spriteset.AttachFile(backupname)) {
       errorMsg = "An error occurred attaching to the backup sprite file. Check write permissions on your game folder";
     }
-    else if (spriteset.SaveToFile(sprsetname, compressSprites)) {
+    else if (spriteset.SaveToFile(sprsetname, compressSprites ? kSprCompress_RLE : kSprCompress_None)) {
       errorMsg = "Unable to save the sprites. An error occurred writing the sprite file.";
     }
 
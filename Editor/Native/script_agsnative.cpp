@@ -2,16 +2,17 @@
 // Implementation for script specific to AGS.Native library
 //
 
+#pragma unmanaged
+
 #include <utility>
+#include "script/cc_compilecontext.h"
 #include "util/string.h"
 
 using namespace AGS::Common;
 
-extern int currentline; // in script/script_common
-
 std::pair<String, String> cc_error_at_line(const char *error_msg)
 {
-    return std::make_pair(String::FromFormat("Error (line %d): %s", currentline, error_msg), String());
+    return std::make_pair(String::FromFormat("Error (line %d): %s", ccCompile.currentline, error_msg), String());
 }
 
 String cc_error_without_line(const char *error_msg)
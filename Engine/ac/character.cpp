@@ -293,6 +293,7 @@ void Character_ChangeView(CharacterInfo *chap, int vii) {
     chap->walkwait = 0;
     charextra[chap->index_id].animwait = 0;
     FindReasonableLoopForCharacter(chap);
+    prefetch_view_loop(chap->view, chap->loop);
 }
 
 enum DirectionalLoop
@@ -1633,6 +1634,77 @@ int Character_GetSpeakingFrame(CharacterInfo *chaa) {
 // order of loops to turn character in circle from down to down
 int turnlooporder[8] = {0, 6, 1, 7, 3, 5, 2, 4};
 
+// Walk which waits for its route to be found
+struct PendingWalk
+{
+    int  Char;
+    int  IgnoreWalls;
+    bool AutoWalkAnims;
+    int  WaitWas;
+    int  AnimWaitWas;
+};
+
+// Whether walks are collected to find their routes all at once
+bool walk_batch_active = false;
+std::vector<PendingWalk> pending_walks;
+std::vector<RouteRequest> pending_routes;
+
+// Starts the walk along the found route, or stops character if there's none
+void start_character_walk(int chac, int mslot, int ignwal, bool autoWalkAnims, int waitWas, int animWaitWas)
+{
+    CharacterInfo*chin=&game.chars[chac];
+    if (mslot>0) {
+        chin->walking = mslot;
+        mls[mslot].direct = ignwal;
+
+        // cancel any pending waits on current animations
+        // or if they were already moving, keep the current wait - 
+        // this prevents a glitch if MoveCharacter is called when they
+        // are already moving
+        if (autoWalkAnims)
+        {
+            chin->walkwait = waitWas;
+            charextra[chac].animwait = animWaitWas;
+
+            if (mls[mslot].pos[0] != mls[mslot].pos[1]) {
+                fix_player_sprite(&mls[mslot],chin);
+            }
+        }
+        else
+            chin->flags |= CHF_MOVENOTWALK;
+    }
+    else if (autoWalkAnims) // pathfinder couldn't get a route, stand them still
+        chin->frame = 0;
+}
+
+void begin_walk_batch()
+{
+    walk_batch_active = true;
+}
+
+void flush_walk_batch()
+{
+    if (pending_walks.empty())
+        return;
+
+    find_routes(pending_routes);
+    for (size_t i = 0; i < pending_walks.size(); ++i)
+    {
+        const PendingWalk &walk = pending_walks[i];
+        start_character_walk(walk.Char, pending_routes[i].Result, walk.IgnoreWalls,
+            walk.AutoWalkAnims, walk.WaitWas, walk.AnimWaitWas);
+        delete pending_routes[i].Mask;
+    }
+    pending_walks.clear();
+    pending_routes.clear();
+}
+
+void end_walk_batch()
+{
+    flush_walk_batch();
+    walk_batch_active = false;
+}
+
 void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     CharacterInfo*chin=&game.chars[chac];
     if (chin->room!=displayed_room)
@@ -1686,31 +1758,53 @@ void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims) {
     }
 
     set_route_move_speed(move_speed_x, move_speed_y);
-    set_color_depth(8);
-    int mslot=find_route(charX, charY, tox, toy, prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal);
-    set_color_depth(game.GetColorDepth());
-    if (mslot>0) {
-        chin->walking = mslot;
-        mls[mslot].direct = ignwal;
 
-        // cancel any pending waits on current animations
-        // or if they were already moving, keep the current wait - 
-        // this prevents a glitch if MoveCharacter is called when they
-        // are already moving
-        if (autoWalkAnims)
+    if (walk_batch_active)
+    {
+        // the walkable mask of a blocking character depends on the frames of
+        // other characters, which are only chosen when the walk starts
+        if ((chin->flags & CHF_NOBLOCKING) == 0)
         {
-            chin->walkwait = waitWas;
-            charextra[chac].animwait = animWaitWas;
-
-            if (mls[mslot].pos[0] != mls[mslot].pos[1]) {
-                fix_player_sprite(&mls[mslot],chin);
+            for (size_t i = 0; i < pending_walks.size(); ++i)
+            {
+                if ((game.chars[pending_walks[i].Char].flags & CHF_NOBLOCKING) == 0)
+                {
+                    flush_walk_batch();
+                    break;
+                }
             }
         }
-        else
-            chin->flags |= CHF_MOVENOTWALK;
+
+        set_color_depth(8);
+        RouteRequest route;
+        route.FromX = charX;
+        route.FromY = charY;
+        route.DestX = tox;
+        route.DestY = toy;
+        route.Mask = BitmapHelper::CreateBitmapCopy(prepare_walkable_areas(chac), 8);
+        route.MoveList = chac+CHMLSOFFS;
+        route.NoCross = 1;
+        route.IgnoreWalls = ignwal;
+        route.SpeedX = move_speed_x;
+        route.SpeedY = move_speed_y;
+        route.Result = 0;
+        set_color_depth(game.GetColorDepth());
+        pending_routes.push_back(route);
+
+        PendingWalk walk;
+        walk.Char = chac;
+        walk.IgnoreWalls = ignwal;
+        walk.AutoWalkAnims = autoWalkAnims;
+        walk.WaitWas = waitWas;
+        walk.AnimWaitWas = animWaitWas;
+        pending_walks.push_back(walk);
+        return;
     }
-    else if (autoWalkAnims) // pathfinder couldn't get a route, stand them still
-        chin->frame = 0;
+
+    set_color_depth(8);
+    int mslot=find_route(charX, charY, tox, toy, prepare_walkable_areas(chac), chac+CHMLSOFFS, 1, ignwal);
+    set_color_depth(game.GetColorDepth());
+    start_character_walk(chac, mslot, ignwal, autoWalkAnims, waitWas, animWaitWas);
 }
 
 int find_looporder_index (int curloop) {
@@ -2111,6 +2205,7 @@ void animate_character(CharacterInfo *chap, int loopn,int sppd,int rept, int noi
         chap->frame=0;
 
     chap->wait = sppd + views[chap->view].loops[loopn].frames[chap->frame].speed;
+    prefetch_view_loop(chap->view, chap->loop);
     CheckViewFrameForCharacter(chap);
 }
 
@@ -161,6 +161,11 @@ using namespace AGS; // FIXME later
 
 void animate_character(CharacterInfo *chap, int loopn,int sppd,int rept, int noidleoverride, int direction);
 void walk_character(int chac,int tox,int toy,int ignwal, bool autoWalkAnims);
+// Makes walk_character collect the walks and find their routes together,
+// when the batch is flushed or ended; the characters stay still until then
+void begin_walk_batch();
+void flush_walk_batch();
+void end_walk_batch();
 int  find_looporder_index (int curloop);
 // returns 0 to use diagonal, 1 to not
 int  useDiagonal (CharacterInfo *char1);
@@ -13,9 +13,11 @@
 //=============================================================================
 
 #include <algorithm>
+#include <memory>
 #include "aastr.h"
 #include "ac/common.h"
 #include "util/compress.h"
+#include "util/threadpool.h"
 #include "ac/view.h"
 #include "ac/charactercache.h"
 #include "ac/characterextras.h"
@@ -42,12 +44,14 @@
 #include "ac/spritelistentry.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/transformedspritecache.h"
 #include "ac/viewframe.h"
 #include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
 #include "ac/dynobj/scriptsystem.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/out.h"
 #include "font/fonts.h"
 #include "gui/guimain.h"
 #include "media/audio/audio.h"
@@ -92,6 +96,8 @@ extern IDriverDependantBitmap *walkBehindBitmap[MAX_WALK_BEHINDS];
 extern int walkBehindsCachedForBgNum;
 extern WalkBehindMethodEnum walkBehindMethod;
 extern int walk_behind_baselines_changed;
+extern std::vector<WalkBehindSpan> walkBehindSpans;
+extern std::vector<int> walkBehindRowSpans;
 extern SpriteCache spriteset;
 extern RoomStatus*croom;
 extern int our_eip;
@@ -160,6 +166,10 @@ IDriverDependantBitmap* roomBackgroundBmp = NULL;
 // For more details see comment in ALSoftwareGraphicsDriver::RenderToBackBuffer().
 PBitmap RoomCameraBuffer;  // this is the actual bitmap
 PBitmap RoomCameraFrame;   // this is either same bitmap reference or sub-bitmap
+// Virtual screen regions changed during the frame, for the software renderer to present
+static std::vector<Rect> ScreenRegionsToPresent;
+// Worker threads which help preparing character and object sprites, if enabled
+std::unique_ptr<ThreadPool> SpritePrepareThreads;
 
 
 std::vector<SpriteListEntry> sprlist;
@@ -333,6 +343,24 @@ Bitmap *AdjustBitmapForUseWithDisplayMode(Bitmap* bitmap, bool has_alpha)
     return new_bitmap;
 }
 
+bool IsBitmapAdjustedInPlace(Bitmap *bitmap, bool has_alpha)
+{
+    // NOTE: must match the conditions in AdjustBitmapForUseWithDisplayMode
+    const int bmp_col_depth = bitmap->GetColorDepth();
+    const int game_col_depth = game.GetColorDepth();
+#if defined (AGS_INVERTED_COLOR_ORDER)
+    if (System_GetColorDepth() > 16 && bmp_col_depth == 32)
+        return true;
+#endif
+    if (game_col_depth == 32 && bmp_col_depth == 32)
+        return has_alpha;
+    if (game_col_depth == 32 && (bmp_col_depth > 8 && bmp_col_depth <= 16))
+        return false;
+    if (game_col_depth <= 16 && bmp_col_depth > 16)
+        return false;
+    return convert_16bit_bgr == 1 && bmp_col_depth == 16;
+}
+
 Bitmap *ReplaceBitmapWithSupportedFormat(Bitmap *bitmap)
 {
     Bitmap *new_bitmap = GfxUtil::ConvertBitmap(bitmap, gfxDriver->GetCompatibleBitmapFormat(bitmap->GetColorDepth()));
@@ -446,6 +474,13 @@ void init_draw_method()
         walkBehindMethod = DrawOverCharSprite;
     }
 
+    // only the software renderer has sprite preparation work to share
+    if (walkBehindMethod == DrawOverCharSprite && usetup.RenderThreads != 1)
+    {
+        SpritePrepareThreads.reset(new ThreadPool(usetup.RenderThreads));
+        Debug::Printf(kDbgMsg_Init, "Preparing sprites using %d threads", SpritePrepareThreads->GetThreadCount());
+    }
+
     on_mainviewport_changed();
     on_roomviewport_changed();
     on_camera_size_changed();
@@ -455,6 +490,7 @@ void dispose_draw_method()
 {
     dispose_room_drawdata();
     destroy_invalid_regions();
+    SpritePrepareThreads.reset();
     destroy_blank_image();
 }
 
@@ -674,6 +710,15 @@ void write_screen() {
         }
     }
 
+    // Software renderer may present only the changed parts of the virtual screen,
+    // unless plugins are allowed to paint over it
+    if (gfxDriver->UsesMemoryBackBuffer())
+    {
+        if (get_changed_screen_regions(ScreenRegionsToPresent) && displayed_room >= 0 && at_yp == 0 &&
+            !pl_any_want_hook(AGSE_PRERENDER | AGSE_PRESCREENDRAW | AGSE_PREGUIDRAW | AGSE_POSTSCREENDRAW | AGSE_FINALSCREENDRAW))
+            gfxDriver->SetMemoryBackBufferDirtyRegions(ScreenRegionsToPresent);
+    }
+
     if (play.screen_tint < 1)
         gfxDriver->SetScreenTint(0, 0, 0);
     else
@@ -743,127 +788,147 @@ void invalidate_cached_walkbehinds()
     memset(&actspswbcache[0], 0, sizeof(CachedActSpsData) * actSpsCount);
 }
 
-// sort_out_walk_behinds: modifies the supplied sprite by overwriting parts
-// of it with transparent pixels where there are walk-behind areas
-// Returns whether any pixels were updated
-int sort_out_walk_behinds(Bitmap *sprit,int xx,int yy,int basel, Bitmap *copyPixelsFrom = NULL, Bitmap *checkPixelsFrom = NULL, int zoom=100) {
-    if (noWalkBehindsAtAll)
-        return 0;
+// 24-bit pixel, copied and compared as a whole
+struct Pixel24
+{
+    uint8_t Bytes[3];
+};
 
-    if ((!thisroom.WalkBehindMask->IsMemoryBitmap()) ||
-        (!sprit->IsMemoryBitmap()))
-        quit("!sort_out_walk_behinds: wb bitmap not linear");
+inline bool operator !=(const Pixel24 &a, const Pixel24 &b)
+{
+    return memcmp(a.Bytes, b.Bytes, sizeof(a.Bytes)) != 0;
+}
 
-    int rr,tmm, toheight;//,tcol;
-    // precalculate this to try and shave some time off
-    int maskcol = sprit->GetMaskColor();
-    int spcoldep = sprit->GetColorDepth();
-    int screenhit = thisroom.WalkBehindMask->GetHeight();
-    short *shptr, *shptr2;
-    int *loptr, *loptr2;
-    int pixelsChanged = 0;
-    int ee = 0;
-    if (xx < 0)
-        ee = 0 - xx;
+template <typename TPixel>
+TPixel make_pixel(int color)
+{
+    // takes the lowest bytes of color
+    TPixel px;
+    memcpy(&px, &color, sizeof(TPixel));
+    return px;
+}
 
-    if ((checkPixelsFrom != NULL) && (checkPixelsFrom->GetColorDepth() != spcoldep))
-        quit("sprite colour depth does not match background colour depth");
+// Does the work of sort_out_walk_behinds for the particular pixel format;
+// goes through the walk-behind mask spans which overlap the sprite
+template <typename TPixel>
+int sort_out_walk_behinds_spans(Bitmap *sprit, int xx, int yy, int basel,
+    Bitmap *copyPixelsFrom, Bitmap *checkPixelsFrom, int zoom)
+{
+    const TPixel maskcol = make_pixel<TPixel>(sprit->GetMaskColor());
+    // sprite columns and rows which are inside the mask
+    const int x_from = std::max(0, -xx);
+    const int x_to = std::min(sprit->GetWidth(), thisroom.WalkBehindMask->GetWidth() - xx);
+    const int y_from = std::max(0, -yy);
+    const int y_to = std::min(sprit->GetHeight(), thisroom.WalkBehindMask->GetHeight() - yy);
+    if (x_from >= x_to)
+        return 0;
 
-    for ( ; ee < sprit->GetWidth(); ee++) {
-        if (ee + xx >= thisroom.WalkBehindMask->GetWidth())
-            break;
+    // columns of the zoomed sprite checked for transparency
+    std::vector<int> check_x;
+    if (copyPixelsFrom != NULL && zoom != 100)
+    {
+        check_x.resize(x_to);
+        for (int ee = x_from; ee < x_to; ee++)
+            check_x[ee] = (ee * 100) / zoom;
+    }
 
-        if ((!walkBehindExists[ee+xx]) ||
-            (walkBehindEndY[ee+xx] <= yy) ||
-            (walkBehindStartY[ee+xx] > yy+sprit->GetHeight()))
+    int pixelsChanged = 0;
+    for (int rr = y_from; rr < y_to; rr++)
+    {
+        const int span_from = walkBehindRowSpans[rr + yy];
+        const int span_to = walkBehindRowSpans[rr + yy + 1];
+        if (span_from == span_to)
             continue;
 
-        toheight = sprit->GetHeight();
+        TPixel *sprite_line = (TPixel*)sprit->GetScanLineForWriting(rr);
+        const TPixel *check_line = NULL, *bg_line = NULL;
+        if (copyPixelsFrom != NULL)
+        {
+            check_line = (const TPixel*)checkPixelsFrom->GetScanLine((rr * 100) / zoom);
+            bg_line = (const TPixel*)copyPixelsFrom->GetScanLine(rr + yy);
+        }
 
-        if (walkBehindStartY[ee+xx] < yy)
-            rr = 0;
-        else
-            rr = (walkBehindStartY[ee+xx] - yy);
-
-        // Since we will use _getpixel, ensure we only check within the screen
-        if (rr + yy < 0)
-            rr = 0 - yy;
-        if (toheight + yy > screenhit)
-            toheight = screenhit - yy;
-        if (toheight + yy > walkBehindEndY[ee+xx])
-            toheight = walkBehindEndY[ee+xx] - yy;
-        if (rr < 0)
-            rr = 0;
-
-        for ( ; rr < toheight;rr++) {
-
-            // we're ok with _getpixel because we've checked the screen edges
-            //tmm = _getpixel(thisroom.WalkBehindMask,ee+xx,rr+yy);
-            // actually, _getpixel is well inefficient, do it ourselves
-            // since we know it's 8-bit bitmap
-            tmm = thisroom.WalkBehindMask->GetScanLine(rr+yy)[ee+xx];
-            if (tmm<1) continue;
-            if (croom->walkbehind_base[tmm] <= basel) continue;
-
-            if (copyPixelsFrom != NULL)
+        for (int i = span_from; i < span_to; i++)
+        {
+            const WalkBehindSpan &span = walkBehindSpans[i];
+            if (croom->walkbehind_base[span.Area] <= basel)
+                continue;
+            const int x1 = std::max(span.X1 - xx, x_from);
+            const int x2 = std::min(span.X2 - xx, x_to);
+            if (x1 >= x2)
+                continue;
+
+            if (copyPixelsFrom == NULL)
+            {
+                std::fill(sprite_line + x1, sprite_line + x2, maskcol);
+                pixelsChanged = 1;
+            }
+            else if (zoom == 100)
             {
-                if (spcoldep <= 8)
+                for (int ee = x1; ee < x2; ee++)
                 {
-                    if (checkPixelsFrom->GetScanLine((rr * 100) / zoom)[(ee * 100) / zoom] != maskcol) {
-                        sprit->GetScanLineForWriting(rr)[ee] = copyPixelsFrom->GetScanLine(rr + yy)[ee + xx];
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep <= 16) {
-                    shptr = (short*)&sprit->GetScanLine(rr)[0];
-                    shptr2 = (short*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (shptr2[(ee * 100) / zoom] != maskcol) {
-                        shptr[ee] = ((short*)(&copyPixelsFrom->GetScanLine(rr + yy)[0]))[ee + xx];
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep == 24) {
-                    char *chptr = (char*)&sprit->GetScanLine(rr)[0];
-                    char *chptr2 = (char*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (memcmp(&chptr2[((ee * 100) / zoom) * 3], &maskcol, 3) != 0) {
-                        memcpy(&chptr[ee * 3], &copyPixelsFrom->GetScanLine(rr + yy)[(ee + xx) * 3], 3);
-                        pixelsChanged = 1;
-                    }
-                }
-                else if (spcoldep <= 32) {
-                    loptr = (int*)&sprit->GetScanLine(rr)[0];
-                    loptr2 = (int*)&checkPixelsFrom->GetScanLine((rr * 100) / zoom)[0];
-                    if (loptr2[(ee * 100) / zoom] != maskcol) {
-                        loptr[ee] = ((int*)(&copyPixelsFrom->GetScanLine(rr + yy)[0]))[ee + xx];
+                    if (check_line[ee] != maskcol)
+                    {
+                        sprite_line[ee] = bg_line[ee + xx];
                         pixelsChanged = 1;
                     }
                 }
             }
             else
             {
-                pixelsChanged = 1;
-                if (spcoldep <= 8)
-                    sprit->GetScanLineForWriting(rr)[ee] = maskcol;
-                else if (spcoldep <= 16) {
-                    shptr = (short*)&sprit->GetScanLine(rr)[0];
-                    shptr[ee] = maskcol;
-                }
-                else if (spcoldep == 24) {
-                    char *chptr = (char*)&sprit->GetScanLine(rr)[0];
-                    memcpy(&chptr[ee * 3], &maskcol, 3);
-                }
-                else if (spcoldep <= 32) {
-                    loptr = (int*)&sprit->GetScanLine(rr)[0];
-                    loptr[ee] = maskcol;
+                for (int ee = x1; ee < x2; ee++)
+                {
+                    if (check_line[check_x[ee]] != maskcol)
+                    {
+                        sprite_line[ee] = bg_line[ee + xx];
+                        pixelsChanged = 1;
+                    }
                 }
-                else
-                    quit("!Sprite colour depth >32 ??");
             }
         }
     }
     return pixelsChanged;
 }
 
+// Checks that the walk-behinds may be cut out of the sprite, quits otherwise
+void check_walk_behinds_target(Bitmap *sprit, Bitmap *checkPixelsFrom) {
+    if ((!thisroom.WalkBehindMask->IsMemoryBitmap()) ||
+        (!sprit->IsMemoryBitmap()))
+        quit("!sort_out_walk_behinds: wb bitmap not linear");
+
+    int spcoldep = sprit->GetColorDepth();
+    if ((checkPixelsFrom != NULL) && (checkPixelsFrom->GetColorDepth() != spcoldep))
+        quit("sprite colour depth does not match background colour depth");
+    if (spcoldep > 32)
+        quit("!Sprite colour depth >32 ??");
+}
+
+// Does the work of sort_out_walk_behinds without checking its arguments;
+// only reads the room state, so may be called from the worker threads
+int cut_walk_behinds(Bitmap *sprit, int xx, int yy, int basel, Bitmap *copyPixelsFrom, Bitmap *checkPixelsFrom, int zoom) {
+    int spcoldep = sprit->GetColorDepth();
+    if (spcoldep <= 8)
+        return sort_out_walk_behinds_spans<uint8_t>(sprit, xx, yy, basel, copyPixelsFrom, checkPixelsFrom, zoom);
+    else if (spcoldep <= 16)
+        return sort_out_walk_behinds_spans<uint16_t>(sprit, xx, yy, basel, copyPixelsFrom, checkPixelsFrom, zoom);
+    else if (spcoldep == 24)
+        return sort_out_walk_behinds_spans<Pixel24>(sprit, xx, yy, basel, copyPixelsFrom, checkPixelsFrom, zoom);
+    else if (spcoldep <= 32)
+        return sort_out_walk_behinds_spans<uint32_t>(sprit, xx, yy, basel, copyPixelsFrom, checkPixelsFrom, zoom);
+    return 0;
+}
+
+// sort_out_walk_behinds: modifies the supplied sprite by overwriting parts
+// of it with transparent pixels where there are walk-behind areas
+// Returns whether any pixels were updated
+int sort_out_walk_behinds(Bitmap *sprit,int xx,int yy,int basel, Bitmap *copyPixelsFrom = NULL, Bitmap *checkPixelsFrom = NULL, int zoom=100) {
+    if (noWalkBehindsAtAll)
+        return 0;
+
+    check_walk_behinds_target(sprit, checkPixelsFrom);
+    return cut_walk_behinds(sprit, xx, yy, basel, copyPixelsFrom, checkPixelsFrom, zoom);
+}
+
 void sort_out_char_sprite_walk_behind(int actspsIndex, int xx, int yy, int basel, int zoom, int width, int height)
 {
     if (noWalkBehindsAtAll)
@@ -1186,7 +1251,7 @@ void apply_tint_or_light(int actspsindex, int light_level,
              lit_amnt = abs(light_level) * 2;
          }
 
-         active_spr->LitBlendBlt(oldwas, 0, 0, lit_amnt);
+         GfxUtil::LitBlendBlt(active_spr, oldwas, 0, 0, lit_amnt);
      }
 
      if (oldwas != blitFrom)
@@ -1284,6 +1349,60 @@ int scale_and_flip_sprite(int useindx, int coldept, int zoom_level,
 
 
 
+// Draws the specified 'sppic' sprite onto actsps[useindx] scaled, flipped
+// and tinted as necessary, reusing the image from the shared cache of
+// transformed sprites when possible.
+// Returns 1 if something was drawn to actsps; returns 0 if no changes to
+// the sprite were required, in which case nothing was done
+int transform_sprite(int useindx, int coldept, int zoom_level,
+                     int sppic, int newwidth, int newheight, int isMirrored,
+                     int light_level, int tint_amount, int tint_red,
+                     int tint_green, int tint_blue, int tint_light)
+{
+    const bool tinted = (light_level != 0) || (tint_amount != 0);
+    // 256-colour tinting depends on the current palette, so is not cached
+    const bool use_cache = (zoom_level != 100 || isMirrored || tinted) && game.color_depth > 1;
+    TransformedSpriteKey key;
+    if (use_cache)
+    {
+        key.Sprite = sppic;
+        key.Width = newwidth;
+        key.Height = newheight;
+        key.Mirrored = isMirrored != 0;
+        key.Antialiased = (zoom_level != 100) && (IS_ANTIALIAS_SPRITES);
+        key.TintAmount = tint_amount;
+        key.TintRed = tint_red;
+        key.TintGreen = tint_green;
+        key.TintBlue = tint_blue;
+        key.TintLight = tint_light;
+        key.LightLevel = light_level;
+        Bitmap *cached = transformed_sprites.Get(key);
+        if (cached)
+        {
+            actsps[useindx] = recycle_bitmap(actsps[useindx], cached->GetColorDepth(), cached->GetWidth(), cached->GetHeight());
+            actsps[useindx]->Blit(cached, 0, 0, 0, 0, cached->GetWidth(), cached->GetHeight());
+            return 1;
+        }
+    }
+
+    // draw the base sprite, scaled and flipped as appropriate
+    int actspsUsed = scale_and_flip_sprite(useindx, coldept, zoom_level,
+        sppic, newwidth, newheight, isMirrored);
+    if (tinted)
+    {
+        // apply the lightening or tinting, directly reading from the source
+        // image if possible
+        apply_tint_or_light(useindx, light_level, tint_amount, tint_red,
+            tint_green, tint_blue, tint_light, coldept,
+            actspsUsed ? NULL : spriteset[sppic]);
+        actspsUsed = 1;
+    }
+
+    if (use_cache)
+        transformed_sprites.Put(key, actsps[useindx]);
+    return actspsUsed;
+}
+
 // create the actsps[aa] image with the object drawn correctly
 // returns 1 if nothing at all has changed and actsps is still
 // intact from last time; 0 otherwise
@@ -1422,9 +1541,10 @@ int construct_object_gfx(int aa, int *drawnWidth, int *drawnHeight, bool alwaysU
     int actspsUsed = 0;
     if (!hardwareAccelerated)
     {
-        // draw the base sprite, scaled and flipped as appropriate
-        actspsUsed = scale_and_flip_sprite(useindx, coldept, zoom_level,
-            objs[aa].num, sprwidth, sprheight, isMirrored);
+        // draw the base sprite, scaled, flipped and tinted as appropriate
+        actspsUsed = transform_sprite(useindx, coldept, zoom_level,
+            objs[aa].num, sprwidth, sprheight, isMirrored, light_level,
+            (tint_level > 0) ? tint_level : 0, tint_red, tint_green, tint_blue, tint_light);
     }
     else
     {
@@ -1432,20 +1552,8 @@ int construct_object_gfx(int aa, int *drawnWidth, int *drawnHeight, bool alwaysU
         actsps[useindx] = recycle_bitmap(actsps[useindx], coldept, game.SpriteInfos[objs[aa].num].Width, game.SpriteInfos[objs[aa].num].Height);
     }
 
-    // direct read from source bitmap, where possible
-    Bitmap *comeFrom = NULL;
-    if (!actspsUsed)
-        comeFrom = spriteset[objs[aa].num];
-
-    // apply tints or lightenings where appropriate, else just copy
-    // the source bitmap
-    if (!hardwareAccelerated && ((tint_level > 0) || (light_level != 0)))
-    {
-        apply_tint_or_light(useindx, light_level, tint_level, tint_red,
-            tint_green, tint_blue, tint_light, coldept,
-            comeFrom);
-    }
-    else if (!actspsUsed) {
+    // just copy the source bitmap if nothing else was done
+    if (!actspsUsed) {
         actsps[useindx]->Blit(spriteset[objs[aa].num],0,0,0,0,game.SpriteInfos[objs[aa].num].Width, game.SpriteInfos[objs[aa].num].Height);
     }
 
@@ -1468,12 +1576,65 @@ int construct_object_gfx(int aa, int *drawnWidth, int *drawnHeight, bool alwaysU
 
 
 
+// Character or object sprite which image was prepared in actsps, along
+// with the details needed to finish it after walk-behinds are cut out
+struct PreparedSprite
+{
+    int  Index;          // character or object index
+    int  ActspsIndex;
+    int  Sprite;
+    int  X, Y;           // position on screen
+    int  RoomX, RoomY;   // position of the image in the room
+    int  Width, Height;
+    int  Baseline;
+    bool Mirrored;
+    bool ImageIntact;    // actsps image has not changed since the last time
+    bool CutWalkBehinds; // walk-behinds should be cut out of the actsps image
+};
+
+std::vector<PreparedSprite> preparedSprites;
+
+// Cuts walk-behinds out of the prepared sprites which require that. Each
+// sprite only has its own actsps image modified, so the work is split
+// between the worker threads, if there are any, without affecting results.
+void cut_prepared_walk_behinds()
+{
+    if (noWalkBehindsAtAll)
+        return;
+
+    std::vector<PreparedSprite*> cut_sprites;
+    for (size_t i = 0; i < preparedSprites.size(); ++i)
+    {
+        if (!preparedSprites[i].CutWalkBehinds)
+            continue;
+        check_walk_behinds_target(actsps[preparedSprites[i].ActspsIndex], NULL);
+        cut_sprites.push_back(&preparedSprites[i]);
+    }
+
+    const ThreadPool::Task cut_task = [&cut_sprites](size_t i)
+    {
+        const PreparedSprite &spr = *cut_sprites[i];
+        cut_walk_behinds(actsps[spr.ActspsIndex], spr.RoomX, spr.RoomY, spr.Baseline, NULL, NULL, 100);
+    };
+    if (SpritePrepareThreads)
+        SpritePrepareThreads->RunForEach(cut_sprites.size(), cut_task);
+    else
+        for (size_t i = 0; i < cut_sprites.size(); ++i)
+            cut_task(i);
+}
+
 // This is only called from draw_screen_background, but it's seperated
 // to help with profiling the program
 void prepare_objects_for_drawing() {
     int aa,atxp,atyp,useindx;
     our_eip=32;
 
+    // TODO: perhaps do not add camera position here, instead let the renderer do coordinate transform
+    const Rect &camera = play.GetRoomCamera();
+    int offsetx = camera.Left;
+    int offsety = camera.Top;
+
+    preparedSprites.clear();
     for (aa=0;aa<croom->numobj;aa++) {
         if (objs[aa].on != 1) continue;
         // offscreen, don't draw
@@ -1489,34 +1650,52 @@ void prepare_objects_for_drawing() {
         objcache[aa].xwas = objs[aa].x;
         objcache[aa].ywas = objs[aa].y;
 
-        // TODO: perhaps do not add camera position here, instead let the renderer do coordinate transform
-        const Rect &camera = play.GetRoomCamera();
-        int offsetx = camera.Left;
-        int offsety = camera.Top;
         atxp = objs[aa].x - offsetx;
         atyp = (objs[aa].y - tehHeight) - offsety;
 
         int usebasel = objs[aa].get_baseline();
 
-        if (objs[aa].flags & OBJF_NOWALKBEHINDS) {
-            // ignore walk-behinds, do nothing
-            if (walkBehindMethod == DrawAsSeparateSprite)
-            {
-                usebasel += thisroom.Height;
-            }
-        }
-        else if (walkBehindMethod == DrawAsSeparateCharSprite) 
+        if ((objs[aa].flags & OBJF_NOWALKBEHINDS) &&
+            (walkBehindMethod == DrawAsSeparateSprite))
         {
-            sort_out_char_sprite_walk_behind(useindx, atxp+offsetx, atyp+offsety, usebasel, objs[aa].last_zoom, objs[aa].last_width, objs[aa].last_height);
+            // ignore walk-behinds
+            usebasel += thisroom.Height;
         }
-        else if ((!actspsIntact) && (walkBehindMethod == DrawOverCharSprite))
+
+        PreparedSprite spr;
+        spr.Index = aa;
+        spr.ActspsIndex = useindx;
+        spr.Sprite = objs[aa].num;
+        spr.X = atxp;
+        spr.Y = atyp;
+        spr.RoomX = atxp + offsetx;
+        spr.RoomY = atyp + offsety;
+        spr.Width = objs[aa].last_width;
+        spr.Height = objs[aa].last_height;
+        spr.Baseline = usebasel;
+        spr.Mirrored = objcache[aa].mirroredWas != 0;
+        spr.ImageIntact = actspsIntact != 0;
+        spr.CutWalkBehinds = !actspsIntact && (walkBehindMethod == DrawOverCharSprite) &&
+            (objs[aa].flags & OBJF_NOWALKBEHINDS) == 0;
+        preparedSprites.push_back(spr);
+    }
+
+    cut_prepared_walk_behinds();
+
+    for (size_t i = 0; i < preparedSprites.size(); ++i) {
+        const PreparedSprite &spr = preparedSprites[i];
+        aa = spr.Index;
+        useindx = spr.ActspsIndex;
+
+        if (((objs[aa].flags & OBJF_NOWALKBEHINDS) == 0) &&
+            (walkBehindMethod == DrawAsSeparateCharSprite))
         {
-            sort_out_walk_behinds(actsps[useindx],atxp+offsetx,atyp+offsety,usebasel);
+            sort_out_char_sprite_walk_behind(useindx, spr.RoomX, spr.RoomY, spr.Baseline, objs[aa].last_zoom, spr.Width, spr.Height);
         }
 
-        if ((!actspsIntact) || (actspsbmp[useindx] == NULL))
+        if ((!spr.ImageIntact) || (actspsbmp[useindx] == NULL))
         {
-            bool hasAlpha = (game.SpriteInfos[objs[aa].num].Flags & SPF_ALPHACHANNEL) != 0;
+            bool hasAlpha = (game.SpriteInfos[spr.Sprite].Flags & SPF_ALPHACHANNEL) != 0;
 
             if (actspsbmp[useindx] != NULL)
                 gfxDriver->DestroyDDB(actspsbmp[useindx]);
@@ -1525,8 +1704,8 @@ void prepare_objects_for_drawing() {
 
         if (gfxDriver->HasAcceleratedTransform())
         {
-            actspsbmp[useindx]->SetFlippedLeftRight(objcache[aa].mirroredWas != 0);
-            actspsbmp[useindx]->SetStretch(objs[aa].last_width, objs[aa].last_height);
+            actspsbmp[useindx]->SetFlippedLeftRight(spr.Mirrored);
+            actspsbmp[useindx]->SetStretch(spr.Width, spr.Height);
             actspsbmp[useindx]->SetTint(objcache[aa].tintredwas, objcache[aa].tintgrnwas, objcache[aa].tintbluwas, (objcache[aa].tintamntwas * 256) / 100);
 
             if (objcache[aa].tintamntwas > 0)
@@ -1544,7 +1723,7 @@ void prepare_objects_for_drawing() {
                 actspsbmp[useindx]->SetLightLevel(0);
         }
 
-        add_to_sprite_list(actspsbmp[useindx],atxp,atyp,usebasel,objs[aa].transparent,objs[aa].num);
+        add_to_sprite_list(actspsbmp[useindx],spr.X,spr.Y,spr.Baseline,objs[aa].transparent,spr.Sprite);
     }
 
 }
@@ -1574,7 +1753,7 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
     if (light_level >= 100) {
         // fully colourised
         ds->FillTransparent();
-        ds->LitBlendBlt(srcimg, 0, 0, luminance);
+        GfxUtil::LitBlendBlt(ds, srcimg, 0, 0, luminance);
     }
     else {
         // light_level is between -100 and 100 normally; 0-100 in
@@ -1586,11 +1765,11 @@ void tint_image (Bitmap *ds, Bitmap *srcimg, int red, int grn, int blu, int ligh
         // Render the colourised image to a temporary bitmap,
         // then transparently draw it over the original image
         Bitmap *finaltarget = BitmapHelper::CreateTransparentBitmap(srcimg->GetWidth(), srcimg->GetHeight(), srcimg->GetColorDepth());
-        finaltarget->LitBlendBlt(srcimg, 0, 0, luminance);
+        GfxUtil::LitBlendBlt(finaltarget, srcimg, 0, 0, luminance);
 
         // customized trans blender to preserve alpha channel
         set_my_trans_blender (0, 0, 0, light_level);
-        ds->TransBlendBlt (finaltarget, 0, 0);
+        GfxUtil::TransBlendBlt(ds, finaltarget, 0, 0);
         delete finaltarget;
     }
 }
@@ -1611,6 +1790,7 @@ void prepare_characters_for_drawing() {
     int offsety = camera.Top;
 
     // draw characters
+    preparedSprites.clear();
     for (aa=0;aa<game.numcharacters;aa++) {
         if (game.chars[aa].on==0) continue;
         if (game.chars[aa].room!=displayed_room) continue;
@@ -1634,6 +1814,9 @@ void prepare_characters_for_drawing() {
                     chin->name, chin->loop, chin->view + 1);
         }
 
+        // have the rest of the loop ready by the time it's displayed
+        prefetch_view_loop(chin->view, chin->loop);
+
         sppic=views[chin->view].loops[chin->loop].frames[chin->frame].pic;
         if (sppic < 0)
             sppic = 0;  // in case it's screwed up somehow
@@ -1768,9 +1951,10 @@ void prepare_characters_for_drawing() {
             int actspsUsed = 0;
             if (!gfxDriver->HasAcceleratedTransform())
             {
-                actspsUsed = scale_and_flip_sprite(
+                actspsUsed = transform_sprite(
                     useindx, coldept, zoom_level, sppic,
-                    newwidth, newheight, isMirrored);
+                    newwidth, newheight, isMirrored, light_level,
+                    tint_amount, tint_red, tint_green, tint_blue, tint_light);
             }
             else 
             {
@@ -1780,19 +1964,7 @@ void prepare_characters_for_drawing() {
 
             our_eip = 335;
 
-            if (((light_level != 0) || (tint_amount != 0)) &&
-                (!gfxDriver->HasAcceleratedTransform())) {
-                    // apply the lightening or tinting
-                    Bitmap *comeFrom = NULL;
-                    // if possible, direct read from the source image
-                    if (!actspsUsed)
-                        comeFrom = spriteset[sppic];
-
-                    apply_tint_or_light(useindx, light_level, tint_amount, tint_red,
-                        tint_green, tint_blue, tint_light, coldept,
-                        comeFrom);
-            }
-            else if (!actspsUsed) {
+            if (!actspsUsed) {
                 // no scaling, flipping or tinting was done, so just blit it normally
                 actsps[useindx]->Blit (spriteset[sppic], 0, 0, 0, 0, actsps[useindx]->GetWidth(), actsps[useindx]->GetHeight());
             }
@@ -1815,33 +1987,65 @@ void prepare_characters_for_drawing() {
         int bgX = atxp + offsetx + chin->pic_xoffs;
         int bgY = atyp + offsety + chin->pic_yoffs;
 
-        if (chin->flags & CHF_NOWALKBEHINDS) {
-            // ignore walk-behinds, do nothing
-            if (walkBehindMethod == DrawAsSeparateSprite)
-            {
-                usebasel += thisroom.Height;
-            }
-        }
-        else if (walkBehindMethod == DrawAsSeparateCharSprite) 
+        if ((chin->flags & CHF_NOWALKBEHINDS) &&
+            (walkBehindMethod == DrawAsSeparateSprite))
         {
-            sort_out_char_sprite_walk_behind(useindx, bgX, bgY, usebasel, charextra[aa].zoom, newwidth, newheight);
+            // ignore walk-behinds
+            usebasel += thisroom.Height;
         }
-        else if (walkBehindMethod == DrawOverCharSprite)
+
+        PreparedSprite spr;
+        spr.Index = aa;
+        spr.ActspsIndex = useindx;
+        spr.Sprite = sppic;
+        spr.X = atxp;
+        spr.Y = atyp;
+        spr.RoomX = bgX;
+        spr.RoomY = bgY;
+        spr.Width = newwidth;
+        spr.Height = newheight;
+        spr.Baseline = usebasel;
+        spr.Mirrored = isMirrored != 0;
+        spr.ImageIntact = usingCachedImage;
+        spr.CutWalkBehinds = (walkBehindMethod == DrawOverCharSprite) &&
+            (chin->flags & CHF_NOWALKBEHINDS) == 0;
+        preparedSprites.push_back(spr);
+    }
+
+    cut_prepared_walk_behinds();
+
+    for (size_t i = 0; i < preparedSprites.size(); ++i) {
+        const PreparedSprite &spr = preparedSprites[i];
+        aa = spr.Index;
+        useindx = spr.ActspsIndex;
+        CharacterInfo*chin=&game.chars[aa];
+        eip_guinum = aa;
+        our_eip = 336;
+
+        if (((chin->flags & CHF_NOWALKBEHINDS) == 0) &&
+            (walkBehindMethod == DrawAsSeparateCharSprite))
         {
-            sort_out_walk_behinds(actsps[useindx], bgX, bgY, usebasel);
+            sort_out_char_sprite_walk_behind(useindx, spr.RoomX, spr.RoomY, spr.Baseline, charextra[aa].zoom, spr.Width, spr.Height);
         }
 
-        if ((!usingCachedImage) || (actspsbmp[useindx] == NULL))
+        if ((!spr.ImageIntact) || (actspsbmp[useindx] == NULL))
         {
-            bool hasAlpha = (game.SpriteInfos[sppic].Flags & SPF_ALPHACHANNEL) != 0;
+            bool hasAlpha = (game.SpriteInfos[spr.Sprite].Flags & SPF_ALPHACHANNEL) != 0;
 
             actspsbmp[useindx] = recycle_ddb_bitmap(actspsbmp[useindx], actsps[useindx], hasAlpha);
         }
 
         if (gfxDriver->HasAcceleratedTransform()) 
         {
-            actspsbmp[useindx]->SetStretch(newwidth, newheight);
-            actspsbmp[useindx]->SetFlippedLeftRight(isMirrored != 0);
+            tint_red = charcache[aa].tintredwas;
+            tint_green = charcache[aa].tintgrnwas;
+            tint_blue = charcache[aa].tintbluwas;
+            tint_amount = charcache[aa].tintamntwas;
+            tint_light = charcache[aa].tintlightwas;
+            light_level = charcache[aa].lightlevwas;
+
+            actspsbmp[useindx]->SetStretch(spr.Width, spr.Height);
+            actspsbmp[useindx]->SetFlippedLeftRight(spr.Mirrored);
             actspsbmp[useindx]->SetTint(tint_red, tint_green, tint_blue, (tint_amount * 256) / 100);
 
             if (tint_amount != 0)
@@ -1865,10 +2069,10 @@ void prepare_characters_for_drawing() {
         // alpha channel was lost in the tinting process)
         //if (((tint_level) && (tint_amount < 100)) || (light_level))
         //sppic = -1;
-        add_to_sprite_list(actspsbmp[useindx], atxp + chin->pic_xoffs, atyp + chin->pic_yoffs, usebasel, chin->transparency, sppic);
+        add_to_sprite_list(actspsbmp[useindx], spr.X + chin->pic_xoffs, spr.Y + chin->pic_yoffs, spr.Baseline, chin->transparency, spr.Sprite);
 
-        chin->actx=atxp+offsetx;
-        chin->acty=atyp+offsety;
+        chin->actx=spr.X+offsetx;
+        chin->acty=spr.Y+offsety;
     }
 }
 
@@ -2049,39 +2253,43 @@ void draw_gui_and_overlays() {
         }*/
         our_eip = 37;
         if (guis_need_update) {
-            //Bitmap *abufwas = ds;
+            // hidden GUIs keep this until they are displayed again
             guis_need_update = 0;
-            for (aa=0;aa<game.numgui;aa++) {
-                if (!guis[aa].IsDisplayed()) continue;
-
-                if (guibg[aa] == NULL)
-                    recreate_guibg_image(&guis[aa]);
-
-                eip_guinum = aa;
-                our_eip = 370;
-                guibg[aa]->ClearTransparent();
-                //ds = guibg[aa];
-                our_eip = 372;
-                guis[aa].DrawAt(guibg[aa], 0,0);
-                our_eip = 373;
-
-                bool isAlpha = false;
-                if (guis[aa].HasAlphaChannel()) 
-                {
-                    isAlpha = true;
-                }
+            for (aa=0;aa<game.numgui;aa++)
+                guis[aa].MarkChanged();
+        }
+        for (aa=0;aa<game.numgui;aa++) {
+            if (!guis[aa].IsDisplayed()) continue;
+            // only redraw the GUIs which contents have changed
+            if (!guis[aa].HasChanged() && guibgbmp[aa] != NULL) continue;
+
+            if (guibg[aa] == NULL)
+                recreate_guibg_image(&guis[aa]);
+
+            eip_guinum = aa;
+            our_eip = 370;
+            guibg[aa]->ClearTransparent();
+            our_eip = 372;
+            // reset before drawing, as drawing may mark the labels with macros again
+            guis[aa].ClearChanged();
+            guis[aa].DrawAt(guibg[aa], 0,0);
+            our_eip = 373;
+
+            bool isAlpha = false;
+            if (guis[aa].HasAlphaChannel()) 
+            {
+                isAlpha = true;
+            }
 
-                if (guibgbmp[aa] != NULL) 
-                {
-                    gfxDriver->UpdateDDBFromBitmap(guibgbmp[aa], guibg[aa], isAlpha);
-                }
-                else
-                {
-                    guibgbmp[aa] = gfxDriver->CreateDDBFromBitmap(guibg[aa], isAlpha);
-                }
-                our_eip = 374;
+            if (guibgbmp[aa] != NULL) 
+            {
+                gfxDriver->UpdateDDBFromBitmap(guibgbmp[aa], guibg[aa], isAlpha);
+            }
+            else
+            {
+                guibgbmp[aa] = gfxDriver->CreateDDBFromBitmap(guibg[aa], isAlpha);
             }
-            //ds = abufwas;
+            our_eip = 374;
         }
         our_eip = 38;
         // Draw the GUIs
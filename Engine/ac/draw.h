@@ -124,6 +124,9 @@ void setpal();
 // implementations while keeping code changes to minimum. The proper solution would probably
 // be to use shared pointers when storing Bitmaps, or make Bitmap reference-counted object.
 Common::Bitmap *ReplaceBitmapWithSupportedFormat(Common::Bitmap *bitmap);
+// Tells if PrepareSpriteForUse would modify the given bitmap's pixels
+// instead of creating a new bitmap
+bool IsBitmapAdjustedInPlace(Common::Bitmap *bitmap, bool has_alpha);
 // Checks if the bitmap needs any kind of adjustments before it may be used
 // in AGS sprite operations. Also handles number of certain special cases
 // (old systems or uncommon gfx modes, and similar stuff).
@@ -46,6 +46,8 @@ using namespace AGS::Engine;
 #define MAXDIRTYREGIONS 25
 #define WHOLESCREENDIRTY (MAXDIRTYREGIONS + 5)
 #define MAX_SPANS_PER_ROW 4
+// Max number of changed screen regions gathered in between presenting the screen
+#define MAXCHANGEDSCREENREGIONS 256
 
 // Dirty rects store coordinate values in the coordinate system of a camera surface,
 // where coords always span from 0,0 to surface width,height.
@@ -171,6 +173,10 @@ DirtyRects BlackRects;
 // TODO: support for multiple cameras (multiple DirtyRects objects)
 // Dirty rects object for the single room camera
 DirtyRects RoomCamRects;
+// Virtual screen regions that were repainted since the screen was last presented
+std::vector<Rect> ChangedScreenRegions;
+// Tells that too many regions were changed and the whole screen has to be presented
+bool WholeScreenChanged = false;
 
 void destroy_invalid_regions()
 {
@@ -423,11 +429,48 @@ void update_invalid_region(Bitmap *ds, color_t fill_color, const DirtyRects &rec
     }
 }
 
+// Remembers dirty regions in the virtual screen coordinates, for presenting them later
+void add_changed_screen_regions(const DirtyRects &rects)
+{
+    if (!rects.IsInit() || rects.NumDirtyRegions == 0 || WholeScreenChanged)
+        return;
+
+    if (rects.NumDirtyRegions == WHOLESCREENDIRTY)
+    {
+        ChangedScreenRegions.push_back(rects.Viewport);
+        return;
+    }
+
+    const std::vector<IRRow> &dirtyRow = rects.DirtyRows;
+    const int surf_height = rects.SurfaceSize.Height;
+    for (int i = 0, rowsInOne = 1; i < surf_height; i += rowsInOne, rowsInOne = 1)
+    {
+        while ((i + rowsInOne < surf_height) && (memcmp(&dirtyRow[i], &dirtyRow[i + rowsInOne], sizeof(IRRow)) == 0))
+            rowsInOne++;
+
+        const IRRow &dirty_row = dirtyRow[i];
+        for (int k = 0; k < dirty_row.numSpans; k++)
+        {
+            if (ChangedScreenRegions.size() >= MAXCHANGEDSCREENREGIONS)
+            {
+                WholeScreenChanged = true;
+                ChangedScreenRegions.clear();
+                return;
+            }
+            Rect src_r(dirty_row.span[k].x1, i, dirty_row.span[k].x2, i + rowsInOne - 1);
+            Rect dst_r = rects.Screen2DirtySurf.UnScaleRange(src_r);
+            // enlarge by a pixel, in case the scaled camera surface rounded the edges differently
+            ChangedScreenRegions.push_back(Rect(dst_r.Left - 1, dst_r.Top - 1, dst_r.Right + 1, dst_r.Bottom + 1));
+        }
+    }
+}
+
 void update_black_invreg_and_reset(Bitmap *ds)
 {
     if (!BlackRects.IsInit())
         return;
     update_invalid_region(ds, (color_t)0, BlackRects);
+    add_changed_screen_regions(BlackRects);
     BlackRects.Reset();
 }
 
@@ -437,5 +480,18 @@ void update_room_invreg_and_reset(int /*view_index*/, Bitmap *ds, Bitmap *src, b
         return;
     
     update_invalid_region(ds, src, RoomCamRects, no_transform);
+    add_changed_screen_regions(RoomCamRects);
     RoomCamRects.Reset();
 }
+
+bool get_changed_screen_regions(std::vector<Rect> &regions)
+{
+    // regions which are dirty now were painted over during this frame
+    add_changed_screen_regions(BlackRects);
+    add_changed_screen_regions(RoomCamRects);
+    const bool whole_screen = WholeScreenChanged;
+    regions.clear();
+    regions.swap(ChangedScreenRegions);
+    WholeScreenChanged = false;
+    return !whole_screen;
+}
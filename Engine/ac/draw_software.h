@@ -19,6 +19,7 @@
 #ifndef __AGS_EE_AC__DRAWSOFTWARE_H
 #define __AGS_EE_AC__DRAWSOFTWARE_H
 
+#include <vector>
 #include "gfx/bitmap.h"
 #include "gfx/ddb.h"
 #include "util/geometry.h"
@@ -35,5 +36,8 @@ void update_black_invreg_and_reset(AGS::Common::Bitmap *ds);
 // Copies the room regions marked as dirty from source (src) to destination (ds) with the given offset (x, y)
 // no_transform flag tells the system that the regions should be plain copied to the ds.
 void update_room_invreg_and_reset(int view_index, AGS::Common::Bitmap *ds, AGS::Common::Bitmap *src, bool no_transform);
+// Gathers the regions of the virtual screen which were repainted or marked as dirty since the last call;
+// returns false if there were too many of them, and the whole screen should be considered changed
+bool get_changed_screen_regions(std::vector<Rect> &regions);
 
 #endif // __AGS_EE_AC__DRAWSOFTWARE_H
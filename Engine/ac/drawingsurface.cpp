@@ -25,8 +25,10 @@
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
+#include "ac/transformedspritecache.h"
 #include "debug/debug_log.h"
 #include "font/fonts.h"
+#include "gui/guibutton.h"
 #include "gui/guimain.h"
 #include "ac/spritecache.h"
 #include "script/runtimescriptvalue.h"
@@ -69,6 +71,7 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
         {
             int tt;
             // force a refresh of any cached object or character images
+            transformed_sprites.InvalidateSprite(sds->dynamicSpriteNumber);
             if (croom != NULL) 
             {
                 for (tt = 0; tt < croom->numobj; tt++) 
@@ -84,12 +87,13 @@ void DrawingSurface_Release(ScriptDrawingSurface* sds)
             }
             for (tt = 0; tt < game.numgui; tt++) 
             {
-                if ((guis[tt].BgImage == sds->dynamicSpriteNumber) &&
-                    (guis[tt].IsDisplayed()))
-                {
-                    guis_need_update = 1;
-                    break;
-                }
+                if (guis[tt].BgImage == sds->dynamicSpriteNumber)
+                    guis[tt].MarkChanged();
+            }
+            for (tt = 0; tt < numguibuts; tt++) 
+            {
+                if (guibuts[tt].CurrentImage == sds->dynamicSpriteNumber)
+                    guibuts[tt].MarkChanged();
             }
         }
 
@@ -26,6 +26,7 @@
 #include "ac/roomobject.h"
 #include "ac/roomstatus.h"
 #include "ac/system.h"
+#include "ac/transformedspritecache.h"
 #include "debug/debug_log.h"
 #include "game/roomstruct.h"
 #include "gui/guibutton.h"
@@ -424,6 +425,7 @@ ScriptDynamicSprite* DynamicSprite_CreateFromBackground(int frame, int x1, int y
 void add_dynamic_sprite(int gotSlot, Bitmap *redin, bool hasAlpha) {
 
   spriteset.Set(gotSlot, redin);
+  transformed_sprites.InvalidateSprite(gotSlot);
 
   game.SpriteInfos[gotSlot].Flags = SPF_DYNAMICALLOC;
 
@@ -438,6 +440,16 @@ void add_dynamic_sprite(int gotSlot, Bitmap *redin, bool hasAlpha) {
   game.SpriteInfos[gotSlot].Height = redin->GetHeight();
 }
 
+void add_dynamic_sprite(int gotSlot, int width, int height, const SpriteCache::ImageLoader &loader) {
+
+  spriteset.SetDeferred(gotSlot, loader);
+  transformed_sprites.InvalidateSprite(gotSlot);
+
+  game.SpriteInfos[gotSlot].Flags = SPF_DYNAMICALLOC;
+  game.SpriteInfos[gotSlot].Width = width;
+  game.SpriteInfos[gotSlot].Height = height;
+}
+
 void free_dynamic_sprite (int gotSlot) {
   int tt;
 
@@ -447,8 +459,11 @@ void free_dynamic_sprite (int gotSlot) {
   if ((game.SpriteInfos[gotSlot].Flags & SPF_DYNAMICALLOC) == 0)
     quitprintf("!DeleteSprite: Attempted to free static sprite %d that was not loaded by the script", gotSlot);
 
-  delete spriteset[gotSlot];
+  // the image which was never requested does not have to be created
+  if (!spriteset.IsDeferred(gotSlot))
+    delete spriteset[gotSlot];
   spriteset.Set(gotSlot, NULL);
+  transformed_sprites.InvalidateSprite(gotSlot);
 
   game.SpriteInfos[gotSlot].Flags = 0;
   game.SpriteInfos[gotSlot].Width = 0;
@@ -20,6 +20,7 @@
 
 #include "ac/dynobj/scriptdynamicsprite.h"
 #include "ac/dynobj/scriptdrawingsurface.h"
+#include "ac/spritecache.h"
 
 void	DynamicSprite_Delete(ScriptDynamicSprite *sds);
 ScriptDrawingSurface* DynamicSprite_GetDrawingSurface(ScriptDynamicSprite *dss);
@@ -46,6 +47,8 @@ ScriptDynamicSprite* DynamicSprite_CreateFromBackground(int frame, int x1, int y
 
 
 void	add_dynamic_sprite(int gotSlot, Common::Bitmap *redin, bool hasAlpha = false);
+// Adds dynamic sprite of the given size, which image is created on first use
+void	add_dynamic_sprite(int gotSlot, int width, int height, const SpriteCache::ImageLoader &loader);
 void	free_dynamic_sprite (int gotSlot);
 
 #endif // __AGS_EE_AC__DYNAMICSPRITE_H
@@ -88,6 +88,11 @@ void ccAttemptDisposeObject(int32_t handle) {
         pool.CheckDispose(handle);
 }
 
+// dispose queued unreferenced objects, within the given budget
+int ccCollectGarbage(int max_objects) {
+    return pool.RunGarbageCollectionStep(max_objects);
+}
+
 // translate between object handles and memory addresses
 int32_t ccGetObjectHandleFromAddress(const char *address) {
     // set to null
@@ -99,6 +99,9 @@ extern void  ccSerializeAllObjects(Common::Stream *out);
 extern int   ccUnserializeAllObjects(Common::Stream *in, ICCObjectReader *callback);
 // dispose the object if RefCount==0
 extern void  ccAttemptDisposeObject(int32_t handle);
+// dispose up to max_objects of the unreferenced objects queued for collection,
+// returns the number of objects still left in queue
+extern int   ccCollectGarbage(int max_objects);
 // translate between object handles and memory addresses
 extern int32_t ccGetObjectHandleFromAddress(const char *address);
 extern const char *ccGetObjectAddressFromHandle(int32_t handle);
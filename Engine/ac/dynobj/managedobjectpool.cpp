@@ -13,6 +13,7 @@
 //=============================================================================
 
 #include <stdlib.h>
+#include <algorithm>
 #include <string.h>
 #include "ac/dynobj/managedobjectpool.h"
 #include "ac/dynobj/cc_dynamicarray.h" // globalDynamicArray, constants
@@ -79,32 +80,55 @@ int32_t ManagedObjectPool::AddRef(int32_t handle) {
 }
 
 int ManagedObjectPool::CheckDispose(int32_t handle) {
-    return objects[handle].CheckDispose();
+    const char *address = objects[handle].addr;
+    if (objects[handle].CheckDispose() == 0)
+    {
+        QueueForCollection(handle);
+        return 0;
+    }
+    OnObjectRemoved(handle, address);
+    return 1;
 }
 
 int32_t ManagedObjectPool::SubRef(int32_t handle) {
     if ((disableDisposeForObject != NULL) && 
         (objects[handle].addr == disableDisposeForObject))
+    {
         objects[handle].SubRefNoDispose();
+        QueueForCollection(handle);
+    }
     else
-        objects[handle].SubRef();
+    {
+        const char *address = objects[handle].addr;
+        if (objects[handle].SubRef())
+            OnObjectRemoved(handle, address);
+        else
+            QueueForCollection(handle);
+    }
     return objects[handle].refCount;
 }
 
+int ManagedObjectPool::Remove(int32_t handle, bool force) {
+    const char *address = objects[handle].addr;
+    if (objects[handle].remove(force) == 0)
+        return 0;
+    OnObjectRemoved(handle, address);
+    return 1;
+}
+
+void ManagedObjectPool::OnObjectRemoved(int32_t handle, const char *address) {
+    HandleMap::iterator it = handleByAddress.find(address);
+    if (it != handleByAddress.end() && it->second == handle)
+        handleByAddress.erase(it);
+    freeSlots.push_back(handle);
+}
+
 int32_t ManagedObjectPool::AddressToHandle(const char *addr) {
     // this function is only called when a pointer is set
-    // SLOW LOOP ALERT, improve at some point
-    // [IKM] 2013-01-01: search in reverse order, as suggested by rofl0r:
-    // it appears that, statistically, the given address is more often
-    // located closer to the end of the managed array.
-    for (size_t i = numObjects - 1; i >= 1; --i)
-    {
-        if (objects[i].addr == addr)
-        {
-            return objects[i].handle;
-        }
-    }
-    return 0;
+    HandleMap::const_iterator it = handleByAddress.find(addr);
+    if (it == handleByAddress.end())
+        return 0;
+    return it->second;
 }
 
 const char* ManagedObjectPool::HandleToAddress(int32_t handle) {
@@ -134,16 +158,52 @@ int ManagedObjectPool::RemoveObject(const char *address) {
     if (handl == 0)
         return 0;
 
-    objects[handl].remove(true);
+    Remove(handl, true);
     return 1;
 }
 
+void ManagedObjectPool::QueueForCollection(int32_t handle)
+{
+    if (!objects[handle].inGcQueue && (objects[handle].refCount < 1) &&
+        (objects[handle].callback != NULL))
+    {
+        objects[handle].inGcQueue = true;
+        gcQueue.push_back(handle);
+    }
+}
+
+void ManagedObjectPool::CollectQueuedObject()
+{
+    const int32_t handle = gcQueue.front();
+    gcQueue.pop_front();
+    objects[handle].inGcQueue = false;
+    // the slot could have been released or reused since it was queued
+    if ((objects[handle].handle == 0) || (objects[handle].refCount >= 1) ||
+        (objects[handle].callback == NULL))
+        return;
+    if (Remove(handle))
+    {
+        gcReclaimedCount++;
+    }
+    else if (objects[handle].obj_type == kScValPluginObject)
+    {
+        // plugin may dispose this object later, while the engine's own
+        // objects which refuse to be disposed are static
+        objects[handle].inGcQueue = true;
+        gcRetry.push_back(handle);
+    }
+}
+
 void ManagedObjectPool::RunGarbageCollectionIfAppropriate()
 {
     if (objectCreationCounter > GARBAGE_COLLECTION_INTERVAL)
     {
         objectCreationCounter = 0;
-        RunGarbageCollection();
+        gcQueue.insert(gcQueue.end(), gcRetry.begin(), gcRetry.end());
+        gcRetry.clear();
+        RunGarbageCollectionStep(GARBAGE_COLLECTION_STEP);
+        Debug::Printf(kDbgGroup_ManObj, kDbgMsg_Debug, "Garbage collection: queued %d, reclaimed %d in total",
+            (int)gcQueue.size(), gcReclaimedCount);
     }
 }
 
@@ -151,13 +211,17 @@ void ManagedObjectPool::RunGarbageCollection()
 {
     ManagedObjectLog("Running garbage collection");
 
-    for (int i = 1; i < numObjects; i++) 
-    {
-        if ((objects[i].refCount < 1) && (objects[i].callback != NULL)) 
-        {
-            objects[i].remove();
-        }
-    }
+    gcQueue.insert(gcQueue.end(), gcRetry.begin(), gcRetry.end());
+    gcRetry.clear();
+    while (!gcQueue.empty())
+        CollectQueuedObject();
+}
+
+int ManagedObjectPool::RunGarbageCollectionStep(int maxObjects)
+{
+    for (int i = 0; i < maxObjects && !gcQueue.empty(); ++i)
+        CollectQueuedObject();
+    return (int)gcQueue.size();
 }
 
 int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback, bool plugin_object, int useSlot) {
@@ -169,6 +233,8 @@ int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback
     if (useSlot < arrayAllocLimit) {
         // still space in the array, so use it
         objects[useSlot].init(useSlot, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject);
+        handleByAddress[address] = useSlot;
+        QueueForCollection(useSlot);
         if (useSlot == numObjects)
             numObjects++;
         return useSlot;
@@ -176,23 +242,31 @@ int ManagedObjectPool::AddObject(const char *address, ICCDynamicObject *callback
     else {
         // array has been used up
         if (useSlot == numObjects) {
-            // if adding new (not un-serializing) check for empty slot
-            // check backwards, since newer objects don't tend to last
-            // long
-            for (int i = arrayAllocLimit - 1; i >= 1; i--) {
+            // if adding new (not un-serializing) check for empty slot;
+            // take the most recently released ones first, since newer
+            // objects don't tend to last long
+            while (!freeSlots.empty()) {
+                int32_t i = freeSlots.back();
+                freeSlots.pop_back();
                 if (objects[i].handle == 0) {
                     objects[i].init(i, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject);
+                    handleByAddress[address] = i;
+                    QueueForCollection(i);
                     return i;
                 }
             }
         }
-        // no empty slots, expand array
+        // no empty slots, expand array; grow proportionally to the current
+        // size, so that the large pools are not reallocated too often
+        const int oldAllocLimit = arrayAllocLimit;
         while (useSlot >= arrayAllocLimit)
-            arrayAllocLimit += ARRAY_INCREMENT_SIZE;
+            arrayAllocLimit += std::max(ARRAY_INCREMENT_SIZE, arrayAllocLimit / 2);
 
         objects = (ManagedObject*)realloc(objects, sizeof(ManagedObject) * arrayAllocLimit);
-        memset(&objects[useSlot], 0, sizeof(ManagedObject) * ARRAY_INCREMENT_SIZE);
+        memset(&objects[oldAllocLimit], 0, sizeof(ManagedObject) * (arrayAllocLimit - oldAllocLimit));
         objects[useSlot].init(useSlot, address, callback, plugin_object ? kScValPluginObject : kScValDynamicObject);
+        handleByAddress[address] = useSlot;
+        QueueForCollection(useSlot);
         if (useSlot == numObjects)
             numObjects++;
         return useSlot;
@@ -259,6 +333,10 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectReader *reader) {
         objects = (ManagedObject*)calloc(sizeof(ManagedObject), arrayAllocLimit);
     }
     numObjects = numObjs;
+    handleByAddress.clear();
+    freeSlots.clear();
+    gcQueue.clear();
+    gcRetry.clear();
 
     for (int i = 1; i < numObjs; i++) {
         fgetstring_limit(typeNameBuffer, in, 199);
@@ -283,6 +361,12 @@ int ManagedObjectPool::ReadFromDisk(Stream *in, ICCObjectReader *reader) {
         }
     }
 
+    // gather the slots left empty; the last ones will be reused first
+    for (int i = 1; i < numObjs; i++) {
+        if (objects[i].handle == 0)
+            freeSlots.push_back(i);
+    }
+
     free(serializeBuffer);
     return 0;
 }
@@ -295,6 +379,10 @@ void ManagedObjectPool::reset() {
     }
     memset(&objects[0], 0, sizeof(ManagedObject) * arrayAllocLimit);
     numObjects = 1;
+    handleByAddress.clear();
+    freeSlots.clear();
+    gcQueue.clear();
+    gcRetry.clear();
 }
 
 ManagedObjectPool::ManagedObjectPool() {
@@ -302,6 +390,8 @@ ManagedObjectPool::ManagedObjectPool() {
     arrayAllocLimit = 10;
     objects = (ManagedObject*)calloc(sizeof(ManagedObject), arrayAllocLimit);
     disableDisposeForObject = NULL;
+    objectCreationCounter = 0;
+    gcReclaimedCount = 0;
 }
 
 ManagedObjectPool pool;
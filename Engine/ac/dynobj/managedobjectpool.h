@@ -15,6 +15,10 @@
 #ifndef __CC_MANAGEDOBJECTPOOL_H
 #define __CC_MANAGEDOBJECTPOOL_H
 
+#include <deque>
+#include <vector>
+#include "util/stdtr1compat.h"
+#include TR1INCLUDE(unordered_map)
 #include "ac/dynobj/cc_dynamicobject.h"   // ICCDynamicObject
 
 namespace AGS { namespace Common { class Stream; }}
@@ -24,6 +28,8 @@ using namespace AGS; // FIXME later
 #define SERIALIZE_BUFFER_SIZE 10240
 const int ARRAY_INCREMENT_SIZE = 100;
 const int GARBAGE_COLLECTION_INTERVAL = 100;
+// max number of queued objects checked by a single collection step
+const int GARBAGE_COLLECTION_STEP = 4 * GARBAGE_COLLECTION_INTERVAL;
 
 struct ManagedObjectPool {
     struct ManagedObject {
@@ -32,6 +38,7 @@ struct ManagedObjectPool {
         const char *addr;
         ICCDynamicObject * callback;
         int  refCount;
+        bool inGcQueue; // this slot is in the collection queue
 
         void init(int32_t theHandle, const char *theAddress,
             ICCDynamicObject *theCallback, ScriptValueType objType);
@@ -47,6 +54,30 @@ private:
     int arrayAllocLimit;
     int numObjects;  // not actually numObjects, but the highest index used
     int objectCreationCounter;  // used to do garbage collection every so often
+    // address to handle lookup, kept in sync with the objects array
+    typedef stdtr1compat::unordered_map<const char*, int32_t> HandleMap;
+    HandleMap handleByAddress;
+    // released slots to reuse when the array is full; may contain stale
+    // entries for the slots that were taken explicitly (un-serialized)
+    std::vector<int32_t> freeSlots;
+
+    // Disposes the object in the given slot, and if succeeded unregisters
+    // its address and marks the slot as free
+    int  Remove(int32_t handle, bool force = false);
+    // Updates lookup data after the object was disposed
+    void OnObjectRemoved(int32_t handle, const char *address);
+
+    // candidates for garbage collection: slots of objects which were
+    // created or lost their last reference, but were not disposed
+    std::deque<int32_t> gcQueue;
+    // plugin objects which refused disposal, retried on the next interval
+    std::vector<int32_t> gcRetry;
+    int gcReclaimedCount; // total number of objects disposed by collection
+
+    // Adds object to the collection queue if it has no references
+    void QueueForCollection(int32_t handle);
+    // Checks one queued object and disposes it if still unreferenced
+    void CollectQueuedObject();
 
 public:
 
@@ -58,7 +89,13 @@ public:
     ScriptValueType HandleToAddressAndManager(int32_t handle, void *&object, ICCDynamicObject *&manager);
     int RemoveObject(const char *address);
     void RunGarbageCollectionIfAppropriate();
+    // Checks all the queued objects
     void RunGarbageCollection();
+    // Checks up to the given number of queued objects,
+    // returns the number of ones still left in queue
+    int  RunGarbageCollectionStep(int maxObjects);
+    int  GetGCQueueLength() const { return (int)gcQueue.size(); }
+    int  GetGCReclaimedCount() const { return gcReclaimedCount; }
     int AddObject(const char *address, ICCDynamicObject *callback, bool plugin_object, int useSlot = -1);
     void WriteToDisk(Common::Stream *out);
     int ReadFromDisk(Common::Stream *in, ICCObjectReader *reader);
@@ -84,6 +84,7 @@
 #include "util/alignedstream.h"
 #include "util/directory.h"
 #include "util/filestream.h" // TODO: needed only because plugins expect file handle
+#include "util/memorystream.h"
 #include "util/path.h"
 #include "util/string_utils.h"
 
@@ -195,6 +196,7 @@ char saveGameDirectory[260] = "./";
 String saveGameParent;
 
 const char* sgnametemplate = "agssave.%03d";
+const char* sgbasenametemplate = "agsbase.%03d";
 String saveGameSuffix;
 
 int game_paused=0;
@@ -356,6 +358,13 @@ String get_save_game_path(int slotNum) {
     return path;
 }
 
+String get_save_game_base_path(int slotNum) {
+    String path = saveGameDirectory;
+    path.Append(String::FromFormat(sgbasenametemplate, slotNum));
+    path.Append(saveGameSuffix);
+    return path;
+}
+
 // Convert a path possibly containing path tags into acceptable save path
 String MakeSaveGameDir(const char *newFolder)
 {
@@ -996,6 +1005,24 @@ void skip_serialized_bitmap(Stream *in)
     in->Seek(picwid * pichit * bpp);
 }
 
+void read_serialized_bitmap_data(Stream *in, int &width, int &height, std::vector<uint8_t> &data)
+{
+    width = in->ReadInt32();
+    height = in->ReadInt32();
+    int piccoldep = in->ReadInt32();
+    MemoryStream blob;
+    blob.WriteInt32(width);
+    blob.WriteInt32(height);
+    blob.WriteInt32(piccoldep);
+    // CHECKME: originally, AGS does not use real BPP here, but simply divides color depth by 8
+    int bpp = piccoldep / 8;
+    std::vector<uint8_t> &buf = blob.GetBuffer();
+    const size_t header_size = buf.size();
+    buf.resize(header_size + width * height * bpp);
+    in->Read(&buf[header_size], buf.size() - header_size);
+    data.swap(buf);
+}
+
 long write_screen_shot_for_vista(Stream *out, Bitmap *screenshot)
 {
     long fileSize = 0;
@@ -1073,14 +1100,27 @@ void save_game(int slotn, const char*descript) {
     // Screenshot
     create_savegame_screenshot(screenShot);
 
-    Common::PStream out = StartSavegame(nametouse, descript, screenShot);
+    // Plugins write their data straight into the savegame file
+    const bool mem_write = (usetup.AsyncSave || usetup.DeltaSaves) && !pl_any_want_hook(AGSE_SAVEGAME);
+    // the restart point is always written in full
+    const bool delta_write = mem_write && usetup.DeltaSaves && slotn != RESTART_POINT_SAVE_GAME_NUMBER;
+    PMemoryStream mem_out;
+    Common::PStream out;
+    if (mem_write)
+        out = mem_out = StartSavegameInMemory(descript, screenShot);
+    else
+        out = StartSavegame(nametouse, descript, screenShot);
     if (out == NULL)
         quit("save_game: unable to open savegame file for writing");
 
     update_polled_stuff_if_runtime();
 
     // Actual dynamic game data is saved here
+    const soff_t data_start = out->GetPosition();
     SaveGameState(out);
+    String base_filename;
+    if (delta_write && !MakeDeltaSavegame(mem_out, data_start, get_save_game_base_path(slotn)))
+        base_filename = get_save_game_base_path(slotn);
 
     if (screenShot != NULL)
     {
@@ -1089,7 +1129,8 @@ void save_game(int slotn, const char*descript) {
 
         update_polled_stuff_if_runtime();
 
-        out.reset(Common::File::OpenFile(nametouse, Common::kFile_Open, Common::kFile_ReadWrite));
+        if (!mem_write)
+            out.reset(Common::File::OpenFile(nametouse, Common::kFile_Open, Common::kFile_ReadWrite));
         out->Seek(12, kSeekBegin);
         out->WriteInt32(screenShotOffset);
         out->Seek(4);
@@ -1098,6 +1139,27 @@ void save_game(int slotn, const char*descript) {
 
     if (screenShot != NULL)
         delete screenShot;
+
+    if (mem_write)
+    {
+        // scripts are told when the file written in background is complete;
+        // the restart point is not a real save, and is never reported
+        const int report_slot = (usetup.AsyncSave && slotn != RESTART_POINT_SAVE_GAME_NUMBER) ? slotn : -1;
+        WriteSavegameAsync(mem_out, nametouse, report_slot, base_filename);
+        if (!usetup.AsyncSave)
+            WaitForSavegameWrite();
+    }
+}
+
+void update_savegame_writes()
+{
+    int slot;
+    bool success;
+    while (PollSavegameWrite(slot, success))
+    {
+        if (slot >= 0)
+            run_on_event(GE_SAVE_GAME, RuntimeScriptValue().SetInt32(success ? slot : -1));
+    }
 }
 
 char rbuffer[200];
@@ -1687,7 +1749,7 @@ HSaveError load_game(const String &path, int slotNumber, bool &data_overwritten)
     }
 
     // do the actual restore
-    err = RestoreGameState(src.InputStream, src.Version);
+    err = RestoreGameState(src.InputStream, src.Version, src.Filename);
     data_overwritten = true;
     if (!err)
         return err;
@@ -1904,6 +1966,9 @@ void display_switch_in()
             platform->EnterFullscreenMode(mode);
     }
     platform->DisplaySwitchIn();
+    // screen contents could have been lost while we were away
+    if (gfxDriver && gfxDriver->UsesMemoryBackBuffer())
+        invalidate_screen();
     clear_input_buffer();
     // If auto lock option is set, lock mouse to the game window
     if (usetup.mouse_auto_lock && scsystem.windowed)
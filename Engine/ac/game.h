@@ -19,6 +19,7 @@
 #ifndef __AGS_EE_AC__GAME_H
 #define __AGS_EE_AC__GAME_H
 
+#include <vector>
 #include "ac/dynobj/scriptviewframe.h"
 #include "main/game_file.h"
 #include "util/string.h"
@@ -121,12 +122,15 @@ void set_game_speed(int fps);
 void setup_for_dialog();
 void restore_after_dialog();
 Common::String get_save_game_path(int slotNum);
+Common::String get_save_game_base_path(int slotNum);
 void restore_game_dialog();
 void save_game_dialog();
 void free_do_once_tokens();
 // Free all the memory associated with the game
 void unload_game_file();
 void save_game(int slotn, const char*descript);
+// Tells scripts about the savegames which finished writing in background
+void update_savegame_writes();
 bool read_savedgame_description(const Common::String &savedgame, Common::String &description);
 bool read_savedgame_screenshot(const Common::String &savedgame, int &want_shot);
 void save_game_data(Common::Stream *out);
@@ -139,6 +143,9 @@ void serialize_bitmap(const Common::Bitmap *thispic, Common::Stream *out);
 void convert_guid_from_text_to_binary(const char *guidText, unsigned char *buffer);
 Common::Bitmap *read_serialized_bitmap(Common::Stream *in);
 void skip_serialized_bitmap(Common::Stream *in);
+// Copies serialized bitmap without unpacking it; the data may be passed to
+// read_serialized_bitmap later
+void read_serialized_bitmap_data(Common::Stream *in, int &width, int &height, std::vector<uint8_t> &data);
 long write_screen_shot_for_vista(Common::Stream *out, Common::Bitmap *screenshot);
 
 void start_skipping_cutscene ();
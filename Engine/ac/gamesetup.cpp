@@ -32,6 +32,11 @@ GameSetup::GameSetup()
     mouse_speed_def = kMouseSpeed_CurrentDisplay;
     RenderAtScreenRes = false;
     Supersampling = 1;
+    RenderThreads = 1;
+    PathfinderThreads = 1;
+    RoomLoadThreads = 1;
+    AsyncSave = false;
+    DeltaSaves = false;
 
     Screen.DisplayMode.ScreenSize.MatchDeviceRatio = true;
     Screen.DisplayMode.ScreenSize.SizeDef = kScreenDef_MaxDisplay;
@@ -60,6 +60,11 @@ struct GameSetup {
     MouseSpeedDef mouse_speed_def;
     bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
     int   Supersampling;
+    int   RenderThreads; // number of threads preparing sprites for software renderer, 0 = all CPU cores
+    int   PathfinderThreads; // number of threads finding routes for the batched walks, 0 = all CPU cores
+    int   RoomLoadThreads; // number of threads decompressing room backgrounds, 0 = all CPU cores
+    bool  AsyncSave; // prepare savegames in memory and write them to disk in background
+    bool  DeltaSaves; // store savegames as a delta to the slot's base savegame
 
     ScreenSetup Screen;
 
@@ -26,7 +26,8 @@
 #include "ac/movelist.h"
 #include "ac/properties.h"
 #include "ac/record.h"
-#include "ac/tree_map.h"
+#include "ac/transformedspritecache.h"
+#include "ac/translationtable.h"
 #include "ac/walkablearea.h"
 #include "gfx/gfxfilter.h"
 #include "gui/guidialog.h"
@@ -51,7 +52,7 @@ extern CharacterInfo*playerchar;
 extern int convert_16bit_bgr;
 extern IGraphicsDriver *gfxDriver;
 extern SpriteCache spriteset;
-extern TreeMap *transtree;
+extern TranslationTable *transtable;
 extern int displayed_room, starting_room;
 extern MoveList *mls;
 extern char transFileName[MAX_PATH];
@@ -72,11 +73,18 @@ String GetRuntimeInfo()
         gfxDriver->GetDriverName(), filter->GetInfo().Name.GetCStr(),
         render_frame.GetWidth(), render_frame.GetHeight(),
         spriteset.GetCacheSize() / 1024, spriteset.GetMaxCacheSize() / 1024, spriteset.GetLockedSize() / 1024);
+    const SpriteCache::Stats &sprstats = spriteset.GetStats();
+    runtimeInfo.Append(String::FromFormat("[Sprite cache hits: %u, misses: %u; released %u (%u KB)",
+        (unsigned)sprstats.Hits, (unsigned)sprstats.Misses, (unsigned)sprstats.Evictions, (unsigned)(sprstats.EvictedBytes / 1024)));
+    const TransformedSpriteCache::Stats &trstats = transformed_sprites.GetStats();
+    runtimeInfo.Append(String::FromFormat("[Transformed sprites: %d KB (limit %d KB); hits: %u, misses: %u; released %u",
+        transformed_sprites.GetCacheSize() / 1024, transformed_sprites.GetMaxCacheSize() / 1024,
+        (unsigned)trstats.Hits, (unsigned)trstats.Misses, (unsigned)trstats.Evictions));
     if (play.separate_music_lib)
         runtimeInfo.Append("[AUDIO.VOX enabled");
     if (play.want_speech >= 1)
         runtimeInfo.Append("[SPEECH.VOX enabled");
-    if (transtree != NULL) {
+    if (transtable != NULL) {
         runtimeInfo.Append("[Using translation ");
         runtimeInfo.Append(transFileName);
     }
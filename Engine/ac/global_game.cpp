@@ -40,8 +40,11 @@
 #include "ac/roomstatus.h"
 #include "ac/string.h"
 #include "ac/system.h"
+#include "ac/transformedspritecache.h"
 #include "debug/debugger.h"
 #include "debug/debug_log.h"
+#include "debug/out.h"
+#include "game/savegame.h"
 #include "gui/guidialog.h"
 #include "main/engine.h"
 #include "main/game_start.h"
@@ -88,7 +91,7 @@ extern int psp_gfx_renderer;
 
 void GiveScore(int amnt) 
 {
-    guis_need_update = 1;
+    mark_macro_labels_changed();
     play.score += amnt;
 
     if ((amnt > 0) && (play.score_sound >= 0))
@@ -119,15 +122,24 @@ void RestoreGameSlot(int slnum) {
 }
 
 void DeleteSaveSlot (int slnum) {
+    // the slot may be still written in background
+    AGS::Engine::WaitForSavegameWrite();
     String nametouse;
     nametouse = get_save_game_path(slnum);
     unlink (nametouse);
+    AGS::Engine::DeleteBaseSavegame(get_save_game_base_path(slnum));
     if ((slnum >= 1) && (slnum <= MAXSAVEGAMES)) {
         String thisname;
         for (int i = MAXSAVEGAMES; i > slnum; i--) {
             thisname = get_save_game_path(i);
             if (Common::File::TestReadFile(thisname)) {
-                // Rename the highest save game to fill in the gap
+                // Rename the highest save game to fill in the gap; it must
+                // not refer to the base of its old slot anymore
+                AGS::Engine::HSaveError err = AGS::Engine::CompactSavegame(thisname);
+                if (err)
+                    AGS::Engine::DeleteBaseSavegame(get_save_game_base_path(i));
+                else
+                    Debug::Printf(kDbgMsg_Error, "Failed to compact savegame %s: %s", thisname.GetCStr(), err->FullMessage().GetCStr());
                 rename (thisname, nametouse);
                 break;
             }
@@ -277,6 +289,7 @@ int RunAGSGame (const char *newgame, unsigned int mode, int data) {
     if (!err)
         quitprintf("!RunAGSGame: error loading new game file:\n%s", err->FullMessage().GetCStr());
 
+    transformed_sprites.Clear();
     spriteset.Reset();
     err = spriteset.InitFile("acsprset.spr");
     if (!err)
@@ -541,13 +554,13 @@ void GetLocationName(int xxx,int yyy,char*tempo) {
         int mover = GetInvAt (xxx, yyy);
         if (mover > 0) {
             if (play.get_loc_name_last_time != 1000 + mover)
-                guis_need_update = 1;
+                mark_macro_labels_changed();
             play.get_loc_name_last_time = 1000 + mover;
             strcpy(tempo,get_translation(game.invinfo[mover].name));
         }
         else if ((play.get_loc_name_last_time > 1000) && (play.get_loc_name_last_time < 1000 + MAX_INV)) {
             // no longer selecting an item
-            guis_need_update = 1;
+            mark_macro_labels_changed();
             play.get_loc_name_last_time = -1;
         }
         return;
@@ -566,7 +579,7 @@ void GetLocationName(int xxx,int yyy,char*tempo) {
     if (loctype == 0) {
         if (play.get_loc_name_last_time != 0) {
             play.get_loc_name_last_time = 0;
-            guis_need_update = 1;
+            mark_macro_labels_changed();
         }
         return;
     }
@@ -576,7 +589,7 @@ void GetLocationName(int xxx,int yyy,char*tempo) {
         onhs = getloctype_index;
         strcpy(tempo,get_translation(game.chars[onhs].name));
         if (play.get_loc_name_last_time != 2000+onhs)
-            guis_need_update = 1;
+            mark_macro_labels_changed();
         play.get_loc_name_last_time = 2000+onhs;
         return;
     }
@@ -585,14 +598,14 @@ void GetLocationName(int xxx,int yyy,char*tempo) {
         aa = getloctype_index;
         strcpy(tempo,get_translation(thisroom.Objects[aa].Name));
         if (play.get_loc_name_last_time != 3000+aa)
-            guis_need_update = 1;
+            mark_macro_labels_changed();
         play.get_loc_name_last_time = 3000+aa;
         return;
     }
     onhs = getloctype_index;
     if (onhs>0) strcpy(tempo,get_translation(thisroom.Hotspots[onhs].Name));
     if (play.get_loc_name_last_time != onhs)
-        guis_need_update = 1;
+        mark_macro_labels_changed();
     play.get_loc_name_last_time = onhs;
 }
 
@@ -62,7 +62,6 @@ void InterfaceOn(int ifn) {
     debug_script_log("GUIOn(%d) ignored (already on)", ifn);
     return;
   }
-  guis_need_update = 1;
   guis[ifn].SetVisible(true);
   debug_script_log("GUI %d turned on", ifn);
   // modal interface
@@ -86,7 +85,6 @@ void InterfaceOff(int ifn) {
     guis[ifn].MouseOverCtrl = -1;
   }
   guis[ifn].OnControlPositionChanged();
-  guis_need_update = 1;
   // modal interface
   if (guis[ifn].PopupStyle==kGUIPopupModal) UnPauseGame();
 }
@@ -168,10 +168,7 @@ void ResetRoom(int nrnum) {
 int HasPlayerBeenInRoom(int roomnum) {
     if ((roomnum < 0) || (roomnum >= MAX_ROOMS))
         return 0;
-    if (isRoomStatusValid(roomnum))
-        return getRoomStatus(roomnum)->beenhere;
-    else
-        return 0;
+    return isRoomVisited(roomnum) ? 1 : 0;
 }
 
 void CallRoomScript (int value) {
@@ -189,10 +186,7 @@ int HasBeenToRoom (int roomnum) {
     if ((roomnum < 0) || (roomnum >= MAX_ROOMS))
         quit("!HasBeenToRoom: invalid room number specified");
 
-    if (isRoomStatusValid(roomnum))
-        return getRoomStatus(roomnum)->beenhere;
-    else
-        return 0;
+    return isRoomVisited(roomnum) ? 1 : 0;
 }
 
 // [DEPRECATED]
@@ -18,7 +18,7 @@
 #include "ac/gamestate.h"
 #include "ac/global_translation.h"
 #include "ac/string.h"
-#include "ac/tree_map.h"
+#include "ac/translationtable.h"
 #include "platform/base/agsplatformdriver.h"
 #include "plugin/agsplugin.h"
 #include "plugin/plugin_engine.h"
@@ -28,7 +28,7 @@ using namespace AGS::Common::Memory;
 
 extern GameState play;
 extern AGSPlatformDriver *platform;
-extern TreeMap *transtree;
+extern TranslationTable *transtable;
 extern char transFileName[MAX_PATH];
 
 const char *get_translation (const char *text) {
@@ -44,9 +44,9 @@ const char *get_translation (const char *text) {
         return plResult;
     }
 
-    if (transtree != NULL) {
+    if (transtable != NULL) {
         // translate the text using the translation file
-        char * transl = transtree->findValue (text);
+        const char * transl = transtable->FindValue (text);
         if (transl != NULL)
             return transl;
     }
@@ -55,7 +55,7 @@ const char *get_translation (const char *text) {
 }
 
 int IsTranslationAvailable () {
-    if (transtree != NULL)
+    if (transtable != NULL)
         return 1;
     return 0;
 }
@@ -22,6 +22,7 @@
 #include "ac/global_game.h"
 #include "ac/global_gui.h"
 #include "ac/global_inventoryitem.h"
+#include "ac/global_translation.h"
 #include "ac/global_screen.h"
 #include "ac/guicontrol.h"
 #include "ac/interfacebutton.h"
@@ -36,6 +37,7 @@
 #include "device/mousew32.h"
 #include "gfx/gfxfilter.h"
 #include "gui/guibutton.h"
+#include "gui/guilabel.h"
 #include "gui/guimain.h"
 #include "script/script.h"
 #include "script/script_runtime.h"
@@ -130,7 +132,7 @@ void GUI_SetSize(ScriptGUI *sgui, int widd, int hitt) {
   
   recreate_guibg_image(tehgui);
 
-  guis_need_update = 1;
+  tehgui->MarkChanged();
 }
 
 int GUI_GetWidth(ScriptGUI *sgui) {
@@ -216,7 +218,7 @@ void GUI_Centre(ScriptGUI *sgui) {
 void GUI_SetBackgroundGraphic(ScriptGUI *tehgui, int slotn) {
   if (guis[tehgui->id].BgImage != slotn) {
     guis[tehgui->id].BgImage = slotn;
-    guis_need_update = 1;
+    guis[tehgui->id].MarkChanged();
   }
 }
 
@@ -231,7 +233,7 @@ void GUI_SetBackgroundColor(ScriptGUI *tehgui, int newcol)
     if (guis[tehgui->id].BgColor != newcol)
     {
         guis[tehgui->id].BgColor = newcol;
-        guis_need_update = 1;
+        guis[tehgui->id].MarkChanged();
     }
 }
 
@@ -247,7 +249,7 @@ void GUI_SetBorderColor(ScriptGUI *tehgui, int newcol)
     if (guis[tehgui->id].FgColor != newcol)
     {
         guis[tehgui->id].FgColor = newcol;
-        guis_need_update = 1;
+        guis[tehgui->id].MarkChanged();
     }
 }
 
@@ -265,7 +267,7 @@ void GUI_SetTextColor(ScriptGUI *tehgui, int newcol)
     if (guis[tehgui->id].FgColor != newcol)
     {
         guis[tehgui->id].FgColor = newcol;
-        guis_need_update = 1;
+        guis[tehgui->id].MarkChanged();
     }
 }
 
@@ -438,6 +440,15 @@ void replace_macro_tokens(const char *text, String &fixed_text) {
     }
 }
 
+void mark_macro_labels_changed() {
+    for (int i = 0; i < numguilabels; ++i) {
+        GUILabel &label = guilabels[i];
+        if (label.Text.FindChar('@') != (size_t)-1 ||
+            (label.IsTranslated() && strchr(get_translation(label.Text), '@') != NULL))
+            label.MarkChanged();
+    }
+}
+
 
 void update_gui_zorder() {
     int numdone = 0, b;
@@ -618,7 +629,7 @@ int gui_on_mouse_move()
 
             if (mousey < guis[guin].PopupAtMouseY) {
                 set_mouse_cursor(CURS_ARROW);
-                guis[guin].SetConceal(false); guis_need_update = 1;
+                guis[guin].SetConceal(false);
                 ifacepopped=guin; PauseGame();
                 break;
             }
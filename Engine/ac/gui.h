@@ -65,6 +65,8 @@ ScriptGUI *GetGUIAtLocation(int xx, int yy);
 void	remove_popup_interface(int ifacenum);
 void	process_interface_click(int ifce, int btn, int mbut);
 void	replace_macro_tokens(const char *text, AGS::Common::String &fixed_text);
+// Marks the labels which may display macro tokens, after the macro values changed
+void	mark_macro_labels_changed();
 void	update_gui_zorder();
 void	export_gui_controls(int ee);
 void	unexport_gui_controls(int ee);
@@ -34,7 +34,7 @@ int ListBox_AddItem(GUIListBox *lbb, const char *text) {
   if (lbb->AddItem(text) < 0)
     return 0;
 
-  guis_need_update = 1;
+  lbb->MarkChanged();
   return 1;
 }
 
@@ -42,13 +42,13 @@ int ListBox_InsertItemAt(GUIListBox *lbb, int index, const char *text) {
   if (lbb->InsertItem(index, text) < 0)
     return 0;
 
-  guis_need_update = 1;
+  lbb->MarkChanged();
   return 1;
 }
 
 void ListBox_Clear(GUIListBox *listbox) {
   listbox->Clear();
-  guis_need_update = 1;
+  listbox->MarkChanged();
 }
 
 void FillDirList(std::set<String> &files, const String &path)
@@ -64,7 +64,7 @@ void FillDirList(std::set<String> &files, const String &path)
 
 void ListBox_FillDirList(GUIListBox *listbox, const char *filemask) {
   listbox->Clear();
-  guis_need_update = 1;
+  listbox->MarkChanged();
 
   String path, alt_path;
   if (!ResolveScriptPath(filemask, true, path, alt_path))
@@ -143,7 +143,7 @@ int ListBox_FillSaveGameList(GUIListBox *listbox) {
     play.filenumbers[nn] = listbox->SavedGameIndex[nn];
   }
 
-  guis_need_update = 1;
+  listbox->MarkChanged();
   listbox->SetSvgIndex(true);
 
   if (numsaves >= MAXSAVEGAMES)
@@ -186,7 +186,7 @@ void ListBox_SetItemText(GUIListBox *listbox, int index, const char *newtext) {
 
   if (strcmp(listbox->Items[index], newtext)) {
     listbox->SetItemText(index, newtext);
-    guis_need_update = 1;
+    listbox->MarkChanged();
   }
 }
 
@@ -196,7 +196,7 @@ void ListBox_RemoveItem(GUIListBox *listbox, int itemIndex) {
     quit("!ListBoxRemove: invalid listindex specified");
 
   listbox->RemoveItem(itemIndex);
-  guis_need_update = 1;
+  listbox->MarkChanged();
 }
 
 int ListBox_GetItemCount(GUIListBox *listbox) {
@@ -214,7 +214,7 @@ void ListBox_SetFont(GUIListBox *listbox, int newfont) {
 
   if (newfont != listbox->Font) {
     listbox->SetFont(newfont);
-    guis_need_update = 1;
+    listbox->MarkChanged();
   }
 
 }
@@ -227,7 +227,7 @@ void ListBox_SetShowBorder(GUIListBox *listbox, bool newValue) {
     if (listbox->IsBorderShown() != newValue)
     {
         listbox->SetShowBorder(newValue);
-        guis_need_update = 1;
+        listbox->MarkChanged();
     }
 }
 
@@ -239,7 +239,7 @@ void ListBox_SetShowScrollArrows(GUIListBox *listbox, bool newValue) {
     if (listbox->AreArrowsShown() != newValue)
     {
         listbox->SetShowArrows(newValue);
-        guis_need_update = 1;
+        listbox->MarkChanged();
     }
 }
 
@@ -266,7 +266,7 @@ int ListBox_GetSelectedBackColor(GUIListBox *listbox) {
 void ListBox_SetSelectedBackColor(GUIListBox *listbox, int colr) {
     if (listbox->SelectedBgColor != colr) {
         listbox->SelectedBgColor = colr;
-        guis_need_update = 1;
+        listbox->MarkChanged();
     }
 }
 
@@ -277,7 +277,7 @@ int ListBox_GetSelectedTextColor(GUIListBox *listbox) {
 void ListBox_SetSelectedTextColor(GUIListBox *listbox, int colr) {
     if (listbox->SelectedTextColor != colr) {
         listbox->SelectedTextColor = colr;
-        guis_need_update = 1;
+        listbox->MarkChanged();
     }
 }
 
@@ -288,7 +288,7 @@ int ListBox_GetTextAlignment(GUIListBox *listbox) {
 void ListBox_SetTextAlignment(GUIListBox *listbox, int align) {
     if (listbox->TextAlignment != align) {
         listbox->TextAlignment = (HorAlignment)align;
-        guis_need_update = 1;
+        listbox->MarkChanged();
     }
 }
 
@@ -299,7 +299,7 @@ int ListBox_GetTextColor(GUIListBox *listbox) {
 void ListBox_SetTextColor(GUIListBox *listbox, int colr) {
     if (listbox->TextColor != colr) {
         listbox->TextColor = colr;
-        guis_need_update = 1;
+        listbox->MarkChanged();
     }
 }
 
@@ -322,7 +322,7 @@ void ListBox_SetSelectedIndex(GUIListBox *guisl, int newsel) {
       if (newsel >= guisl->TopItem + guisl->VisibleItemCount)
         guisl->TopItem = (newsel - guisl->VisibleItemCount) + 1;
     }
-    guis_need_update = 1;
+    guisl->MarkChanged();
   }
 
 }
@@ -338,7 +338,7 @@ void ListBox_SetTopItem(GUIListBox *guisl, int item) {
     quit("!ListBoxSetTopItem: tried to set top to beyond top or bottom of list");
 
   guisl->TopItem = item;
-  guis_need_update = 1;
+  guisl->MarkChanged();
 }
 
 int ListBox_GetRowCount(GUIListBox *listbox) {
@@ -348,14 +348,14 @@ int ListBox_GetRowCount(GUIListBox *listbox) {
 void ListBox_ScrollDown(GUIListBox *listbox) {
   if (listbox->TopItem + listbox->VisibleItemCount < listbox->ItemCount) {
     listbox->TopItem++;
-    guis_need_update = 1;
+    listbox->MarkChanged();
   }
 }
 
 void ListBox_ScrollUp(GUIListBox *listbox) {
   if (listbox->TopItem > 0) {
     listbox->TopItem--;
-    guis_need_update = 1;
+    listbox->MarkChanged();
   }
 }
 
@@ -365,7 +365,7 @@ GUIListBox* is_valid_listbox (int guin, int objn) {
   if ((objn<0) | (objn>=guis[guin].GetControlCount())) quit("!ListBox: invalid object number");
   if (guis[guin].GetControlType(objn)!=kGUIListBox)
     quit("!ListBox: specified control is not a list box");
-  guis_need_update = 1;
+  guis[guin].GetControl(objn)->MarkChanged();
   return (GUIListBox*)guis[guin].GetControl(objn);
 }
 
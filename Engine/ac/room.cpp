@@ -39,7 +39,9 @@
 #include "ac/roomstatus.h"
 #include "ac/screen.h"
 #include "ac/string.h"
+#include "ac/viewframe.h"
 #include "ac/system.h"
+#include "ac/transformedspritecache.h"
 #include "ac/walkablearea.h"
 #include "ac/walkbehind.h"
 #include "ac/dynobj/scriptobject.h"
@@ -65,7 +67,9 @@
 #include "gfx/bitmap.h"
 #include "gfx/gfxfilter.h"
 #include "util/math.h"
+#include "util/threadpool.h"
 #include "ac/dynobj/scriptcamera.h"
+#include <memory>
 
 using namespace AGS::Common;
 using namespace AGS::Engine;
@@ -120,6 +124,8 @@ extern CCObject ccDynamicObject;
 RGB_MAP rgb_table;  // for 256-col antialiasing
 int new_room_flags=0;
 int gs_to_newroom=-1;
+// Threads decompressing room backgrounds, created on first room load
+std::unique_ptr<ThreadPool> room_decode_threads;
 
 ScriptDrawingSurface* Room_GetDrawingSurfaceForBackground(int backgroundNumber)
 {
@@ -393,7 +399,9 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     // load the room from disk
     our_eip=200;
     thisroom.GameID = NO_GAME_ID_IN_ROOM_FILE;
-    load_room(room_filename, &thisroom, game.SpriteInfos);
+    if (!room_decode_threads && usetup.RoomLoadThreads != 1)
+        room_decode_threads.reset(new ThreadPool(usetup.RoomLoadThreads));
+    load_room(room_filename, &thisroom, game.SpriteInfos, room_decode_threads.get());
 
     if ((thisroom.GameID != NO_GAME_ID_IN_ROOM_FILE) &&
         (thisroom.GameID != game.uniqueid)) {
@@ -746,6 +754,16 @@ void load_new_room(int newnum, CharacterInfo*forchar) {
     }
     color_map = NULL;
 
+    // start loading sprites of the room objects and characters in background
+    for (cc=0;cc<croom->numobj;cc++) {
+        if (objs[cc].on == 1)
+            spriteset.Prefetch(objs[cc].num);
+    }
+    for (cc=0;cc<game.numcharacters;cc++) {
+        if ((game.chars[cc].on == 1) && (game.chars[cc].room == displayed_room))
+            prefetch_view_loop(game.chars[cc].view, game.chars[cc].loop);
+    }
+
     our_eip = 209;
     update_polled_stuff_if_runtime();
     generate_light_table();
@@ -814,6 +832,7 @@ void new_room(int newnum,CharacterInfo*forchar) {
     {
         // Delete all cached sprites
         spriteset.RemoveAll();
+        transformed_sprites.Clear();
 
         // Delete all gui background images
         for (int i = 0; i < game.numgui; i++)
@@ -836,7 +855,7 @@ void new_room(int newnum,CharacterInfo*forchar) {
 int find_highest_room_entered() {
     int qq,fndas=-1;
     for (qq=0;qq<MAX_ROOMS;qq++) {
-        if (isRoomStatusValid(qq) && (getRoomStatus(qq)->beenhere != 0))
+        if (isRoomVisited(qq))
             fndas = qq;
     }
     // This is actually legal - they might start in room 400 and save
@@ -19,6 +19,7 @@
 #include "ac/roomstatus.h"
 #include "game/customproperties.h"
 #include "util/alignedstream.h"
+#include "util/memorystream.h"
 
 using namespace AGS::Common;
 
@@ -180,6 +181,8 @@ void RoomStatus::WriteToSavegame(Stream *out) const
 // JJS: Replacement for the global roomstats array in the original engine.
 
 RoomStatus* room_statuses[MAX_ROOMS];
+// Room statuses restored from a savegame but not unpacked yet
+std::vector<uint8_t> room_statuses_serialized[MAX_ROOMS];
 
 // Replaces all accesses to the roomstats array
 RoomStatus* getRoomStatus(int room)
@@ -188,6 +191,12 @@ RoomStatus* getRoomStatus(int room)
     {
         // First access, allocate and initialise the status
         room_statuses[room] = new RoomStatus();
+        if (!room_statuses_serialized[room].empty())
+        {
+            MemoryStream in(std::move(room_statuses_serialized[room]));
+            room_statuses[room]->ReadFromSavegame(&in);
+            room_statuses_serialized[room].clear();
+        }
     }
     return room_statuses[room];
 }
@@ -198,7 +207,15 @@ RoomStatus* getRoomStatus(int room)
 // a room if the status is already initialised.
 bool isRoomStatusValid(int room)
 {
-    return (room_statuses[room] != NULL);
+    return (room_statuses[room] != NULL) || !room_statuses_serialized[room].empty();
+}
+
+bool isRoomVisited(int room)
+{
+    // only the visited rooms are written to the savegame
+    if (room_statuses[room] == NULL)
+        return !room_statuses_serialized[room].empty();
+    return room_statuses[room]->beenhere != 0;
 }
 
 void resetRoomStatuses()
@@ -210,5 +227,20 @@ void resetRoomStatuses()
             delete room_statuses[i];
             room_statuses[i] = NULL;
         }
+        std::vector<uint8_t>().swap(room_statuses_serialized[i]);
     }
 }
+
+void setRoomStatusSerialized(int room, std::vector<uint8_t> &&data)
+{
+    delete room_statuses[room];
+    room_statuses[room] = NULL;
+    room_statuses_serialized[room] = std::move(data);
+}
+
+const std::vector<uint8_t> *getRoomStatusSerialized(int room)
+{
+    if (room_statuses[room] != NULL || room_statuses_serialized[room].empty())
+        return NULL;
+    return &room_statuses_serialized[room];
+}
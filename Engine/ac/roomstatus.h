@@ -18,6 +18,7 @@
 #ifndef __AGS_EE_AC__ROOMSTATUS_H
 #define __AGS_EE_AC__ROOMSTATUS_H
 
+#include <vector>
 #include "ac/roomobject.h"
 #include "game/roomstruct.h"
 #include "game/interactions.h"
@@ -76,6 +77,14 @@ RoomStatus* getRoomStatus(int room);
 // to initialise the status because a player can only have been in
 // a room if the status is already initialised.
 bool isRoomStatusValid(int room);
+// Tells if the player has been in the room, without restoring its status
+bool isRoomVisited(int room);
 void resetRoomStatuses();
+// Keeps the room status serialized until the first access to it; used to
+// avoid reading the states of all the visited rooms when restoring a game
+void setRoomStatusSerialized(int room, std::vector<uint8_t> &&data);
+// Returns the serialized status of the room which was not accessed since
+// restoring a game, or NULL
+const std::vector<uint8_t> *getRoomStatusSerialized(int room);
 
 #endif // __AGS_EE_AC__ROOMSTATUS_H
@@ -22,11 +22,17 @@
 #include "ac/common_defines.h"
 #include <string.h>
 #include <math.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include "gfx/bitmap.h"
+#include "util/threadpool.h"
 
 #include "route_finder_jps.inl"
 
 using AGS::Common::Bitmap;
+using AGS::Common::ThreadPool;
 namespace BitmapHelper = AGS::Common::BitmapHelper;
 
 #define MAKE_INTCOORD(x,y) (((unsigned short)x << 16) | ((unsigned short)y))
@@ -42,10 +48,40 @@ extern void update_polled_stuff_if_runtime();
 
 extern MoveList *mls;
 
-Navigation nav;
+// Navigation map with the walkable mask rows bound to it, and the buffers
+// used by the route search; each thread searching for routes needs its own
+struct NavWorkspace
+{
+  Navigation Nav;
+  // Rows of the walkable mask which were last bound to the navigation map;
+  // rows of a memory bitmap are laid out one after another, so the first and
+  // last ones are enough to tell if the same pixel data is used
+  const unsigned char *FirstRow, *LastRow;
+  int Width, Height;
+  std::vector<int> Path, CPath;
+
+  NavWorkspace()
+    : FirstRow(NULL), LastRow(NULL), Width(0), Height(0)
+  {
+  }
+};
 
-void init_pathfinder()
+NavWorkspace nav;
+// Workspaces for the pathfinder threads, and the ones not taken at the moment
+std::vector<NavWorkspace> nav_workers;
+std::vector<NavWorkspace*> nav_free;
+std::mutex nav_free_mutex;
+std::unique_ptr<ThreadPool> route_threads;
+
+void init_pathfinder(int thread_count)
 {
+  route_threads.reset();
+  if (thread_count != 1)
+    route_threads.reset(new ThreadPool(thread_count));
+  nav_workers.resize(route_threads ? route_threads->GetThreadCount() : 0);
+  nav_free.clear();
+  for (size_t i = 0; i < nav_workers.size(); ++i)
+    nav_free.push_back(&nav_workers[i]);
 }
 
 Bitmap *wallscreen;
@@ -57,13 +93,123 @@ int lastcx, lastcy;
 extern void winalert(char *, ...);
 #endif
 
+void sync_nav_mask(NavWorkspace &ws, Bitmap *mask)
+{
+  const int width = mask->GetWidth();
+  const int height = mask->GetHeight();
+  const unsigned char *first_row = mask->GetScanLine(0);
+  const unsigned char *last_row = mask->GetScanLine(height - 1);
+  if (first_row == ws.FirstRow && last_row == ws.LastRow &&
+      width == ws.Width && height == ws.Height)
+    return;
+
+  ws.Nav.Resize(width, height);
+
+  for (int y=0; y<height; y++)
+    ws.Nav.SetMapRow(y, mask->GetScanLine(y));
+
+  ws.FirstRow = first_row;
+  ws.LastRow = last_row;
+  ws.Width = width;
+  ws.Height = height;
+}
+
 void sync_nav_wallscreen()
 {
-  // FIXME: this is dumb, but...
-  nav.Resize(wallscreen->GetWidth(), wallscreen->GetHeight());
+  sync_nav_mask(nav, wallscreen);
+}
+
+// Copy of the walkable mask pixels which cached routes were found for
+struct NavMaskCopy
+{
+  uint64_t Hash;
+  int Width, Height;
+  std::vector<unsigned char> Pixels;
+};
+
+// Route found for the particular walkable mask, start and destination
+struct CachedRoute
+{
+  std::shared_ptr<NavMaskCopy> Mask;
+  int FromX, FromY;
+  int DestX, DestY;
+  bool Found;
+  std::vector<int> NavPoints;
+};
+
+// Recently found routes, most recently used first. Characters walking
+// between the same points over and over again get their routes from here
+// instead of searching for them every time.
+const size_t ROUTE_CACHE_SIZE = 32;
+std::list<CachedRoute> route_cache;
+std::mutex route_cache_mutex;
+
+// Calculates the hash of walkable mask pixels, used to quickly skip cached
+// routes found for other masks. The mask has other characters and objects
+// cut out of it before every route search, so routes are matched by its
+// contents rather than by tracking all the changes.
+uint64_t hash_nav_mask(Bitmap *mask)
+{
+  const uint64_t mul = 0x9E3779B97F4A7C15ULL;
+  const int width = mask->GetWidth();
+  const int height = mask->GetHeight();
+  uint64_t hash = ((uint64_t)width << 32) | (uint64_t)height;
+  for (int y = 0; y < height; y++)
+  {
+    const unsigned char *row = mask->GetScanLine(y);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+      uint64_t word;
+      memcpy(&word, row + x, sizeof(word));
+      hash = (hash ^ word) * mul;
+      hash ^= hash >> 29;
+    }
+    for (; x < width; x++)
+      hash = (hash ^ row[x]) * mul;
+  }
+  return hash;
+}
+
+// Tells whether the mask pixels are exactly the same as the copy's
+bool nav_mask_equals(const NavMaskCopy &copy, Bitmap *mask, uint64_t hash)
+{
+  const int width = mask->GetWidth();
+  const int height = mask->GetHeight();
+  if (copy.Hash != hash || copy.Width != width || copy.Height != height)
+    return false;
+  for (int y = 0; y < height; y++)
+  {
+    if (memcmp(&copy.Pixels[y * width], mask->GetScanLine(y), width) != 0)
+      return false;
+  }
+  return true;
+}
+
+// Finds the cached copy of the mask, or makes a new one; cached routes
+// for the same mask share the copy
+std::shared_ptr<NavMaskCopy> copy_nav_mask(Bitmap *mask, uint64_t hash)
+{
+  for (std::list<CachedRoute>::const_iterator it = route_cache.begin(); it != route_cache.end(); ++it)
+  {
+    if (nav_mask_equals(*it->Mask, mask, hash))
+      return it->Mask;
+  }
+  std::shared_ptr<NavMaskCopy> copy(new NavMaskCopy());
+  copy->Hash = hash;
+  copy->Width = mask->GetWidth();
+  copy->Height = mask->GetHeight();
+  copy->Pixels.resize(copy->Width * copy->Height);
+  for (int y = 0; y < copy->Height; y++)
+    memcpy(&copy->Pixels[y * copy->Width], mask->GetScanLine(y), copy->Width);
+  return copy;
+}
 
-  for (int y=0; y<wallscreen->GetHeight(); y++)
-    nav.SetMapRow(y, wallscreen->GetScanLine(y));
+// Clears remembered routes
+void reset_route_cache()
+{
+  std::lock_guard<std::mutex> lock(route_cache_mutex);
+  route_cache.clear();
 }
 
 int can_see_from(int x1, int y1, int x2, int y2)
@@ -76,34 +222,72 @@ int can_see_from(int x1, int y1, int x2, int y2)
 
   sync_nav_wallscreen();
 
-  return !nav.TraceLine(x1, y1, x2, y2, lastcx, lastcy);
+  return !nav.Nav.TraceLine(x1, y1, x2, y2, lastcx, lastcy);
 }
 
-// new routing using JPS
-int find_route_jps(int fromx, int fromy, int destx, int desty)
+// new routing using JPS; fills the navpoints and returns their number, or
+// 0 if there's no route. Only uses the given workspace and the route cache,
+// so may be run by any thread.
+int find_route_jps(NavWorkspace &ws, Bitmap *mask, int fromx, int fromy, int destx, int desty, int *points)
 {
-  sync_nav_wallscreen();
+  const uint64_t mask_hash = hash_nav_mask(mask);
+  {
+    std::lock_guard<std::mutex> lock(route_cache_mutex);
+    for (std::list<CachedRoute>::iterator it = route_cache.begin(); it != route_cache.end(); ++it)
+    {
+      if (it->FromX != fromx || it->FromY != fromy ||
+          it->DestX != destx || it->DestY != desty ||
+          !nav_mask_equals(*it->Mask, mask, mask_hash))
+        continue;
+      route_cache.splice(route_cache.begin(), route_cache, it);
+      std::copy(it->NavPoints.begin(), it->NavPoints.end(), points);
+      return it->Found ? (int)it->NavPoints.size() : 0;
+    }
+  }
+
+  sync_nav_mask(ws, mask);
 
-  static std::vector<int> path, cpath;
+  std::vector<int> &path = ws.Path, &cpath = ws.CPath;
   path.clear();
   cpath.clear();
 
-  if (nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) == Navigation::NAV_UNREACHABLE)
-    return 0;
-
-  num_navpoints = 0;
+  CachedRoute route;
+  route.FromX = fromx;
+  route.FromY = fromy;
+  route.DestX = destx;
+  route.DestY = desty;
+  route.Found = ws.Nav.NavigateRefined(fromx, fromy, destx, desty, path, cpath) != Navigation::NAV_UNREACHABLE;
 
-  // new behavior: cut path if too complex rather than abort with error message
-  int count = std::min<int>((int)cpath.size(), MAXNAVPOINTS);
-
-  for (int i = 0; i<count; i++)
+  int num_points = 0;
+  if (route.Found)
   {
-    int x, y;
-    nav.UnpackSquare(cpath[i], x, y);
+    // new behavior: cut path if too complex rather than abort with error message
+    int count = std::min<int>((int)cpath.size(), MAXNAVPOINTS);
+
+    for (int i = 0; i<count; i++)
+    {
+      int x, y;
+      ws.Nav.UnpackSquare(cpath[i], x, y);
 
-    navpoints[num_navpoints++] = MAKE_INTCOORD(x, y);
+      points[num_points++] = MAKE_INTCOORD(x, y);
+    }
+    route.NavPoints.assign(points, points + num_points);
   }
 
+  std::lock_guard<std::mutex> lock(route_cache_mutex);
+  route.Mask = copy_nav_mask(mask, mask_hash);
+  if (route_cache.size() >= ROUTE_CACHE_SIZE)
+    route_cache.pop_back();
+  route_cache.push_front(route);
+  return num_points;
+}
+
+int find_route_jps(int fromx, int fromy, int destx, int desty)
+{
+  const int num_points = find_route_jps(nav, wallscreen, fromx, fromy, destx, desty, navpoints);
+  if (!num_points)
+    return 0;
+  num_navpoints = num_points;
   return 1;
 }
 
@@ -203,43 +387,70 @@ void calculate_move_stage(MoveList * mlsp, int aaa)
 }
 
 
-int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+// Finds the route on the given mask, fills the points and returns their
+// number, or 0 if there's no route; optionally returns the last point
+// which may be seen from the start, like can_see_from does
+int solve_route(NavWorkspace &ws, Bitmap *mask, short srcx, short srcy, short xx, short yy,
+                int nocross, int ignore_walls, int *points, int *lastx = NULL, int *lasty = NULL)
 {
-  int i;
-
-  wallscreen = onscreen;
+  int num_points = 0;
 
-  num_navpoints = 0;
+  if (ignore_walls)
+  {
+    num_points = 2;
+  }
+  else
+  {
+    int cx = srcx, cy = srcy;
+    if (srcx == xx && srcy == yy)
+    {
+      num_points = 2;
+    }
+    else
+    {
+      sync_nav_mask(ws, mask);
+      if (!ws.Nav.TraceLine(srcx, srcy, xx, yy, cx, cy))
+        num_points = 2;
+    }
+    if (lastx)
+      *lastx = cx;
+    if (lasty)
+      *lasty = cy;
+  }
 
-  if (ignore_walls || can_see_from(srcx, srcy, xx, yy))
+  if (num_points)
   {
-    num_navpoints = 2;
-    navpoints[0] = MAKE_INTCOORD(srcx, srcy);
-    navpoints[1] = MAKE_INTCOORD(xx, yy);
+    points[0] = MAKE_INTCOORD(srcx, srcy);
+    points[1] = MAKE_INTCOORD(xx, yy);
   } else {
-    if ((nocross == 0) && (wallscreen->GetPixel(xx, yy) == 0))
+    if ((nocross == 0) && (mask->GetPixel(xx, yy) == 0))
       return 0; // clicked on a wall
 
-    find_route_jps(srcx, srcy, xx, yy);
+    num_points = find_route_jps(ws, mask, srcx, srcy, xx, yy, points);
   }
 
-  if (!num_navpoints)
+  if (!num_points)
     return 0;
 
   // FIXME: really necessary?
-  if (num_navpoints == 1)
-    navpoints[num_navpoints++] = navpoints[0];
+  if (num_points == 1)
+    points[num_points++] = points[0];
 
-  assert(num_navpoints <= MAXNAVPOINTS);
+  assert(num_points <= MAXNAVPOINTS);
+  return num_points;
+}
 
-//    Display("Route from %d,%d to %d,%d - %d stages", srcx,srcy,xx,yy,num_navpoints);
+// Sets up the movelist for walking along the found route
+void fill_move_list(int movlst, short srcx, short srcy, const int *points, int num_points)
+{
+//    Display("Route from %d,%d to %d,%d - %d stages", srcx,srcy,xx,yy,num_points);
 
   int mlist = movlst;
-  mls[mlist].numstage = num_navpoints;
-  memcpy(&mls[mlist].pos[0], &navpoints[0], sizeof(int) * num_navpoints);
-//    fprintf(stderr,"stages: %d\n",num_navpoints);
+  mls[mlist].numstage = num_points;
+  memcpy(&mls[mlist].pos[0], &points[0], sizeof(int) * num_points);
+//    fprintf(stderr,"stages: %d\n",num_points);
 
-  for (i=0; i<num_navpoints-1; i++)
+  for (int i=0; i<num_points-1; i++)
     calculate_move_stage(&mls[mlist], i);
 
   mls[mlist].fromx = srcx;
@@ -249,5 +460,63 @@ int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int
   mls[mlist].doneflag = 0;
   mls[mlist].lastx = -1;
   mls[mlist].lasty = -1;
-  return mlist;
+}
+
+int find_route(short srcx, short srcy, short xx, short yy, Bitmap *onscreen, int movlst, int nocross, int ignore_walls)
+{
+  wallscreen = onscreen;
+
+  num_navpoints = solve_route(nav, wallscreen, srcx, srcy, xx, yy, nocross, ignore_walls, navpoints,
+    &lastcx, &lastcy);
+  if (!num_navpoints)
+    return 0;
+
+  fill_move_list(movlst, srcx, srcy, navpoints, num_navpoints);
+  return movlst;
+}
+
+void find_routes(std::vector<RouteRequest> &requests)
+{
+  std::vector<std::vector<int> > points(requests.size());
+  if (route_threads && requests.size() > 1)
+  {
+    route_threads->RunForEach(requests.size(), [&requests, &points](size_t i)
+    {
+      NavWorkspace *ws;
+      {
+        std::lock_guard<std::mutex> lock(nav_free_mutex);
+        ws = nav_free.back();
+        nav_free.pop_back();
+      }
+      const RouteRequest &r = requests[i];
+      points[i].resize(MAXNAVPOINTS);
+      points[i].resize(solve_route(*ws, r.Mask, r.FromX, r.FromY, r.DestX, r.DestY,
+        r.NoCross, r.IgnoreWalls, &points[i][0]));
+      std::lock_guard<std::mutex> lock(nav_free_mutex);
+      nav_free.push_back(ws);
+    });
+  }
+  else
+  {
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+      const RouteRequest &r = requests[i];
+      points[i].resize(MAXNAVPOINTS);
+      points[i].resize(solve_route(nav, r.Mask, r.FromX, r.FromY, r.DestX, r.DestY,
+        r.NoCross, r.IgnoreWalls, &points[i][0]));
+    }
+  }
+
+  // movelists are filled in the order of requests, same as if they were
+  // found one by one
+  for (size_t i = 0; i < requests.size(); ++i)
+  {
+    RouteRequest &r = requests[i];
+    r.Result = 0;
+    if (points[i].empty())
+      continue;
+    set_route_move_speed(r.SpeedX, r.SpeedY);
+    fill_move_list(r.MoveList, r.FromX, r.FromY, &points[i][0], (int)points[i].size());
+    r.Result = r.MoveList;
+  }
 }
@@ -15,16 +15,39 @@
 #ifndef __AC_ROUTEFND_H
 #define __AC_ROUTEFND_H
 
+#include <vector>
 #include "ac/movelist.h"
 
 void calculate_move_stage(MoveList * mlsp, int aaa);
 int can_see_from(int x1, int y1, int x2, int y2);
 
-void init_pathfinder();
+// Initializes pathfinder, which uses given number of threads for solving
+// batched route requests; 0 means as many as there are CPU cores
+void init_pathfinder(int thread_count = 1);
+// Clears the routes remembered for the repeated requests
+void reset_route_cache();
 void set_route_move_speed(int speed_x, int speed_y);
 int find_route(short srcx, short srcy, short xx, short yy, Common::Bitmap *onscreen, int movlst, int nocross =
                0, int ignore_walls = 0);
 
+// Parameters of the route search, and its result
+struct RouteRequest
+{
+    short FromX, FromY;
+    short DestX, DestY;
+    Common::Bitmap *Mask; // walkable mask, must stay unchanged until routes are found
+    int   MoveList;
+    int   NoCross;
+    int   IgnoreWalls;
+    int   SpeedX, SpeedY;
+    int   Result; // same as find_route would return
+};
+
+// Finds routes for several requests at once, possibly in parallel, and sets
+// up their movelists. The results are same as if find_route were called for
+// each of them in turn, but the movement speed is left set to the last one.
+void find_routes(std::vector<RouteRequest> &requests);
+
 extern Common::Bitmap *wallscreen;
 extern int lastcx, lastcy;
 
@@ -144,7 +144,13 @@ void initialize_sprite (int ee) {
         game.SpriteInfos[ee].Width=spriteset[ee]->GetWidth();
         game.SpriteInfos[ee].Height=spriteset[ee]->GetHeight();
 
-        spriteset.Set(ee, PrepareSpriteForUse(spriteset[ee], (game.SpriteInfos[ee].Flags & SPF_ALPHACHANNEL) != 0));
+        // Image made over the mapped sprite file is read-only
+        const bool has_alpha = (game.SpriteInfos[ee].Flags & SPF_ALPHACHANNEL) != 0;
+        if (spriteset.IsImageMapped(curspr) &&
+            (IsBitmapAdjustedInPlace(curspr, has_alpha) || pl_any_want_hook(AGSE_SPRITELOAD)))
+            curspr = spriteset.GetWritableImage(ee);
+
+        spriteset.Set(ee, PrepareSpriteForUse(spriteset[ee], has_alpha));
 
         if (game.GetColorDepth() < 32) {
             game.SpriteInfos[ee].Flags &= ~SPF_ALPHACHANNEL;
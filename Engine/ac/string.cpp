@@ -12,6 +12,8 @@
 //
 //=============================================================================
 
+#include <list>
+#include <vector>
 #include "ac/string.h"
 #include "ac/common.h"
 #include "ac/display.h"
@@ -21,6 +23,7 @@
 #include "ac/runtime_defines.h"
 #include "ac/dynobj/scriptstring.h"
 #include "debug/debug_log.h"
+#include "font/fonts.h"
 #include "util/string_utils.h"
 #include "script/runtimescriptvalue.h"
 
@@ -31,6 +34,64 @@ extern GameState play;
 extern int longestline;
 extern ScriptString myScriptStringImpl;
 
+using AGS::Common::String;
+
+// Maximal number of laid out texts remembered
+#define TEXT_LAYOUT_CACHE_SIZE 64
+
+// Text broken up into lines; the same texts are usually laid out again and
+// again every frame, e.g. dialog options and labels
+struct TextLayout
+{
+    String  Text;
+    int     Width;
+    int     Font;
+    bool    RightToLeft;
+    std::vector<String> Lines;
+    int     LongestLine;
+};
+
+// Recently laid out texts, the most recently used first
+static std::list<TextLayout> text_layouts;
+static int text_layouts_font_changes = -1;
+
+static bool find_text_layout(int wii, int fonnt, const char *todis)
+{
+    if (text_layouts_font_changes != get_font_change_count())
+    {
+        text_layouts.clear();
+        text_layouts_font_changes = get_font_change_count();
+        return false;
+    }
+    const bool rtl = game.options[OPT_RIGHTLEFTWRITE] != 0;
+    for (std::list<TextLayout>::iterator it = text_layouts.begin(); it != text_layouts.end(); ++it)
+    {
+        if (it->Width != wii || it->Font != fonnt || it->RightToLeft != rtl || it->Text.Compare(todis) != 0)
+            continue;
+        text_layouts.splice(text_layouts.begin(), text_layouts, it);
+        for (numlines = 0; numlines < (int)it->Lines.size(); numlines++)
+            strcpy(lines[numlines], it->Lines[numlines]);
+        longestline = it->LongestLine;
+        return true;
+    }
+    return false;
+}
+
+static void add_text_layout(int wii, int fonnt, const char *todis)
+{
+    if (text_layouts.size() >= TEXT_LAYOUT_CACHE_SIZE)
+        text_layouts.pop_back();
+    text_layouts.push_front(TextLayout());
+    TextLayout &layout = text_layouts.front();
+    layout.Text = todis;
+    layout.Width = wii;
+    layout.Font = fonnt;
+    layout.RightToLeft = game.options[OPT_RIGHTLEFTWRITE] != 0;
+    for (int i = 0; i < numlines; ++i)
+        layout.Lines.push_back(lines[i]);
+    layout.LongestLine = longestline;
+}
+
 int String_IsNullOrEmpty(const char *thisString) 
 {
     if ((thisString == NULL) || (thisString[0] == 0))
@@ -258,6 +319,9 @@ void break_up_text_into_lines(int wii,int fonnt, const char*todis) {
     if (wii < 3)
         return;
 
+    if (find_text_layout(wii, fonnt, todis))
+        return;
+
     int rr;
     int line_length;
 
@@ -278,6 +342,8 @@ void break_up_text_into_lines(int wii,int fonnt, const char*todis) {
             if (line_length > longestline)
                 longestline = line_length;
         }
+
+    add_text_layout(wii, fonnt, todis);
 }
 
 int MAXSTRLEN = MAX_MAXSTRLEN;
@@ -34,7 +34,7 @@ void TextBox_GetText(GUITextBox *texbox, char *buffer) {
 void TextBox_SetText(GUITextBox *texbox, const char *newtex) {
     if (strcmp(texbox->Text, newtex)) {
         texbox->Text = newtex;
-        guis_need_update = 1;
+        texbox->MarkChanged();
     }
 }
 
@@ -47,7 +47,7 @@ void TextBox_SetTextColor(GUITextBox *guit, int colr)
     if (guit->TextColor != colr) 
     {
         guit->TextColor = colr;
-        guis_need_update = 1;
+        guit->MarkChanged();
     }
 }
 
@@ -61,7 +61,7 @@ void TextBox_SetFont(GUITextBox *guit, int fontnum) {
 
     if (guit->Font != fontnum) {
         guit->Font = fontnum;
-        guis_need_update = 1;
+        guit->MarkChanged();
     }
 }
 
@@ -74,7 +74,7 @@ void TextBox_SetShowBorder(GUITextBox *guit, bool on)
     if (guit->IsBorderShown() != on)
     {
         guit->SetShowBorder(on);
-        guis_need_update = 1;
+        guit->MarkChanged();
     }
 }
 
@@ -0,0 +1,156 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include "ac/transformedspritecache.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+TransformedSpriteCache transformed_sprites;
+
+TransformedSpriteKey::TransformedSpriteKey()
+    : Sprite(0)
+    , Width(0)
+    , Height(0)
+    , Mirrored(false)
+    , Antialiased(false)
+    , TintAmount(0)
+    , TintRed(0)
+    , TintGreen(0)
+    , TintBlue(0)
+    , TintLight(0)
+    , LightLevel(0)
+{
+}
+
+bool TransformedSpriteKey::operator ==(const TransformedSpriteKey &other) const
+{
+    return Sprite == other.Sprite && Width == other.Width && Height == other.Height &&
+        Mirrored == other.Mirrored && Antialiased == other.Antialiased &&
+        TintAmount == other.TintAmount && TintRed == other.TintRed &&
+        TintGreen == other.TintGreen && TintBlue == other.TintBlue &&
+        TintLight == other.TintLight && LightLevel == other.LightLevel;
+}
+
+size_t TransformedSpriteKeyHash::operator ()(const TransformedSpriteKey &key) const
+{
+    size_t hash = (size_t)key.Sprite;
+    const int fields[] = { key.Width, key.Height, key.Mirrored, key.Antialiased, key.TintAmount,
+        key.TintRed, key.TintGreen, key.TintBlue, key.TintLight, key.LightLevel };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i)
+        hash = hash * 31 + (size_t)fields[i];
+    return hash;
+}
+
+TransformedSpriteCache::Stats::Stats()
+    : Hits(0)
+    , Misses(0)
+    , Evictions(0)
+{
+}
+
+TransformedSpriteCache::TransformedSpriteCache()
+    : _cacheSize(0)
+{
+}
+
+TransformedSpriteCache::~TransformedSpriteCache()
+{
+    Clear();
+}
+
+Bitmap *TransformedSpriteCache::Get(const TransformedSpriteKey &key)
+{
+    EntryMap::iterator it = _entries.find(key);
+    if (it == _entries.end())
+    {
+        _stats.Misses++;
+        return NULL;
+    }
+    _stats.Hits++;
+    _lru.splice(_lru.end(), _lru, it->second.LruIt);
+    return it->second.Image;
+}
+
+void TransformedSpriteCache::Put(const TransformedSpriteKey &key, Bitmap *image)
+{
+    EntryMap::iterator it = _entries.find(key);
+    if (it != _entries.end())
+        Remove(it);
+
+    const size_t size = image->GetWidth() * image->GetHeight() * image->GetBPP();
+    const size_t limit = GetMaxCacheSize();
+    if (size > limit)
+        return;
+    FreeMem(limit - size);
+
+    Entry entry;
+    entry.Image = BitmapHelper::CreateBitmapCopy(image);
+    entry.Size = size;
+    entry.LruIt = _lru.insert(_lru.end(), key);
+    _entries[key] = entry;
+    _cacheSize += size;
+}
+
+void TransformedSpriteCache::InvalidateSprite(sprkey_t sprite)
+{
+    for (EntryMap::iterator it = _entries.begin(); it != _entries.end();)
+    {
+        EntryMap::iterator cur = it++;
+        if (cur->first.Sprite == sprite)
+            Remove(cur);
+    }
+}
+
+void TransformedSpriteCache::Clear()
+{
+    for (EntryMap::iterator it = _entries.begin(); it != _entries.end(); ++it)
+        delete it->second.Image;
+    _entries.clear();
+    _lru.clear();
+    _cacheSize = 0;
+}
+
+size_t TransformedSpriteCache::GetCacheSize() const
+{
+    return _cacheSize;
+}
+
+size_t TransformedSpriteCache::GetMaxCacheSize() const
+{
+    // follow the sprite cache limit, which may be changed by the user config
+    return spriteset.GetMaxCacheSize() / 100 * TRANSFORMCACHEPERCENT;
+}
+
+const TransformedSpriteCache::Stats &TransformedSpriteCache::GetStats() const
+{
+    return _stats;
+}
+
+void TransformedSpriteCache::FreeMem(size_t limit)
+{
+    while (_cacheSize > limit && !_lru.empty())
+    {
+        Remove(_entries.find(_lru.front()));
+        _stats.Evictions++;
+    }
+}
+
+void TransformedSpriteCache::Remove(EntryMap::iterator it)
+{
+    _cacheSize -= it->second.Size;
+    delete it->second.Image;
+    _lru.erase(it->second.LruIt);
+    _entries.erase(it);
+}
@@ -0,0 +1,118 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Cache of sprites scaled, flipped and tinted by the software renderer,
+// shared by all characters and objects. Unlike the per-character and
+// per-object caches, which only remember the last image, this one keeps
+// images of any combination of transformations until memory limit is hit,
+// so that many characters using same views reuse each others images.
+//
+// The memory limit is a percentage of the sprite cache limit. Images are
+// released when the limit is exceeded, least recently used first, and when
+// the source sprite is changed or deleted.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__TRANSFORMEDSPRITECACHE_H
+#define __AGS_EE_AC__TRANSFORMEDSPRITECACHE_H
+
+#include <list>
+#include "util/stdtr1compat.h"
+#include TR1INCLUDE(unordered_map)
+#include "ac/spritecache.h"
+
+namespace AGS { namespace Common { class Bitmap; } }
+
+// Max size of the transformed sprites cache, in percents of the sprite cache limit
+#define TRANSFORMCACHEPERCENT 25
+
+// Describes the way sprite was drawn
+struct TransformedSpriteKey
+{
+    sprkey_t Sprite;
+    int      Width;         // final size, after scaling
+    int      Height;
+    bool     Mirrored;
+    bool     Antialiased;
+    int      TintAmount;
+    int      TintRed;
+    int      TintGreen;
+    int      TintBlue;
+    int      TintLight;
+    int      LightLevel;
+
+    TransformedSpriteKey();
+    bool operator ==(const TransformedSpriteKey &other) const;
+};
+
+struct TransformedSpriteKeyHash
+{
+    size_t operator ()(const TransformedSpriteKey &key) const;
+};
+
+class TransformedSpriteCache
+{
+public:
+    // Cache usage statistics
+    struct Stats
+    {
+        uint64_t Hits;          // requests for images already in cache
+        uint64_t Misses;        // requests for images not in cache
+        uint64_t Evictions;     // number of images released to free space
+
+        Stats();
+    };
+
+    TransformedSpriteCache();
+    ~TransformedSpriteCache();
+
+    // Returns cached image, or NULL if there is none; the image remains
+    // owned by the cache and may only be used until the next Put
+    Common::Bitmap *Get(const TransformedSpriteKey &key);
+    // Stores a copy of the image, releasing older images if needed
+    void        Put(const TransformedSpriteKey &key, Common::Bitmap *image);
+    // Releases all images made of the given sprite
+    void        InvalidateSprite(sprkey_t sprite);
+    // Releases all images
+    void        Clear();
+    // Returns current size of the cache, in bytes
+    size_t      GetCacheSize() const;
+    // Returns maximal size limit of the cache, in bytes
+    size_t      GetMaxCacheSize() const;
+    // Returns cache usage statistics
+    const Stats &GetStats() const;
+
+private:
+    typedef std::list<TransformedSpriteKey> LruList;
+    struct Entry
+    {
+        Common::Bitmap     *Image;
+        size_t              Size;
+        LruList::iterator   LruIt;
+    };
+    typedef stdtr1compat::unordered_map<TransformedSpriteKey, Entry, TransformedSpriteKeyHash> EntryMap;
+
+    // Releases least recently used images until the cache fits the limit
+    void        FreeMem(size_t limit);
+    void        Remove(EntryMap::iterator it);
+
+    EntryMap    _entries;
+    // Least recently used images are at the front
+    LruList     _lru;
+    size_t      _cacheSize;
+    Stats       _stats;
+};
+
+extern TransformedSpriteCache transformed_sprites;
+
+#endif // __AGS_EE_AC__TRANSFORMEDSPRITECACHE_H
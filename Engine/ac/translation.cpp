@@ -20,7 +20,7 @@
 #include "ac/global_game.h"
 #include "ac/runtime_defines.h"
 #include "ac/translation.h"
-#include "ac/tree_map.h"
+#include "ac/translationtable.h"
 #include "ac/wordsdictionary.h"
 #include "debug/out.h"
 #include "util/misc.h"
@@ -35,14 +35,14 @@ extern GameState play;
 extern char transFileName[MAX_PATH];
 
 
-TreeMap *transtree = NULL;
+TranslationTable *transtable = NULL;
 long lang_offs_start = 0;
 char transFileName[MAX_PATH] = "\0";
 
 void close_translation () {
-    if (transtree != NULL) {
-        delete transtree;
-        transtree = NULL;
+    if (transtable != NULL) {
+        delete transtable;
+        transtable = NULL;
     }
 }
 
@@ -71,11 +71,11 @@ bool init_translation (const String &lang, const String &fallback_lang, bool qui
         return false;
     }
 
-    if (transtree != NULL)
+    if (transtable != NULL)
     {
         close_translation();
     }
-    transtree = new TreeMap();
+    transtable = new TranslationTable();
 
     String parse_error;
     bool result = parse_translation(language_file, parse_error);
@@ -126,7 +126,7 @@ bool parse_translation(Stream *language_file, String &parse_error)
                     parse_error = "Translation file is corrupt";
                     return false;
                 }
-                transtree->addText (original, translation);
+                transtable->AddText (original, translation);
             }
 
         }
@@ -169,7 +169,7 @@ bool parse_translation(Stream *language_file, String &parse_error)
         }
     }
 
-    if (transtree->text == NULL)
+    if (transtable->GetCount() == 0)
     {
         parse_error = "The translation file was empty.";
         return false;
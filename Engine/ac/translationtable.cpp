@@ -0,0 +1,100 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#include <string.h>
+#include <algorithm>
+#include "ac/translationtable.h"
+#include "util/string_types.h"
+
+// Initial number of slots; the table grows when it gets half full
+const size_t MIN_SLOT_COUNT = 64;
+
+TranslationTable::TranslationTable()
+{
+}
+
+void TranslationTable::AddText(const char *text, const char *translation)
+{
+    if ((text == NULL) || (text[0] == 0))
+        // don't add if it's an empty string
+        return;
+
+    if (_slots.size() < (_entries.size() + 1) * 2)
+        Rehash(std::max(MIN_SLOT_COUNT, _slots.size() * 2));
+
+    const size_t text_len = strlen(text);
+    const uint32_t hash = (uint32_t)FNV::Hash(text, text_len);
+    const size_t slot = FindSlot(text, hash);
+    if (_slots[slot] != 0)
+        // already here
+        return;
+
+    Entry entry;
+    entry.Hash = hash;
+    entry.Text = (uint32_t)_strings.size();
+    _strings.insert(_strings.end(), text, text + text_len + 1);
+    entry.Translation = (uint32_t)_strings.size();
+    _strings.insert(_strings.end(), translation, translation + strlen(translation) + 1);
+    _entries.push_back(entry);
+    _slots[slot] = (uint32_t)_entries.size();
+}
+
+const char *TranslationTable::FindValue(const char *text) const
+{
+    if (_entries.empty())
+        return NULL;
+    const size_t slot = FindSlot(text, (uint32_t)FNV::Hash(text, strlen(text)));
+    if (_slots[slot] == 0)
+        return NULL;
+    return &_strings[_entries[_slots[slot] - 1].Translation];
+}
+
+size_t TranslationTable::GetCount() const
+{
+    return _entries.size();
+}
+
+void TranslationTable::Clear()
+{
+    _strings.clear();
+    _entries.clear();
+    _slots.clear();
+}
+
+size_t TranslationTable::FindSlot(const char *text, uint32_t hash) const
+{
+    const size_t mask = _slots.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+    {
+        const uint32_t index = _slots[slot];
+        if (index == 0)
+            return slot;
+        const Entry &entry = _entries[index - 1];
+        if (entry.Hash == hash && strcmp(&_strings[entry.Text], text) == 0)
+            return slot;
+    }
+}
+
+void TranslationTable::Rehash(size_t slot_count)
+{
+    _slots.assign(slot_count, 0);
+    const size_t mask = slot_count - 1;
+    for (size_t i = 0; i < _entries.size(); ++i)
+    {
+        size_t slot = _entries[i].Hash & mask;
+        while (_slots[slot] != 0)
+            slot = (slot + 1) & mask;
+        _slots[slot] = (uint32_t)(i + 1);
+    }
+}
@@ -0,0 +1,63 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+//
+// Hash table holding translations. All texts are stored one after another
+// in a single buffer, and the table keeps their offsets along with the
+// hashes of the original texts, so that a lookup only compares the strings
+// whose hashes are equal.
+//
+//=============================================================================
+#ifndef __AGS_EE_AC__TRANSLATIONTABLE_H
+#define __AGS_EE_AC__TRANSLATIONTABLE_H
+
+#include <vector>
+#include "core/types.h"
+
+class TranslationTable
+{
+public:
+    TranslationTable();
+
+    // Adds the text and its translation; does nothing if the text is empty
+    // or was already added
+    void        AddText(const char *text, const char *translation);
+    // Returns translation of the text, or NULL if there's none; the returned
+    // string is valid until the table is changed
+    const char *FindValue(const char *text) const;
+    // Returns number of texts in the table
+    size_t      GetCount() const;
+    // Removes all texts
+    void        Clear();
+
+private:
+    struct Entry
+    {
+        uint32_t Hash;
+        uint32_t Text;          // offsets in the string buffer
+        uint32_t Translation;
+    };
+
+    // Returns the slot which holds the text, or the empty one where it belongs
+    size_t      FindSlot(const char *text, uint32_t hash) const;
+    // Resizes the slot table and puts all entries to it anew
+    void        Rehash(size_t slot_count);
+
+    std::vector<char>     _strings;
+    std::vector<Entry>    _entries;
+    // Open addressing table of entry indexes plus one, 0 marks empty slot;
+    // the number of slots is a power of two
+    std::vector<uint32_t> _slots;
+};
+
+#endif // __AGS_EE_AC__TRANSLATIONTABLE_H
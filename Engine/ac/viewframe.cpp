@@ -117,6 +117,15 @@ void precache_view(int view)
     }
 }
 
+void prefetch_view_loop(int view, int loop)
+{
+    if ((view < 0) || (view >= game.numviews) || (loop < 0) || (loop >= views[view].numLoops))
+        return;
+
+    for (int j = 0; j < views[view].loops[loop].numFrames; j++)
+        spriteset.Prefetch(views[view].loops[loop].frames[j].pic);
+}
+
 // the specified frame has just appeared, see if we need
 // to play a sound or whatever
 void CheckViewFrame (int view, int loop, int frame, int sound_volume) {
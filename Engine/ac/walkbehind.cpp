@@ -12,6 +12,7 @@
 //
 //=============================================================================
 
+#include <vector>
 #include "ac/walkbehind.h"
 #include "ac/common.h"
 #include "ac/common_defines.h"
@@ -37,6 +38,10 @@ IDriverDependantBitmap *walkBehindBitmap[MAX_WALK_BEHINDS];
 int walkBehindsCachedForBgNum = 0;
 WalkBehindMethodEnum walkBehindMethod = DrawOverCharSprite;
 int walk_behind_baselines_changed = 0;
+// Walk-behind mask pixels as spans, row by row; spans of row Y are
+// indexed [walkBehindRowSpans[Y], walkBehindRowSpans[Y + 1])
+std::vector<WalkBehindSpan> walkBehindSpans;
+std::vector<int> walkBehindRowSpans;
 
 void update_walk_behind_images()
 {
@@ -137,6 +142,30 @@ void recache_walk_behinds () {
     }
   }
 
+  // area baselines are not a part of the spans, so these need to be updated
+  // only when the mask changes
+  walkBehindSpans.clear();
+  walkBehindRowSpans.resize(thisroom.WalkBehindMask->GetHeight() + 1);
+  for (rr = 0; rr < thisroom.WalkBehindMask->GetHeight(); rr++) {
+    walkBehindRowSpans[rr] = walkBehindSpans.size();
+    const unsigned char *mask_line = thisroom.WalkBehindMask->GetScanLine(rr);
+    for (ee = 0; ee < thisroom.WalkBehindMask->GetWidth(); ) {
+      tmm = mask_line[ee];
+      int span_end = ee + 1;
+      while (span_end < thisroom.WalkBehindMask->GetWidth() && mask_line[span_end] == tmm)
+        span_end++;
+      if ((tmm >= 1) && (tmm < MAX_WALK_BEHINDS)) {
+        WalkBehindSpan span;
+        span.X1 = ee;
+        span.X2 = span_end;
+        span.Area = tmm;
+        walkBehindSpans.push_back(span);
+      }
+      ee = span_end;
+    }
+  }
+  walkBehindRowSpans[thisroom.WalkBehindMask->GetHeight()] = walkBehindSpans.size();
+
   if (walkBehindMethod == DrawAsSeparateSprite)
   {
     update_walk_behind_images();
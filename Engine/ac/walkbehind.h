@@ -25,6 +25,14 @@ enum WalkBehindMethodEnum
     DrawAsSeparateCharSprite
 };
 
+// Horizontal run of walk-behind mask pixels belonging to the same area
+struct WalkBehindSpan
+{
+    int X1;     // first column
+    int X2;     // column past the last one
+    int Area;
+};
+
 void update_walk_behind_images();
 void recache_walk_behinds ();
 
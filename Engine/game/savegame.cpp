@@ -12,6 +12,9 @@
 //
 //=============================================================================
 
+#include <atomic>
+#include <deque>
+#include <thread>
 #include "ac/character.h"
 #include "ac/common.h"
 #include "ac/draw.h"
@@ -50,6 +53,7 @@
 #include "script/cc_error.h"
 #include "util/alignedstream.h"
 #include "util/file.h"
+#include "util/memorystream.h"
 #include "util/stream.h"
 #include "util/string_utils.h"
 
@@ -158,6 +162,8 @@ String GetSavegameErrorText(SavegameErrorType err)
         return "Saved with the engine running at a different colour depth.";
     case kSvgErr_GameObjectInitFailed:
         return "Game object initialization failed after save restoration.";
+    case kSvgErr_BaseSavegameMismatch:
+        return "Base savegame is missing, or does not match the incremental save.";
     }
     return "Unknown error.";
 }
@@ -267,6 +273,8 @@ HSaveError ReadDescription_v321(Stream *in, SavegameVersion &svg_ver, SavegameDe
 
 HSaveError OpenSavegameBase(const String &filename, SavegameSource *src, SavegameDescription *desc, SavegameDescElem elems)
 {
+    // the file may be still written in background
+    WaitForSavegameWrite();
     UStream in(File::OpenFileRead(filename));
     if (!in.get())
         return new SavegameError(kSvgErr_FileOpenFailed, String::FromFormat("Requested filename: %s.", filename.GetCStr()));
@@ -637,14 +645,14 @@ HSaveError DoAfterRestore(const PreservedParams &pp, const RestoredData &r_data)
     return HSaveError::None();
 }
 
-HSaveError RestoreGameState(PStream in, SavegameVersion svg_version)
+HSaveError RestoreGameState(PStream in, SavegameVersion svg_version, const String &filename)
 {
     PreservedParams pp;
     RestoredData r_data;
     DoBeforeRestore(pp);
     HSaveError err;
     if (svg_version >= kSvgVersion_Components)
-        err = SavegameComponents::ReadAll(in, svg_version, pp, r_data);
+        err = SavegameComponents::ReadAll(in, svg_version, filename, pp, r_data);
     else
         err = restore_game_data(in.get(), svg_version, pp, r_data);
     if (!err)
@@ -679,12 +687,9 @@ void WriteDescription(Stream *out, const String &user_text, const Bitmap *user_i
     WriteSaveImage(out, user_image);
 }
 
-PStream StartSavegame(const String &filename, const String &user_text, const Bitmap *user_image)
+// Writes the savegame headers and description block
+static void WriteSavegameHeader(Stream *out, const String &user_text, const Bitmap *user_image)
 {
-    Stream *out = Common::File::CreateFile(filename);
-    if (!out)
-        return PStream();
-
     // Initialize and write Vista header
     RICH_GAME_MEDIA_HEADER vistaHeader;
     memset(&vistaHeader, 0, sizeof(RICH_GAME_MEDIA_HEADER));
@@ -710,9 +715,180 @@ PStream StartSavegame(const String &filename, const String &user_text, const Bit
 
     // Write descrition block
     WriteDescription(out, user_text, user_image);
+}
+
+PStream StartSavegame(const String &filename, const String &user_text, const Bitmap *user_image)
+{
+    WaitForSavegameWrite();
+    Stream *out = Common::File::CreateFile(filename);
+    if (!out)
+        return PStream();
+    WriteSavegameHeader(out, user_text, user_image);
     return PStream(out);
 }
 
+PMemoryStream StartSavegameInMemory(const String &user_text, const Bitmap *user_image)
+{
+    PMemoryStream out(new MemoryStream());
+    WriteSavegameHeader(out.get(), user_text, user_image);
+    return out;
+}
+
+// Components of the last used base savegame, kept to make deltas without
+// reading the base file every time
+struct BaseSavegameCache
+{
+    String              Filename;
+    uint64_t            Id;
+    RawComponentList    Components;
+
+    BaseSavegameCache() : Id(0) {}
+};
+
+static BaseSavegameCache BaseCache;
+
+bool MakeDeltaSavegame(PMemoryStream data, soff_t data_start, const String &base_filename)
+{
+    RawComponentList cmps;
+    data->Seek(data_start, kSeekBegin);
+    HSaveError err = SavegameComponents::ReadAllRaw(data, kSvgVersion_Current, "", cmps);
+    const soff_t data_end = data->GetPosition();
+    data->Seek(0, kSeekEnd);
+    if (!err)
+        return false;
+
+    if (BaseCache.Filename.Compare(base_filename) != 0)
+    {
+        BaseCache = BaseSavegameCache();
+        SavegameSource src;
+        SavegameDescription desc;
+        err = OpenSavegame(base_filename, src, desc, kSvgDesc_None);
+        if (err)
+            err = SavegameComponents::ReadAllRaw(src.InputStream, src.Version, base_filename, BaseCache.Components);
+        if (err)
+        {
+            BaseCache.Filename = base_filename;
+            BaseCache.Id = SavegameComponents::GetComponentsHash(BaseCache.Components);
+        }
+    }
+
+    if (!BaseCache.Filename.IsEmpty())
+    {
+        PMemoryStream delta(new MemoryStream());
+        const String base_name = get_filename(base_filename);
+        SavegameComponents::WriteAllDelta(delta, cmps, base_name, BaseCache.Id, BaseCache.Components);
+        if (delta->GetLength() <= (data_end - data_start) / 2)
+        {
+            std::vector<uint8_t> &buf = data->GetBuffer();
+            const std::vector<uint8_t> &delta_buf = delta->GetBuffer();
+            buf.resize((size_t)data_start);
+            buf.insert(buf.end(), delta_buf.begin(), delta_buf.end());
+            data->Seek(0, kSeekEnd);
+            return true;
+        }
+    }
+
+    // the new savegame will become the base
+    BaseCache.Filename = base_filename;
+    BaseCache.Id = SavegameComponents::GetComponentsHash(cmps);
+    BaseCache.Components.swap(cmps);
+    return false;
+}
+
+void DeleteBaseSavegame(const String &base_filename)
+{
+    WaitForSavegameWrite();
+    if (BaseCache.Filename.Compare(base_filename) == 0)
+        BaseCache = BaseSavegameCache();
+    File::DeleteFile(base_filename);
+}
+
+// Savegame which is being written to the file in background
+struct SavegameWrite
+{
+    PMemoryStream       Data;
+    String              Filename;
+    String              BaseFilename;
+    int                 Slot;
+    std::thread         Thread;
+    std::atomic<bool>   Done;
+    bool                Success;
+
+    SavegameWrite() : Slot(0), Done(false), Success(false) {}
+};
+
+static std::unique_ptr<SavegameWrite> SaveWrite;
+// Results of the completed writes, not yet reported
+static std::deque<std::pair<int, bool> > SaveWritesDone;
+
+// Writes the data under a temporary name, and replaces the file with it
+static bool WriteSavegameFile(const std::vector<uint8_t> &data, const String &filename)
+{
+    const String temp_name = String::FromFormat("%s.tmp", filename.GetCStr());
+    Stream *out = File::CreateFile(temp_name);
+    bool success = out && out->Write(data.data(), data.size()) == data.size();
+    delete out;
+    if (success)
+        success = File::ReplaceFile(temp_name, filename);
+    if (!success)
+        File::DeleteFile(temp_name);
+    return success;
+}
+
+static void RunSavegameWrite(SavegameWrite *w)
+{
+    const std::vector<uint8_t> &data = w->Data->GetBuffer();
+    // the base is written first, so that a savegame never refers to a missing one
+    bool success = w->BaseFilename.IsEmpty() || WriteSavegameFile(data, w->BaseFilename);
+    if (success)
+        success = WriteSavegameFile(data, w->Filename);
+    w->Success = success;
+    w->Done = true;
+}
+
+// Joins the finished write thread and remembers its result
+static void FinishSavegameWrite()
+{
+    SaveWrite->Thread.join();
+    SaveWritesDone.push_back(std::make_pair(SaveWrite->Slot, SaveWrite->Success));
+    if (!SaveWrite->Success)
+    {
+        Debug::Printf(kDbgMsg_Error, "Failed to write savegame file: %s", SaveWrite->Filename.GetCStr());
+        // the base might not have been written, or the savegame refers to the wrong one
+        BaseCache = BaseSavegameCache();
+    }
+    SaveWrite.reset();
+}
+
+void WriteSavegameAsync(PMemoryStream data, const String &filename, int slot, const String &base_filename)
+{
+    WaitForSavegameWrite();
+    SaveWrite.reset(new SavegameWrite());
+    SaveWrite->Data = data;
+    SaveWrite->Filename = filename;
+    SaveWrite->BaseFilename = base_filename;
+    SaveWrite->Slot = slot;
+    SaveWrite->Thread = std::thread(RunSavegameWrite, SaveWrite.get());
+}
+
+void WaitForSavegameWrite()
+{
+    if (SaveWrite)
+        FinishSavegameWrite();
+}
+
+bool PollSavegameWrite(int &slot, bool &success)
+{
+    if (SaveWrite && SaveWrite->Done)
+        FinishSavegameWrite();
+    if (SaveWritesDone.empty())
+        return false;
+    slot = SaveWritesDone.front().first;
+    success = SaveWritesDone.front().second;
+    SaveWritesDone.pop_front();
+    return true;
+}
+
 void DoBeforeSave()
 {
     if (play.cur_music_number >= 0)
@@ -735,5 +911,58 @@ void SaveGameState(PStream out)
     SavegameComponents::WriteAllCommon(out);
 }
 
+HSaveError CompactSavegame(const String &filename)
+{
+    SavegameSource src;
+    SavegameDescription desc;
+    HSaveError err = OpenSavegame(filename, src, desc, kSvgDesc_None);
+    if (!err)
+        return err;
+    if (src.Version < kSvgVersion_Deltas)
+        return HSaveError::None(); // older formats had no deltas
+
+    PStream in = src.InputStream;
+    const soff_t data_start = in->GetPosition();
+    RawComponentList cmps;
+    err = SavegameComponents::ReadAllRaw(in, src.Version, filename, cmps);
+    if (!err)
+        return err;
+    const soff_t data_end = in->GetPosition();
+    const soff_t file_end = in->GetLength();
+
+    // Copy the header and the trailing screenshot as they are
+    PMemoryStream out(new MemoryStream());
+    std::vector<uint8_t> &buf = out->GetBuffer();
+    buf.resize((size_t)data_start);
+    in->Seek(0, kSeekBegin);
+    in->Read(buf.data(), buf.size());
+    out->Seek(0, kSeekEnd);
+    SavegameComponents::WriteAllRaw(out, cmps);
+    const soff_t new_data_end = out->GetPosition();
+    buf.resize((size_t)(new_data_end + file_end - data_end));
+    in->Seek(data_end, kSeekBegin);
+    in->Read(&buf[(size_t)new_data_end], (size_t)(file_end - data_end));
+    in.reset();
+    src.InputStream.reset();
+
+    // The screenshot has moved along with the end of game data
+    RICH_GAME_MEDIA_HEADER vista_header;
+    out->Seek(0, kSeekBegin);
+    vista_header.ReadFromFile(out.get());
+    // The components list is rewritten in the current format
+    out->Seek(SavegameSource::Signature.GetLength(), kSeekCurrent);
+    out->WriteInt32(kSvgVersion_Current);
+    if (vista_header.dwThumbnailOffsetLowerDword != 0)
+    {
+        vista_header.dwThumbnailOffsetLowerDword += (int)(new_data_end - data_end);
+        out->Seek(0, kSeekBegin);
+        vista_header.WriteToFile(out.get());
+    }
+
+    if (!WriteSavegameFile(buf, filename))
+        return new SavegameError(kSvgErr_FileOpenFailed, String::FromFormat("Failed to write: %s.", filename.GetCStr()));
+    return HSaveError::None();
+}
+
 } // namespace Engine
 } // namespace AGS
@@ -25,25 +25,29 @@
 namespace AGS
 {
 
-namespace Common { class Bitmap; class Stream; }
+namespace Common { class Bitmap; class MemoryStream; class Stream; }
 
 namespace Engine
 {
 
 using Common::Bitmap;
 using Common::ErrorHandle;
+using Common::MemoryStream;
 using Common::TypedCodeError;
 using Common::Stream;
 using Common::String;
 using Common::Version;
 
 typedef stdtr1compat::shared_ptr<Stream> PStream;
+typedef stdtr1compat::shared_ptr<MemoryStream> PMemoryStream;
 
 //-----------------------------------------------------------------------------
 // Savegame version history
 //
 // 8      last old style saved game format (of AGS 3.2.1)
 // 9      first new style (self-descriptive block-based) format version
+// 11     components may be stored as a delta to the base savegame
+// 12     components list is followed by the index of component offsets
 //-----------------------------------------------------------------------------
 enum SavegameVersion
 {
@@ -51,7 +55,9 @@ enum SavegameVersion
     kSvgVersion_321       = 8,
     kSvgVersion_Components= 9,
     kSvgVersion_Cmp_64bit = 10,
-    kSvgVersion_Current   = kSvgVersion_Cmp_64bit,
+    kSvgVersion_Deltas    = 11,
+    kSvgVersion_Index     = 12,
+    kSvgVersion_Current   = kSvgVersion_Index,
     kSvgVersion_LowestSupported = kSvgVersion_321 // change if support dropped
 };
 
@@ -79,6 +85,7 @@ enum SavegameErrorType
     kSvgErr_InconsistentPlugin,
     kSvgErr_DifferentColorDepth,
     kSvgErr_GameObjectInitFailed,
+    kSvgErr_BaseSavegameMismatch,
     kNumSavegameError
 };
 
@@ -153,14 +160,37 @@ HSaveError     OpenSavegame(const String &filename, SavegameSource &src,
 // Opens savegame and reads the savegame description
 HSaveError     OpenSavegame(const String &filename, SavegameDescription &desc, SavegameDescElem elems = kSvgDesc_All);
 
-// Reads the game data from the save stream and reinitializes game state
-HSaveError     RestoreGameState(PStream in, SavegameVersion svg_version);
+// Reads the game data from the save stream and reinitializes game state;
+// the savegame's filename is needed to find its base savegame, if any
+HSaveError     RestoreGameState(PStream in, SavegameVersion svg_version, const String &filename = "");
 
 // Opens savegame for writing and puts in savegame description
 PStream        StartSavegame(const String &filename, const String &user_text, const Bitmap *user_image);
+// Starts savegame in memory and puts in savegame description; the complete
+// savegame is passed to WriteSavegameAsync
+PMemoryStream  StartSavegameInMemory(const String &user_text, const Bitmap *user_image);
+// Replaces the game data in the savegame prepared in memory with the delta
+// to the base savegame. Returns false if the base does not exist, or the delta
+// would not be much smaller than the full data; then the savegame is left
+// unchanged, and should be written as the new base too.
+bool           MakeDeltaSavegame(PMemoryStream data, soff_t data_start, const String &base_filename);
+// Writes the savegame prepared in memory to the file on a background thread;
+// the data is written under a temporary name first, and renamed when complete.
+// If the base filename is given, the same data is written as the base first.
+void           WriteSavegameAsync(PMemoryStream data, const String &filename, int slot,
+                                  const String &base_filename = "");
+// Waits until the savegame being written in background is complete
+void           WaitForSavegameWrite();
+// Gets the result of the next completed background write, if there is any
+bool           PollSavegameWrite(int &slot, bool &success);
 
 // Prepares game for saving state and writes game data into the save stream
 void           SaveGameState(PStream out);
+// Rewrites the savegame stored as a delta into the full one, which does not
+// depend on the base savegame anymore
+HSaveError     CompactSavegame(const String &filename);
+// Deletes the base savegame, which is no longer referenced by any delta
+void           DeleteBaseSavegame(const String &base_filename);
 
 } // namespace Engine
 } // namespace AGS
@@ -49,6 +49,9 @@
 #include "plugin/plugin_engine.h"
 #include "script/cc_error.h"
 #include "script/script.h"
+#include "util/delta.h"
+#include "util/memorystream.h"
+#include "util/string_utils.h"
 #include "util/filestream.h" // TODO: needed only because plugins expect file handle
 
 using namespace Common;
@@ -638,7 +641,15 @@ HSaveError ReadDynamicSprites(PStream in, int32_t cmp_ver, const PreservedParams
     {
         int id = in->ReadInt32();
         int flags = in->ReadInt32();
-        add_dynamic_sprite(id, read_serialized_bitmap(in.get()));
+        // keep the pixels serialized until the sprite is drawn or accessed by script
+        int width, height;
+        stdtr1compat::shared_ptr< std::vector<uint8_t> > data(new std::vector<uint8_t>());
+        read_serialized_bitmap_data(in.get(), width, height, *data);
+        add_dynamic_sprite(id, width, height, [data]()
+        {
+            MemoryStream data_in(std::move(*data));
+            return read_serialized_bitmap(&data_in);
+        });
         game.SpriteInfos[id].Flags = flags;
     }
     return err;
@@ -757,18 +768,28 @@ HSaveError WriteRoomStates(PStream out)
     out->WriteInt32(MAX_ROOMS);
     for (int i = 0; i < MAX_ROOMS; ++i)
     {
-        if (isRoomStatusValid(i))
+        if (isRoomVisited(i))
         {
-            RoomStatus *roomstat = getRoomStatus(i);
-            if (roomstat->beenhere)
+            out->WriteInt32(i);
+            WriteFormatTag(out, "RoomState", true);
+            // rooms not accessed since the last restore are written as they were read
+            const std::vector<uint8_t> *data = getRoomStatusSerialized(i);
+            if (data)
             {
-                out->WriteInt32(i);
-                WriteFormatTag(out, "RoomState", true);
-                roomstat->WriteToSavegame(out.get());
-                WriteFormatTag(out, "RoomState", false);
+                out->WriteInt32(data->size());
+                out->Write(data->data(), data->size());
             }
             else
-                out->WriteInt32(-1);
+            {
+                const soff_t ref_pos = out->GetPosition();
+                out->WriteInt32(0); // placeholder for the room state size
+                getRoomStatus(i)->WriteToSavegame(out.get());
+                const soff_t end_pos = out->GetPosition();
+                out->Seek(ref_pos, kSeekBegin);
+                out->WriteInt32(end_pos - ref_pos - sizeof(int32_t));
+                out->Seek(end_pos, kSeekBegin);
+            }
+            WriteFormatTag(out, "RoomState", false);
         }
         else
             out->WriteInt32(-1);
@@ -790,8 +811,21 @@ HSaveError ReadRoomStates(PStream in, int32_t cmp_ver, const PreservedParams &pp
                 return err;
             if (!AssertFormatTagStrict(err, in, "RoomState", true))
                 return err;
-            RoomStatus *roomstat = getRoomStatus(id);
-            roomstat->ReadFromSavegame(in.get());
+            if (cmp_ver >= 1)
+            {
+                // the room state is unpacked on the first access to the room
+                const soff_t data_size = in->ReadInt32();
+                if (data_size <= 0 || data_size > in->GetLength() - in->GetPosition())
+                    return new SavegameError(kSvgErr_InconsistentFormat, String::FromFormat("Invalid room state size: %lld", data_size));
+                std::vector<uint8_t> data((size_t)data_size);
+                in->Read(data.data(), data.size());
+                setRoomStatusSerialized(id, std::move(data));
+            }
+            else
+            {
+                RoomStatus *roomstat = getRoomStatus(id);
+                roomstat->ReadFromSavegame(in.get());
+            }
             if (!AssertFormatTagStrict(err, in, "RoomState", false))
                 return err;
         }
@@ -918,7 +952,9 @@ HSaveError ReadManagedPool(PStream in, int32_t cmp_ver, const PreservedParams &p
 HSaveError WritePluginData(PStream out)
 {
     // [IKM] Plugins expect FILE pointer! // TODO something with this later...
-    pl_run_plugin_hooks(AGSE_SAVEGAME, (long)((Common::FileStream*)out.get())->GetHandle());
+    // Savegames are written into memory only if no plugin wants this hook
+    if (pl_any_want_hook(AGSE_SAVEGAME))
+        pl_run_plugin_hooks(AGSE_SAVEGAME, (long)((Common::FileStream*)out.get())->GetHandle());
     return HSaveError::None();
 }
 
@@ -1029,7 +1065,7 @@ ComponentHandler ComponentHandlers[] =
     },
     {
         "Room States",
-        0,
+        1,
         0,
         WriteRoomStates,
         ReadRoomStates
@@ -1067,6 +1103,16 @@ void GenerateHandlersMap(HandlersMap &map)
         map[ComponentHandlers[i].Name] = ComponentHandlers[i];
 }
 
+// Ways of storing the component data
+enum ComponentStorage
+{
+    kCmpStorage_Raw   = 0, // serialized data as is
+    kCmpStorage_Delta = 1  // delta to the data of the same component in the base savegame
+};
+
+// Plugins read their data straight from the savegame file, so it is never stored as a delta
+const String PluginDataComponent = "Plugin Data";
+
 // A helper struct to pass to (de)serialization handlers
 struct SvgCmpReadHelper
 {
@@ -1076,6 +1122,8 @@ struct SvgCmpReadHelper
                                     // will be applied after loading is done
     // The map of serialization handlers, one per supported component type ID
     HandlersMap            Handlers;
+    // Components of the base savegame, if this one is stored as a delta
+    RawComponentList       Base;
 
     SvgCmpReadHelper(SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data)
         : Version(svg_version)
@@ -1090,22 +1138,73 @@ struct ComponentInfo
 {
     String  Name;       // internal component's ID
     int32_t Version;    // data format version
+    int     Storage;    // the way data is stored
     soff_t  Offset;     // offset at which an opening tag is located
     soff_t  DataOffset; // offset at which component data begins
     soff_t  DataSize;   // expected size of component data
 
-    ComponentInfo() : Version(-1), Offset(0), DataOffset(0), DataSize(0) {}
+    ComponentInfo() : Version(-1), Storage(kCmpStorage_Raw), Offset(0), DataOffset(0), DataSize(0) {}
 };
 
-HSaveError ReadComponent(PStream in, SvgCmpReadHelper &hlp, ComponentInfo &info)
+// An entry of the index which follows the components list
+struct ComponentIndexEntry
+{
+    String  Name;   // internal component's ID
+    soff_t  Offset; // offset at which an opening tag is located
+
+    ComponentIndexEntry() : Offset(0) {}
+    ComponentIndexEntry(const String &name, soff_t offset) : Name(name), Offset(offset) {}
+};
+
+typedef std::vector<ComponentIndexEntry> ComponentIndex;
+
+// Reads component's header, up to the beginning of its data
+HSaveError ReadComponentHeader(PStream in, SavegameVersion svg_version, ComponentInfo &info)
 {
     info = ComponentInfo(); // reset in case of early error
     info.Offset = in->GetPosition();
     if (!ReadFormatTag(in, info.Name, true))
         return new SavegameError(kSvgErr_ComponentOpeningTagFormat);
     info.Version = in->ReadInt32();
-    info.DataSize = hlp.Version >= kSvgVersion_Cmp_64bit ? in->ReadInt64() : in->ReadInt32();
+    if (svg_version >= kSvgVersion_Deltas)
+        info.Storage = in->ReadInt8();
+    info.DataSize = svg_version >= kSvgVersion_Cmp_64bit ? in->ReadInt64() : in->ReadInt32();
     info.DataOffset = in->GetPosition();
+    if ((info.Storage != kCmpStorage_Raw && info.Storage != kCmpStorage_Delta) ||
+        info.DataSize < 0 || info.DataSize > in->GetLength() - info.DataOffset)
+        return new SavegameError(kSvgErr_InconsistentFormat);
+    return HSaveError::None();
+}
+
+// Reads component's data, merging it with the base component if it's stored as a delta
+HSaveError ReadComponentData(PStream in, const ComponentInfo &info, const RawComponentList &base, std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> stored((size_t)info.DataSize);
+    if (in->Read(stored.data(), stored.size()) != stored.size())
+        return new SavegameError(kSvgErr_ComponentSizeMismatch);
+    if (info.Storage == kCmpStorage_Raw)
+    {
+        data.swap(stored);
+        return HSaveError::None();
+    }
+    const RawComponent *base_cmp = NULL;
+    for (size_t i = 0; i < base.size() && !base_cmp; ++i)
+    {
+        if (base[i].Name == info.Name)
+            base_cmp = &base[i];
+    }
+    if (!base_cmp || base_cmp->Version != info.Version)
+        return new SavegameError(kSvgErr_BaseSavegameMismatch, String::FromFormat("Component not found in the base savegame: %s", info.Name.GetCStr()));
+    if (!deltaexpand(base_cmp->Data.data(), base_cmp->Data.size(), stored.data(), stored.size(), data))
+        return new SavegameError(kSvgErr_InconsistentData, "Failed to apply component delta.");
+    return HSaveError::None();
+}
+
+HSaveError ReadComponent(PStream in, SvgCmpReadHelper &hlp, ComponentInfo &info)
+{
+    HSaveError err = ReadComponentHeader(in, hlp.Version, info);
+    if (!err)
+        return err;
 
     const ComponentHandler *handler = NULL;
     std::map<String, ComponentHandler>::const_iterator it_hdr = hlp.Handlers.find(info.Name);
@@ -1116,37 +1215,162 @@ HSaveError ReadComponent(PStream in, SvgCmpReadHelper &hlp, ComponentInfo &info)
         return new SavegameError(kSvgErr_UnsupportedComponent);
     if (info.Version > handler->Version || info.Version < handler->LowestVersion)
         return new SavegameError(kSvgErr_UnsupportedComponentVersion, String::FromFormat("Saved version: %d, supported: %d - %d", info.Version, handler->LowestVersion, handler->Version));
-    HSaveError err = handler->Unserialize(in, info.Version, hlp.PP, hlp.RData);
-    if (!err)
-        return err;
-    if (in->GetPosition() - info.DataOffset != info.DataSize)
-        return new SavegameError(kSvgErr_ComponentSizeMismatch, String::FromFormat("Expected: %lld, actual: %lld", info.DataSize, in->GetPosition() - info.DataOffset));
+    if (info.Storage == kCmpStorage_Delta)
+    {
+        // restore the full data and let handler read it from memory
+        std::vector<uint8_t> data;
+        err = ReadComponentData(in, info, hlp.Base, data);
+        if (!err)
+            return err;
+        const soff_t data_size = data.size();
+        PStream data_in(new MemoryStream(std::move(data)));
+        err = handler->Unserialize(data_in, info.Version, hlp.PP, hlp.RData);
+        if (!err)
+            return err;
+        if (data_in->GetPosition() != data_size)
+            return new SavegameError(kSvgErr_ComponentSizeMismatch, String::FromFormat("Expected: %lld, actual: %lld", data_size, data_in->GetPosition()));
+    }
+    else
+    {
+        err = handler->Unserialize(in, info.Version, hlp.PP, hlp.RData);
+        if (!err)
+            return err;
+        if (in->GetPosition() - info.DataOffset != info.DataSize)
+            return new SavegameError(kSvgErr_ComponentSizeMismatch, String::FromFormat("Expected: %lld, actual: %lld", info.DataSize, in->GetPosition() - info.DataOffset));
+    }
     if (!AssertFormatTag(in, info.Name, false))
         return new SavegameError(kSvgErr_ComponentClosingTagFormat);
     return HSaveError::None();
 }
 
-HSaveError ReadAll(PStream in, SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data)
+// Returns the path to the base savegame, which is located next to the given one
+String GetBaseSavegamePath(const String &save_filename, const String &base_name)
+{
+    size_t slash_at = save_filename.FindCharReverse('/');
+    size_t bslash_at = save_filename.FindCharReverse('\\');
+    if (slash_at == (size_t)-1 || (bslash_at != (size_t)-1 && bslash_at > slash_at))
+        slash_at = bslash_at;
+    if (slash_at == (size_t)-1)
+        return base_name;
+    return String::FromFormat("%s%s", save_filename.Left(slash_at + 1).GetCStr(), base_name.GetCStr());
+}
+
+HSaveError ReadBaseComponents(const String &save_filename, const String &base_name, uint64_t base_id, RawComponentList &base)
+{
+    const String base_path = GetBaseSavegamePath(save_filename, base_name);
+    SavegameSource src;
+    SavegameDescription desc;
+    HSaveError err = OpenSavegame(base_path, src, desc, kSvgDesc_None);
+    if (err)
+        err = ReadAllRaw(src.InputStream, src.Version, base_path, base);
+    if (!err)
+        return new SavegameError(kSvgErr_BaseSavegameMismatch, String::FromFormat("Base savegame: %s", base_path.GetCStr()), err);
+    if (GetComponentsHash(base) != base_id)
+        return new SavegameError(kSvgErr_BaseSavegameMismatch, String::FromFormat("Base savegame has changed: %s", base_path.GetCStr()));
+    return HSaveError::None();
+}
+
+// Reads the index of the components list; the index offset and the offsets of
+// components are relative to the position of the index offset itself
+HSaveError ReadListIndex(PStream in, ComponentIndex &index, soff_t &list_end)
+{
+    const soff_t ref_pos = in->GetPosition();
+    const soff_t index_off = in->ReadInt64();
+    if (index_off <= 0 || index_off > in->GetLength() - ref_pos)
+        return new SavegameError(kSvgErr_InconsistentFormat, "Invalid component index offset.");
+    in->Seek(ref_pos + index_off, kSeekBegin);
+    const int32_t count = in->ReadInt32();
+    if (count < 0)
+        return new SavegameError(kSvgErr_InconsistentFormat, "Invalid component count.");
+    index.resize(count);
+    for (int32_t i = 0; i < count; ++i)
+    {
+        index[i].Name = StrUtil::ReadString(in.get());
+        index[i].Offset = ref_pos + in->ReadInt64();
+        if (index[i].Offset <= ref_pos || index[i].Offset >= ref_pos + index_off)
+            return new SavegameError(kSvgErr_InconsistentFormat, "Invalid component offset.");
+    }
+    list_end = in->GetPosition();
+    in->Seek(ref_pos + sizeof(int64_t), kSeekBegin);
+    return HSaveError::None();
+}
+
+// Reads the opening of the components list, its index, and the base savegame
+// if the list refers to one
+HSaveError ReadListHeader(PStream in, SavegameVersion svg_version, const String &save_filename, RawComponentList &base,
+                          ComponentIndex &index, soff_t &list_end)
+{
+    if (!AssertFormatTag(in, ComponentListTag, true))
+        return new SavegameError(kSvgErr_ComponentListOpeningTagFormat);
+    if (svg_version < kSvgVersion_Deltas)
+        return HSaveError::None();
+    const String base_name = StrUtil::ReadString(in.get());
+    const uint64_t base_id = in->ReadInt64();
+    if (svg_version >= kSvgVersion_Index)
+    {
+        HSaveError err = ReadListIndex(in, index, list_end);
+        if (!err)
+            return err;
+    }
+    if (base_name.IsEmpty())
+        return HSaveError::None();
+    return ReadBaseComponents(save_filename, base_name, base_id, base);
+}
+
+// Tells if the components list ends at the current stream position, and skips its closing tag;
+// otherwise leaves the position unchanged
+bool ReadListEnd(PStream in)
+{
+    soff_t off = in->GetPosition();
+    if (AssertFormatTag(in, ComponentListTag, false))
+        return true;
+    in->Seek(off, kSeekBegin);
+    return false;
+}
+
+HSaveError ReadAll(PStream in, SavegameVersion svg_version, const String &save_filename, const PreservedParams &pp, RestoredData &r_data)
 {
     // Prepare a helper struct we will be passing to the block reading proc
     SvgCmpReadHelper hlp(svg_version, pp, r_data);
     GenerateHandlersMap(hlp.Handlers);
 
     size_t idx = 0;
-    if (!AssertFormatTag(in, ComponentListTag, true))
-        return new SavegameError(kSvgErr_ComponentListOpeningTagFormat);
+    ComponentIndex index;
+    soff_t list_end = 0;
+    HSaveError err = ReadListHeader(in, svg_version, save_filename, hlp.Base, index, list_end);
+    if (!err)
+        return err;
+    if (svg_version >= kSvgVersion_Index)
+    {
+        // go straight to each component, and past the index in the end
+        for (; idx < index.size(); ++idx)
+        {
+            in->Seek(index[idx].Offset, kSeekBegin);
+            ComponentInfo info;
+            err = ReadComponent(in, hlp, info);
+            if (err && info.Name != index[idx].Name)
+                err = new SavegameError(kSvgErr_InconsistentFormat, "Component does not match the index.");
+            if (!err)
+            {
+                return new SavegameError(kSvgErr_ComponentUnserialization,
+                    String::FromFormat("(#%d) %s, version %i, at offset %u.",
+                    (int)idx, index[idx].Name.GetCStr(), info.Version, index[idx].Offset),
+                    err);
+            }
+            update_polled_stuff_if_runtime();
+        }
+        in->Seek(list_end, kSeekBegin);
+        return HSaveError::None();
+    }
     do
     {
         // Look out for the end of the component list:
         // this is the only way how this function ends with success
-        soff_t off = in->GetPosition();
-        if (AssertFormatTag(in, ComponentListTag, false))
+        if (ReadListEnd(in))
             return HSaveError::None();
-        // If the list's end was not detected, then seek back and continue reading
-        in->Seek(off, kSeekBegin);
 
         ComponentInfo info;
-        HSaveError err = ReadComponent(in, hlp, info);
+        err = ReadComponent(in, hlp, info);
         if (!err)
         {
             return new SavegameError(kSvgErr_ComponentUnserialization,
@@ -1161,10 +1385,161 @@ HSaveError ReadAll(PStream in, SavegameVersion svg_version, const PreservedParam
     return new SavegameError(kSvgErr_ComponentListClosingTagMissing);
 }
 
+// Reads the component's data without unserializing it, and appends it to the list
+HSaveError ReadRawComponent(PStream in, SavegameVersion svg_version, const RawComponentList &base, RawComponentList &cmps)
+{
+    ComponentInfo info;
+    RawComponent cmp;
+    HSaveError err = ReadComponentHeader(in, svg_version, info);
+    if (err)
+        err = ReadComponentData(in, info, base, cmp.Data);
+    if (err && !AssertFormatTag(in, info.Name, false))
+        err = new SavegameError(kSvgErr_ComponentClosingTagFormat);
+    if (!err)
+    {
+        return new SavegameError(kSvgErr_ComponentUnserialization,
+            String::FromFormat("(#%d) %s, version %i, at offset %u.",
+            (int)cmps.size(), info.Name.IsEmpty() ? "unknown" : info.Name.GetCStr(), info.Version, info.Offset),
+            err);
+    }
+    cmp.Name = info.Name;
+    cmp.Version = info.Version;
+    cmps.push_back(std::move(cmp));
+    return HSaveError::None();
+}
+
+HSaveError ReadAllRaw(PStream in, SavegameVersion svg_version, const String &save_filename, RawComponentList &cmps)
+{
+    cmps.clear();
+    RawComponentList base;
+    ComponentIndex index;
+    soff_t list_end = 0;
+    HSaveError err = ReadListHeader(in, svg_version, save_filename, base, index, list_end);
+    if (!err)
+        return err;
+    if (svg_version >= kSvgVersion_Index)
+    {
+        for (size_t i = 0; i < index.size(); ++i)
+        {
+            in->Seek(index[i].Offset, kSeekBegin);
+            err = ReadRawComponent(in, svg_version, base, cmps);
+            if (err && cmps.back().Name != index[i].Name)
+                err = new SavegameError(kSvgErr_InconsistentFormat, "Component does not match the index.");
+            if (!err)
+                return err;
+        }
+        in->Seek(list_end, kSeekBegin);
+        return HSaveError::None();
+    }
+    do
+    {
+        if (ReadListEnd(in))
+            return HSaveError::None();
+        err = ReadRawComponent(in, svg_version, base, cmps);
+        if (!err)
+            return err;
+    }
+    while (!in->EOS());
+    return new SavegameError(kSvgErr_ComponentListClosingTagMissing);
+}
+
+// Writes the opening of the components list; returns the position of the
+// index offset, which the component offsets are relative to
+soff_t WriteListHeader(PStream out, const String &base_name, uint64_t base_id)
+{
+    WriteFormatTag(out, ComponentListTag, true);
+    StrUtil::WriteString(base_name, out.get());
+    out->WriteInt64(base_id);
+    const soff_t ref_pos = out->GetPosition();
+    out->WriteInt64(0); // placeholder for the index offset
+    return ref_pos;
+}
+
+// Writes the closing of the components list followed by its index
+void WriteListEnd(PStream out, soff_t ref_pos, const ComponentIndex &index)
+{
+    WriteFormatTag(out, ComponentListTag, false);
+    const soff_t index_pos = out->GetPosition();
+    out->WriteInt32(index.size());
+    for (size_t i = 0; i < index.size(); ++i)
+    {
+        StrUtil::WriteString(index[i].Name, out.get());
+        out->WriteInt64(index[i].Offset - ref_pos);
+    }
+    const soff_t end_pos = out->GetPosition();
+    out->Seek(ref_pos, kSeekBegin);
+    out->WriteInt64(index_pos - ref_pos);
+    out->Seek(end_pos, kSeekBegin);
+}
+
+void WriteRawComponent(PStream out, const RawComponent &cmp, ComponentStorage storage, const std::vector<uint8_t> &data,
+                       ComponentIndex &index)
+{
+    index.push_back(ComponentIndexEntry(cmp.Name, out->GetPosition()));
+    WriteFormatTag(out, cmp.Name, true);
+    out->WriteInt32(cmp.Version);
+    out->WriteInt8(storage);
+    out->WriteInt64(data.size());
+    out->Write(data.data(), data.size());
+    WriteFormatTag(out, cmp.Name, false);
+}
+
+void WriteAllRaw(PStream out, const RawComponentList &cmps)
+{
+    const soff_t ref_pos = WriteListHeader(out, "", 0);
+    ComponentIndex index;
+    for (size_t i = 0; i < cmps.size(); ++i)
+        WriteRawComponent(out, cmps[i], kCmpStorage_Raw, cmps[i].Data, index);
+    WriteListEnd(out, ref_pos, index);
+}
+
+void WriteAllDelta(PStream out, const RawComponentList &cmps, const String &base_name, uint64_t base_id, const RawComponentList &base)
+{
+    const soff_t ref_pos = WriteListHeader(out, base_name, base_id);
+    ComponentIndex index;
+    std::vector<uint8_t> delta;
+    for (size_t i = 0; i < cmps.size(); ++i)
+    {
+        const RawComponent &cmp = cmps[i];
+        const RawComponent *base_cmp = NULL;
+        for (size_t j = 0; j < base.size() && !base_cmp; ++j)
+        {
+            if (base[j].Name == cmp.Name && base[j].Version == cmp.Version)
+                base_cmp = &base[j];
+        }
+        delta.clear();
+        if (base_cmp && cmp.Name != PluginDataComponent)
+            deltacompress(base_cmp->Data.data(), base_cmp->Data.size(), cmp.Data.data(), cmp.Data.size(), delta);
+        if (!delta.empty() && delta.size() < cmp.Data.size())
+            WriteRawComponent(out, cmp, kCmpStorage_Delta, delta, index);
+        else
+            WriteRawComponent(out, cmp, kCmpStorage_Raw, cmp.Data, index);
+    }
+    WriteListEnd(out, ref_pos, index);
+}
+
+uint64_t GetComponentsHash(const RawComponentList &cmps)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < cmps.size(); ++i)
+    {
+        const RawComponent &cmp = cmps[i];
+        const uint8_t *name = (const uint8_t*)cmp.Name.GetCStr();
+        for (size_t j = 0; j <= cmp.Name.GetLength(); ++j)
+            hash = (hash ^ name[j]) * 0x100000001b3ull;
+        for (size_t j = 0; j < sizeof(cmp.Version); ++j)
+            hash = (hash ^ (uint8_t)(cmp.Version >> (j * 8))) * 0x100000001b3ull;
+        for (size_t j = 0; j < cmp.Data.size(); ++j)
+            hash = (hash ^ cmp.Data[j]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
 HSaveError WriteComponent(PStream out, ComponentHandler &hdlr)
 {
     WriteFormatTag(out, hdlr.Name, true);
     out->WriteInt32(hdlr.Version);
+    out->WriteInt8(kCmpStorage_Raw);
     soff_t ref_pos = out->GetPosition();
     out->WriteInt64(0); // placeholder for the component size
     HSaveError err = hdlr.Serialize(out);
@@ -1179,9 +1554,11 @@ HSaveError WriteComponent(PStream out, ComponentHandler &hdlr)
 
 HSaveError WriteAllCommon(PStream out)
 {
-    WriteFormatTag(out, ComponentListTag, true);
+    const soff_t ref_pos = WriteListHeader(out, "", 0);
+    ComponentIndex index;
     for (int type = 0; !ComponentHandlers[type].Name.IsEmpty(); ++type)
     {
+        index.push_back(ComponentIndexEntry(ComponentHandlers[type].Name, out->GetPosition()));
         HSaveError err = WriteComponent(out, ComponentHandlers[type]);
         if (!err)
         {
@@ -1191,7 +1568,7 @@ HSaveError WriteAllCommon(PStream out)
         }
         update_polled_stuff_if_runtime();
     }
-    WriteFormatTag(out, ComponentListTag, false);
+    WriteListEnd(out, ref_pos, index);
     return HSaveError::None();
 }
 
@@ -17,6 +17,7 @@
 
 #include "util/stdtr1compat.h"
 #include TR1INCLUDE(memory)
+#include <vector>
 #include "game/savegame.h"
 #include "game/savegame_internal.h"
 #include "gfx/bitmap.h"
@@ -34,12 +35,39 @@ using Common::String;
 
 typedef stdtr1compat::shared_ptr<Stream> PStream;
 
+// Serialized component data, as found in the savegame
+struct RawComponent
+{
+    String               Name;
+    int32_t              Version;
+    std::vector<uint8_t> Data;
+
+    RawComponent() : Version(0) {}
+};
+typedef std::vector<RawComponent> RawComponentList;
+
 namespace SavegameComponents
 {
-    // Reads all available components from the stream
-    HSaveError    ReadAll(PStream in, SavegameVersion svg_version, const PreservedParams &pp, RestoredData &r_data);
+    // Reads all available components from the stream; the filename of the
+    // savegame is used to locate the base savegame, if there is one
+    HSaveError    ReadAll(PStream in, SavegameVersion svg_version, const String &save_filename,
+                          const PreservedParams &pp, RestoredData &r_data);
     // Writes a full list of common components to the stream
     HSaveError    WriteAllCommon(PStream out);
+
+    // Reads all components without restoring them; the ones stored as a
+    // delta are merged with the base savegame's data
+    HSaveError    ReadAllRaw(PStream in, SavegameVersion svg_version, const String &save_filename,
+                             RawComponentList &cmps);
+    // Writes the list of components in full
+    void          WriteAllRaw(PStream out, const RawComponentList &cmps);
+    // Writes the list of components as a delta to the components of the base
+    // savegame; a component is stored in full if its delta is not smaller
+    void          WriteAllDelta(PStream out, const RawComponentList &cmps, const String &base_name,
+                                uint64_t base_id, const RawComponentList &base);
+    // Calculates the identifier of the components' content, which lets
+    // the delta savegame check that its base has not changed
+    uint64_t      GetComponentsHash(const RawComponentList &cmps);
 }
 
 } // namespace Engine
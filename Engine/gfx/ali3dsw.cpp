@@ -18,6 +18,7 @@
 
 #include "gfx/ali3dexception.h"
 #include "gfx/ali3dsw.h"
+#include "gfx/blender.h"
 #include "gfx/gfxfilter_allegro.h"
 #include "gfx/gfxfilter_hqx.h"
 #include "gfx/gfx_util.h"
@@ -68,8 +69,9 @@ bool ALSoftwareGfxModeList::GetMode(int index, DisplayMode &mode) const
     return false;
 }
 
-unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n);
 RGB faded_out_palette[256];
+// Max number of virtual screen regions to present separately
+const size_t MAX_DIRTY_REGIONS = 1024;
 
 
 ALSoftwareGraphicsDriver::ALSoftwareGraphicsDriver()
@@ -87,6 +89,8 @@ ALSoftwareGraphicsDriver::ALSoftwareGraphicsDriver()
   _origVirtualScreen = NULL;
   virtualScreen = NULL;
   _stageVirtualScreen = NULL;
+  _dirtyRegionsSet = false;
+  _presentWhole = true;
 
   // Initialize default sprite batch, it will be used when no other batch was activated
   InitSpriteBatch(0, _spriteBatchDesc[0]);
@@ -254,6 +258,7 @@ void ALSoftwareGraphicsDriver::CreateVirtualScreen()
   }
   virtualScreen = _origVirtualScreen;
   _stageVirtualScreen = virtualScreen;
+  _presentWhole = true;
   // Set Allegro's screen pointer to what may be the real or virtual screen
   screen = (BITMAP*)_origVirtualScreen->GetAllegroBitmap();
 }
@@ -313,6 +318,8 @@ void ALSoftwareGraphicsDriver::ClearRectangle(int x1, int y1, int x2, int y2, RG
   // TODO: hardware renderers do not scale these coordinates, but software filter does!
   // find out what's the expected behavior and sync them
   _filter->ClearRect(x1, y1, x2, y2, color);
+  // real screen no longer matches the virtual one
+  _presentWhole = true;
 }
 
 ALSoftwareGraphicsDriver::~ALSoftwareGraphicsDriver()
@@ -430,6 +437,12 @@ void ALSoftwareGraphicsDriver::DrawSprite(int x, int y, IDriverDependantBitmap*
 
 void ALSoftwareGraphicsDriver::RenderToBackBuffer()
 {
+    // If the changes for this frame were not reported, then we cannot know
+    // which parts of the virtual screen have to be presented
+    if (!_dirtyRegionsSet)
+        _presentWhole = true;
+    _dirtyRegionsSet = false;
+
     // Render all the sprite batches with necessary transformations
     //
     // NOTE: that's not immediately clear whether it would be faster to first draw upon a camera-sized
@@ -508,7 +521,7 @@ void ALSoftwareGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, Com
         // here _transparency is used as alpha (between 1 and 254)
         set_blender_mode(NULL, NULL, _trans_alpha_blender32, 0, 0, 0, bitmap->_transparency);
 
-      surface->TransBlendBlt(bitmap->_bmp, drawAtX, drawAtY);
+      GfxUtil::TransBlendBlt(surface, bitmap->_bmp, drawAtX, drawAtY);
     }
     else
     {
@@ -523,7 +536,7 @@ void ALSoftwareGraphicsDriver::RenderSpriteBatch(const ALSpriteBatch &batch, Com
     // Common::gl_ScreenBmp tint
     // This slows down the game no end, only experimental ATM
     set_trans_blender(_tint_red, _tint_green, _tint_blue, 0);
-    surface->LitBlendBlt(surface, 0, 0, 128);
+    GfxUtil::LitBlendBlt(surface, surface, 0, 0, 128);
 /*  This alternate method gives the correct (D3D-style) result, but is just too slow!
     if ((_spareTintingScreen != NULL) &&
         ((_spareTintingScreen->GetWidth() != surface->GetWidth()) || (_spareTintingScreen->GetHeight() != surface->GetHeight())))
@@ -547,10 +560,19 @@ void ALSoftwareGraphicsDriver::Render(GlobalFlipType flip)
   if (_autoVsync)
     this->Vsync();
 
-  if (flip == kFlip_None)
-    _filter->RenderScreen(virtualScreen, _virtualScrOff.X + _globalViewOff.X, _virtualScrOff.Y + _globalViewOff.Y);
+  const Point present_off(_virtualScrOff.X + _globalViewOff.X, _virtualScrOff.Y + _globalViewOff.Y);
+  // Screen tint is applied over the whole surface each frame
+  const bool has_tint = (_tint_red > 0 || _tint_green > 0 || _tint_blue > 0) && _mode.ColorDepth > 8;
+  if (flip != kFlip_None)
+    _filter->RenderScreenFlipped(virtualScreen, present_off.X, present_off.Y, flip);
+  else if (_presentWhole || has_tint || present_off.X != _lastPresentOff.X || present_off.Y != _lastPresentOff.Y)
+    _filter->RenderScreen(virtualScreen, present_off.X, present_off.Y);
   else
-    _filter->RenderScreenFlipped(virtualScreen, _virtualScrOff.X + _globalViewOff.X, _virtualScrOff.Y + _globalViewOff.Y, flip);
+    _filter->RenderScreenRegions(virtualScreen, present_off.X, present_off.Y, _dirtyRegions);
+
+  _dirtyRegions.clear();
+  _presentWhole = (flip != kFlip_None);
+  _lastPresentOff = present_off;
 }
 
 void ALSoftwareGraphicsDriver::Render()
@@ -581,6 +603,22 @@ void ALSoftwareGraphicsDriver::SetMemoryBackBuffer(Bitmap *backBuffer, int offx,
     _virtualScrOff = Point();
   }
   _stageVirtualScreen = virtualScreen;
+  _presentWhole = true;
+}
+
+void ALSoftwareGraphicsDriver::SetMemoryBackBufferDirtyRegions(const std::vector<Rect> &regions)
+{
+  _dirtyRegionsSet = true;
+  if (_presentWhole)
+    return;
+  // if the frames keep changing without being presented, just present the whole screen later
+  if (_dirtyRegions.size() + regions.size() > MAX_DIRTY_REGIONS)
+  {
+    _dirtyRegions.clear();
+    _presentWhole = true;
+    return;
+  }
+  _dirtyRegions.insert(_dirtyRegions.end(), regions.begin(), regions.end());
 }
 
 Bitmap *ALSoftwareGraphicsDriver::GetStageBackBuffer()
@@ -634,7 +672,7 @@ void ALSoftwareGraphicsDriver::highcolor_fade_in(Bitmap *currentVirtScreen, int
        int timerValue = *_loopTimer;
        bmp_buff->Fill(clearColor);
        set_trans_blender(0,0,0,a);
-       bmp_buff->TransBlendBlt(bmp_orig, 0, 0);
+       GfxUtil::TransBlendBlt(bmp_buff, bmp_orig, 0, 0);
        this->Vsync();
        _filter->RenderScreen(bmp_buff, 0, 0);
        do
@@ -673,7 +711,7 @@ void ALSoftwareGraphicsDriver::highcolor_fade_out(int speed, int targetColourRed
                 int timerValue = *_loopTimer;
                 bmp_buff->Fill(clearColor);
                 set_trans_blender(0,0,0,a);
-                bmp_buff->TransBlendBlt(bmp_orig, 0, 0);
+                GfxUtil::TransBlendBlt(bmp_buff, bmp_orig, 0, 0);
                 this->Vsync();
                 _filter->RenderScreen(bmp_buff, 0, 0);
                 do
@@ -735,6 +773,7 @@ void ALSoftwareGraphicsDriver::__fade_out_range(int speed, int from, int to, int
 }
 
 void ALSoftwareGraphicsDriver::FadeOut(int speed, int targetColourRed, int targetColourGreen, int targetColourBlue) {
+  _presentWhole = true;
 
   if (_mode.ColorDepth > 8) 
   {
@@ -745,6 +784,7 @@ void ALSoftwareGraphicsDriver::FadeOut(int speed, int targetColourRed, int targe
 }
 
 void ALSoftwareGraphicsDriver::FadeIn(int speed, PALETTE p, int targetColourRed, int targetColourGreen, int targetColourBlue) {
+  _presentWhole = true;
   if (_mode.ColorDepth > 8) {
 
     highcolor_fade_in(virtualScreen, speed * 4, targetColourRed, targetColourGreen, targetColourBlue);
@@ -786,6 +826,7 @@ void ALSoftwareGraphicsDriver::BoxOutEffect(bool blackingOut, int speed, int del
 
 bool ALSoftwareGraphicsDriver::PlayVideo(const char *filename, bool useAVISound, VideoSkipType skipType, bool stretchToFullScreen)
 {
+  _presentWhole = true;
 #ifdef _WIN32
   int result = dxmedia_play_video(filename, useAVISound, skipType, stretchToFullScreen ? 1 : 0);
   return (result == 0);
@@ -794,28 +835,6 @@ bool ALSoftwareGraphicsDriver::PlayVideo(const char *filename, bool useAVISound,
 #endif
 }
 
-// add the alpha values together, used for compositing alpha images
-unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n)
-{
-   unsigned long res, g;
-
-   n = (n * geta32(x)) / 256;
-
-   if (n)
-      n++;
-
-   res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
-   y &= 0xFF00;
-   x &= 0xFF00;
-   g = (x - y) * n / 256 + y;
-
-   res &= 0xFF00FF;
-   g &= 0xFF00;
-
-   return res | g;
-}
-
-
 ALSWGraphicsFactory *ALSWGraphicsFactory::_factory = NULL;
 
 ALSWGraphicsFactory::~ALSWGraphicsFactory()
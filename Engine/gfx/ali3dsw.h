@@ -176,6 +176,7 @@ public:
     virtual bool UsesMemoryBackBuffer() { return true; }
     virtual Bitmap *GetMemoryBackBuffer();
     virtual void SetMemoryBackBuffer(Bitmap *backBuffer, int offx, int offy);
+    virtual void SetMemoryBackBufferDirtyRegions(const std::vector<Rect> &regions);
     virtual Bitmap *GetStageBackBuffer();
     virtual void SetScreenTint(int red, int green, int blue) { 
         _tint_red = red; _tint_green = green; _tint_blue = blue; }
@@ -208,6 +209,15 @@ private:
     // actual virtual screen or separate bitmap of different size that is
     // blitted to virtual screen at the stage finalization.
     Bitmap *_stageVirtualScreen;
+    // Regions of the virtual screen changed since it was last presented
+    std::vector<Rect> _dirtyRegions;
+    // Whether the changes were reported for the next rendered frame
+    bool _dirtyRegionsSet;
+    // Whether the whole virtual screen must be presented next time,
+    // either because of untracked changes or because real screen was painted over
+    bool _presentWhole;
+    // Screen offset of the last presentation
+    Point _lastPresentOff;
     Bitmap *_spareTintingScreen;
     int _tint_red, _tint_green, _tint_blue;
 
@@ -16,9 +16,17 @@
 #include "gfx/blender.h"
 #include "util/wgt2allg.h"
 
+// SSE2 is a part of every x86-64 CPU, and may be enabled for 32-bit x86 builds
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define AGS_BLENDER_SSE2
+#include <emmintrin.h>
+#endif
+
 extern "C" {
     unsigned long _blender_trans16(unsigned long x, unsigned long y, unsigned long n);
     unsigned long _blender_trans15(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_trans24(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_alpha32(unsigned long x, unsigned long y, unsigned long n);
 }
 
 // the allegro "inline" ones are not actually inline, so #define
@@ -132,16 +140,11 @@ unsigned long _myblender_color32(unsigned long x, unsigned long y, unsigned long
     return makeacol32(r, g, b, geta32(y));
 }
 
-// trans24 blender, but preserve alpha channel from image
-unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n)
+// Mixes RGB of two colors in proportion n / 256, same way as Allegro's
+// trans24 blender; alpha of the result is zero
+FORCEINLINE unsigned long trans_blend_core(unsigned long x, unsigned long y, unsigned long n)
 {
-    unsigned long res, g, alph;
-
-    if (n)
-        n++;
-
-    alph = y & 0xff000000;
-    y &= 0x00ffffff;
+    unsigned long res, g;
 
     res = ((x & 0xFF00FF) - (y & 0xFF00FF)) * n / 256 + y;
     y &= 0xFF00;
@@ -151,7 +154,20 @@ unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigne
     res &= 0xFF00FF;
     g &= 0xFF00;
 
-    return res | g | alph;
+    return res | g;
+}
+
+// trans24 blender, but preserve alpha channel from image
+unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n)
+{
+    unsigned long alph;
+
+    if (n)
+        n++;
+
+    alph = y & 0xff000000;
+    y &= 0x00ffffff;
+    return trans_blend_core(x, y, n) | alph;
 }
 
 void set_my_trans_blender(int r, int g, int b, int a)
@@ -228,24 +244,22 @@ unsigned long _rgb2argb_blender(unsigned long src_col, unsigned long dst_col, un
 
 unsigned long _argb2rgb_blender(unsigned long src_col, unsigned long dst_col, unsigned long src_alpha)
 {
-   unsigned long res, g;
-
-   if (src_alpha > 0)
+    if (src_alpha > 0)
         src_alpha = geta32(src_col) * ((src_alpha & 0xFF) + 1) / 256;
     else
         src_alpha = geta32(src_col);
-   if (src_alpha)
-      src_alpha++;
-
-   res = ((src_col & 0xFF00FF) - (dst_col & 0xFF00FF)) * src_alpha / 256 + dst_col;
-   dst_col &= 0xFF00;
-   src_col &= 0xFF00;
-   g = (src_col - dst_col) * src_alpha / 256 + dst_col;
-
-   res &= 0xFF00FF;
-   g &= 0xFF00;
+    if (src_alpha)
+        src_alpha++;
+    return trans_blend_core(src_col, dst_col, src_alpha);
+}
 
-   return res | g;
+// add the alpha values together, used for compositing alpha images
+unsigned long _trans_alpha_blender32(unsigned long x, unsigned long y, unsigned long n)
+{
+    n = (n * geta32(x)) / 256;
+    if (n)
+        n++;
+    return trans_blend_core(x, y, n);
 }
 
 void set_additive_alpha_blender()
@@ -268,3 +282,239 @@ void set_opaque_alpha_blender()
 {
     set_blender_mode(NULL, NULL, _opaque_alpha_blender, 0, 0, 0, 0);
 }
+
+
+//=============================================================================
+// Scanline blenders
+//=============================================================================
+
+// Generic row blending, calls the blender for each non-masked pixel
+template <PfnBlender32 Blender>
+void scanline_trans_blend(uint32_t *dst, const uint32_t *src, int count, uint32_t color, unsigned long n)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (src[i] != MASK_COLOR_32)
+            dst[i] = Blender(src[i], dst[i], n);
+    }
+}
+
+template <PfnBlender32 Blender>
+void scanline_lit_blend(uint32_t *dst, const uint32_t *src, int count, uint32_t color, unsigned long n)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        if (src[i] != MASK_COLOR_32)
+            dst[i] = Blender(color, src[i], n);
+    }
+}
+
+#if defined (AGS_BLENDER_SSE2)
+
+// Low 32 bits of products of 32-bit lanes; SSE2 only has 32x32->64 multiply
+FORCEINLINE __m128i mullo_epi32_sse2(__m128i a, __m128i b)
+{
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd,  _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Same as trans_blend_core, for 4 pixels with individual factors; wrapping
+// 32-bit arithmetic gives same lower 24 bits as the scalar code
+FORCEINLINE __m128i trans_blend_core_sse2(__m128i x, __m128i y, __m128i n)
+{
+    const __m128i rb_mask = _mm_set1_epi32(0xFF00FF);
+    const __m128i g_mask  = _mm_set1_epi32(0xFF00);
+    __m128i res = _mm_sub_epi32(_mm_and_si128(x, rb_mask), _mm_and_si128(y, rb_mask));
+    res = _mm_add_epi32(_mm_srli_epi32(mullo_epi32_sse2(res, n), 8), y);
+    y = _mm_and_si128(y, g_mask);
+    __m128i g = _mm_sub_epi32(_mm_and_si128(x, g_mask), y);
+    g = _mm_add_epi32(_mm_srli_epi32(mullo_epi32_sse2(g, n), 8), y);
+    return _mm_or_si128(_mm_and_si128(res, rb_mask), _mm_and_si128(g, g_mask));
+}
+
+// Converts alpha values into blend factors: a ? a + 1 : 0
+FORCEINLINE __m128i alpha_factor_sse2(__m128i a)
+{
+    __m128i zero = _mm_cmpeq_epi32(a, _mm_setzero_si128());
+    return _mm_add_epi32(a, _mm_andnot_si128(zero, _mm_set1_epi32(1)));
+}
+
+// Blending operations for 4 pixels at once; constructed from the blender's
+// parameter once per row
+
+// _blender_trans24
+struct TransOpSSE2
+{
+    __m128i N;
+    TransOpSSE2(unsigned long n) : N(_mm_set1_epi32(n ? n + 1 : 0)) {}
+    FORCEINLINE __m128i Blend(__m128i x, __m128i y) const
+    {
+        return trans_blend_core_sse2(x, y, N);
+    }
+};
+
+// _myblender_alpha_trans24
+struct TransKeepAlphaOpSSE2 : TransOpSSE2
+{
+    TransKeepAlphaOpSSE2(unsigned long n) : TransOpSSE2(n) {}
+    FORCEINLINE __m128i Blend(__m128i x, __m128i y) const
+    {
+        return _mm_or_si128(trans_blend_core_sse2(x, y, N),
+                            _mm_and_si128(y, _mm_set1_epi32(0xFF000000)));
+    }
+};
+
+// _blender_alpha32
+struct AlphaOpSSE2
+{
+    AlphaOpSSE2(unsigned long n) {}
+    FORCEINLINE __m128i Blend(__m128i x, __m128i y) const
+    {
+        return trans_blend_core_sse2(x, y, alpha_factor_sse2(_mm_srli_epi32(x, 24)));
+    }
+};
+
+// Src alpha multiplied by K / 256; K must not exceed 256, so that
+// the product fits into 16-bit multiplication
+struct ScaledAlphaOpSSE2
+{
+    __m128i K;
+    ScaledAlphaOpSSE2(unsigned long k) : K(_mm_set1_epi32(k)) {}
+    FORCEINLINE __m128i Blend(__m128i x, __m128i y) const
+    {
+        __m128i a = _mm_srli_epi32(_mm_mullo_epi16(_mm_srli_epi32(x, 24), K), 8);
+        return trans_blend_core_sse2(x, y, alpha_factor_sse2(a));
+    }
+};
+
+// _argb2rgb_blender
+struct Argb2RgbOpSSE2 : ScaledAlphaOpSSE2
+{
+    Argb2RgbOpSSE2(unsigned long n) : ScaledAlphaOpSSE2(n > 0 ? (n & 0xFF) + 1 : 256) {}
+};
+
+// _trans_alpha_blender32
+struct TransAlphaOpSSE2 : ScaledAlphaOpSSE2
+{
+    TransAlphaOpSSE2(unsigned long n) : ScaledAlphaOpSSE2(n) {}
+};
+
+// _additive_alpha_copysrc_blender
+struct AdditiveAlphaOpSSE2
+{
+    AdditiveAlphaOpSSE2(unsigned long n) {}
+    FORCEINLINE __m128i Blend(__m128i x, __m128i y) const
+    {
+        const __m128i alpha_mask = _mm_set1_epi32(0xFF000000);
+        // saturated addition of alpha bytes gives min(ax + ay, 0xFF)
+        __m128i alpha = _mm_adds_epu8(_mm_and_si128(x, alpha_mask), _mm_and_si128(y, alpha_mask));
+        return _mm_or_si128(_mm_andnot_si128(alpha_mask, x), alpha);
+    }
+};
+
+// _opaque_alpha_blender
+struct OpaqueAlphaOpSSE2
+{
+    OpaqueAlphaOpSSE2(unsigned long n) {}
+    FORCEINLINE __m128i Blend(__m128i x, __m128i y) const
+    {
+        return _mm_or_si128(x, _mm_set1_epi32(0xFF000000));
+    }
+};
+
+template <class Op, PfnBlender32 Blender>
+void scanline_trans_blend_sse2(uint32_t *dst, const uint32_t *src, int count, uint32_t color, unsigned long n)
+{
+    const __m128i mask = _mm_set1_epi32(MASK_COLOR_32);
+    const Op op(n);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i skip = _mm_cmpeq_epi32(x, mask);
+        __m128i res = op.Blend(x, y);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(skip, y), _mm_andnot_si128(skip, res)));
+    }
+    scanline_trans_blend<Blender>(dst + i, src + i, count - i, color, n);
+}
+
+template <class Op, PfnBlender32 Blender>
+void scanline_lit_blend_sse2(uint32_t *dst, const uint32_t *src, int count, uint32_t color, unsigned long n)
+{
+    const __m128i mask = _mm_set1_epi32(MASK_COLOR_32);
+    const __m128i c = _mm_set1_epi32(color);
+    const Op op(n);
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i y = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i skip = _mm_cmpeq_epi32(x, mask);
+        __m128i res = op.Blend(c, x);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(skip, y), _mm_andnot_si128(skip, res)));
+    }
+    scanline_lit_blend<Blender>(dst + i, src + i, count - i, color, n);
+}
+
+void scanline_trans_alpha_blend_sse2(uint32_t *dst, const uint32_t *src, int count, uint32_t color, unsigned long n)
+{
+    if (n <= 256)
+        scanline_trans_blend_sse2<TransAlphaOpSSE2, _trans_alpha_blender32>(dst, src, count, color, n);
+    else
+        scanline_trans_blend<_trans_alpha_blender32>(dst, src, count, color, n);
+}
+
+#define TRANS_SCANLINE(Op, Blender) scanline_trans_blend_sse2<Op, Blender>
+#define LIT_SCANLINE(Op, Blender)   scanline_lit_blend_sse2<Op, Blender>
+#define TRANS_ALPHA_SCANLINE        scanline_trans_alpha_blend_sse2
+#else
+#define TRANS_SCANLINE(Op, Blender) scanline_trans_blend<Blender>
+#define LIT_SCANLINE(Op, Blender)   scanline_lit_blend<Blender>
+#define TRANS_ALPHA_SCANLINE        scanline_trans_blend<_trans_alpha_blender32>
+#endif // AGS_BLENDER_SSE2
+
+struct ScanlineBlenderDesc
+{
+    PfnBlender32       Blender;
+    PfnScanlineBlender Trans; // for draw_trans_sprite
+    PfnScanlineBlender Lit;   // for draw_lit_sprite
+};
+
+// NOTE: blenders that combine alpha of both src and dst do not have
+// vectorized versions, and only save on calling blender through pointer
+static const ScanlineBlenderDesc ScanlineBlenders[] =
+{
+    { _blender_trans24, TRANS_SCANLINE(TransOpSSE2, _blender_trans24), LIT_SCANLINE(TransOpSSE2, _blender_trans24) },
+    { _myblender_alpha_trans24, TRANS_SCANLINE(TransKeepAlphaOpSSE2, _myblender_alpha_trans24),
+        LIT_SCANLINE(TransKeepAlphaOpSSE2, _myblender_alpha_trans24) },
+    { _blender_alpha32, TRANS_SCANLINE(AlphaOpSSE2, _blender_alpha32), NULL },
+    { _argb2rgb_blender, TRANS_SCANLINE(Argb2RgbOpSSE2, _argb2rgb_blender), NULL },
+    { _trans_alpha_blender32, TRANS_ALPHA_SCANLINE, NULL },
+    { _additive_alpha_copysrc_blender, TRANS_SCANLINE(AdditiveAlphaOpSSE2, _additive_alpha_copysrc_blender), NULL },
+    { _opaque_alpha_blender, TRANS_SCANLINE(OpaqueAlphaOpSSE2, _opaque_alpha_blender), NULL },
+    { _argb2argb_blender, scanline_trans_blend<_argb2argb_blender>, NULL },
+    { _rgb2argb_blender, scanline_trans_blend<_rgb2argb_blender>, NULL },
+};
+
+PfnScanlineBlender GetScanlineTransBlender(PfnBlender32 blender)
+{
+    for (size_t i = 0; i < sizeof(ScanlineBlenders) / sizeof(ScanlineBlenders[0]); ++i)
+    {
+        if (ScanlineBlenders[i].Blender == blender)
+            return ScanlineBlenders[i].Trans;
+    }
+    return NULL;
+}
+
+PfnScanlineBlender GetScanlineLitBlender(PfnBlender32 blender)
+{
+    for (size_t i = 0; i < sizeof(ScanlineBlenders) / sizeof(ScanlineBlenders[0]); ++i)
+    {
+        if (ScanlineBlenders[i].Blender == blender)
+            return ScanlineBlenders[i].Lit;
+    }
+    return NULL;
+}
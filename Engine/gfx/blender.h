@@ -19,6 +19,8 @@
 #ifndef __AC_BLENDER_H
 #define __AC_BLENDER_H
 
+#include "core/types.h"
+
 //
 // Allegro's standard alpha blenders result in:
 // - src and dst RGB are combined proportionally to src alpha
@@ -40,6 +42,7 @@ unsigned long _myblender_color32_light(unsigned long x, unsigned long y, unsigne
 // Customizable alpha blender that uses the supplied alpha value as src alpha,
 // and preserves destination's alpha channel (if there was one);
 void set_my_trans_blender(int r, int g, int b, int a);
+unsigned long _myblender_alpha_trans24(unsigned long x, unsigned long y, unsigned long n);
 // Argb2argb alpha blender combines RGBs proportionally to src alpha, but also
 // applies dst alpha factor to the dst RGB used in the merge;
 // The final alpha is calculated by multiplying two translucences (1 - .alpha).
@@ -54,10 +57,35 @@ unsigned long _rgb2argb_blender(unsigned long src_col, unsigned long dst_col, un
 // Sets the alpha channel to opaque. Used when drawing a non-alpha sprite onto an alpha-sprite.
 unsigned long _opaque_alpha_blender(unsigned long src_col, unsigned long dst_col, unsigned long src_alpha);
 
+// Trans alpha blender combines RGBs proportionally to src alpha multiplied by
+// the custom alpha parameter; the final alpha is zero.
+unsigned long _trans_alpha_blender32(unsigned long src_col, unsigned long dst_col, unsigned long src_alpha);
+
 // Additive alpha blender plain copies src over, applying a summ of src and
 // dst alpha values.
 void set_additive_alpha_blender();
+unsigned long _additive_alpha_copysrc_blender(unsigned long x, unsigned long y, unsigned long n);
 // Opaque alpha blender plain copies src over, applying opaque alpha value.
 void set_opaque_alpha_blender();
 
+
+//
+// Scanline blenders do the same as Allegro's 32-bit sprite drawing does with
+// the blender callback, but process a whole row of pixels at once, several
+// pixels per step where the CPU supports that. Pixels of the mask color in
+// the source row are skipped.
+// Trans scanline blender combines src pixels with dst pixels, using the
+// blender's alpha parameter; lit scanline blender combines given color with
+// src pixels, using light level, and writes result to dst.
+// NOTE: these assume that alpha channel occupies the highest byte of pixel.
+//
+typedef unsigned long (*PfnBlender32)(unsigned long x, unsigned long y, unsigned long n);
+typedef void (*PfnScanlineBlender)(uint32_t *dst, const uint32_t *src, int count, uint32_t color, unsigned long n);
+// Returns scanline blender that gives same result as the given 32-bit
+// blender callback used with draw_trans_sprite, or NULL if there's none
+PfnScanlineBlender GetScanlineTransBlender(PfnBlender32 blender);
+// Returns scanline blender that gives same result as the given 32-bit
+// blender callback used with draw_lit_sprite, or NULL if there's none
+PfnScanlineBlender GetScanlineLitBlender(PfnBlender32 blender);
+
 #endif // __AC_BLENDER_H
@@ -12,8 +12,11 @@
 //
 //=============================================================================
 
+#include <allegro.h>
+#include <allegro/internal/aintern.h>
 #include "gfx/gfx_util.h"
 #include "gfx/blender.h"
+#include "util/math.h"
 
 // CHECKME: is this hack still relevant?
 #if defined(IOS_VERSION) || defined(ANDROID_VERSION)
@@ -88,6 +91,57 @@ bool SetBlender(BlendMode blend_mode, bool dst_has_alpha, bool src_has_alpha, in
     return false;
 }
 
+// Tells if the scanline blenders may be used to draw sprite on ds
+static bool CanBlendScanlines(Bitmap *ds, Bitmap *sprite)
+{
+    return ds->GetColorDepth() == 32 && sprite->GetColorDepth() == 32 &&
+        ds->IsMemoryBitmap() && sprite->IsMemoryBitmap() &&
+        _rgb_a_shift_32 == 24;
+}
+
+// Draws sprite over ds row by row; clips same way Allegro's sprite drawing does
+static void BlendScanlines(Bitmap *ds, Bitmap *sprite, int x, int y,
+                           PfnScanlineBlender blender, uint32_t color, unsigned long n)
+{
+    BITMAP *al_ds = ds->GetAllegroBitmap();
+    int sx = 0, sy = 0;
+    int w = sprite->GetWidth(), h = sprite->GetHeight();
+    if (al_ds->clip)
+    {
+        sx = Math::Max(0, al_ds->cl - x);
+        sy = Math::Max(0, al_ds->ct - y);
+        w = Math::Min(w, al_ds->cr - x) - sx;
+        h = Math::Min(h, al_ds->cb - y) - sy;
+        if (w <= 0 || h <= 0)
+            return;
+    }
+    for (int row = 0; row < h; ++row)
+    {
+        blender((uint32_t*)ds->GetScanLineForWriting(y + sy + row) + x + sx,
+            (const uint32_t*)sprite->GetScanLine(sy + row) + sx, w, color, n);
+    }
+}
+
+void TransBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y)
+{
+    PfnScanlineBlender blender = CanBlendScanlines(ds, sprite) ?
+        GetScanlineTransBlender(_blender_func32) : NULL;
+    if (blender)
+        BlendScanlines(ds, sprite, x, y, blender, 0, _blender_alpha);
+    else
+        ds->TransBlendBlt(sprite, x, y);
+}
+
+void LitBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y, int light_amount)
+{
+    PfnScanlineBlender blender = CanBlendScanlines(ds, sprite) ?
+        GetScanlineLitBlender(_blender_func32) : NULL;
+    if (blender)
+        BlendScanlines(ds, sprite, x, y, blender, _blender_col_32, light_amount);
+    else
+        ds->LitBlendBlt(sprite, x, y, light_amount);
+}
+
 void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
                        BlendMode blend_mode,  bool dst_has_alpha, bool src_has_alpha, int blend_alpha)
 {
@@ -99,7 +153,7 @@ void DrawSpriteBlend(Bitmap *ds, const Point &ds_at, Bitmap *sprite,
         // set blenders if applicable and tell if succeeded
         SetBlender(blend_mode, dst_has_alpha, src_has_alpha, blend_alpha))
     {
-        ds->TransBlendBlt(sprite, ds_at.X, ds_at.Y);
+        TransBlendBlt(ds, sprite, ds_at.X, ds_at.Y);
     }
     else
     {
@@ -162,7 +216,7 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
         if (alpha < 0xFF) 
         {
             set_trans_blender(0, 0, 0, alpha);
-            ds->TransBlendBlt(&hctemp, x, y);
+            TransBlendBlt(ds, &hctemp, x, y);
         }
         else
         {
@@ -174,7 +228,7 @@ void DrawSpriteWithTransparency(Bitmap *ds, Bitmap *sprite, int x, int y, int al
         if (alpha < 0xFF && surface_depth > 8 && sprite_depth > 8) 
         {
             set_trans_blender(0, 0, 0, alpha);
-            ds->TransBlendBlt(sprite, x, y);
+            TransBlendBlt(ds, sprite, x, y);
         }
         else
         {
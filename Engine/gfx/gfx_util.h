@@ -39,6 +39,14 @@ namespace GfxUtil
     // Creates a COPY of the source bitmap, converted to the given format.
     Bitmap *ConvertBitmap(Bitmap *src, int dst_color_depth);
 
+    // Draws a bitmap over another one using current Allegro blender, same as
+    // Bitmap::TransBlendBlt does, but blends whole rows of 32-bit pixels at
+    // once when the blender has an optimized implementation.
+    void TransBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y);
+    // Draws a bitmap tinted with the current Allegro blender color, same as
+    // Bitmap::LitBlendBlt does, optimized same way as TransBlendBlt.
+    void LitBlendBlt(Bitmap *ds, Bitmap *sprite, int x, int y, int light_amount);
+
     // Considers the given information about source and destination surfaces,
     // then draws a bimtap over another either using requested blending mode,
     // or fallbacks to common "magic pink" transparency mode;
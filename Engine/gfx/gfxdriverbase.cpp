@@ -173,6 +173,10 @@ void VideoMemoryGraphicsDriver::SetMemoryBackBuffer(Bitmap *backBuffer, int offx
 { // do nothing, video-memory drivers don't use main back buffer, only stage bitmaps they pass to plugins
 }
 
+void VideoMemoryGraphicsDriver::SetMemoryBackBufferDirtyRegions(const std::vector<Rect> &regions)
+{ // do nothing, video-memory drivers redraw whole screen each frame
+}
+
 Bitmap *VideoMemoryGraphicsDriver::GetStageBackBuffer()
 {
     _stageScreenDirty = true;
@@ -179,6 +179,7 @@ public:
     virtual bool UsesMemoryBackBuffer();
     virtual Bitmap *GetMemoryBackBuffer();
     virtual void SetMemoryBackBuffer(Bitmap *backBuffer, int offx, int offy);
+    virtual void SetMemoryBackBufferDirtyRegions(const std::vector<Rect> &regions);
     virtual Bitmap* GetStageBackBuffer();
 
 protected:
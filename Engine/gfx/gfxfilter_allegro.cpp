@@ -94,6 +94,40 @@ void AllegroGfxFilter::RenderScreen(Bitmap *toRender, int x, int y) {
     lastBlitY = y;
 }
 
+void AllegroGfxFilter::RenderScreenRegions(Bitmap *toRender, int x, int y, const std::vector<Rect> &regions)
+{
+    if (toRender == realScreen)
+        return;
+    // Partial update is only safe when every source pixel is scaled to the whole
+    // number of pixels, otherwise the region edges may be rounded differently
+    const int width = _scaling.X.ScaleDistance(toRender->GetWidth());
+    const int height = _scaling.Y.ScaleDistance(toRender->GetHeight());
+    if (width % toRender->GetWidth() != 0 || height % toRender->GetHeight() != 0)
+    {
+        RenderScreen(toRender, x, y);
+        return;
+    }
+
+    const int scale_x = width / toRender->GetWidth();
+    const int scale_y = height / toRender->GetHeight();
+    const Rect bounds = RectWH(toRender->GetSize());
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        if (!AreRectsIntersecting(bounds, regions[i]))
+            continue;
+        const Rect src = ClampToRect(bounds, regions[i]);
+        const int dst_x = _scaling.X.ScalePt(x + src.Left);
+        const int dst_y = _scaling.Y.ScalePt(y + src.Top);
+        if (scale_x == 1 && scale_y == 1)
+            realScreen->Blit(toRender, src.Left, src.Top, dst_x, dst_y, src.GetWidth(), src.GetHeight());
+        else
+            realScreen->StretchBlt(toRender, src, RectWH(dst_x, dst_y, src.GetWidth() * scale_x, src.GetHeight() * scale_y));
+    }
+    lastBlitFrom = toRender;
+    lastBlitX = _scaling.X.ScalePt(x);
+    lastBlitY = _scaling.Y.ScalePt(y);
+}
+
 void AllegroGfxFilter::RenderScreenFlipped(Bitmap *toRender, int x, int y, GlobalFlipType flipType) {
 
     if (toRender == virtualScreen)
@@ -19,6 +19,7 @@
 #ifndef __AGS_EE_GFX__ALLEGROGFXFILTER_H
 #define __AGS_EE_GFX__ALLEGROGFXFILTER_H
 
+#include <vector>
 #include "gfx/bitmap.h"
 #include "gfx/gfxfilter_scaling.h"
 #include "gfx/gfxdefines.h"
@@ -42,6 +43,8 @@ public:
     virtual Bitmap *InitVirtualScreen(Bitmap *screen, const Size src_size, const Rect dst_rect);
     virtual Bitmap *ShutdownAndReturnRealScreen();
     virtual void RenderScreen(Bitmap *toRender, int x, int y);
+    // Presents only the given regions of the screen bitmap
+    virtual void RenderScreenRegions(Bitmap *toRender, int x, int y, const std::vector<Rect> &regions);
     virtual void RenderScreenFlipped(Bitmap *toRender, int x, int y, GlobalFlipType flipType);
     virtual void ClearRect(int x1, int y1, int x2, int y2, int color);
     virtual void GetCopyOfScreenIntoBitmap(Bitmap *copyBitmap);
@@ -78,6 +78,11 @@ Bitmap *HqxGfxFilter::ShutdownAndReturnRealScreen()
     return real_screen;
 }
 
+void HqxGfxFilter::RenderScreenRegions(Bitmap *toRender, int x, int y, const std::vector<Rect> &regions)
+{
+    RenderScreen(toRender, x, y);
+}
+
 Bitmap *HqxGfxFilter::PreRenderPass(Bitmap *toRender)
 {
     _hqxScalingBuffer->Acquire();
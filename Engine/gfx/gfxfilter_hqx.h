@@ -39,6 +39,8 @@ public:
     virtual bool Initialize(const int color_depth, String &err_str);
     virtual Bitmap *InitVirtualScreen(Bitmap *screen, const Size src_size, const Rect dst_rect);
     virtual Bitmap *ShutdownAndReturnRealScreen();
+    // Hqx processes the whole screen at once, so it cannot present separate regions
+    virtual void RenderScreenRegions(Bitmap *toRender, int x, int y, const std::vector<Rect> &regions);
 
     static const GfxFilterInfo FilterInfo;
 
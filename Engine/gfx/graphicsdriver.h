@@ -19,6 +19,7 @@
 #ifndef __AGS_EE_GFX__GRAPHICSDRIVER_H
 #define __AGS_EE_GFX__GRAPHICSDRIVER_H
 
+#include <vector>
 #include "util/stdtr1compat.h"
 #include TR1INCLUDE(memory)
 #include "gfx/gfxdefines.h"
@@ -172,6 +173,10 @@ public:
   // to the final render surface. Passing NULL pointer will tell renderer to switch back to its original virtual screen.
   // Note that only software renderer supports this.
   virtual void SetMemoryBackBuffer(Common::Bitmap *backBuffer, int offx = 0, int offy = 0) = 0;
+  // Tells which regions of the memory backbuffer were changed since the previous call, in backbuffer coordinates.
+  // Renderer may then present only these regions on the next Render; if it was not called before rendering,
+  // the whole backbuffer is presented. Only software renderer makes use of this.
+  virtual void SetMemoryBackBufferDirtyRegions(const std::vector<Rect> &regions) = 0;
   // Returns memory backbuffer for the current rendering stage (or base virtual screen if called outside of render pass).
   // All renderers should support this.
   virtual Common::Bitmap* GetStageBackBuffer() = 0;
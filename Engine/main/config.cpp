@@ -28,6 +28,7 @@
 #include "main/config.h"
 #include "platform/base/agsplatformdriver.h"
 #include "platform/base/override_defines.h" //_getcwd()
+#include "script/cc_options.h"
 #include "util/directory.h"
 #include "util/ini_util.h"
 #include "util/textstreamreader.h"
@@ -460,6 +461,7 @@ void apply_config(const ConfigTree &cfg)
         usetup.Screen.DisplayMode.VSync = INIreadint(cfg, "graphics", "vsync") > 0;
         usetup.RenderAtScreenRes = INIreadint(cfg, "graphics", "render_at_screenres") > 0;
         usetup.Supersampling = INIreadint(cfg, "graphics", "supersampling", 1);
+        usetup.RenderThreads = INIreadint(cfg, "graphics", "render_threads", 1);
 
         usetup.enable_antialiasing = INIreadint(cfg, "misc", "antialias") > 0;
 
@@ -477,6 +479,11 @@ void apply_config(const ConfigTree &cfg)
         // the config file specifies cache size in KB, here we convert it to bytes
         spriteset.SetMaxCacheSize(INIreadint (cfg, "misc", "cachemax", DEFAULTCACHESIZE / 1024) * 1024);
 #endif
+        spriteset.SetFileMapping(INIreadint(cfg, "misc", "sprite_mmap", 1) != 0);
+        usetup.PathfinderThreads = INIreadint(cfg, "misc", "pathfinder_threads", 1);
+        usetup.RoomLoadThreads = INIreadint(cfg, "misc", "room_load_threads", 1);
+        usetup.AsyncSave = INIreadint(cfg, "misc", "async_save", 0) != 0;
+        usetup.DeltaSaves = INIreadint(cfg, "misc", "delta_saves", 0) != 0;
 
         String repfile = INIreadstring(cfg, "misc", "replay");
         if (repfile != NULL) {
@@ -532,6 +539,9 @@ void apply_config(const ConfigTree &cfg)
             usetup.override_script_os = eOS_Mac;
         }
         usetup.override_upscale = INIreadint(cfg, "override", "upscale") > 0;
+
+        ccSetOption(SCOPT_FUSEOPS, INIreadint(cfg, "script", "fuse_ops") > 0);
+        ccSetOption(SCOPT_OPSTATS, INIreadint(cfg, "script", "op_stats") > 0);
     }
 
     // Apply logging configuration
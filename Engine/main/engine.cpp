@@ -712,7 +712,7 @@ void engine_init_pathfinder()
 {
     Debug::Printf(kDbgMsg_Init, "Initialize path finder library");
 
-    init_pathfinder();
+    init_pathfinder(usetup.PathfinderThreads);
 }
 
 void engine_pre_init_gfx()
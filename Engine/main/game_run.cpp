@@ -20,6 +20,7 @@
 #include "ac/characterextras.h"
 #include "ac/characterinfo.h"
 #include "ac/draw.h"
+#include "ac/dynobj/cc_dynamicobject.h"
 #include "ac/event.h"
 #include "ac/game.h"
 #include "ac/gamesetup.h"
@@ -50,6 +51,7 @@
 #include "media/audio/soundclip.h"
 #include "plugin/agsplugin.h"
 #include "plugin/plugin_engine.h"
+#include "script/cc_instance.h"
 #include "script/script.h"
 #include "ac/spritecache.h"
 
@@ -638,6 +640,7 @@ void game_loop_do_render_and_check_mouse(IDriverDependantBitmap *extraBitmap, in
 
 void game_loop_update_events()
 {
+    update_savegame_writes();
     new_room_was = in_new_room;
     if (in_new_room>0)
         setevent(EV_FADEIN,0,0,0);
@@ -701,12 +704,22 @@ void game_loop_update_fps()
     }
 }
 
+// Number of queued script objects to check for disposal at once while
+// waiting for the next frame
+const int IDLE_GARBAGE_COLLECTION_STEP = 50;
+
 void PollUntilNextFrame()
 {
     // make sure we poll, cos a low framerate (eg 5 fps) could stutter
     // mp3 music
     while (timerloop == 0 && play.fast_forward == 0) {
         update_polled_stuff_if_runtime();
+        // spend the remaining frame time collecting unreferenced script
+        // objects; not while the script is suspended in a blocking call,
+        // as it may hold the only reference to a new object on stack
+        if (ccInstance::GetCurrentInstance() == NULL &&
+            ccCollectGarbage(IDLE_GARBAGE_COLLECTION_STEP) > 0)
+            continue;
         platform->YieldCPU();
     }
 }
@@ -29,6 +29,7 @@
 #include "debug/agseditordebugger.h"
 #include "debug/debug_log.h"
 #include "debug/out.h"
+#include "game/savegame.h"
 #include "main/config.h"
 #include "main/engine.h"
 #include "main/mainheader.h"
@@ -88,6 +89,10 @@ bool justRunSetup = false;
 bool justRegisterGame = false;
 bool justUnRegisterGame = false;
 const char *loadSaveGameOnStartup = NULL;
+const char *compactSaveGame = NULL;
+#ifdef _DEBUG
+bool justRunPerfTests = false;
+#endif
 
 #if !defined(MAC_VERSION) && !defined(IOS_VERSION) && !defined(PSP_VERSION) && !defined(ANDROID_VERSION)
 int psp_video_framedrop = 1;
@@ -201,6 +206,8 @@ void main_print_help() {
            "  --log                        Enable program output to the log file\n"
            "  --no-log                     Disable program output to the log file,\n"
            "                                 overriding configuration file setting\n"
+           "  --compact-save <file>        Rewrite the incremental savegame into the\n"
+           "                                 full one, which does not need its base file\n"
            "  --help                       Print this help message\n"
            "\n"
            "Gamefile options:\n"
@@ -252,6 +259,8 @@ int main_process_cmdline(int argc,char*argv[])
             override_start_room = atoi(argv[ee+1]);
             ee++;
         }
+        else if (stricmp(argv[ee],"--run-perf-tests") == 0)
+            justRunPerfTests = true;
 #endif
         else if ((stricmp(argv[ee],"--testre") == 0) && (ee < argc-2)) {
             strcpy(return_to_roomedit, argv[ee+1]);
@@ -283,6 +292,11 @@ int main_process_cmdline(int argc,char*argv[])
         {
             justUnRegisterGame = true;
         }
+        else if ((stricmp(argv[ee],"--compact-save") == 0) && (argc > ee + 1))
+        {
+            compactSaveGame = argv[ee + 1];
+            ee++;
+        }
         else if ((stricmp(argv[ee],"-loadsavedgame") == 0) && (argc > ee + 1))
         {
             loadSaveGameOnStartup = argv[ee + 1];
@@ -493,6 +507,25 @@ int main(int argc,char*argv[]) {
         return 0;
     }
 
+#ifdef _DEBUG
+    if (justRunPerfTests)
+    {
+        Test_DoAllPerfTests();
+        return 0;
+    }
+#endif
+
+    if (compactSaveGame)
+    {
+        HSaveError err = CompactSavegame(compactSaveGame);
+        if (!err)
+        {
+            platform->WriteStdOut("Failed to compact savegame %s:\n%s", compactSaveGame, err->FullMessage().GetCStr());
+            return 1;
+        }
+        return 0;
+    }
+
     init_debug();
     Debug::Printf(kDbgMsg_Init, get_engine_string());
 
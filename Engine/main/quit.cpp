@@ -26,12 +26,14 @@
 #include "debug/debugger.h"
 #include "debug/out.h"
 #include "font/fonts.h"
+#include "game/savegame.h"
 #include "main/config.h"
 #include "main/engine.h"
 #include "main/main.h"
 #include "main/mainheader.h"
 #include "main/quit.h"
 #include "ac/spritecache.h"
+#include "ac/transformedspritecache.h"
 #include "gfx/graphicsdriver.h"
 #include "gfx/bitmap.h"
 #include "core/assetmanager.h"
@@ -258,6 +260,9 @@ void quit(const char *quitmsg)
 
     stop_recording();
 
+    // let the last savegame be written completely
+    AGS::Engine::WaitForSavegameWrite();
+
     our_eip = 9020;
 
     quit_shutdown_scripts();
@@ -273,6 +278,7 @@ void quit(const char *quitmsg)
     shutdown_font_renderer();
     our_eip = 9902;
 
+    transformed_sprites.Clear();
     spriteset.Reset();
 
     our_eip = 9907;
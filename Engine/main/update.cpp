@@ -213,15 +213,20 @@ void update_shadow_areas()
 
 void update_character_move_and_anim(int &numSheep, int *followingAsSheep)
 {
-	// move & animate characters
+	// move & animate characters; the followers which start walking find
+	// their routes together, before anyone moves who might bump into them
+  begin_walk_batch();
   for (int aa=0;aa<game.numcharacters;aa++) {
     if (game.chars[aa].on != 1) continue;
 
     CharacterInfo*chi    = &game.chars[aa];
 	CharacterExtras*chex = &charextra[aa];
 
+    if (chi->walking)
+      flush_walk_batch();
 	chi->UpdateMoveAndAnim(aa, chex, numSheep, followingAsSheep);
   }
+  end_walk_batch();
 }
 
 void update_following_exactly_characters(int &numSheep, int *followingAsSheep)
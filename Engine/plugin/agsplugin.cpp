@@ -35,6 +35,7 @@
 #include "ac/record.h"
 #include "ac/roomstatus.h"
 #include "ac/string.h"
+#include "ac/transformedspritecache.h"
 #include "ac/dynobj/scriptobject.h"
 #include "font/fonts.h"
 #include "util/string_utils.h"
@@ -471,7 +472,8 @@ void IAGSEngine::FreeBitmap (BITMAP *tofree) {
         destroy_bitmap (tofree);
 }
 BITMAP *IAGSEngine::GetSpriteGraphic (int32 num) {
-    return (BITMAP*)spriteset[num]->GetAllegroBitmap();
+    // plugins may draw onto the sprite, so it cannot stay over the mapped file
+    return (BITMAP*)spriteset.GetWritableImage(num)->GetAllegroBitmap();
 }
 BITMAP *IAGSEngine::GetRoomMask (int32 index) {
     if (index == MASK_WALKABLE)
@@ -673,6 +675,7 @@ int IAGSEngine::CallGameScriptFunction(const char *name, int32 globalScript, int
 
 void IAGSEngine::NotifySpriteUpdated(int32 slot) {
     int ff;
+    transformed_sprites.InvalidateSprite(slot);
     // wipe the character cache when we change rooms
     for (ff = 0; ff < game.numcharacters; ff++) {
         if ((charcache[ff].inUse) && (charcache[ff].sppic == slot)) {
@@ -864,6 +867,14 @@ int pl_run_plugin_hooks (int event, int data) {
     return 0;
 }
 
+bool pl_any_want_hook(int event) {
+    for (int i = 0; i < numPlugins; i++) {
+        if (plugins[i].wantHook & event)
+            return true;
+    }
+    return false;
+}
+
 int pl_run_plugin_debug_hooks (const char *scriptfile, int linenum) {
     int i, retval = 0;
     for (i = 0; i < numPlugins; i++) {
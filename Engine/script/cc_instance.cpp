@@ -13,6 +13,9 @@
 //=============================================================================
 
 #include <string.h>
+#include <algorithm>
+#include <map>
+#include <vector>
 #include "ac/common.h"
 #include "ac/dynobj/cc_dynamicarray.h"
 #include "ac/dynobj/managedobjectpool.h"
@@ -158,6 +161,18 @@ const char *regnames[] = { "null", "sp", "mar", "ax", "bx", "cx", "op", "dx" };
 
 const char *fixupnames[] = { "null", "fix_gldata", "fix_func", "fix_string", "fix_import", "fix_datadata", "fix_stack" };
 
+// Engine-private handlers for the fused instruction sequences; these codes
+// are never written to the script, and are only set in pre-decoded operations
+enum ScriptFusedCommand
+{
+    kScFused_LoadSpOffsMemRead = CC_NUM_SCCMDS, // load.sp.offs + memread
+    kScFused_LitToRegPush,                      // mov reg, lit + push reg
+    kScFused_PushLitPop,                        // push reg1 + mov reg2, lit + pop reg3
+    kScFused_CmpJz,                             // int comparison to ax + jz
+    kScFused_CmpMovJz,                          // int comparison + mov ax + jz
+    kScNumOpHandlers
+};
+
 ccInstance *current_instance;
 // [IKM] 2012-10-21:
 // NOTE: This is temporary solution (*sigh*, one of many) which allows certain
@@ -237,6 +252,9 @@ ccInstance::ccInstance()
     returnValue         = 0;
 
     code_fixups         = NULL;
+    code_ops            = NULL;
+    numcodeops          = 0;
+    code_opindex        = NULL;
 }
 
 ccInstance::~ccInstance()
@@ -411,6 +429,20 @@ int ccInstance::CallScriptFunction(const char *funcname, int32_t numargs, const
     currentline = line_number
 
 #define MAXNEST 50  // number of recursive function calls allowed
+
+// When supported by compiler, use "labels as values" extension to jump
+// directly to the instruction handler, skipping switch's range check.
+// This is still a single dispatch point: every handler returns to the top
+// of the loop, which fetches the next operation.
+#if defined (__GNUC__) && !defined (AGS_SCRIPT_NO_DIRECT_DISPATCH)
+#define SCRIPT_DIRECT_DISPATCH
+#define SCMD_CASE(cmd) case cmd: lbl_##cmd
+#define SCMD_DEFAULT   default: lbl_default
+#else
+#define SCMD_CASE(cmd) case cmd
+#define SCMD_DEFAULT   default
+#endif
+
 int ccInstance::Run(int32_t curpc)
 {
     pc = curpc;
@@ -437,102 +469,67 @@ int ccInstance::Run(int32_t curpc)
 
     FunctionCallStack func_callstack;
 
-    while (1) {
+#if defined (SCRIPT_DIRECT_DISPATCH)
+    // NOTE: the order of entries must match instruction and fused handler codes
+    static const void *const dispatch_table[kScNumOpHandlers] = {
+        &&lbl_default, &&lbl_SCMD_ADD, &&lbl_SCMD_SUB, &&lbl_SCMD_REGTOREG, &&lbl_SCMD_WRITELIT,
+        &&lbl_SCMD_RET, &&lbl_SCMD_LITTOREG, &&lbl_SCMD_MEMREAD, &&lbl_SCMD_MEMWRITE,
+        &&lbl_SCMD_MULREG, &&lbl_SCMD_DIVREG, &&lbl_SCMD_ADDREG, &&lbl_SCMD_SUBREG,
+        &&lbl_SCMD_BITAND, &&lbl_SCMD_BITOR, &&lbl_SCMD_ISEQUAL, &&lbl_SCMD_NOTEQUAL,
+        &&lbl_SCMD_GREATER, &&lbl_SCMD_LESSTHAN, &&lbl_SCMD_GTE, &&lbl_SCMD_LTE, &&lbl_SCMD_AND,
+        &&lbl_SCMD_OR, &&lbl_SCMD_CALL, &&lbl_SCMD_MEMREADB, &&lbl_SCMD_MEMREADW,
+        &&lbl_SCMD_MEMWRITEB, &&lbl_SCMD_MEMWRITEW, &&lbl_SCMD_JZ, &&lbl_SCMD_PUSHREG,
+        &&lbl_SCMD_POPREG, &&lbl_SCMD_JMP, &&lbl_SCMD_MUL, &&lbl_SCMD_CALLEXT, &&lbl_SCMD_PUSHREAL,
+        &&lbl_SCMD_SUBREALSTACK, &&lbl_SCMD_LINENUM, &&lbl_SCMD_CALLAS, &&lbl_SCMD_THISBASE,
+        &&lbl_SCMD_NUMFUNCARGS, &&lbl_SCMD_MODREG, &&lbl_SCMD_XORREG, &&lbl_SCMD_NOTREG,
+        &&lbl_SCMD_SHIFTLEFT, &&lbl_SCMD_SHIFTRIGHT, &&lbl_SCMD_CALLOBJ, &&lbl_SCMD_CHECKBOUNDS,
+        &&lbl_SCMD_MEMWRITEPTR, &&lbl_SCMD_MEMREADPTR, &&lbl_SCMD_MEMZEROPTR,
+        &&lbl_SCMD_MEMINITPTR, &&lbl_SCMD_LOADSPOFFS, &&lbl_SCMD_CHECKNULL, &&lbl_SCMD_FADD,
+        &&lbl_SCMD_FSUB, &&lbl_SCMD_FMULREG, &&lbl_SCMD_FDIVREG, &&lbl_SCMD_FADDREG,
+        &&lbl_SCMD_FSUBREG, &&lbl_SCMD_FGREATER, &&lbl_SCMD_FLESSTHAN, &&lbl_SCMD_FGTE,
+        &&lbl_SCMD_FLTE, &&lbl_SCMD_ZEROMEMORY, &&lbl_SCMD_CREATESTRING, &&lbl_SCMD_STRINGSEQUAL,
+        &&lbl_SCMD_STRINGSNOTEQ, &&lbl_SCMD_CHECKNULLREG, &&lbl_SCMD_LOOPCHECKOFF,
+        &&lbl_SCMD_MEMZEROPTRND, &&lbl_SCMD_JNZ, &&lbl_SCMD_DYNAMICBOUNDS, &&lbl_SCMD_NEWARRAY,
+        &&lbl_SCMD_NEWUSEROBJECT,
+        &&lbl_kScFused_LoadSpOffsMemRead, &&lbl_kScFused_LitToRegPush, &&lbl_kScFused_PushLitPop,
+        &&lbl_kScFused_CmpJz, &&lbl_kScFused_CmpMovJz
+    };
+#endif
 
-        /*
-		if (!codeInst->ReadOperation(codeOp, pc))
-        {
-            return -1;
-        }
-        */
-        /* ReadOperation */
-        //=====================================================================
-        codeOp.Instruction.Code			= codeInst->code[pc];
-        codeOp.Instruction.InstanceId	= (codeOp.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-        codeOp.Instruction.Code		   &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
-
-        if (codeOp.Instruction.Code < 0 || codeOp.Instruction.Code >= CC_NUM_SCCMDS)
-        {
-            cc_error("invalid instruction %d found in code stream", codeOp.Instruction.Code);
-            return -1;
-        }
-
-        codeOp.ArgCount = sccmd_info[codeOp.Instruction.Code].ArgCount;
-        if (pc + codeOp.ArgCount >= codeInst->codesize)
-        {
-            cc_error("unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
-            return -1;
-        }
+    while (1) {
 
-        int pc_at = pc + 1;
-        for (int i = 0; i < codeOp.ArgCount; ++i, ++pc_at)
+        // Take the pre-decoded operation if there is one at this position,
+        // otherwise fallback to reading one from the code array
+        const ScriptOperation *op = &codeOp;
+        const int32_t op_at = ((uint32_t)pc < (uint32_t)codeInst->codesize) ? codeInst->code_opindex[pc] : -1;
+        if (op_at >= 0)
         {
-            char fixup = codeInst->code_fixups[pc_at];
-            if (fixup > 0)
+            op = &codeInst->code_ops[op_at];
+            if (op->LateFixups)
             {
-                // could be relative pointer or import address
-                /*
-                if (!FixupArgument(code[pc], fixup, codeOp.Args[i]))
-                {
-                    return -1;
-                }
-                */
-                /* FixupArgument */
-                //=====================================================================
-                switch (fixup)
+                codeOp = *op;
+                for (int i = 0; i < codeOp.ArgCount; ++i)
                 {
-                case FIXUP_GLOBALDATA:
-                    {
-                        ScriptVariable *gl_var = (ScriptVariable*)codeInst->code[pc_at];
-                        codeOp.Args[i].SetGlobalVar(&gl_var->RValue);
-                    }
-                    break;
-                case FIXUP_FUNCTION:
-                    // originally commented -- CHECKME: could this be used in very old versions of AGS?
-                    //      code[fixup] += (long)&code[0];
-                    // This is a program counter value, presumably will be used as SCMD_CALL argument
-                    codeOp.Args[i].SetInt32((int32_t)codeInst->code[pc_at]);
-                    break;
-                case FIXUP_STRING:
-                    codeOp.Args[i].SetStringLiteral(&codeInst->strings[0] + codeInst->code[pc_at]);
-                    break;
-                case FIXUP_IMPORT:
+                    if ((codeOp.LateFixups & (1 << i)) == 0)
+                        continue;
+                    const int32_t pc_at = pc + 1 + i;
+                    if (!FixupArgument(codeInst, codeInst->code[pc_at], codeInst->code_fixups[pc_at], codeOp.Args[i]))
                     {
-                        const ScriptImport *import = simp.getByIndex((int32_t)codeInst->code[pc_at]);
-                        if (import)
-                        {
-                            codeOp.Args[i] = import->Value;
-                        }
-                        else
-                        {
-                            cc_error("cannot resolve import, key = %ld", codeInst->code[pc_at]);
-                            return -1;
-                        }
+                        return -1;
                     }
-                    break;
-                case FIXUP_STACK:
-                    codeOp.Args[i] = GetStackPtrOffsetFw((int32_t)codeInst->code[pc_at]);
-                    break;
-                default:
-                    cc_error("internal fixup type error: %d", fixup);
-                    return -1;
                 }
-                /* End FixupArgument */
-                //=====================================================================
-            }
-            else
-            {
-                // should be a numeric literal (int32 or float)
-                codeOp.Args[i].SetInt32( (int32_t)codeInst->code[pc_at] );
+                op = &codeOp;
             }
         }
-        /* End ReadOperation */
-        //=====================================================================
+        else if (!ReadOperation(codeOp, codeInst, pc))
+        {
+            return -1;
+        }
 
         // save the arguments for quick access
-        RuntimeScriptValue &arg1 = codeOp.Args[0];
-        RuntimeScriptValue &arg2 = codeOp.Args[1];
-        RuntimeScriptValue &arg3 = codeOp.Args[2];
+        const RuntimeScriptValue &arg1 = op->Args[0];
+        const RuntimeScriptValue &arg2 = op->Args[1];
+        const RuntimeScriptValue &arg3 = op->Args[2];
         RuntimeScriptValue &reg1 = 
             registers[arg1.IValue >= 0 && arg1.IValue < CC_NUM_REGISTERS ? arg1.IValue : 0];
         RuntimeScriptValue &reg2 = 
@@ -543,17 +540,20 @@ int ccInstance::Run(int32_t curpc)
 
         if (write_debug_dump)
         {
-            DumpInstruction(codeOp);
+            DumpInstruction(*op);
         }
 
-        switch (codeOp.Instruction.Code) {
-      case SCMD_LINENUM:
+#if defined (SCRIPT_DIRECT_DISPATCH)
+        goto *dispatch_table[op->Handler];
+#endif
+        switch (op->Handler) {
+      SCMD_CASE(SCMD_LINENUM):
           line_number = arg1.IValue;
           currentline = arg1.IValue;
           if (new_line_hook)
               new_line_hook(this, currentline);
           break;
-      case SCMD_ADD:
+      SCMD_CASE(SCMD_ADD):
           // If the the register is SREG_SP, we are allocating new variable on the stack
           if (arg1.IValue == SREG_SP)
           {
@@ -579,7 +579,7 @@ int ccInstance::Run(int32_t curpc)
             reg1.IValue += arg2.IValue;
           }
           break;
-      case SCMD_SUB:
+      SCMD_CASE(SCMD_SUB):
           if (reg1.Type == kScValStackPtr)
           {
             // If this is SREG_SP, this is stack pop, which frees local variables;
@@ -606,10 +606,10 @@ int ccInstance::Run(int32_t curpc)
             reg1.IValue -= arg2.IValue;
           }
           break;
-      case SCMD_REGTOREG:
+      SCMD_CASE(SCMD_REGTOREG):
           reg2 = reg1;
           break;
-      case SCMD_WRITELIT:
+      SCMD_CASE(SCMD_WRITELIT):
           // Take the data address from reg[MAR] and copy there arg1 bytes from arg2 address
           //
           // NOTE: since it reads directly from arg2 (which originally was
@@ -633,7 +633,7 @@ int ccInstance::Run(int32_t curpc)
               break;
           }
           break;
-      case SCMD_RET:
+      SCMD_CASE(SCMD_RET):
           {
           if (loopIterationCheckDisabled > 0)
               loopIterationCheckDisabled--;
@@ -651,18 +651,18 @@ int ccInstance::Run(int32_t curpc)
           POP_CALL_STACK;
           continue; // continue so that the PC doesn't get overwritten
           }
-      case SCMD_LITTOREG:
+      SCMD_CASE(SCMD_LITTOREG):
           reg1 = arg2;
           break;
-      case SCMD_MEMREAD:
+      SCMD_CASE(SCMD_MEMREAD):
           // Take the data address from reg[MAR] and copy int32_t to reg[arg1]
           reg1 = registers[SREG_MAR].ReadValue();
           break;
-      case SCMD_MEMWRITE:
+      SCMD_CASE(SCMD_MEMWRITE):
           // Take the data address from reg[MAR] and copy there int32_t from reg[arg1]
           registers[SREG_MAR].WriteValue(reg1);
           break;
-      case SCMD_LOADSPOFFS:
+      SCMD_CASE(SCMD_LOADSPOFFS):
           registers[SREG_MAR] = GetStackPtrOffsetRw(arg1.IValue);
           if (ccError)
           {
@@ -671,68 +671,68 @@ int ccInstance::Run(int32_t curpc)
           break;
 
           // 64 bit: Force 32 bit math
-      case SCMD_MULREG:
+      SCMD_CASE(SCMD_MULREG):
           reg1.SetInt32(reg1.IValue * reg2.IValue);
           break;
-      case SCMD_DIVREG:
+      SCMD_CASE(SCMD_DIVREG):
           if (reg2.IValue == 0) {
               cc_error("!Integer divide by zero");
               return -1;
           } 
           reg1.SetInt32(reg1.IValue / reg2.IValue);
           break;
-      case SCMD_ADDREG:
+      SCMD_CASE(SCMD_ADDREG):
           // This may be pointer arithmetics, in which case IValue stores offset from base pointer
           reg1.IValue += reg2.IValue;
           break;
-      case SCMD_SUBREG:
+      SCMD_CASE(SCMD_SUBREG):
           // This may be pointer arithmetics, in which case IValue stores offset from base pointer
           reg1.IValue -= reg2.IValue;
           break;
-      case SCMD_BITAND:
+      SCMD_CASE(SCMD_BITAND):
           reg1.SetInt32(reg1.IValue & reg2.IValue);
           break;
-      case SCMD_BITOR:
+      SCMD_CASE(SCMD_BITOR):
           reg1.SetInt32(reg1.IValue | reg2.IValue);
           break;
-      case SCMD_ISEQUAL:
+      SCMD_CASE(SCMD_ISEQUAL):
           reg1.SetInt32AsBool(reg1 == reg2);
           break;
-      case SCMD_NOTEQUAL:
+      SCMD_CASE(SCMD_NOTEQUAL):
           reg1.SetInt32AsBool(reg1 != reg2);
           break;
-      case SCMD_GREATER:
+      SCMD_CASE(SCMD_GREATER):
           reg1.SetInt32AsBool(reg1.IValue > reg2.IValue);
           break;
-      case SCMD_LESSTHAN:
+      SCMD_CASE(SCMD_LESSTHAN):
           reg1.SetInt32AsBool(reg1.IValue < reg2.IValue);
           break;
-      case SCMD_GTE:
+      SCMD_CASE(SCMD_GTE):
           reg1.SetInt32AsBool(reg1.IValue >= reg2.IValue);
           break;
-      case SCMD_LTE:
+      SCMD_CASE(SCMD_LTE):
           reg1.SetInt32AsBool(reg1.IValue <= reg2.IValue);
           break;
-      case SCMD_AND:
+      SCMD_CASE(SCMD_AND):
           reg1.SetInt32AsBool(reg1.IValue && reg2.IValue);
           break;
-      case SCMD_OR:
+      SCMD_CASE(SCMD_OR):
           reg1.SetInt32AsBool(reg1.IValue || reg2.IValue);
           break;
-      case SCMD_XORREG:
+      SCMD_CASE(SCMD_XORREG):
           reg1.SetInt32(reg1.IValue ^ reg2.IValue);
           break;
-      case SCMD_MODREG:
+      SCMD_CASE(SCMD_MODREG):
           if (reg2.IValue == 0) {
               cc_error("!Integer divide by zero");
               return -1;
           } 
           reg1.SetInt32(reg1.IValue % reg2.IValue);
           break;
-      case SCMD_NOTREG:
+      SCMD_CASE(SCMD_NOTREG):
           reg1 = !(reg1);
           break;
-      case SCMD_CALL:
+      SCMD_CASE(SCMD_CALL):
           // CallScriptFunction another function within same script, just save PC
           // and continue from there
           if (curnest >= MAXNEST - 1) {
@@ -743,7 +743,7 @@ int ccInstance::Run(int32_t curpc)
           PUSH_CALL_STACK;
 
           ASSERT_STACK_SPACE_AVAILABLE(1);
-          PushValueToStack(RuntimeScriptValue().SetInt32(pc + codeOp.ArgCount + 1));
+          PushValueToStack(RuntimeScriptValue().SetInt32(pc + op->ArgCount + 1));
           if (ccError)
           {
               return -1;
@@ -765,31 +765,31 @@ int ccInstance::Run(int32_t curpc)
           thisbase[curnest] = 0;
           funcstart[curnest] = pc;
           continue; // continue so that the PC doesn't get overwritten
-      case SCMD_MEMREADB:
+      SCMD_CASE(SCMD_MEMREADB):
           // Take the data address from reg[MAR] and copy byte to reg[arg1]
           reg1.SetUInt8(registers[SREG_MAR].ReadByte());
           break;
-      case SCMD_MEMREADW:
+      SCMD_CASE(SCMD_MEMREADW):
           // Take the data address from reg[MAR] and copy int16_t to reg[arg1]
           reg1.SetInt16(registers[SREG_MAR].ReadInt16());
           break;
-      case SCMD_MEMWRITEB:
+      SCMD_CASE(SCMD_MEMWRITEB):
           // Take the data address from reg[MAR] and copy there byte from reg[arg1]
           registers[SREG_MAR].WriteByte(reg1.IValue);
           break;
-      case SCMD_MEMWRITEW:
+      SCMD_CASE(SCMD_MEMWRITEW):
           // Take the data address from reg[MAR] and copy there int16_t from reg[arg1]
           registers[SREG_MAR].WriteInt16(reg1.IValue);
           break;
-      case SCMD_JZ:
+      SCMD_CASE(SCMD_JZ):
           if (registers[SREG_AX].IsNull())
               pc += arg1.IValue;
           break;
-      case SCMD_JNZ:
+      SCMD_CASE(SCMD_JNZ):
           if (!registers[SREG_AX].IsNull())
               pc += arg1.IValue;
           break;
-      case SCMD_PUSHREG:
+      SCMD_CASE(SCMD_PUSHREG):
           // Script code analysis shows that statistically there's a moderate
           // chance (10-30% depending on game) that a PUSHREG instruction will be
           // immediately followed by POPREG.
@@ -810,11 +810,11 @@ int ccInstance::Run(int32_t curpc)
               return -1;
           }
           break;
-      case SCMD_POPREG:
+      SCMD_CASE(SCMD_POPREG):
           ASSERT_STACK_SIZE(1);
           reg1 = PopValueFromStack();
           break;
-      case SCMD_JMP:
+      SCMD_CASE(SCMD_JMP):
           pc += arg1.IValue;
 
           if ((arg1.IValue < 0) && (maxWhileLoops > 0) && (loopIterationCheckDisabled == 0)) {
@@ -830,17 +830,17 @@ int ccInstance::Run(int32_t curpc)
               }
           }
           break;
-      case SCMD_MUL:
+      SCMD_CASE(SCMD_MUL):
           reg1.IValue *= arg2.IValue;
           break;
-      case SCMD_CHECKBOUNDS:
+      SCMD_CASE(SCMD_CHECKBOUNDS):
           if ((reg1.IValue < 0) ||
               (reg1.IValue >= arg2.IValue)) {
                   cc_error("!Array index out of bounds (index: %d, bounds: 0..%d)", reg1.IValue, arg2.IValue - 1);
                   return -1;
           }
           break;
-      case SCMD_DYNAMICBOUNDS:
+      SCMD_CASE(SCMD_DYNAMICBOUNDS):
           {
               // TODO: test reg[MAR] type here;
               // That might be dynamic object, but also a non-managed dynamic array, "allocated"
@@ -858,7 +858,7 @@ int ccInstance::Run(int32_t curpc)
 
           // 64 bit: Handles are always 32 bit values. They are not C pointer.
 
-      case SCMD_MEMREADPTR: {
+      SCMD_CASE(SCMD_MEMREADPTR): {
           ccError = 0;
 
           int32_t handle = registers[SREG_MAR].ReadInt32();
@@ -878,7 +878,7 @@ int ccInstance::Run(int32_t curpc)
           if (ccError)
               return -1;
           break; }
-      case SCMD_MEMWRITEPTR: {
+      SCMD_CASE(SCMD_MEMWRITEPTR): {
 
           int32_t handle = registers[SREG_MAR].ReadInt32();
           char *address = NULL;
@@ -914,7 +914,7 @@ int ccInstance::Run(int32_t curpc)
           }
           break;
                              }
-      case SCMD_MEMINITPTR: { 
+      SCMD_CASE(SCMD_MEMINITPTR): { 
           char *address = NULL;
 
           if (reg1.Type == kScValStaticArray && reg1.StcArr->GetDynamicManager())
@@ -945,13 +945,13 @@ int ccInstance::Run(int32_t curpc)
           registers[SREG_MAR].WriteInt32(newHandle);
           break;
                             }
-      case SCMD_MEMZEROPTR: {
+      SCMD_CASE(SCMD_MEMZEROPTR): {
           int32_t handle = registers[SREG_MAR].ReadInt32();
           ccReleaseObjectReference(handle);
           registers[SREG_MAR].WriteInt32(0);
           break;
                             }
-      case SCMD_MEMZEROPTRND: {
+      SCMD_CASE(SCMD_MEMZEROPTRND): {
           int32_t handle = registers[SREG_MAR].ReadInt32();
 
           // don't do the Dispose check for the object being returned -- this is
@@ -965,22 +965,22 @@ int ccInstance::Run(int32_t curpc)
           registers[SREG_MAR].WriteInt32(0);
           break;
                               }
-      case SCMD_CHECKNULL:
+      SCMD_CASE(SCMD_CHECKNULL):
           if (registers[SREG_MAR].IsNull()) {
               cc_error("!Null pointer referenced");
               return -1;
           }
           break;
-      case SCMD_CHECKNULLREG:
+      SCMD_CASE(SCMD_CHECKNULLREG):
           if (reg1.IsNull()) {
               cc_error("!Null string referenced");
               return -1;
           }
           break;
-      case SCMD_NUMFUNCARGS:
+      SCMD_CASE(SCMD_NUMFUNCARGS):
           num_args_to_func = arg1.IValue;
           break;
-      case SCMD_CALLAS:{
+      SCMD_CASE(SCMD_CALLAS):{
           PUSH_CALL_STACK;
 
           // CallScriptFunction to a function in another script
@@ -1011,7 +1011,7 @@ int ccInstance::Run(int32_t curpc)
           ccInstance *wasRunning = runningInst;
 
           // extract the instance ID
-          int32_t instId = codeOp.Instruction.InstanceId;
+          int32_t instId = op->Instruction.InstanceId;
           // determine the offset into the code of the instance we want
           runningInst = loadedInstances[instId];
           intptr_t callAddr = reg1.Ptr - (char*)&runningInst->code[0];
@@ -1042,7 +1042,7 @@ int ccInstance::Run(int32_t curpc)
           POP_CALL_STACK;
           break;
                        }
-      case SCMD_CALLEXT: {
+      SCMD_CASE(SCMD_CALLEXT): {
           // CallScriptFunction to a real 'C' code function
           was_just_callas = -1;
           if (num_args_to_func < 0)
@@ -1121,10 +1121,10 @@ int ccInstance::Run(int32_t curpc)
           num_args_to_func = -1;
           break;
                          }
-      case SCMD_PUSHREAL:
+      SCMD_CASE(SCMD_PUSHREAL):
           PushToFuncCallStack(func_callstack, reg1);
           break;
-      case SCMD_SUBREALSTACK:
+      SCMD_CASE(SCMD_SUBREALSTACK):
           PopFromFuncCallStack(func_callstack, arg1.IValue);
           if (was_just_callas >= 0)
           {
@@ -1133,7 +1133,7 @@ int ccInstance::Run(int32_t curpc)
               was_just_callas = -1;
           }
           break;
-      case SCMD_CALLOBJ:
+      SCMD_CASE(SCMD_CALLOBJ):
           // set the OP register
           if (reg1.IsNull()) {
               cc_error("!Null pointer referenced");
@@ -1168,16 +1168,16 @@ int ccInstance::Run(int32_t curpc)
           }
           next_call_needs_object = 1;
           break;
-      case SCMD_SHIFTLEFT:
+      SCMD_CASE(SCMD_SHIFTLEFT):
           reg1.SetInt32(reg1.IValue << reg2.IValue);
           break;
-      case SCMD_SHIFTRIGHT:
+      SCMD_CASE(SCMD_SHIFTRIGHT):
           reg1.SetInt32(reg1.IValue >> reg2.IValue);
           break;
-      case SCMD_THISBASE:
+      SCMD_CASE(SCMD_THISBASE):
           thisbase[curnest] = arg1.IValue;
           break;
-      case SCMD_NEWARRAY:
+      SCMD_CASE(SCMD_NEWARRAY):
           {
               int numElements = reg1.IValue;
               if ((numElements < 1) || (numElements > 1000000))
@@ -1189,7 +1189,7 @@ int ccInstance::Run(int32_t curpc)
               reg1.SetDynamicObject((void*)ccGetObjectAddressFromHandle(handle), &globalDynamicArray);
               break;
           }
-      case SCMD_NEWUSEROBJECT:
+      SCMD_CASE(SCMD_NEWUSEROBJECT):
           {
               const int32_t size = arg2.IValue;
               if (size < 0)
@@ -1201,41 +1201,41 @@ int ccInstance::Run(int32_t curpc)
               reg1.SetDynamicObject(suo, suo);
               break;
           }
-      case SCMD_FADD:
+      SCMD_CASE(SCMD_FADD):
           reg1.SetFloat(reg1.FValue + arg2.IValue); // arg2 was used as int here originally
           break;
-      case SCMD_FSUB:
+      SCMD_CASE(SCMD_FSUB):
           reg1.SetFloat(reg1.FValue - arg2.IValue); // arg2 was used as int here originally
           break;
-      case SCMD_FMULREG:
+      SCMD_CASE(SCMD_FMULREG):
           reg1.SetFloat(reg1.FValue * reg2.FValue);
           break;
-      case SCMD_FDIVREG:
+      SCMD_CASE(SCMD_FDIVREG):
           if (reg2.FValue == 0.0) {
               cc_error("!Floating point divide by zero");
               return -1;
           } 
           reg1.SetFloat(reg1.FValue / reg2.FValue);
           break;
-      case SCMD_FADDREG:
+      SCMD_CASE(SCMD_FADDREG):
           reg1.SetFloat(reg1.FValue + reg2.FValue);
           break;
-      case SCMD_FSUBREG:
+      SCMD_CASE(SCMD_FSUBREG):
           reg1.SetFloat(reg1.FValue - reg2.FValue);
           break;
-      case SCMD_FGREATER:
+      SCMD_CASE(SCMD_FGREATER):
           reg1.SetFloatAsBool(reg1.FValue > reg2.FValue);
           break;
-      case SCMD_FLESSTHAN:
+      SCMD_CASE(SCMD_FLESSTHAN):
           reg1.SetFloatAsBool(reg1.FValue < reg2.FValue);
           break;
-      case SCMD_FGTE:
+      SCMD_CASE(SCMD_FGTE):
           reg1.SetFloatAsBool(reg1.FValue >= reg2.FValue);
           break;
-      case SCMD_FLTE:
+      SCMD_CASE(SCMD_FLTE):
           reg1.SetFloatAsBool(reg1.FValue <= reg2.FValue);
           break;
-      case SCMD_ZEROMEMORY:
+      SCMD_CASE(SCMD_ZEROMEMORY):
           // Check if we are zeroing at stack tail
           if (registers[SREG_MAR] == registers[SREG_SP]) {
               // creating a local variable -- check the stack to ensure no mem overrun
@@ -1260,7 +1260,7 @@ int ccInstance::Run(int32_t curpc)
             return -1;
           }
           break;
-      case SCMD_CREATESTRING:
+      SCMD_CASE(SCMD_CREATESTRING):
           if (stringClassImpl == NULL) {
               cc_error("No string class implementation set, but opcode was used");
               return -1;
@@ -1270,7 +1270,7 @@ int ccInstance::Run(int32_t curpc)
               (void*)stringClassImpl->CreateString(direct_ptr1),
               &myScriptStringImpl);
           break;
-      case SCMD_STRINGSEQUAL:
+      SCMD_CASE(SCMD_STRINGSEQUAL):
           if ((reg1.IsNull()) || (reg2.IsNull())) {
               cc_error("!Null pointer referenced");
               return -1;
@@ -1280,7 +1280,7 @@ int ccInstance::Run(int32_t curpc)
           reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) == 0);
           
           break;
-      case SCMD_STRINGSNOTEQ:
+      SCMD_CASE(SCMD_STRINGSNOTEQ):
           if ((reg1.IsNull()) || (reg2.IsNull())) {
               cc_error("!Null pointer referenced");
               return -1;
@@ -1289,19 +1289,85 @@ int ccInstance::Run(int32_t curpc)
           direct_ptr2 = (const char*)reg2.GetDirectPtr();
           reg1.SetInt32AsBool(strcmp(direct_ptr1, direct_ptr2) != 0 );
           break;
-      case SCMD_LOOPCHECKOFF:
+      SCMD_CASE(SCMD_LOOPCHECKOFF):
           if (loopIterationCheckDisabled == 0)
               loopIterationCheckDisabled++;
           break;
-      default:
-          cc_error("instruction %d is not implemented", codeOp.Instruction.Code);
+      // Fused operations: these process several consecutive instructions at
+      // once and set the program counter themselves. The pc is advanced to each
+      // following instruction before executing it, in case it reports an error.
+      SCMD_CASE(kScFused_LoadSpOffsMemRead):
+          registers[SREG_MAR] = GetStackPtrOffsetRw(arg1.IValue);
+          if (ccError)
+          {
+              return -1;
+          }
+          pc += op->ArgCount + 1;
+          registers[op[1].Args[0].IValue] = registers[SREG_MAR].ReadValue();
+          pc += op[1].ArgCount + 1;
+          continue;
+      SCMD_CASE(kScFused_LitToRegPush):
+          reg1 = arg2;
+          pc += op->ArgCount + 1;
+          ASSERT_STACK_SPACE_AVAILABLE(1);
+          PushValueToStack(reg1);
+          if (ccError)
+          {
+              return -1;
+          }
+          pc += op[1].ArgCount + 1;
+          continue;
+      SCMD_CASE(kScFused_PushLitPop):
+          // The value goes through the stack with the same checks as
+          // separate instructions do; only the dispatches are saved
+          ASSERT_STACK_SPACE_AVAILABLE(1);
+          PushValueToStack(reg1);
+          if (ccError)
+          {
+              return -1;
+          }
+          pc += op->ArgCount + 1;
+          registers[op[1].Args[0].IValue] = op[1].Args[1];
+          pc += op[1].ArgCount + 1;
+          registers[op[2].Args[0].IValue] = PopValueFromStack();
+          pc += op[2].ArgCount + 1;
+          continue;
+      SCMD_CASE(kScFused_CmpJz):
+      SCMD_CASE(kScFused_CmpMovJz):
+          {
+          bool result;
+          switch (op->Instruction.Code)
+          {
+          case SCMD_ISEQUAL:  result = reg1 == reg2; break;
+          case SCMD_NOTEQUAL: result = reg1 != reg2; break;
+          case SCMD_GREATER:  result = reg1.IValue > reg2.IValue; break;
+          case SCMD_LESSTHAN: result = reg1.IValue < reg2.IValue; break;
+          case SCMD_GTE:      result = reg1.IValue >= reg2.IValue; break;
+          default:            result = reg1.IValue <= reg2.IValue; break;
+          }
+          reg1.SetInt32AsBool(result);
+          const ScriptOperation *jz_op = op + 1;
+          pc += op->ArgCount + 1;
+          if (op->Handler == kScFused_CmpMovJz)
+          {
+              registers[SREG_AX] = reg1;
+              pc += jz_op->ArgCount + 1;
+              jz_op++;
+          }
+          if (!result)
+              pc += jz_op->Args[0].IValue;
+          pc += jz_op->ArgCount + 1;
+          continue;
+          }
+      SCMD_DEFAULT:
+          cc_error("instruction %d is not implemented", op->Instruction.Code);
           return -1;
         }
 
         if (flags & INSTF_ABORTED)
             return 0;
 
-        pc += codeOp.ArgCount + 1;
+        pc += op->ArgCount + 1;
     }
 }
 
@@ -1345,6 +1411,23 @@ RuntimeScriptValue ccInstance::GetSymbolAddress(const char *symname)
     return rval_null;
 }
 
+// Tells how many consecutive instructions the operation's handler executes
+static int GetHandledInstructionCount(const ScriptOperation &op)
+{
+    switch (op.Handler)
+    {
+    case kScFused_LoadSpOffsMemRead:
+    case kScFused_LitToRegPush:
+    case kScFused_CmpJz:
+        return 2;
+    case kScFused_PushLitPop:
+    case kScFused_CmpMovJz:
+        return 3;
+    default:
+        return 1;
+    }
+}
+
 void ccInstance::DumpInstruction(const ScriptOperation &op)
 {
     // line_num local var should be shared between all the instances
@@ -1358,29 +1441,39 @@ void ccInstance::DumpInstruction(const ScriptOperation &op)
 
     Stream *data_s = ci_fopen("script.log", kFile_Create, kFile_Write);
     TextStreamWriter writer(data_s);
-    writer.WriteFormat("Line %3d, IP:%8d (SP:%p) ", line_num, pc, registers[SREG_SP].RValue);
-
-    const ScriptCommandInfo &cmd_info = sccmd_info[op.Instruction.Code];
-    writer.WriteString(cmd_info.CmdName);
 
-    for (int i = 0; i < cmd_info.ArgCount; ++i)
+    // fused operation is written as every instruction it replaces; these
+    // follow it in the code_ops array
+    int32_t at_pc = pc;
+    const int count = GetHandledInstructionCount(op);
+    for (int n = 0; n < count; ++n)
     {
-        if (i > 0)
-        {
-            writer.WriteChar(',');
-        }
-        if (cmd_info.ArgIsReg[i])
-        {
-            writer.WriteFormat(" %s", regnames[op.Args[i].IValue]);
-        }
-        else
+        const ScriptOperation &cur_op = (&op)[n];
+        writer.WriteFormat("Line %3d, IP:%8d (SP:%p) ", line_num, at_pc, registers[SREG_SP].RValue);
+
+        const ScriptCommandInfo &cmd_info = sccmd_info[cur_op.Instruction.Code];
+        writer.WriteString(cmd_info.CmdName);
+
+        for (int i = 0; i < cmd_info.ArgCount; ++i)
         {
-            // MACPORT FIX 9/6/5: changed %d to %ld
-            // FIXME: check type and write appropriate values
-            writer.WriteFormat(" %ld", op.Args[i].GetPtrWithOffset());
+            if (i > 0)
+            {
+                writer.WriteChar(',');
+            }
+            if (cmd_info.ArgIsReg[i])
+            {
+                writer.WriteFormat(" %s", regnames[cur_op.Args[i].IValue]);
+            }
+            else
+            {
+                // MACPORT FIX 9/6/5: changed %d to %ld
+                // FIXME: check type and write appropriate values
+                writer.WriteFormat(" %ld", cur_op.Args[i].GetPtrWithOffset());
+            }
         }
+        writer.WriteLineBreak();
+        at_pc += cur_op.ArgCount + 1;
     }
-    writer.WriteLineBreak();
     // the writer will delete data stream internally
 }
 
@@ -1462,6 +1555,9 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
     {
         resolved_imports = joined->resolved_imports;
         code_fixups = joined->code_fixups;
+        code_ops = joined->code_ops;
+        numcodeops = joined->numcodeops;
+        code_opindex = joined->code_opindex;
     }
     else
     {
@@ -1477,6 +1573,10 @@ bool ccInstance::_Create(PScript scri, ccInstance * joined)
         {
             return false;
         }
+        if (!CreateRuntimeCodeOps(scri))
+        {
+            return false;
+        }
     }
 
     exports = new RuntimeScriptValue[scri->numexports];
@@ -1563,9 +1663,14 @@ void ccInstance::Free()
     {
         delete [] resolved_imports;
         delete [] code_fixups;
+        delete [] code_ops;
+        delete [] code_opindex;
     }
     resolved_imports = NULL;
     code_fixups = NULL;
+    code_ops = NULL;
+    numcodeops = 0;
+    code_opindex = NULL;
 }
 
 bool ccInstance::ResolveScriptImports(PScript scri)
@@ -1757,29 +1862,214 @@ bool ccInstance::CreateRuntimeCodeFixups(PScript scri)
     return true;
 }
 
-/*
-bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
+bool ccInstance::CreateRuntimeCodeOps(PScript scri)
 {
-	op.Instruction.Code			= code[at_pc];
-	op.Instruction.InstanceId	= (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
-	op.Instruction.Code		   &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+    code_opindex = new int32_t[codesize];
+    for (int32_t i = 0; i < codesize; ++i)
+    {
+        code_opindex[i] = -1;
+    }
+    // without any pre-decoded operations every instruction is read by
+    // ReadOperation when it is executed
+    if (ccGetOption(SCOPT_NOPREDECODE))
+        return true;
+
+    // Count the operations first; decoding stops at the first malformed
+    // instruction, and any error is reported only if it gets executed
+    int32_t num_ops = 0;
+    int32_t at_pc = 0;
+    while (at_pc < codesize)
+    {
+        const int32_t cmd = (int32_t)code[at_pc] & INSTANCE_ID_REMOVEMASK;
+        if (cmd < 0 || cmd >= CC_NUM_SCCMDS || at_pc + sccmd_info[cmd].ArgCount >= codesize)
+        {
+            break;
+        }
+        at_pc += sccmd_info[cmd].ArgCount + 1;
+        num_ops++;
+    }
 
-    int want_args = sccmd_info[op.Instruction.Code].ArgCount;
-    if (at_pc + want_args >= codesize)
+    numcodeops = num_ops;
+    code_ops = new ScriptOperation[num_ops];
+    at_pc = 0;
+    for (int32_t op_index = 0; op_index < num_ops; ++op_index)
     {
-        cc_error("unexpected end of code data at %d", at_pc + want_args);
+        ScriptOperation &op = code_ops[op_index];
+        code_opindex[at_pc] = op_index;
+        op.Instruction.Code         = (int32_t)code[at_pc];
+        op.Instruction.InstanceId   = (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+        op.Instruction.Code        &= INSTANCE_ID_REMOVEMASK;
+        op.Handler                  = op.Instruction.Code;
+        op.ArgCount = sccmd_info[op.Instruction.Code].ArgCount;
+
+        at_pc++;
+        for (int i = 0; i < op.ArgCount; ++i, ++at_pc)
+        {
+            const char fixup = code_fixups[at_pc];
+            switch (fixup)
+            {
+            case 0:
+                // should be a numeric literal (int32 or float)
+                op.Args[i].SetInt32((int32_t)code[at_pc]);
+                break;
+            case FIXUP_GLOBALDATA:
+            case FIXUP_FUNCTION:
+            case FIXUP_STRING:
+                if (!FixupArgument(this, code[at_pc], fixup, op.Args[i]))
+                {
+                    return false;
+                }
+                break;
+            default:
+                // imports and stack offsets are resolved when executed
+                op.LateFixups |= (1 << i);
+                break;
+            }
+        }
+    }
+
+    if (ccGetOption(SCOPT_OPSTATS))
+        LogCodeOpStats(scri);
+    if (ccGetOption(SCOPT_FUSEOPS))
+        FuseCodeOps();
+    return true;
+}
+
+// Tells if the operation's argument is a valid register index
+static inline bool IsRegArg(const ScriptOperation &op, int arg)
+{
+    return op.Args[arg].Type == kScValInteger &&
+        op.Args[arg].IValue >= 0 && op.Args[arg].IValue < CC_NUM_REGISTERS;
+}
+
+static inline bool IsIntComparison(int32_t code)
+{
+    return code == SCMD_ISEQUAL || code == SCMD_NOTEQUAL || code == SCMD_GREATER ||
+        code == SCMD_LESSTHAN || code == SCMD_GTE || code == SCMD_LTE;
+}
+
+void ccInstance::FuseCodeOps()
+{
+    // NOTE: fused operations read arguments of the following ones directly
+    // from the code_ops array; instructions in the middle of the sequence are
+    // kept intact, so that the jumps into them are still valid.
+    // Sequences which require runtime fixups are never fused.
+    for (int32_t i = 0; i < numcodeops; ++i)
+    {
+        ScriptOperation &op = code_ops[i];
+        const ScriptOperation *op2 = i + 1 < numcodeops ? &code_ops[i + 1] : NULL;
+        const ScriptOperation *op3 = i + 2 < numcodeops ? &code_ops[i + 2] : NULL;
+        if (op.LateFixups || !op2 || op2->LateFixups)
+            continue;
+        const int32_t code2 = op2->Instruction.Code;
+        const int32_t code3 = (op3 && !op3->LateFixups) ? op3->Instruction.Code : 0;
+
+        switch (op.Instruction.Code)
+        {
+        case SCMD_LOADSPOFFS:
+            if (code2 == SCMD_MEMREAD && IsRegArg(*op2, 0))
+                op.Handler = kScFused_LoadSpOffsMemRead;
+            break;
+        case SCMD_LITTOREG:
+            // push followed by pop is optimized separately on execution
+            if (code2 == SCMD_PUSHREG && code3 != SCMD_POPREG &&
+                IsRegArg(op, 0) && op.Args[0].IValue != SREG_SP && op2->Args[0].IValue == op.Args[0].IValue)
+                op.Handler = kScFused_LitToRegPush;
+            break;
+        case SCMD_PUSHREG:
+            if (code2 == SCMD_LITTOREG && code3 == SCMD_POPREG &&
+                IsRegArg(op, 0) && IsRegArg(*op2, 0) && IsRegArg(*op3, 0) &&
+                op.Args[0].IValue != SREG_SP && op2->Args[0].IValue != SREG_SP && op3->Args[0].IValue != SREG_SP)
+                op.Handler = kScFused_PushLitPop;
+            break;
+        default:
+            if (!IsIntComparison(op.Instruction.Code) || !IsRegArg(op, 0) || !IsRegArg(op, 1))
+                break;
+            if (code2 == SCMD_JZ && op.Args[0].IValue == SREG_AX)
+                op.Handler = kScFused_CmpJz;
+            else if (code2 == SCMD_REGTOREG && code3 == SCMD_JZ &&
+                op2->Args[0].IValue == op.Args[0].IValue && op2->Args[1].IValue == SREG_AX)
+                op.Handler = kScFused_CmpMovJz;
+            break;
+        }
+    }
+}
+
+// Sorts gathered sequence counters in descending order
+static bool CompareOpStats(const std::pair<uint32_t, int> &a, const std::pair<uint32_t, int> &b)
+{
+    return a.second > b.second;
+}
+
+void ccInstance::LogCodeOpStats(PScript scri)
+{
+    const int max_entries = 20;
+    typedef std::map<uint32_t, int> OpSeqCounts;
+    OpSeqCounts seq_counts[2];
+    for (int32_t i = 0; i + 1 < numcodeops; ++i)
+    {
+        uint32_t key = code_ops[i].Instruction.Code * CC_NUM_SCCMDS + code_ops[i + 1].Instruction.Code;
+        seq_counts[0][key]++;
+        if (i + 2 < numcodeops)
+            seq_counts[1][key * CC_NUM_SCCMDS + code_ops[i + 2].Instruction.Code]++;
+    }
+
+    Debug::Printf(kDbgMsg_Init, "Script '%s': %d instructions in %d code elements",
+        codesize > 0 ? scri->GetSectionName(codesize - 1) : "", numcodeops, codesize);
+    for (int n = 0; n < 2; ++n)
+    {
+        std::vector< std::pair<uint32_t, int> > sorted(seq_counts[n].begin(), seq_counts[n].end());
+        std::sort(sorted.begin(), sorted.end(), CompareOpStats);
+        Debug::Printf(kDbgMsg_Init, "Most frequent instruction %s:", n == 0 ? "pairs" : "triples");
+        for (size_t i = 0; i < sorted.size() && i < (size_t)max_entries; ++i)
+        {
+            int32_t codes[3];
+            uint32_t key = sorted[i].first;
+            for (int k = n + 1; k >= 0; --k, key /= CC_NUM_SCCMDS)
+                codes[k] = key % CC_NUM_SCCMDS;
+            String seq;
+            for (int k = 0; k < n + 2; ++k)
+                seq.Append(String::FromFormat(k == 0 ? "%s(%d)" : " + %s(%d)", sccmd_info[codes[k]].CmdName, codes[k]));
+            Debug::Printf(kDbgMsg_Init, "  %6d  %s", sorted[i].second, seq.GetCStr());
+        }
+    }
+}
+
+bool ccInstance::ReadOperation(ScriptOperation &op, const ccInstance *code_inst, int32_t at_pc)
+{
+    if (at_pc < 0 || at_pc >= code_inst->codesize)
+    {
+        cc_error("unexpected end of code data (%d; %d)", at_pc, code_inst->codesize);
+        return false;
+    }
+
+    op.Instruction.Code         = (int32_t)code_inst->code[at_pc];
+    op.Instruction.InstanceId   = (op.Instruction.Code >> INSTANCE_ID_SHIFT) & INSTANCE_ID_MASK;
+    op.Instruction.Code        &= INSTANCE_ID_REMOVEMASK; // now this is pure instruction code
+    op.Handler                  = op.Instruction.Code;
+    op.LateFixups               = 0;
+
+    if (op.Instruction.Code < 0 || op.Instruction.Code >= CC_NUM_SCCMDS)
+    {
+        cc_error("invalid instruction %d found in code stream", op.Instruction.Code);
+        return false;
+    }
+
+    op.ArgCount = sccmd_info[op.Instruction.Code].ArgCount;
+    if (at_pc + op.ArgCount >= code_inst->codesize)
+    {
+        cc_error("unexpected end of code data (%d; %d)", at_pc + op.ArgCount, code_inst->codesize);
         return false;
     }
-    op.ArgCount = want_args;
 
     at_pc++;
     for (int i = 0; i < op.ArgCount; ++i, ++at_pc)
     {
-        char fixup = code_fixups[at_pc];
+        char fixup = code_inst->code_fixups[at_pc];
         if (fixup > 0)
         {
             // could be relative pointer or import address
-            if (!FixupArgument(code[at_pc], fixup, op.Args[i]))
+            if (!FixupArgument(code_inst, code_inst->code[at_pc], fixup, op.Args[i]))
             {
                 return false;
             }
@@ -1787,15 +2077,14 @@ bool ccInstance::ReadOperation(ScriptOperation &op, int32_t at_pc)
         else
         {
             // should be a numeric literal (int32 or float)
-            op.Args[i].SetInt32( (int32_t)code[at_pc] );
+            op.Args[i].SetInt32( (int32_t)code_inst->code[at_pc] );
         }
     }
 
     return true;
 }
-*/
-/*
-bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScriptValue &argument)
+
+bool ccInstance::FixupArgument(const ccInstance *code_inst, intptr_t code_value, char fixup_type, RuntimeScriptValue &argument)
 {
     switch (fixup_type)
     {
@@ -1812,7 +2101,7 @@ bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScri
         argument.SetInt32((int32_t)code_value);
         break;
     case FIXUP_STRING:
-        argument.SetStringLiteral(&strings[0] + code_value);
+        argument.SetStringLiteral(&code_inst->strings[0] + code_value);
         break;
     case FIXUP_IMPORT:
         {
@@ -1833,11 +2122,11 @@ bool ccInstance::FixupArgument(intptr_t code_value, char fixup_type, RuntimeScri
         break;
     default:
         cc_error("internal fixup type error: %d", fixup_type);
-        return false;;
+        return false;
     }
     return true;
 }
-*/
+
 //-----------------------------------------------------------------------------
 
 void ccInstance::PushValueToStack(const RuntimeScriptValue &rval)
@@ -64,12 +64,20 @@ struct ScriptOperation
 {
 	ScriptOperation()
 	{
+		Handler = 0;
 		ArgCount = 0;
+		LateFixups = 0;
 	}
 
 	ScriptInstruction   Instruction;
+	// Code of the handler to execute; it differs from the instruction code
+	// only if this operation begins a fused sequence of instructions
+	int32_t             Handler;
 	RuntimeScriptValue	Args[MAX_SCMD_ARGS];
 	int				    ArgCount;
+	// Bit mask of arguments which depend on the runtime state
+	// (imports and stack offsets) and must be fixed up on execution
+	int                 LateFixups;
 };
 
 struct ScriptVariable
@@ -146,6 +154,12 @@ public:
     int  numimports;
 
     char *code_fixups;
+    // pre-decoded operations, prepared once when the code is linked
+    ScriptOperation *code_ops;
+    int32_t numcodeops;
+    // index of the operation in code_ops for every code array element,
+    // or -1 if it is not a beginning of the decoded operation
+    int32_t *code_opindex;
 
     // returns the currently executing instance, or NULL if none
     static ccInstance *GetCurrentInstance(void);
@@ -188,10 +202,19 @@ protected:
     bool    AddGlobalVar(const ScriptVariable &glvar);
     ScriptVariable *FindGlobalVar(int32_t var_addr);
     bool    CreateRuntimeCodeFixups(PScript scri);
-	//bool    ReadOperation(ScriptOperation &op, int32_t at_pc);
+    // Decodes whole code array into the sequence of operations, applying
+    // all the fixups which do not depend on runtime state
+    bool    CreateRuntimeCodeOps(PScript scri);
+    // Replaces handlers of the common instruction sequences with the fused ones
+    void    FuseCodeOps();
+    // Prints statistics of the instruction pairs and triples to the log
+    void    LogCodeOpStats(PScript scri);
+    // Reads and fixes up single operation from the code of the given instance;
+    // this is a slow path used when there's no valid pre-decoded operation
+    bool    ReadOperation(ScriptOperation &op, const ccInstance *code_inst, int32_t at_pc);
 
     // Runtime fixups
-    //bool    FixupArgument(intptr_t code_value, char fixup_type, RuntimeScriptValue &argument);
+    bool    FixupArgument(const ccInstance *code_inst, intptr_t code_value, char fixup_type, RuntimeScriptValue &argument);
 
     // Stack processing
     // Push writes new value and increments stack ptr;
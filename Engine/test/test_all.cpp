@@ -20,14 +20,36 @@ void Test_DoAllTests()
 {
     Test_Math();
     Test_Memory();
+    Test_ManagedObjectPool();
+    Test_ThreadPool();
+    Test_RouteFinder();
+    Test_RouteFinderBatch();
+    Test_ScriptFuseOps();
+    Test_TranslationTable();
     Test_Path();
     Test_ScriptSprintf();
     Test_String();
     Test_Version();
     Test_File();
+    Test_MappedFileStream();
+    Test_MemoryStream();
     Test_IniFile();
+    Test_Compress();
 
     Test_Gfx();
+    Test_DirtyRegions();
+    Test_TransformedSpriteCache();
+    Test_Blender();
+}
+
+void Test_DoAllPerfTests()
+{
+    Test_ManagedObjectPoolPerf();
+    Test_RouteFinderPerf();
+    Test_CompressPerf();
+    Test_SpriteLoadPerf();
+    Test_BlenderPerf();
+    Test_ScriptDispatchPerf();
 }
 
 #endif // _DEBUG
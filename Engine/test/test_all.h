@@ -15,15 +15,51 @@
 #ifdef _DEBUG
 
 void Test_DoAllTests();
+// Runs performance tests, which print timings to stdout; these take much
+// longer than the rest, and are run only with --run-perf-tests
+void Test_DoAllPerfTests();
 // Math tests
 void Test_Math();
 // File tests
 void Test_File();
+void Test_MappedFileStream();
+void Test_MemoryStream();
 void Test_IniFile();
+// Compression
+void Test_Compress();
+// Decompression throughput of LZW, RLE and LZ4 on image-like data
+void Test_CompressPerf();
 // Graphics tests
 void Test_Gfx();
+void Test_DirtyRegions();
+void Test_TransformedSpriteCache();
+void Test_Blender();
+// Blending performance, per pixel blender callback compared to scanline
+// blenders
+void Test_BlenderPerf();
 // Memory / bit-byte operations
 void Test_Memory();
+// Managed object pool
+void Test_ManagedObjectPool();
+// Managed object pool performance, scaling from 1k to 1M objects
+void Test_ManagedObjectPoolPerf();
+// Route finder
+void Test_RouteFinder();
+void Test_RouteFinderBatch();
+// Route finder latency percentiles, with and without remembered routes
+void Test_RouteFinderPerf();
+// Sprite loading performance, reading uncompressed sprites from file stream
+// and from mapped file
+void Test_SpriteLoadPerf();
+// Script interpreter
+void Test_ScriptFuseOps();
+// Script interpreter speed on a simple loop, with and without fused
+// operations
+void Test_ScriptDispatchPerf();
+// Worker thread pool
+void Test_ThreadPool();
+// Translation lookup
+void Test_TranslationTable();
 // String tests
 void Test_ScriptSprintf();
 void Test_String();
@@ -0,0 +1,138 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "gfx/blender.h"
+#include "util/wgt2allg.h"
+#include "debug/assert.h"
+
+extern "C" {
+    unsigned long _blender_trans24(unsigned long x, unsigned long y, unsigned long n);
+    unsigned long _blender_alpha32(unsigned long x, unsigned long y, unsigned long n);
+}
+
+// Blenders which have scanline implementation
+static const PfnBlender32 TransBlenders[] = {
+    _blender_trans24, _myblender_alpha_trans24, _blender_alpha32, _argb2rgb_blender,
+    _trans_alpha_blender32, _additive_alpha_copysrc_blender, _opaque_alpha_blender,
+    _argb2argb_blender, _rgb2argb_blender };
+static const PfnBlender32 LitBlenders[] = { _blender_trans24, _myblender_alpha_trans24 };
+static const unsigned long BlendParams[] = { 0, 1, 100, 128, 254, 255 };
+
+// Random pixels, with fully transparent, opaque and masked ones among them
+static void FillPixels(std::vector<uint32_t> &pixels, uint32_t &seed)
+{
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32_t px = seed ^ (seed >> 16) * 0x9E3779B1;
+        switch (seed % 7)
+        {
+        case 0: px = MASK_COLOR_32; break;
+        case 1: px &= 0x00FFFFFF; break;
+        case 2: px |= 0xFF000000; break;
+        }
+        pixels[i] = px;
+    }
+}
+
+static void TestScanlineBlender(PfnBlender32 blender, PfnScanlineBlender scanline_blender, bool lit, uint32_t &seed)
+{
+    const int max_len = 37;
+    std::vector<uint32_t> src(max_len), dst(max_len), expect(max_len);
+    for (int len = 0; len <= max_len; ++len)
+    {
+        for (size_t p = 0; p < sizeof(BlendParams) / sizeof(BlendParams[0]); ++p)
+        {
+            const unsigned long n = BlendParams[p];
+            FillPixels(src, seed);
+            FillPixels(dst, seed);
+            const uint32_t color = seed & 0xFFFFFF;
+            // same as Allegro's sprite drawing does for every pixel
+            for (int i = 0; i < max_len; ++i)
+            {
+                expect[i] = dst[i];
+                if (i < len && src[i] != MASK_COLOR_32)
+                    expect[i] = lit ? blender(color, src[i], n) : blender(src[i], dst[i], n);
+            }
+            scanline_blender(&dst.front(), &src.front(), len, color, n);
+            assert(memcmp(&dst.front(), &expect.front(), max_len * sizeof(uint32_t)) == 0);
+        }
+    }
+}
+
+void Test_Blender()
+{
+    uint32_t seed = 1;
+    for (size_t i = 0; i < sizeof(TransBlenders) / sizeof(TransBlenders[0]); ++i)
+    {
+        PfnScanlineBlender scanline_blender = GetScanlineTransBlender(TransBlenders[i]);
+        assert(scanline_blender != NULL);
+        TestScanlineBlender(TransBlenders[i], scanline_blender, false, seed);
+    }
+    for (size_t i = 0; i < sizeof(LitBlenders) / sizeof(LitBlenders[0]); ++i)
+    {
+        PfnScanlineBlender scanline_blender = GetScanlineLitBlender(LitBlenders[i]);
+        assert(scanline_blender != NULL);
+        TestScanlineBlender(LitBlenders[i], scanline_blender, true, seed);
+    }
+    // blenders without scanline implementation are left to Allegro
+    assert(GetScanlineTransBlender(_myblender_color32) == NULL);
+    assert(GetScanlineLitBlender(_blender_alpha32) == NULL);
+}
+
+void Test_BlenderPerf()
+{
+    const int width = 640, height = 400, frames = 100;
+    const char *names[] = { "trans", "alpha" };
+    const PfnBlender32 blenders[] = { _blender_trans24, _blender_alpha32 };
+    uint32_t seed = 1;
+    std::vector<uint32_t> src(width * height), dst(width * height);
+    FillPixels(src, seed);
+    FillPixels(dst, seed);
+
+    for (int b = 0; b < 2; ++b)
+    {
+        // blender called through pointer for each pixel, like Allegro does
+        PfnBlender32 volatile blender = blenders[b];
+        clock_t start = clock();
+        for (int f = 0; f < frames; ++f)
+        {
+            for (size_t i = 0; i < src.size(); ++i)
+            {
+                if (src[i] != MASK_COLOR_32)
+                    dst[i] = blender(src[i], dst[i], 128);
+            }
+        }
+        const long pixel_ms = (long)((clock() - start) * 1000 / CLOCKS_PER_SEC);
+
+        PfnScanlineBlender scanline_blender = GetScanlineTransBlender(blenders[b]);
+        start = clock();
+        for (int f = 0; f < frames; ++f)
+        {
+            for (int y = 0; y < height; ++y)
+                scanline_blender(&dst[y * width], &src[y * width], width, 0, 128);
+        }
+        const long scanline_ms = (long)((clock() - start) * 1000 / CLOCKS_PER_SEC);
+        printf("Blender: %s, %d frames %dx%d, per pixel %ld ms, scanline %ld ms\n",
+            names[b], frames, width, height, pixel_ms, scanline_ms);
+    }
+}
+
+#endif // _DEBUG
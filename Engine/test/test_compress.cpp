@@ -0,0 +1,224 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "core/types.h"
+#include "debug/assert.h"
+#include "util/compress.h"
+#include "util/delta.h"
+#include "util/file.h"
+#include "util/lz4.h"
+#include "util/lzw.h"
+#include "util/stream.h"
+
+using namespace AGS::Common;
+
+// Makes image-like data: flat areas, gradients and noise
+static std::vector<uint8_t> MakeTestData(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    unsigned int seed = 1;
+    for (size_t i = 0; i < size; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        switch ((i / 1000) % 3)
+        {
+        case 0: data[i] = 7; break;
+        case 1: data[i] = (uint8_t)(i / 8); break;
+        default: data[i] = (uint8_t)(seed >> 16); break;
+        }
+    }
+    return data;
+}
+
+static std::vector<uint8_t> ReadTempFile(const char *filename)
+{
+    Stream *in = File::OpenFileRead(filename);
+    std::vector<uint8_t> data((size_t)in->GetLength());
+    in->Read(&data[0], data.size());
+    delete in;
+    remove(filename);
+    return data;
+}
+
+static std::vector<uint8_t> CompressTestData(const std::vector<uint8_t> &data)
+{
+    Stream *out = File::OpenFile("lzwtest.tmp", kFile_CreateAlways, kFile_Write);
+    out->Write(&data[0], data.size());
+    delete out;
+    Stream *in = File::OpenFileRead("lzwtest.tmp");
+    out = File::OpenFile("lzwtest2.tmp", kFile_CreateAlways, kFile_Write);
+    lzwcompress(in, out);
+    delete in;
+    delete out;
+    remove("lzwtest.tmp");
+    return ReadTempFile("lzwtest2.tmp");
+}
+
+// Packs data with RLE, as lines of the given width
+static std::vector<uint8_t> PackTestLines(const std::vector<uint8_t> &data, int width)
+{
+    Stream *out = File::OpenFile("rletest.tmp", kFile_CreateAlways, kFile_Write);
+    for (size_t i = 0; i + width <= data.size(); i += width)
+        cpackbitl((unsigned char*)&data[i], width, out);
+    delete out;
+    return ReadTempFile("rletest.tmp");
+}
+
+static std::vector<uint8_t> PackTestLz4(const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> packed(lz4bound(data.size()));
+    packed.resize(lz4compress(data.data(), data.size(), &packed[0], packed.size()));
+    return packed;
+}
+
+void Test_Compress()
+{
+    const std::vector<uint8_t> data = MakeTestData(100000);
+    const std::vector<uint8_t> packed = CompressTestData(data);
+    assert(packed.size() < data.size());
+
+    // data is restored exactly
+    std::vector<uint8_t> unpacked(data.size());
+    assert(lzwexpand(&packed[0], packed.size(), &unpacked[0], unpacked.size()));
+    assert(unpacked == data);
+    // only as much as requested is decompressed
+    std::vector<uint8_t> part(data.size() / 2 + 1, 0xFF);
+    assert(lzwexpand(&packed[0], packed.size(), &part[0], part.size() - 1));
+    assert(std::equal(part.begin(), part.end() - 1, data.begin()));
+    assert(part.back() == 0xFF);
+    // truncated data is detected
+    assert(!lzwexpand(&packed[0], packed.size() / 2, &unpacked[0], unpacked.size()));
+
+    // RLE lines decoded from memory are same as the ones decoded from stream
+    const int width = 500;
+    const std::vector<uint8_t> rle = PackTestLines(data, width);
+    std::fill(unpacked.begin(), unpacked.end(), 0);
+    size_t pos = 0;
+    for (size_t i = 0; i < data.size(); i += width)
+    {
+        // too short buffer is reported, without reading past it
+        assert(cunpackbitl(&unpacked[i], width, &rle[pos], 1) == 0);
+        const int used = cunpackbitl(&unpacked[i], width, &rle[pos], rle.size() - pos);
+        assert(used > 0);
+        pos += used;
+    }
+    assert(pos == rle.size());
+    assert(unpacked == data);
+    // line overflow is reported
+    const uint8_t overflow[] = { 0x80 + 1, 5 }; // run of 128
+    assert(cunpackbitl(&unpacked[0], 100, overflow, sizeof(overflow)) == -1);
+
+    // LZ4 data is restored exactly, for any size
+    for (size_t size = 0; size < 300; size += 7)
+    {
+        const std::vector<uint8_t> small(data.begin(), data.begin() + size);
+        const std::vector<uint8_t> small_packed = PackTestLz4(small);
+        std::vector<uint8_t> small_unpacked(size + 1);
+        assert(lz4expand(&small_packed[0], small_packed.size(), small_unpacked.data(), size));
+        assert(std::equal(small.begin(), small.end(), small_unpacked.begin()));
+    }
+    const std::vector<uint8_t> lz4 = PackTestLz4(data);
+    assert(lz4.size() < data.size());
+    std::fill(unpacked.begin(), unpacked.end(), 0);
+    assert(lz4expand(&lz4[0], lz4.size(), &unpacked[0], unpacked.size()));
+    assert(unpacked == data);
+    // truncated data or wrong output size is detected
+    assert(!lz4expand(&lz4[0], lz4.size() / 2, &unpacked[0], unpacked.size()));
+    assert(!lz4expand(&lz4[0], lz4.size(), &unpacked[0], unpacked.size() - 1));
+    // too small output buffer is detected
+    std::vector<uint8_t> small_buf(lz4.size() / 2);
+    assert(lz4compress(&data[0], data.size(), &small_buf[0], small_buf.size()) == 0);
+
+    // data changed in several places is restored from the small delta
+    std::vector<uint8_t> changed = data;
+    changed[500] ^= 1;
+    changed.insert(changed.begin() + 30000, 100, 1);
+    changed.erase(changed.begin() + 60000, changed.begin() + 60100);
+    changed.insert(changed.end(), 50, 2);
+    std::vector<uint8_t> delta;
+    deltacompress(&data[0], data.size(), &changed[0], changed.size(), delta);
+    assert(delta.size() < data.size() / 10);
+    std::vector<uint8_t> restored;
+    assert(deltaexpand(&data[0], data.size(), &delta[0], delta.size(), restored));
+    assert(restored == changed);
+    // same data, or data without any base
+    deltacompress(&data[0], data.size(), &data[0], data.size(), delta);
+    assert(delta.size() < 16);
+    assert(deltaexpand(&data[0], data.size(), &delta[0], delta.size(), restored));
+    assert(restored == data);
+    deltacompress(NULL, 0, &data[0], data.size(), delta);
+    assert(deltaexpand(NULL, 0, &delta[0], delta.size(), restored));
+    assert(restored == data);
+    // truncated delta, or delta made for the other base is detected
+    deltacompress(&data[0], data.size(), &changed[0], changed.size(), delta);
+    assert(!deltaexpand(&data[0], data.size(), &delta[0], delta.size() - 1, restored));
+    assert(!deltaexpand(&data[0], data.size() / 2, &delta[0], delta.size(), restored));
+}
+
+typedef bool (*TestDecoder)(const std::vector<uint8_t> &packed, std::vector<uint8_t> &unpacked, int width);
+
+static bool DecodeTestLzw(const std::vector<uint8_t> &packed, std::vector<uint8_t> &unpacked, int)
+{
+    return lzwexpand(&packed[0], packed.size(), &unpacked[0], unpacked.size());
+}
+
+static bool DecodeTestLines(const std::vector<uint8_t> &packed, std::vector<uint8_t> &unpacked, int width)
+{
+    size_t pos = 0;
+    for (size_t i = 0; i + width <= unpacked.size(); i += width)
+    {
+        const int used = cunpackbitl(&unpacked[i], width, &packed[pos], packed.size() - pos);
+        if (used <= 0)
+            return false;
+        pos += used;
+    }
+    return true;
+}
+
+static bool DecodeTestLz4(const std::vector<uint8_t> &packed, std::vector<uint8_t> &unpacked, int)
+{
+    return lz4expand(&packed[0], packed.size(), &unpacked[0], unpacked.size());
+}
+
+static void PrintDecodeSpeed(const char *what, TestDecoder decode,
+    const std::vector<uint8_t> &packed, const std::vector<uint8_t> &data, int width)
+{
+    std::vector<uint8_t> unpacked(data.size());
+    const int passes = 20;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < passes; ++i)
+        assert(decode(packed, unpacked, width));
+    const double secs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    assert(unpacked == data);
+    printf("Compress: %s: ratio %.2f, decoding %.1f MB/s\n", what,
+        (double)data.size() / packed.size(), (double)data.size() * passes / (1024 * 1024) / secs);
+}
+
+void Test_CompressPerf()
+{
+    // 640x400 background, 32-bit
+    const int width = 640 * 4;
+    const std::vector<uint8_t> data = MakeTestData(width * 400);
+    PrintDecodeSpeed("LZW", DecodeTestLzw, CompressTestData(data), data, width);
+    PrintDecodeSpeed("RLE", DecodeTestLines, PackTestLines(data, width), data, width);
+    PrintDecodeSpeed("LZ4", DecodeTestLz4, PackTestLz4(data), data, width);
+}
+
+#endif // _DEBUG
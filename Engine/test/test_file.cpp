@@ -18,6 +18,8 @@
 #include "debug/assert.h"
 #include "util/alignedstream.h"
 #include "util/file.h"
+#include "util/mappedfilestream.h"
+#include "util/memorystream.h"
 
 using namespace AGS::Common;
 
@@ -204,4 +206,100 @@ void Test_File()
     assert(!File::TestReadFile("test.tmp"));
 }
 
+void Test_MappedFileStream()
+{
+    Stream *out = File::OpenFile("test.tmp", AGS::Common::kFile_CreateAlways, AGS::Common::kFile_Write);
+    out->WriteInt16(10);
+    out->WriteInt32(-20202);
+    for (int i = 0; i < 100; ++i)
+        out->WriteByte(i);
+    delete out;
+
+    MappedFileStream *in = new MappedFileStream("test.tmp");
+    // memory mapping is not supported on every platform
+    if (!in->IsValid())
+    {
+        delete in;
+        File::DeleteFile("test.tmp");
+        return;
+    }
+
+    assert(in->GetLength() == 106);
+    assert(in->ReadInt16() == 10);
+    assert(in->ReadInt32() == -20202);
+    assert(in->GetPosition() == 6);
+    assert(in->ReadByte() == 0);
+    uint8_t buf[10];
+    assert(in->Read(buf, 10) == 10);
+    assert(buf[0] == 1 && buf[9] == 10);
+    assert(in->Seek(-2, AGS::Common::kSeekEnd) == 104);
+    assert(in->Read(buf, 10) == 2);
+    assert(buf[0] == 98 && buf[1] == 99);
+    assert(in->EOS());
+    assert(in->ReadByte() == -1);
+    assert(in->Write(buf, 1) == 0);
+
+    // direct access
+    const uint8_t *data = in->GetData(6, 100);
+    assert(data != NULL);
+    assert(data[0] == 0 && data[99] == 99);
+    assert(in->GetData(6, 101) == NULL);
+    assert(in->GetData(107, 0) == NULL);
+    assert(in->HasAddress(data) && in->HasAddress(data + 99));
+    assert(!in->HasAddress(data + 100));
+    in->Seek(6, AGS::Common::kSeekBegin);
+    assert(in->ReadByte() == data[0]);
+    delete in;
+
+    Stream *check = File::OpenFile("test.tmp", AGS::Common::kFile_Open, AGS::Common::kFile_Read);
+    check->Seek(6, AGS::Common::kSeekBegin);
+    assert(check->ReadByte() == 0);
+    delete check;
+
+    File::DeleteFile("test.tmp");
+}
+
+void Test_MemoryStream()
+{
+    MemoryStream out;
+    out.WriteInt16(10);
+    out.WriteInt64(0); // placeholder
+    for (int i = 0; i < 100; ++i)
+        out.WriteByte(i);
+    assert(out.GetLength() == 110);
+    // patching the written data does not change the length
+    assert(out.Seek(2, AGS::Common::kSeekBegin) == 2);
+    out.WriteInt64(-20202);
+    assert(out.GetPosition() == 10);
+    assert(out.GetLength() == 110);
+    out.Seek(0, AGS::Common::kSeekEnd);
+    out.WriteInt32(7);
+    assert(out.GetLength() == 114);
+
+    MemoryStream in(out.GetBuffer());
+    assert(in.ReadInt16() == 10);
+    assert(in.ReadInt64() == -20202);
+    assert(in.ReadByte() == 0);
+    uint8_t buf[10];
+    assert(in.Read(buf, 10) == 10);
+    assert(buf[0] == 1 && buf[9] == 10);
+    assert(in.Seek(-4, AGS::Common::kSeekEnd) == 110);
+    assert(in.ReadInt32() == 7);
+    assert(in.EOS());
+    assert(in.Read(buf, 10) == 0);
+    assert(in.ReadByte() == -1);
+
+    // file replacement
+    Stream *file = File::CreateFile("test.tmp");
+    file->Write(&out.GetBuffer()[0], out.GetBuffer().size());
+    delete file;
+    file = File::CreateFile("test2.tmp");
+    file->WriteInt32(1);
+    delete file;
+    assert(File::ReplaceFile("test.tmp", "test2.tmp"));
+    assert(!File::TestReadFile("test.tmp"));
+    assert(File::GetFileSize("test2.tmp") == 114);
+    File::DeleteFile("test2.tmp");
+}
+
 #endif // _DEBUG
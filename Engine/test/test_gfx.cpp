@@ -14,9 +14,16 @@
 
 #ifdef _DEBUG
 
+#include <vector>
+#include "ac/draw.h"
+#include "ac/draw_software.h"
+#include "ac/spritecache.h"
+#include "ac/transformedspritecache.h"
+#include "gfx/bitmap.h"
 #include "gfx/gfx_def.h"
 #include "debug/assert.h"
 
+using namespace AGS::Common;
 namespace GfxDef = AGS::Common::GfxDef;
 
 void Test_Gfx()
@@ -36,4 +43,102 @@ void Test_Gfx()
     }
 }
 
+static bool RectEquals(const Rect &r, int x1, int y1, int x2, int y2)
+{
+    return r.Left == x1 && r.Top == y1 && r.Right == x2 && r.Bottom == y2;
+}
+
+void Test_DirtyRegions()
+{
+    // uncommon size, so that the engine will reinitialize dirty rects later
+    const int width = 321, height = 201;
+    Bitmap *screen = BitmapHelper::CreateBitmap(width, height, 32);
+    Bitmap *background = BitmapHelper::CreateBitmap(width, height, 32);
+    std::vector<Rect> regions;
+
+    // whole screen is repainted after initialization
+    init_invalid_regions(-1, Size(width, height), RectWH(0, 0, width, height));
+    init_invalid_regions(0, Size(width, height), RectWH(0, 0, width, height));
+    update_black_invreg_and_reset(screen);
+    update_room_invreg_and_reset(0, screen, background, false);
+    assert(get_changed_screen_regions(regions));
+    assert(regions.size() == 2);
+    assert(RectEquals(regions[0], 0, 0, width - 1, height - 1));
+    assert(RectEquals(regions[1], 0, 0, width - 1, height - 1));
+    assert(get_changed_screen_regions(regions));
+    assert(regions.empty());
+
+    // both repainted regions and ones marked dirty after repainting are reported
+    invalidate_rect_ds(10, 10, 19, 19, true);
+    update_room_invreg_and_reset(0, screen, background, false);
+    invalidate_rect_ds(100, 50, 109, 59, false);
+    assert(get_changed_screen_regions(regions));
+    assert(regions.size() == 2);
+    assert(RectEquals(regions[0], 9, 9, 20, 20));
+    assert(RectEquals(regions[1], 99, 49, 110, 60));
+
+    // too many regions in between presentations mean the whole screen
+    update_room_invreg_and_reset(0, screen, background, false);
+    for (int pass = 0; pass < 40; ++pass)
+    {
+        for (int i = 0; i < 10; ++i)
+            invalidate_rect_ds(i * 20, i * 20, i * 20 + 9, i * 20 + 9, true);
+        update_room_invreg_and_reset(0, screen, background, false);
+    }
+    assert(!get_changed_screen_regions(regions));
+    assert(get_changed_screen_regions(regions));
+    assert(regions.empty());
+
+    destroy_invalid_regions();
+    delete screen;
+    delete background;
+}
+
+void Test_TransformedSpriteCache()
+{
+    // limit the cache to two 100x100 32-bit images
+    const size_t old_limit = spriteset.GetMaxCacheSize();
+    spriteset.SetMaxCacheSize(100 * 100 * 4 * 2 * 100 / TRANSFORMCACHEPERCENT);
+    TransformedSpriteCache cache;
+    Bitmap *image = BitmapHelper::CreateBitmap(100, 100, 32);
+    image->Clear(1);
+
+    TransformedSpriteKey key1, key2, key3;
+    key1.Sprite = 1;
+    key1.Width = 100;
+    key1.Height = 100;
+    key2 = key1;
+    key2.Sprite = 2;
+    key3 = key1;
+    key3.Mirrored = true;
+
+    // the cache keeps a copy of the image
+    assert(cache.Get(key1) == NULL);
+    cache.Put(key1, image);
+    image->Clear(2);
+    cache.Put(key2, image);
+    Bitmap *cached = cache.Get(key1);
+    assert(cached != NULL && cached != image);
+    assert(*(const uint32_t*)cached->GetScanLine(0) == 1);
+    assert(cache.GetCacheSize() == 100 * 100 * 4 * 2);
+
+    // least recently used image is released when the limit is reached
+    cache.Put(key3, image);
+    assert(cache.Get(key2) == NULL);
+    assert(cache.Get(key1) != NULL);
+    assert(cache.Get(key3) != NULL);
+    assert(cache.GetStats().Evictions == 1);
+    assert(cache.GetStats().Hits == 3);
+    assert(cache.GetStats().Misses == 2);
+
+    // all images of the changed sprite are released
+    cache.InvalidateSprite(1);
+    assert(cache.Get(key1) == NULL);
+    assert(cache.Get(key3) == NULL);
+    assert(cache.GetCacheSize() == 0);
+
+    delete image;
+    spriteset.SetMaxCacheSize(old_limit);
+}
+
 #endif // _DEBUG
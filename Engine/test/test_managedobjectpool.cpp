@@ -0,0 +1,124 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdio.h>
+#include <time.h>
+#include <vector>
+#include "ac/dynobj/cc_agsdynamicobject.h"
+#include "ac/dynobj/managedobjectpool.h"
+#include "debug/assert.h"
+
+// Dummy managed object type, which does not own any memory
+struct TestPoolObject : AGSCCDynamicObject
+{
+    virtual int Dispose(const char *address, bool force) { return 1; }
+    virtual const char *GetType() { return "TestPoolObject"; }
+    virtual int Serialize(const char *address, char *buffer, int bufsize) { return 0; }
+    virtual void Unserialize(int index, const char *serializedData, int dataSize) {}
+};
+
+void Test_ManagedObjectPool()
+{
+    TestPoolObject mgr;
+    ManagedObjectPool test_pool;
+    char objects[400];
+
+    // fill past the initial array size
+    for (int i = 0; i < 300; ++i)
+        assert(test_pool.AddObject(&objects[i], &mgr, false) == i + 1);
+    for (int i = 0; i < 300; ++i)
+    {
+        assert(test_pool.AddressToHandle(&objects[i]) == i + 1);
+        assert(test_pool.HandleToAddress(i + 1) == &objects[i]);
+    }
+    assert(test_pool.AddressToHandle(&objects[0] - 1) == 0);
+
+    // removed objects must not be found anymore
+    assert(test_pool.RemoveObject(&objects[10]) == 1);
+    assert(test_pool.RemoveObject(&objects[10]) == 0);
+    assert(test_pool.AddressToHandle(&objects[10]) == 0);
+    assert(test_pool.HandleToAddress(11) == NULL);
+    // disposed when the last reference is released
+    test_pool.AddRef(21);
+    test_pool.SubRef(21);
+    assert(test_pool.AddressToHandle(&objects[20]) == 0);
+
+    // fill remaining allocated space, after that released slots are reused,
+    // most recent first
+    int i = 300;
+    int32_t handle = 0;
+    for (; i < 400; ++i)
+    {
+        handle = test_pool.AddObject(&objects[i], &mgr, false);
+        if (handle != i + 1)
+            break;
+    }
+    assert(handle == 21);
+    assert(test_pool.AddressToHandle(&objects[i]) == 21);
+    assert(test_pool.AddObject(&objects[i + 1], &mgr, false) == 11);
+    assert(test_pool.AddressToHandle(&objects[i + 1]) == 11);
+
+    test_pool.reset();
+    for (i = 0; i < 400; ++i)
+        assert(test_pool.AddressToHandle(&objects[i]) == 0);
+    assert(test_pool.AddObject(&objects[0], &mgr, false) == 1);
+
+    // unreferenced objects are disposed by collector, referenced are kept
+    const int reclaimed = test_pool.GetGCReclaimedCount();
+    assert(test_pool.AddObject(&objects[1], &mgr, false) == 2);
+    test_pool.AddRef(2);
+    assert(test_pool.GetGCQueueLength() == 2);
+    assert(test_pool.RunGarbageCollectionStep(1) == 1);
+    assert(test_pool.AddressToHandle(&objects[0]) == 0);
+    assert(test_pool.RunGarbageCollectionStep(1) == 0);
+    assert(test_pool.AddressToHandle(&objects[1]) == 2);
+    assert(test_pool.GetGCReclaimedCount() == reclaimed + 1);
+    // queued again when the last reference is released without disposal
+    test_pool.disableDisposeForObject = &objects[1];
+    test_pool.SubRef(2);
+    test_pool.disableDisposeForObject = NULL;
+    assert(test_pool.AddressToHandle(&objects[1]) == 2);
+    assert(test_pool.GetGCQueueLength() == 1);
+    test_pool.RunGarbageCollection();
+    assert(test_pool.AddressToHandle(&objects[1]) == 0);
+    assert(test_pool.GetGCReclaimedCount() == reclaimed + 2);
+}
+
+void Test_ManagedObjectPoolPerf()
+{
+    TestPoolObject mgr;
+    for (int count = 1000; count <= 1000000; count *= 10)
+    {
+        ManagedObjectPool test_pool;
+        std::vector<char> objects(count);
+        const clock_t start = clock();
+        for (int i = 0; i < count; ++i)
+            test_pool.AddObject(&objects[i], &mgr, false);
+        for (int i = 0; i < count; ++i)
+            assert(test_pool.AddressToHandle(&objects[i]) != 0);
+        // release every second object, then recreate them
+        for (int i = 0; i < count; i += 2)
+            test_pool.RemoveObject(&objects[i]);
+        for (int i = 0; i < count; i += 2)
+            test_pool.AddObject(&objects[i], &mgr, false);
+        for (int i = 0; i < count; ++i)
+            test_pool.RemoveObject(&objects[i]);
+        printf("ManagedObjectPool: %d objects, %ld ms\n", count,
+            (long)((clock() - start) * 1000 / CLOCKS_PER_SEC));
+    }
+}
+
+#endif // _DEBUG
@@ -0,0 +1,235 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "ac/movelist.h"
+#include "ac/route_finder.h"
+#include "debug/assert.h"
+#include "gfx/bitmap.h"
+
+using namespace AGS::Common;
+
+extern int find_route_jps(int fromx, int fromy, int destx, int desty);
+extern int navpoints[];
+extern int num_navpoints;
+extern MoveList *mls;
+
+static const int MASK_WIDTH  = 640;
+static const int MASK_HEIGHT = 400;
+
+static unsigned int TestRandom(unsigned int &seed)
+{
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 16) & 0x7fff;
+}
+
+static void FillMaskRect(Bitmap *mask, int x1, int y1, int x2, int y2, int value)
+{
+    for (int y = std::max(0, y1); y <= std::min(mask->GetHeight() - 1, y2); ++y)
+    {
+        unsigned char *row = mask->GetScanLineForWriting(y);
+        for (int x = std::max(0, x1); x <= std::min(mask->GetWidth() - 1, x2); ++x)
+            row[x] = value;
+    }
+}
+
+// Makes room-like walkable mask: a floor divided by walls with doorways,
+// scattered furniture and an unreachable closed area
+static Bitmap *MakeTestMask()
+{
+    Bitmap *mask = BitmapHelper::CreateBitmap(MASK_WIDTH, MASK_HEIGHT, 8);
+    FillMaskRect(mask, 0, 0, MASK_WIDTH - 1, MASK_HEIGHT - 1, 0);
+    FillMaskRect(mask, 10, 10, MASK_WIDTH - 11, MASK_HEIGHT - 11, 1);
+    for (int wall = 1; wall < 4; ++wall)
+    {
+        const int x = wall * MASK_WIDTH / 4;
+        FillMaskRect(mask, x - 3, 10, x + 3, MASK_HEIGHT - 11, 0);
+        const int door = (wall % 2) ? 40 : MASK_HEIGHT - 80;
+        FillMaskRect(mask, x - 3, door, x + 3, door + 30, 1);
+    }
+    unsigned int seed = 1;
+    for (int i = 0; i < 60; ++i)
+    {
+        const int x = TestRandom(seed) % MASK_WIDTH;
+        const int y = TestRandom(seed) % MASK_HEIGHT;
+        FillMaskRect(mask, x, y, x + 5 + TestRandom(seed) % 30, y + 5 + TestRandom(seed) % 20, 0);
+    }
+    FillMaskRect(mask, 200, 150, 260, 200, 0);
+    FillMaskRect(mask, 210, 160, 250, 190, 2);
+    return mask;
+}
+
+struct TestRoute
+{
+    int FromX, FromY, DestX, DestY;
+};
+
+static std::vector<TestRoute> MakeTestRoutes(Bitmap *mask, size_t count)
+{
+    std::vector<TestRoute> routes;
+    unsigned int seed = 7;
+    while (routes.size() < count)
+    {
+        TestRoute r;
+        r.FromX = TestRandom(seed) % MASK_WIDTH;
+        r.FromY = TestRandom(seed) % MASK_HEIGHT;
+        r.DestX = TestRandom(seed) % MASK_WIDTH;
+        r.DestY = TestRandom(seed) % MASK_HEIGHT;
+        if (mask->GetScanLine(r.FromY)[r.FromX] != 0)
+            routes.push_back(r);
+    }
+    return routes;
+}
+
+static std::vector<int> FindTestRoute(const TestRoute &r)
+{
+    num_navpoints = 0;
+    std::vector<int> result;
+    result.push_back(find_route_jps(r.FromX, r.FromY, r.DestX, r.DestY));
+    result.insert(result.end(), navpoints, navpoints + num_navpoints);
+    return result;
+}
+
+void Test_RouteFinder()
+{
+    Bitmap *mask = MakeTestMask();
+    wallscreen = mask;
+    std::vector<TestRoute> routes = MakeTestRoutes(mask, 100);
+
+    // repeated requests give same routes as the first search
+    std::vector<std::vector<int> > found;
+    reset_route_cache();
+    for (size_t i = 0; i < routes.size(); ++i)
+        found.push_back(FindTestRoute(routes[i]));
+    for (size_t i = 0; i < routes.size(); ++i)
+        assert(FindTestRoute(routes[i]) == found[i]);
+    for (size_t i = routes.size(); i-- > 0;)
+        assert(FindTestRoute(routes[i]) == found[i]);
+
+    // remembered routes are not used after the mask has changed
+    FillMaskRect(mask, MASK_WIDTH / 2 - 3, 10, MASK_WIDTH / 2 + 3, MASK_HEIGHT - 11, 0);
+    std::vector<std::vector<int> > found_changed;
+    for (size_t i = 0; i < routes.size(); ++i)
+        found_changed.push_back(FindTestRoute(routes[i]));
+    reset_route_cache();
+    for (size_t i = 0; i < routes.size(); ++i)
+        assert(FindTestRoute(routes[i]) == found_changed[i]);
+
+    wallscreen = NULL;
+    delete mask;
+}
+
+void Test_RouteFinderBatch()
+{
+    Bitmap *masks[2] = { MakeTestMask(), MakeTestMask() };
+    FillMaskRect(masks[1], MASK_WIDTH / 2 - 3, 10, MASK_WIDTH / 2 + 3, MASK_HEIGHT - 11, 0);
+    std::vector<TestRoute> routes = MakeTestRoutes(masks[0], 40);
+    std::vector<RouteRequest> requests;
+    for (size_t i = 0; i < routes.size(); ++i)
+    {
+        RouteRequest r;
+        r.FromX = routes[i].FromX;
+        r.FromY = routes[i].FromY;
+        r.DestX = routes[i].DestX;
+        r.DestY = routes[i].DestY;
+        r.Mask = masks[i % 2];
+        r.MoveList = (int)i + 1;
+        r.NoCross = (i % 3) != 0;
+        r.IgnoreWalls = (i % 7) == 0;
+        r.SpeedX = (int)(i % 5) - 2;
+        r.SpeedY = (int)(i % 4) + 1;
+        r.Result = -1;
+        requests.push_back(r);
+    }
+    const size_t movelist_count = routes.size() + 1;
+    MoveList *old_mls = mls;
+
+    // batched routes are same as the ones found one by one, with or without
+    // the pathfinder threads
+    std::vector<MoveList> expect_mls(movelist_count);
+    memset(&expect_mls[0], 0, sizeof(MoveList) * movelist_count);
+    mls = &expect_mls[0];
+    reset_route_cache();
+    std::vector<int> expect_results;
+    for (size_t i = 0; i < requests.size(); ++i)
+    {
+        const RouteRequest &r = requests[i];
+        set_route_move_speed(r.SpeedX, r.SpeedY);
+        expect_results.push_back(find_route(r.FromX, r.FromY, r.DestX, r.DestY, r.Mask, r.MoveList, r.NoCross, r.IgnoreWalls));
+    }
+
+    for (int threads = 1; threads <= 4; threads += 3)
+    {
+        init_pathfinder(threads);
+        std::vector<MoveList> batch_mls(movelist_count);
+        memset(&batch_mls[0], 0, sizeof(MoveList) * movelist_count);
+        mls = &batch_mls[0];
+        reset_route_cache();
+        find_routes(requests);
+        for (size_t i = 0; i < requests.size(); ++i)
+            assert(requests[i].Result == expect_results[i]);
+        assert(memcmp(&batch_mls[0], &expect_mls[0], sizeof(MoveList) * movelist_count) == 0);
+    }
+
+    init_pathfinder();
+    mls = old_mls;
+    wallscreen = NULL;
+    delete masks[0];
+    delete masks[1];
+}
+
+static void PrintLatency(const char *what, std::vector<double> &times)
+{
+    std::sort(times.begin(), times.end());
+    printf("RouteFinder: %s: p50 %.3f ms, p90 %.3f ms, p99 %.3f ms, max %.3f ms\n", what,
+        times[times.size() * 50 / 100], times[times.size() * 90 / 100],
+        times[times.size() * 99 / 100], times.back());
+}
+
+void Test_RouteFinderPerf()
+{
+    Bitmap *mask = MakeTestMask();
+    wallscreen = mask;
+    // characters wandering between a limited set of points
+    std::vector<TestRoute> routes = MakeTestRoutes(mask, 20);
+    const size_t request_count = 2000;
+
+    for (int cached = 0; cached < 2; ++cached)
+    {
+        std::vector<double> times;
+        reset_route_cache();
+        unsigned int seed = 3;
+        for (size_t i = 0; i < request_count; ++i)
+        {
+            const TestRoute &r = routes[TestRandom(seed) % routes.size()];
+            if (!cached)
+                reset_route_cache();
+            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+            find_route_jps(r.FromX, r.FromY, r.DestX, r.DestY);
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count());
+        }
+        PrintLatency(cached ? "cached routes" : "no cache", times);
+    }
+
+    wallscreen = NULL;
+    delete mask;
+}
+
+#endif // _DEBUG
@@ -0,0 +1,222 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "debug/assert.h"
+#include "script/cc_instance.h"
+#include "script/cc_options.h"
+#include "script/script_common.h"
+#include "script/script_runtime.h"
+
+// Makes a script which exports a single function "test" without
+// arguments, starting at the beginning of the code
+static PScript MakeTestScript(const intptr_t *code, int codesize)
+{
+    PScript script(new ccScript());
+    script->codesize = codesize;
+    script->code = (intptr_t*)malloc(codesize * sizeof(intptr_t));
+    memcpy(script->code, code, codesize * sizeof(intptr_t));
+    // instance creation fails on a script without imports; unused import
+    // names are blanked out by the compiler, which is what this one is
+    script->numimports = 1;
+    script->importsCapacity = 1;
+    script->imports = (char**)malloc(sizeof(char*));
+    script->imports[0] = NULL;
+    script->numexports = 1;
+    script->exportsCapacity = 1;
+    script->exports = (char**)malloc(sizeof(char*));
+    script->exports[0] = strdup("test$0");
+    script->export_addr = (int32_t*)malloc(sizeof(int32_t));
+    script->export_addr[0] = (EXPORT_FUNCTION << 24) | 0;
+    return script;
+}
+
+// Value of the register or stack entry; stack pointers are saved as the
+// entry index, to compare them between instances
+struct TestScriptValue
+{
+    int     Type;
+    int32_t IValue;
+    intptr_t Ptr;
+    int     Size;
+
+    bool operator ==(const TestScriptValue &other) const
+    {
+        return Type == other.Type && IValue == other.IValue && Ptr == other.Ptr && Size == other.Size;
+    }
+};
+
+// Registers and stack contents at the script line
+struct TestScriptState
+{
+    int Line;
+    std::vector<TestScriptValue> Registers;
+    std::vector<TestScriptValue> Stack;
+
+    bool operator ==(const TestScriptState &other) const
+    {
+        return Line == other.Line && Registers == other.Registers && Stack == other.Stack;
+    }
+};
+
+static std::vector<TestScriptState> script_states;
+
+static TestScriptValue SaveTestValue(const ccInstance *inst, const RuntimeScriptValue &val)
+{
+    TestScriptValue saved;
+    saved.Type = val.Type;
+    saved.IValue = val.IValue;
+    saved.Ptr = val.Type == kScValStackPtr ? val.RValue - inst->stack : (intptr_t)val.Ptr;
+    saved.Size = val.Size;
+    return saved;
+}
+
+static void SaveTestScriptState(ccInstance *inst, int line)
+{
+    if (!inst)
+        return; // called with no instance when the script has finished
+    TestScriptState state;
+    state.Line = line;
+    for (int i = 0; i < CC_NUM_REGISTERS; ++i)
+        state.Registers.push_back(SaveTestValue(inst, inst->registers[i]));
+    for (const RuntimeScriptValue *val = inst->stack; val != inst->registers[SREG_SP].RValue; ++val)
+        state.Stack.push_back(SaveTestValue(inst, *val));
+    script_states.push_back(state);
+}
+
+// Runs the script's test function, saving the registers and stack at
+// every line; returns the value it returned
+static int RunTestScript(PScript script, bool fuse_ops, std::vector<TestScriptState> &states)
+{
+    const int old_fuse_ops = ccGetOption(SCOPT_FUSEOPS);
+    ccSetOption(SCOPT_FUSEOPS, fuse_ops);
+    ccInstance *inst = ccInstance::CreateFromScript(script);
+    ccSetOption(SCOPT_FUSEOPS, old_fuse_ops);
+    assert(inst != NULL);
+
+    script_states.clear();
+    ccSetDebugHook(SaveTestScriptState);
+    assert(inst->CallScriptFunction("test", 0, NULL) == 0);
+    ccSetDebugHook(NULL);
+    states = script_states;
+    script_states.clear();
+
+    const int result = inst->returnValue;
+    delete inst;
+    return result;
+}
+
+void Test_ScriptFuseOps()
+{
+    // every sequence which may be fused, with lines between them
+    const intptr_t code[] = {
+        SCMD_LOOPCHECKOFF,
+        SCMD_LITTOREG, SREG_AX, 5,
+        SCMD_LITTOREG, SREG_BX, 7,
+        SCMD_PUSHREG, SREG_AX,              // push, literal and pop
+        SCMD_LITTOREG, SREG_AX, 3,
+        SCMD_POPREG, SREG_CX,
+        SCMD_LINENUM, 1,
+        SCMD_ADDREG, SREG_AX, SREG_CX,
+        SCMD_LITTOREG, SREG_DX, 11,         // literal and push
+        SCMD_PUSHREG, SREG_DX,
+        SCMD_LINENUM, 2,
+        SCMD_LOADSPOFFS, 4,                 // local variable read
+        SCMD_MEMREAD, SREG_BX,
+        SCMD_LINENUM, 3,
+        SCMD_POPREG, SREG_DX,
+        SCMD_ISEQUAL, SREG_AX, SREG_BX,     // comparison and jump
+        SCMD_JZ, 3,
+        SCMD_LITTOREG, SREG_CX, 100,
+        SCMD_LINENUM, 4,
+        SCMD_LITTOREG, SREG_AX, 2,
+        SCMD_LESSTHAN, SREG_BX, SREG_DX,    // comparison, result to ax and jump
+        SCMD_REGTOREG, SREG_BX, SREG_AX,
+        SCMD_JZ, 3,
+        SCMD_LITTOREG, SREG_CX, 200,
+        SCMD_LINENUM, 5,
+        SCMD_REGTOREG, SREG_CX, SREG_AX,
+        SCMD_RET
+    };
+    PScript script = MakeTestScript(code, sizeof(code) / sizeof(code[0]));
+
+    // fused operations leave the same registers and stack as separate ones
+    std::vector<TestScriptState> states, fused_states;
+    assert(RunTestScript(script, false, states) == 5);
+    assert(RunTestScript(script, true, fused_states) == 5);
+    assert(states.size() == 5);
+    assert(states == fused_states);
+    assert(states[0].Registers[SREG_CX].IValue == 5);
+    assert(states[1].Stack.size() == 2 && states[1].Stack[1].IValue == 11);
+    assert(states[2].Registers[SREG_BX].IValue == 11);
+    assert(states[4].Registers[SREG_BX].IValue == 0);
+}
+
+// Runs the script's test function and prints how many instructions per
+// second were executed
+static void PrintScriptSpeed(const char *what, PScript script, bool predecode, bool fuse_ops, int expect_result, double instructions)
+{
+    const int old_predecode = ccGetOption(SCOPT_NOPREDECODE);
+    const int old_fuse_ops = ccGetOption(SCOPT_FUSEOPS);
+    ccSetOption(SCOPT_NOPREDECODE, !predecode);
+    ccSetOption(SCOPT_FUSEOPS, fuse_ops);
+    ccInstance *inst = ccInstance::CreateFromScript(script);
+    ccSetOption(SCOPT_NOPREDECODE, old_predecode);
+    ccSetOption(SCOPT_FUSEOPS, old_fuse_ops);
+    assert(inst != NULL);
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    assert(inst->CallScriptFunction("test", 0, NULL) == 0);
+    const double secs = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    assert(inst->returnValue == expect_result);
+    delete inst;
+    printf("Script: %s: %.1f million instructions per second\n", what, instructions / secs / 1000000.0);
+}
+
+void Test_ScriptDispatchPerf()
+{
+    // a loop counting to the limit, passing the counter through the stack
+    const int limit = 5000000;
+    const int loop_instructions = 8;
+    const intptr_t code[] = {
+        SCMD_LOOPCHECKOFF,
+        SCMD_LITTOREG, SREG_CX, 0,
+        SCMD_LITTOREG, SREG_DX, limit,
+        SCMD_PUSHREG, SREG_CX,              // loop start
+        SCMD_LITTOREG, SREG_BX, 1,
+        SCMD_POPREG, SREG_AX,
+        SCMD_ADDREG, SREG_AX, SREG_BX,
+        SCMD_REGTOREG, SREG_AX, SREG_CX,
+        SCMD_LESSTHAN, SREG_AX, SREG_DX,
+        SCMD_JZ, 2,
+        SCMD_JMP, -20,                      // to the loop start
+        SCMD_REGTOREG, SREG_CX, SREG_AX,
+        SCMD_RET
+    };
+    PScript script = MakeTestScript(code, sizeof(code) / sizeof(code[0]));
+    const double instructions = (double)limit * loop_instructions;
+    // decoding each instruction when it is executed is what the engine
+    // did before the operations were decoded when creating the instance
+    PrintScriptSpeed("decoded on execution", script, false, false, limit, instructions);
+    PrintScriptSpeed("pre-decoded, separate operations", script, true, false, limit, instructions);
+    PrintScriptSpeed("pre-decoded, fused operations", script, true, true, limit, instructions);
+}
+
+#endif // _DEBUG
@@ -0,0 +1,140 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "debug/assert.h"
+#include "gfx/bitmap.h"
+#include "util/file.h"
+#include "util/mappedfilestream.h"
+
+using namespace AGS::Common;
+
+static const int SPRITE_COUNT  = 1000;
+static const int SPRITE_WIDTH  = 128;
+static const int SPRITE_HEIGHT = 128;
+
+// Sums the pixels, so that the sprite memory is actually accessed
+static uint32_t SumPixels(Bitmap *image)
+{
+    uint32_t sum = 0;
+    for (int y = 0; y < image->GetHeight(); ++y)
+    {
+        const uint32_t *px = (const uint32_t*)image->GetScanLine(y);
+        for (int x = 0; x < image->GetWidth(); ++x)
+            sum += px[x];
+    }
+    return sum;
+}
+
+// Same as SpriteCache does with uncompressed sprite file
+static uint32_t LoadFromStream(const std::vector<soff_t> &offsets)
+{
+    uint32_t sum = 0;
+    Stream *in = File::OpenFileRead("test.tmp");
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        in->Seek(offsets[i], kSeekBegin);
+        int coldep = in->ReadInt16();
+        int wdd = in->ReadInt16();
+        int htt = in->ReadInt16();
+        Bitmap *image = BitmapHelper::CreateBitmap(wdd, htt, coldep * 8);
+        for (int hh = 0; hh < htt; ++hh)
+            in->ReadArrayOfInt32((int32_t*)image->GetScanLineForWriting(hh), wdd);
+        sum += SumPixels(image);
+        delete image;
+    }
+    delete in;
+    return sum;
+}
+
+static uint32_t LoadFromMappedFile(const std::vector<soff_t> &offsets, int &wrapped)
+{
+    uint32_t sum = 0;
+    wrapped = 0;
+    MappedFileStream in("test.tmp");
+    for (size_t i = 0; i < offsets.size(); ++i)
+    {
+        int16_t fields[3];
+        memcpy(fields, in.GetData(offsets[i], sizeof(fields)), sizeof(fields));
+        const size_t pitch = fields[1] * fields[0];
+        const uint8_t *data = in.GetData(offsets[i] + sizeof(fields), pitch * fields[2]);
+        Bitmap *image = new Bitmap();
+        if (((uintptr_t)data % fields[0]) == 0 && image->WrapPixelData(const_cast<uint8_t*>(data), fields[1], fields[2], fields[0] * 8))
+        {
+            wrapped++;
+        }
+        else
+        {
+            image->Create(fields[1], fields[2], fields[0] * 8);
+            for (int hh = 0; hh < fields[2]; ++hh)
+                memcpy(image->GetScanLineForWriting(hh), data + hh * pitch, pitch);
+        }
+        sum += SumPixels(image);
+        delete image;
+    }
+    return sum;
+}
+
+void Test_SpriteLoadPerf()
+{
+    // Uncompressed sprite file layout: color depth, width, height, pixels
+    std::vector<soff_t> offsets;
+    Stream *out = File::CreateFile("test.tmp");
+    std::vector<int32_t> pixels(SPRITE_WIDTH * SPRITE_HEIGHT);
+    for (int i = 0; i < SPRITE_COUNT; ++i)
+    {
+        offsets.push_back(out->GetPosition());
+        out->WriteInt16(4);
+        out->WriteInt16(SPRITE_WIDTH);
+        out->WriteInt16(SPRITE_HEIGHT);
+        for (size_t p = 0; p < pixels.size(); ++p)
+            pixels[p] = i * 7919 + p;
+        out->WriteArrayOfInt32(&pixels.front(), pixels.size());
+    }
+    delete out;
+
+    MappedFileStream test_mapping("test.tmp");
+    if (!test_mapping.IsValid())
+    {
+        printf("SpriteLoad: file mapping is not supported\n");
+        File::DeleteFile("test.tmp");
+        return;
+    }
+    test_mapping.Close();
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        clock_t start = clock();
+        const uint32_t stream_sum = LoadFromStream(offsets);
+        const long stream_ms = (long)((clock() - start) * 1000 / CLOCKS_PER_SEC);
+
+        int wrapped;
+        start = clock();
+        const uint32_t mapped_sum = LoadFromMappedFile(offsets, wrapped);
+        const long mapped_ms = (long)((clock() - start) * 1000 / CLOCKS_PER_SEC);
+
+        assert(stream_sum == mapped_sum);
+        printf("SpriteLoad: %d sprites %dx%d, stream %ld ms, mapped %ld ms (%d not copied)\n",
+            SPRITE_COUNT, SPRITE_WIDTH, SPRITE_HEIGHT, stream_ms, mapped_ms, wrapped);
+    }
+
+    File::DeleteFile("test.tmp");
+}
+
+#endif // _DEBUG
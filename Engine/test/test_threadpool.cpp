@@ -0,0 +1,48 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <algorithm>
+#include <vector>
+#include "debug/assert.h"
+#include "util/threadpool.h"
+
+using namespace AGS::Common;
+
+void Test_ThreadPool()
+{
+    ThreadPool serial_pool(1);
+    assert(serial_pool.GetThreadCount() == 1);
+    ThreadPool auto_pool(0);
+    assert(auto_pool.GetThreadCount() >= 1);
+
+    ThreadPool test_pool(4);
+    assert(test_pool.GetThreadCount() == 4);
+    // every index is run exactly once, in every batch
+    std::vector<int> runs(1000);
+    for (int pass = 0; pass < 100; ++pass)
+    {
+        const size_t count = pass * 10;
+        test_pool.RunForEach(count, [&runs](size_t i) { runs[i]++; });
+        for (size_t i = 0; i < runs.size(); ++i)
+            assert(runs[i] == (i < count ? 1 : 0));
+        std::fill(runs.begin(), runs.end(), 0);
+    }
+    serial_pool.RunForEach(runs.size(), [&runs](size_t i) { runs[i] = (int)i; });
+    for (size_t i = 0; i < runs.size(); ++i)
+        assert(runs[i] == (int)i);
+}
+
+#endif // _DEBUG
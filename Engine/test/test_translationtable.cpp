@@ -0,0 +1,63 @@
+//=============================================================================
+//
+// Adventure Game Studio (AGS)
+//
+// Copyright (C) 1999-2011 Chris Jones and 2011-20xx others
+// The full list of copyright holders can be found in the Copyright.txt
+// file, which is part of this source code distribution.
+//
+// The AGS source code is provided under the Artistic License 2.0.
+// A copy of this license can be found in the file License.txt and at
+// http://www.opensource.org/licenses/artistic-license-2.0.php
+//
+//=============================================================================
+
+#ifdef _DEBUG
+
+#include <stdio.h>
+#include <string.h>
+#include "ac/translationtable.h"
+#include "debug/assert.h"
+
+void Test_TranslationTable()
+{
+    TranslationTable table;
+    assert(table.GetCount() == 0);
+    assert(table.FindValue("Hello") == NULL);
+
+    table.AddText("Hello", "Hallo");
+    table.AddText("", "Empty");
+    table.AddText(NULL, "Null");
+    // first translation of the same text is kept
+    table.AddText("Hello", "Servus");
+    table.AddText("Untranslated", "");
+    assert(table.GetCount() == 2);
+    assert(strcmp(table.FindValue("Hello"), "Hallo") == 0);
+    assert(strcmp(table.FindValue("Untranslated"), "") == 0);
+    assert(table.FindValue("") == NULL);
+    assert(table.FindValue("hello") == NULL);
+
+    // texts remain found as the table grows
+    char text[32], translation[32];
+    for (int i = 0; i < 10000; ++i)
+    {
+        sprintf(text, "Line %d", i);
+        sprintf(translation, "Zeile %d", i);
+        table.AddText(text, translation);
+    }
+    assert(table.GetCount() == 10002);
+    for (int i = 0; i < 10000; ++i)
+    {
+        sprintf(text, "Line %d", i);
+        sprintf(translation, "Zeile %d", i);
+        assert(strcmp(table.FindValue(text), translation) == 0);
+    }
+    assert(table.FindValue("Line 10000") == NULL);
+    assert(strcmp(table.FindValue("Hello"), "Hallo") == 0);
+
+    table.Clear();
+    assert(table.GetCount() == 0);
+    assert(table.FindValue("Hello") == NULL);
+}
+
+#endif // _DEBUG